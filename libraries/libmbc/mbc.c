@@ -61,6 +61,7 @@
 
 #include "mbc.h"
 #include "sock.h"
+#include "shm.h"
 
 
 /* private flags for internal use */
@@ -85,6 +86,27 @@ mbc_cmd2str(uint8_t cmd)
 	return "UNKNOWN";
 }
 
+/* send/receive using the transport the connection was initialized with */
+static ssize_t
+mbc_sendn(mbc_t *mbc, const void *buf, size_t n)
+{
+	if (mbc->shm != NULL) {
+		return mbc_shm_sendn(mbc->shm, (const char *)buf, n);
+	}
+
+	return sendn(mbc->sock, (const char *)buf, n, mbc->send_flags);
+}
+
+static ssize_t
+mbc_recvn(mbc_t *mbc, void *buf, size_t n)
+{
+	if (mbc->shm != NULL) {
+		return mbc_shm_recvn(mbc->shm, (char *)buf, n, 0);
+	}
+
+	return recvn(mbc->sock, (char *)buf, n, mbc->recv_flags);
+}
+
 /* validate command
  *
  * command needs to be set in mbc->cmd
@@ -127,8 +149,7 @@ mbc_get_cmd(mbc_t *mbc)
 	}
 #endif /* _WIN32 */
 
-	rc = recvn(mbc->sock, (char *)&mbc->cmd, sizeof(mbc->cmd),
-		  mbc->recv_flags);
+	rc = mbc_recvn(mbc, (char *)&mbc->cmd, sizeof(mbc->cmd));
 
 	if (rc == SOCKET_ERROR) {
 		int err = WSAGetLastError();
@@ -187,8 +208,7 @@ mbc_put_cmd(mbc_t *mbc)
 			(unsigned long)mbc->cmd, mbc_cmd2str(mbc->cmd));
 	}
 
-	rc = sendn(mbc->sock, (const char *)&mbc->cmd, sizeof(mbc->cmd),
-		mbc->send_flags);
+	rc = mbc_sendn(mbc, (const char *)&mbc->cmd, sizeof(mbc->cmd));
 
 	if (rc == SOCKET_ERROR){
 		int save_errno = WSAGetLastError();
@@ -312,6 +332,8 @@ mbc_inet_init(mbc_t *mbc, const char *host, short unsigned port)
 		return -1;
 	}
 
+	mbc->shm = NULL;
+
 	int sock_err;
 	int serr = mbdyn_make_inet_socket(&mbc->sock, &addr, host, port, 0, &sock_err);
 	if (serr != 0) {
@@ -343,6 +365,8 @@ mbc_unix_init(mbc_t *mbc, const char *path)
 		return -1;
 	}
 
+	mbc->shm = NULL;
+
 	rc = mbdyn_make_named_socket(&mbc->sock, &addr, path, 0, NULL);
 	if (rc == 0) {
 		rc = mbc_init(mbc, (struct sockaddr *)&addr, sizeof(addr));
@@ -351,6 +375,50 @@ mbc_unix_init(mbc_t *mbc, const char *path)
 }
 #endif /* _WIN32 */
 
+/* initialize communication using shared memory
+ *
+ * mbc must be a pointer to a valid mbc_t structure
+ * name must be defined
+ */
+int
+mbc_shm_init(mbc_t *mbc, const char *name)
+{
+	char buf[256];
+	int err = 0;
+
+	if (name == NULL || name[0] == '\0') {
+		fprintf(stderr, "shared memory name must be defined\n");
+		return -1;
+	}
+
+	/* MBDyn prepends '/' to the name when missing; do the same */
+	if (name[0] != '/') {
+		if (snprintf(buf, sizeof(buf), "/%s", name) >= (int)sizeof(buf)) {
+			fprintf(stderr, "shared memory name \"%s\" too long\n", name);
+			return -1;
+		}
+		name = buf;
+	}
+
+	mbc->sock = INVALID_SOCKET;
+	mbc->shm = mbc_shm_open(name, mbc->timeout, &err);
+	if (mbc->shm == NULL) {
+		fprintf(stderr, "unable to attach to shared memory \"%s\" (%d: %s)\n",
+			name, err, strerror(err));
+		return -1;
+	}
+
+	if (mbc->verbose) {
+		fprintf(stdout, "Shared memory attach succeeded\n");
+	}
+
+	mbc->recv_flags = 0;
+	mbc->send_flags = 0;
+	mbc->sock_flags = MBC_SF_VALID;
+
+	return 0;
+}
+
 /* destroy communication
  *
  * does NOT free the mbc structure
@@ -359,6 +427,11 @@ static int
 mbc_destroy(mbc_t *mbc)
 {
 	/* TODO: send "abort"? */
+	if (mbc->shm != NULL) {
+		mbc_shm_close(mbc->shm);
+		mbc->shm = NULL;
+	}
+
 	if (mbc->sock != INVALID_SOCKET) {
 #ifdef _WIN32
         /*shutdown(mbc->sock, SD_BOTH); */
@@ -513,8 +586,8 @@ mbc_nodal_get_motion(mbc_nodal_t *mbc)
 			unsigned long mode = 0;
 			int ioctlresult = ioctlsocket(mbc->mbc.sock, FIONBIO, &mode);
 #endif
-			rc = recvn(mbc->mbc.sock, (void *)MBC_R_KINEMATICS(mbc),
-				MBC_R_KINEMATICS_SIZE(mbc), mbc->mbc.recv_flags);
+			rc = mbc_recvn(&mbc->mbc, (void *)MBC_R_KINEMATICS(mbc),
+				MBC_R_KINEMATICS_SIZE(mbc));
 
 			if (rc == SOCKET_ERROR){
 				int save_errno = WSAGetLastError();
@@ -543,8 +616,8 @@ mbc_nodal_get_motion(mbc_nodal_t *mbc)
 			unsigned long mode = 0;
 			int ioctlresult = ioctlsocket(mbc->mbc.sock, FIONBIO, &mode);
 #endif
-			rc = recvn(mbc->mbc.sock, (void *)MBC_N_KINEMATICS(mbc),
-				MBC_N_KINEMATICS_SIZE(mbc), mbc->mbc.recv_flags);
+			rc = mbc_recvn(&mbc->mbc, (void *)MBC_N_KINEMATICS(mbc),
+				MBC_N_KINEMATICS_SIZE(mbc));
 			if (rc == SOCKET_ERROR){
 				int save_errno = WSAGetLastError();
 				char* msg = sock_err_string(save_errno);
@@ -610,8 +683,8 @@ mbc_nodal_put_forces(mbc_nodal_t *mbc, int last)
 
 			ssize_t	rc;
 
-			rc = sendn(mbc->mbc.sock, (const void *)MBC_R_DYNAMICS(mbc),
-				MBC_R_DYNAMICS_SIZE(mbc), mbc->mbc.send_flags);
+			rc = mbc_sendn(&mbc->mbc, (const void *)MBC_R_DYNAMICS(mbc),
+				MBC_R_DYNAMICS_SIZE(mbc));
 
 			if (rc != MBC_R_DYNAMICS_SIZE(mbc)) {
 				fprintf(stderr, "send(%lu) reference node failed (%ld)\n",
@@ -630,8 +703,8 @@ mbc_nodal_put_forces(mbc_nodal_t *mbc, int last)
 
 			ssize_t	rc;
 
-			rc = sendn(mbc->mbc.sock, (const void *)MBC_N_DYNAMICS(mbc),
-				MBC_N_DYNAMICS_SIZE(mbc), mbc->mbc.send_flags);
+			rc = mbc_sendn(&mbc->mbc, (const void *)MBC_N_DYNAMICS(mbc),
+				MBC_N_DYNAMICS_SIZE(mbc));
 
 		if (mbc->mbc.verbose)
 		{
@@ -871,8 +944,7 @@ mbc_nodal_negotiate_request(mbc_nodal_t *mbc)
 	uint32_ptr[0] = MBC_F(mbc);
 	uint32_ptr[1] = mbc->nodes;
 
-	rc = sendn(mbc->mbc.sock, (const void *)buf, sizeof(buf),
-		mbc->mbc.send_flags);
+	rc = mbc_sendn(&mbc->mbc, (const void *)buf, sizeof(buf));
 	if (rc != sizeof(buf)) {
 		fprintf(stderr, "send negotiate request failed (%ld)\n", (long)rc);
 		return -1;
@@ -932,7 +1004,7 @@ mbc_nodal_negotiate_response(mbc_nodal_t *mbc)
 		return -1;
 	}
 
-	rc = recvn(mbc->mbc.sock, (void *)buf, sizeof(buf), mbc->mbc.recv_flags);
+	rc = mbc_recvn(&mbc->mbc, (void *)buf, sizeof(buf));
 	if (rc != sizeof(buf)) {
 		fprintf(stderr, "recv negotiate request failed\n");
 		return -1;
@@ -1038,8 +1110,8 @@ mbc_modal_get_motion(mbc_modal_t *mbc)
 		if (MBC_F_REF_NODE(mbc)) {
 			ssize_t rc;
 
-			rc = recvn(mbc->mbc.sock, (void *)MBC_R_KINEMATICS(mbc),
-				MBC_R_KINEMATICS_SIZE(mbc), mbc->mbc.recv_flags);
+			rc = mbc_recvn(&mbc->mbc, (void *)MBC_R_KINEMATICS(mbc),
+				MBC_R_KINEMATICS_SIZE(mbc));
 			if (rc == -1) {
 				int save_errno = WSAGetLastError();
 				const char *msg;
@@ -1060,8 +1132,8 @@ mbc_modal_get_motion(mbc_modal_t *mbc)
 		if (mbc->modes > 0) {
 			ssize_t rc;
 
-			rc = recvn(mbc->mbc.sock, (void *)MBC_M_KINEMATICS(mbc),
-				MBC_M_KINEMATICS_SIZE(mbc), mbc->mbc.recv_flags);
+			rc = mbc_recvn(&mbc->mbc, (void *)MBC_M_KINEMATICS(mbc),
+				MBC_M_KINEMATICS_SIZE(mbc));
 			if (rc == -1) {
 				int save_errno = WSAGetLastError();
 				const char *msg;
@@ -1114,8 +1186,8 @@ mbc_modal_put_forces(mbc_modal_t *mbc, int last)
 		if (MBC_F_REF_NODE(mbc)) {
 			ssize_t	rc;
 
-			rc = sendn(mbc->mbc.sock, (const void *)MBC_R_DYNAMICS(mbc),
-				MBC_R_DYNAMICS_SIZE(mbc), mbc->mbc.send_flags);
+			rc = mbc_sendn(&mbc->mbc, (const void *)MBC_R_DYNAMICS(mbc),
+				MBC_R_DYNAMICS_SIZE(mbc));
 			if (rc == -1) {
 				int save_errno = WSAGetLastError();
 				const char *msg;
@@ -1137,8 +1209,8 @@ mbc_modal_put_forces(mbc_modal_t *mbc, int last)
 		if (mbc->modes > 0) {
 			ssize_t	rc;
 
-			rc = sendn(mbc->mbc.sock, (const void *)MBC_M_DYNAMICS(mbc),
-				MBC_M_DYNAMICS_SIZE(mbc), mbc->mbc.send_flags);
+			rc = mbc_sendn(&mbc->mbc, (const void *)MBC_M_DYNAMICS(mbc),
+				MBC_M_DYNAMICS_SIZE(mbc));
 			if (rc == -1) {
 				int save_errno = WSAGetLastError();
 				const char *msg;
@@ -1234,8 +1306,7 @@ mbc_modal_negotiate_request(mbc_modal_t *mbc)
 	uint32_ptr[0] = (uint32_t)MBC_F(mbc);
 	uint32_ptr[1] = mbc->modes;
 
-	rc = sendn(mbc->mbc.sock, (const void *)buf, sizeof(buf),
-		mbc->mbc.send_flags);
+	rc = mbc_sendn(&mbc->mbc, (const void *)buf, sizeof(buf));
 	if (rc != sizeof(buf)) {
 		fprintf(stderr, "send negotiate request failed (%ld)\n", (long)rc);
 		return -1;
@@ -1293,7 +1364,7 @@ mbc_modal_negotiate_response(mbc_modal_t *mbc)
 		return -1;
 	}
 
-	rc = recvn(mbc->mbc.sock, (void *)buf, sizeof(buf), mbc->mbc.recv_flags);
+	rc = mbc_recvn(&mbc->mbc, (void *)buf, sizeof(buf));
 	if (rc != sizeof(buf)) {
 		fprintf(stderr, "recv negotiate request failed\n");
 		return -1;
@@ -118,11 +118,16 @@ enum MBCType {
 	MBC_LAST
 };
 
+struct mbc_shm;
+
 /** \brief Connection data structure (partially opaque) */
 typedef struct {
 	/** Opaque. */
 	SOCKET	    sock;
 
+	/** Opaque. */
+	struct mbc_shm	*shm;
+
 	/** Opaque. */
 	unsigned	sock_flags;
 
@@ -209,6 +214,23 @@ mbc_inet_init(mbc_t *mbc, const char *host, short unsigned port);
 extern int
 mbc_unix_init(mbc_t *mbc, const char *path);
 
+/** \brief Initialize communication using shared memory.
+ *
+ * \param [in,out] mbc a pointer to a valid mbc_t structure
+ * \param [in] name name of the shared memory segment (see shm_open(3))
+ *
+ * Attaches to the shared memory segment created by the peer
+ * (e.g. MBDyn's "shared memory" external communicator);
+ * name must be defined.  If the segment does not exist yet,
+ * the behavior depends on mbc_t::timeout.
+ * Data are exchanged through lock-free ring buffers,
+ * without system calls unless a side needs to wait.
+ *
+ * @return 0 on success, !0 on failure.
+ */
+extern int
+mbc_shm_init(mbc_t *mbc, const char *name);
+
 /**
  * \brief Reference node (AKA "rigid") stuff (partially opaque).
  *
@@ -0,0 +1,288 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Local ping-pong benchmark of the co-simulation transports:
+ * a child process echoes a payload back to the parent through
+ * an inet socket, a local socket and shared memory, and the parent
+ * reports the average round trip time.
+ *
+ * usage: mbc_pingpong [iterations [payload_bytes]]
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+
+#include "sock.h"
+#include "shm.h"
+
+typedef struct {
+	SOCKET sock;
+	mbc_shm_t *shm;
+} pp_conn_t;
+
+static ssize_t
+pp_sendn(pp_conn_t *c, const char *buf, size_t n)
+{
+	if (c->shm != NULL) {
+		return mbc_shm_sendn(c->shm, buf, n);
+	}
+	return sendn(c->sock, buf, n, 0);
+}
+
+static ssize_t
+pp_recvn(pp_conn_t *c, char *buf, size_t n)
+{
+	if (c->shm != NULL) {
+		return mbc_shm_recvn(c->shm, buf, n, 0);
+	}
+	return recvn(c->sock, buf, n, MSG_WAITALL);
+}
+
+static void
+pp_close(pp_conn_t *c)
+{
+	if (c->shm != NULL) {
+		mbc_shm_close(c->shm);
+	}
+	if (c->sock != INVALID_SOCKET) {
+		close(c->sock);
+	}
+}
+
+static double
+pp_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+static int
+pp_echo(pp_conn_t *c, char *buf, size_t n)
+{
+	for ( ; ; ) {
+		ssize_t rc = pp_recvn(c, buf, n);
+		if (rc != (ssize_t)n) {
+			/* peer done */
+			return 0;
+		}
+		if (pp_sendn(c, buf, n) != (ssize_t)n) {
+			return -1;
+		}
+	}
+}
+
+static int
+pp_connect(pp_conn_t *c, struct sockaddr *addr, socklen_t len)
+{
+	int i;
+
+	for (i = 0; i < 100; i++) {
+		if (connect(c->sock, addr, len) == 0) {
+			return 0;
+		}
+		usleep(10000);
+	}
+
+	return -1;
+}
+
+static int
+pp_run(const char *type, unsigned iters, size_t n)
+{
+	pp_conn_t srv = { INVALID_SOCKET, NULL }, c = { INVALID_SOCKET, NULL };
+	struct sockaddr_in in_addr;
+	struct sockaddr_un un_addr;
+	char name[64];
+	char *buf;
+	pid_t pid;
+	unsigned i;
+	double t0, dt;
+	int status;
+
+	buf = (char *)calloc(n, 1);
+	if (buf == NULL) {
+		return -1;
+	}
+
+	/* server side, as in MBDyn */
+	if (strcmp(type, "inet") == 0) {
+		socklen_t len = sizeof(in_addr);
+
+		/* port 0: let the kernel pick a free one */
+		if (mbdyn_make_inet_socket(&srv.sock, &in_addr, "127.0.0.1", 0, 1, NULL) != 0
+			|| listen(srv.sock, 1) != 0
+			|| getsockname(srv.sock, (struct sockaddr *)&in_addr, &len) != 0)
+		{
+			fprintf(stderr, "inet: unable to listen\n");
+			return -1;
+		}
+
+	} else if (strcmp(type, "unix") == 0) {
+		snprintf(name, sizeof(name), "/tmp/mbc_pingpong.%ld", (long)getpid());
+		unlink(name);
+		if (mbdyn_make_named_socket(&srv.sock, &un_addr, name, 1, NULL) != 0
+			|| listen(srv.sock, 1) != 0)
+		{
+			fprintf(stderr, "unix: unable to listen on %s\n", name);
+			return -1;
+		}
+
+	} else {
+		int err = 0;
+
+		snprintf(name, sizeof(name), "/mbc_pingpong.%ld", (long)getpid());
+		c.shm = mbc_shm_create(name, 0, &err);
+		if (c.shm == NULL) {
+			fprintf(stderr, "shm: unable to create %s (%s)\n", name, strerror(err));
+			return -1;
+		}
+	}
+
+	pid = fork();
+	if (pid == -1) {
+		return -1;
+	}
+
+	if (pid == 0) {
+		/* peer side, as in libmbc */
+		pp_conn_t p = { INVALID_SOCKET, NULL };
+		int rc = -1;
+
+		if (strcmp(type, "shm") == 0) {
+			p.shm = mbc_shm_open(name, 10, NULL);
+			rc = (p.shm == NULL) ? -1 : 0;
+
+		} else if (strcmp(type, "inet") == 0) {
+			struct sockaddr_in addr;
+
+			if (mbdyn_make_inet_socket(&p.sock, &addr, "127.0.0.1", ntohs(in_addr.sin_port), 0, NULL) == 0) {
+				rc = pp_connect(&p, (struct sockaddr *)&addr, sizeof(addr));
+			}
+
+		} else {
+			struct sockaddr_un addr;
+
+			if (mbdyn_make_named_socket(&p.sock, &addr, name, 0, NULL) == 0) {
+				rc = pp_connect(&p, (struct sockaddr *)&addr, sizeof(addr));
+			}
+		}
+
+		if (rc == 0) {
+			rc = pp_echo(&p, buf, n);
+		}
+		pp_close(&p);
+		_exit(rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	if (srv.sock != INVALID_SOCKET) {
+		c.sock = accept(srv.sock, NULL, NULL);
+		if (c.sock == INVALID_SOCKET) {
+			fprintf(stderr, "%s: accept failed (%s)\n", type, strerror(errno));
+			return -1;
+		}
+	}
+
+	/* warm up */
+	for (i = 0; i < iters/10 + 1; i++) {
+		if (pp_sendn(&c, buf, n) != (ssize_t)n || pp_recvn(&c, buf, n) != (ssize_t)n) {
+			fprintf(stderr, "%s: exchange failed\n", type);
+			return -1;
+		}
+	}
+
+	t0 = pp_now();
+	for (i = 0; i < iters; i++) {
+		pp_sendn(&c, buf, n);
+		pp_recvn(&c, buf, n);
+	}
+	dt = pp_now() - t0;
+
+	pp_close(&c);
+	pp_close(&srv);
+	waitpid(pid, &status, 0);
+	if (strcmp(type, "unix") == 0) {
+		unlink(name);
+	}
+	free(buf);
+
+	fprintf(stdout, "%-5s %8lu bytes: %10.3f us/round trip\n",
+		type, (unsigned long)n, 1e6*dt/iters);
+
+	return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+	const char *types[] = { "inet", "unix", "shm" };
+	unsigned iters = 10000;
+	size_t sizes[] = { 8, 0 };
+	unsigned t, s;
+	int rc = EXIT_SUCCESS;
+
+	if (argc > 1) {
+		iters = strtoul(argv[1], NULL, 10);
+		if (iters == 0) {
+			fprintf(stderr, "usage: %s [iterations [payload_bytes]]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* default: 100 nodes, position, orientation matrix, velocities */
+	sizes[1] = 100*(3 + 9 + 3 + 3)*sizeof(double);
+	if (argc > 2) {
+		sizes[1] = strtoul(argv[2], NULL, 10);
+	}
+
+	for (s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+		for (t = 0; t < sizeof(types)/sizeof(types[0]); t++) {
+			if (pp_run(types[t], iters, sizes[s]) != 0) {
+				rc = EXIT_FAILURE;
+			}
+		}
+	}
+
+	return rc;
+}
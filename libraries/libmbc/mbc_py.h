@@ -35,6 +35,10 @@
 #include "mbc.h"
 #include "mbc_py_global.h"
 
+/* a path starting with this prefix names a shared memory segment
+ * (e.g. "shm:/mbdyn") instead of a local socket */
+#define MBC_PY_SHM_PREFIX "shm:"
+
 extern int
 mbc_py_nodal_initialize(const char *const path,
 	const char *const host, unsigned port,
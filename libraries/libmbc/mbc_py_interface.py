@@ -39,7 +39,7 @@ except ImportError:
 
 class mbcNodal:
 	def __init__(self, path, host, port, timeout, verbose, data_and_next, refnode, nodes, labels, rot, accels):
-		""" initialize the module """
+		""" initialize the module; path="shm:<name>" uses shared memory """
 		self.id = mbc_py.mbc_py_nodal_initialize(path, host, port, timeout, verbose, data_and_next, refnode, nodes, labels, rot, accels);
 		if self.id < 0:
 			print("mbc_py_nodal_initialize: error");
@@ -117,7 +117,7 @@ class mbcNodal:
 
 class mbcModal:
 	def __init__(self, path, host, port, timeout, verbose, data_and_next, refnode, modes):
-		""" initialize the module """
+		""" initialize the module; path="shm:<name>" uses shared memory """
 		self.id = mbc_py.mbc_py_modal_initialize(path, host, port, timeout, verbose, data_and_next, refnode, modes);
 		if self.id < 0:
 			print("mbc_py_modal_initialize: error");
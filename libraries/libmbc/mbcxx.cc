@@ -143,6 +143,15 @@ MBCBase::Init(const char *const host, short unsigned port)
 	return rc;
 }
 
+int
+MBCBase::InitShm(const char *const name)
+{
+	if (GetStatus() != INITIALIZED) return -1;
+	int rc = mbc_shm_init(GetBasePtr(), name);
+	if (rc == 0) SetStatus(SOCKET_READY);
+	return rc;
+}
+
 int
 MBCBase::GetCmd(void) const
 {
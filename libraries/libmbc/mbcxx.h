@@ -92,6 +92,7 @@ public:
 
 	int Init(const char *const path);
 	int Init(const char *const host, short unsigned port);
+	int InitShm(const char *const name);
 
 	Status GetStatus(void) const;
 	virtual int Negotiate(void) const = 0;
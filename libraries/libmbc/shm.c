@@ -0,0 +1,557 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "shm.h"
+
+#ifdef USE_SHM
+
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_LINUX_FUTEX_H
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif /* HAVE_LINUX_FUTEX_H */
+
+#define MBC_SHM_MAGIC		0x4d424353U	/* "MBCS" */
+#define MBC_SHM_VERSION		1U
+#define MBC_SHM_CACHELINE	64
+#define MBC_SHM_MIN_SIZE	4096
+
+/* number of polls before going to sleep
+ * (no polling on a single CPU: the peer could not run meanwhile) */
+#define MBC_SHM_SPIN		4000
+
+/* a sleeping side wakes up at least this often (ms)
+ * to check whether the peer is still alive */
+#define MBC_SHM_POLL_MS		500
+
+/* one cache line per writer, to avoid false sharing */
+typedef struct {
+	/* bytes written (producer) or read (consumer) so far */
+	uint64_t	pos;
+	/* bumped after each update of pos; futex word */
+	uint32_t	seq;
+	/* !0 when the owner sleeps waiting for the other side */
+	uint32_t	waiters;
+	char		pad[MBC_SHM_CACHELINE - sizeof(uint64_t) - 2*sizeof(uint32_t)];
+} mbc_shm_line_t;
+
+typedef struct {
+	mbc_shm_line_t	prod;
+	mbc_shm_line_t	cons;
+} mbc_shm_ring_t;
+
+typedef struct {
+	uint32_t	magic;
+	uint32_t	version;
+	uint64_t	size;
+	int32_t		pid[2];
+	uint32_t	closed[2];
+	char		pad[MBC_SHM_CACHELINE - 2*sizeof(uint32_t) - sizeof(uint64_t) - 2*sizeof(int32_t) - 2*sizeof(uint32_t)];
+
+	/* ring[0]: side 0 -> side 1; ring[1]: side 1 -> side 0;
+	 * data follows the header */
+	mbc_shm_ring_t	ring[2];
+} mbc_shm_header_t;
+
+struct mbc_shm {
+	mbc_shm_header_t	*hdr;
+	size_t			maplen;
+	char			*data[2];
+	uint64_t		mask;
+	int			side;
+	int			spin;
+	char			*name;
+};
+
+static void
+mbc_shm_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#else
+	__asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+static void
+mbc_shm_usleep(long us)
+{
+	struct timespec ts;
+
+	ts.tv_sec = us/1000000L;
+	ts.tv_nsec = (us % 1000000L)*1000L;
+	(void)nanosleep(&ts, NULL);
+}
+
+static void
+mbc_shm_sleep(uint32_t *addr, uint32_t val)
+{
+#ifdef HAVE_LINUX_FUTEX_H
+	struct timespec ts = { 0, MBC_SHM_POLL_MS*1000000L };
+
+	/* no FUTEX_PRIVATE_FLAG: the word is shared among processes */
+	(void)syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+#else /* ! HAVE_LINUX_FUTEX_H */
+	if (__atomic_load_n(addr, __ATOMIC_SEQ_CST) == val) {
+		mbc_shm_usleep(50);
+	}
+#endif /* ! HAVE_LINUX_FUTEX_H */
+}
+
+static void
+mbc_shm_wake(uint32_t *addr)
+{
+#ifdef HAVE_LINUX_FUTEX_H
+	(void)syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif /* HAVE_LINUX_FUTEX_H */
+}
+
+/* publish an update of self->pos and wake the other side if it sleeps */
+static void
+mbc_shm_signal(mbc_shm_line_t *self, mbc_shm_line_t *other)
+{
+	__atomic_add_fetch(&self->seq, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&other->waiters, __ATOMIC_SEQ_CST)) {
+		mbc_shm_wake(&self->seq);
+	}
+}
+
+static int
+mbc_shm_peer_gone(mbc_shm_t *shm)
+{
+	int peer = 1 - shm->side;
+	pid_t pid;
+
+	if (__atomic_load_n(&shm->hdr->closed[peer], __ATOMIC_SEQ_CST)) {
+		return 1;
+	}
+
+	/* peer not attached yet */
+	pid = __atomic_load_n(&shm->hdr->pid[peer], __ATOMIC_SEQ_CST);
+	if (pid == 0) {
+		return 0;
+	}
+
+	return (kill(pid, 0) == -1 && errno == ESRCH);
+}
+
+/* wait until other->pos differs from pos;
+ * returns 0 on success, -1 if the peer is gone */
+static int
+mbc_shm_wait(mbc_shm_t *shm, mbc_shm_line_t *other, uint64_t pos, uint32_t *waiters)
+{
+	int i;
+
+	for (i = 0; i < shm->spin; i++) {
+		if (__atomic_load_n(&other->pos, __ATOMIC_ACQUIRE) != pos) {
+			return 0;
+		}
+		mbc_shm_relax();
+	}
+
+	for (;;) {
+		uint32_t seq = __atomic_load_n(&other->seq, __ATOMIC_SEQ_CST);
+		int changed;
+
+		__atomic_add_fetch(waiters, 1, __ATOMIC_SEQ_CST);
+		changed = (__atomic_load_n(&other->pos, __ATOMIC_SEQ_CST) != pos);
+		if (!changed) {
+			mbc_shm_sleep(&other->seq, seq);
+			changed = (__atomic_load_n(&other->pos, __ATOMIC_SEQ_CST) != pos);
+		}
+		__atomic_sub_fetch(waiters, 1, __ATOMIC_SEQ_CST);
+
+		if (changed) {
+			return 0;
+		}
+
+		if (mbc_shm_peer_gone(shm)) {
+			/* the peer may have written before leaving */
+			return (__atomic_load_n(&other->pos, __ATOMIC_SEQ_CST) != pos) ? 0 : -1;
+		}
+	}
+}
+
+static mbc_shm_t *
+mbc_shm_map(int fd, size_t maplen, int *perrno)
+{
+	mbc_shm_t *shm;
+	void *p;
+
+	p = mmap(NULL, maplen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED) {
+		*perrno = errno;
+		return NULL;
+	}
+
+	shm = (mbc_shm_t *)calloc(1, sizeof(mbc_shm_t));
+	if (shm == NULL) {
+		*perrno = ENOMEM;
+		munmap(p, maplen);
+		return NULL;
+	}
+
+	shm->hdr = (mbc_shm_header_t *)p;
+	shm->maplen = maplen;
+
+	return shm;
+}
+
+static void
+mbc_shm_setup(mbc_shm_t *shm, uint64_t size, int side)
+{
+	shm->data[0] = (char *)&shm->hdr[1];
+	shm->data[1] = shm->data[0] + size;
+	shm->mask = size - 1;
+	shm->side = side;
+	shm->spin = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? MBC_SHM_SPIN : 0;
+
+	__atomic_store_n(&shm->hdr->pid[side], (int32_t)getpid(), __ATOMIC_SEQ_CST);
+}
+
+mbc_shm_t *
+mbc_shm_create(const char *name, size_t size, int *perrno)
+{
+	mbc_shm_t *shm = NULL;
+	uint64_t rsize = MBC_SHM_MIN_SIZE;
+	size_t maplen;
+	int fd, err = 0;
+
+	if (perrno == NULL) {
+		perrno = &err;
+	}
+
+	if (name == NULL) {
+		*perrno = EINVAL;
+		return NULL;
+	}
+
+	if (size == 0) {
+		size = MBC_SHM_DEFAULT_SIZE;
+	}
+
+	while (rsize < size) {
+		rsize <<= 1;
+	}
+
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd == -1 && errno == EEXIST) {
+		/* leftover from a previous run */
+		(void)shm_unlink(name);
+		fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	}
+
+	if (fd == -1) {
+		*perrno = errno;
+		return NULL;
+	}
+
+	maplen = sizeof(mbc_shm_header_t) + 2*rsize;
+	if (ftruncate(fd, maplen) == -1) {
+		*perrno = errno;
+		close(fd);
+		(void)shm_unlink(name);
+		return NULL;
+	}
+
+	shm = mbc_shm_map(fd, maplen, perrno);
+	close(fd);
+	if (shm == NULL) {
+		(void)shm_unlink(name);
+		return NULL;
+	}
+
+	shm->name = strdup(name);
+
+	/* ftruncate(2) zero-fills the segment */
+	shm->hdr->version = MBC_SHM_VERSION;
+	shm->hdr->size = rsize;
+	mbc_shm_setup(shm, rsize, 0);
+
+	/* the peer does not use the segment until the magic appears */
+	__atomic_store_n(&shm->hdr->magic, MBC_SHM_MAGIC, __ATOMIC_RELEASE);
+
+	return shm;
+}
+
+mbc_shm_t *
+mbc_shm_open(const char *name, int timeout, int *perrno)
+{
+	const long useconds = 100000;
+	long left = (long)timeout*1000000L;
+	int err = 0;
+
+	if (perrno == NULL) {
+		perrno = &err;
+	}
+
+	if (name == NULL) {
+		*perrno = EINVAL;
+		return NULL;
+	}
+
+	for ( ; ; ) {
+		int fd = shm_open(name, O_RDWR, 0);
+
+		if (fd == -1 && errno != ENOENT) {
+			*perrno = errno;
+			return NULL;
+		}
+
+		if (fd != -1) {
+			struct stat st;
+			mbc_shm_t *shm = NULL;
+
+			/* the segment may not have been sized yet */
+			if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(mbc_shm_header_t)) {
+				shm = mbc_shm_map(fd, st.st_size, perrno);
+			}
+			close(fd);
+
+			if (shm != NULL) {
+				mbc_shm_header_t *hdr = shm->hdr;
+
+				if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) == MBC_SHM_MAGIC) {
+					if (hdr->version != MBC_SHM_VERSION
+						|| shm->maplen != sizeof(mbc_shm_header_t) + 2*hdr->size)
+					{
+						munmap(hdr, shm->maplen);
+						free(shm);
+						*perrno = EINVAL;
+						return NULL;
+					}
+
+					mbc_shm_setup(shm, hdr->size, 1);
+
+					return shm;
+				}
+
+				munmap(hdr, shm->maplen);
+				free(shm);
+			}
+		}
+
+		/* segment not ready yet; retry */
+		if (timeout == 0 || (timeout > 0 && left <= 0)) {
+			*perrno = ENOENT;
+			return NULL;
+		}
+
+		mbc_shm_usleep(useconds);
+		if (timeout > 0) {
+			left -= useconds;
+		}
+	}
+}
+
+ssize_t
+mbc_shm_sendn(mbc_shm_t *shm, const char *buf, size_t n)
+{
+	mbc_shm_ring_t *r = &shm->hdr->ring[shm->side];
+	char *data = shm->data[shm->side];
+	const uint64_t size = shm->mask + 1;
+	uint64_t head = r->prod.pos;
+	size_t left = n;
+
+	if (__atomic_load_n(&shm->hdr->closed[1 - shm->side], __ATOMIC_SEQ_CST)) {
+		errno = EPIPE;
+		return -1;
+	}
+
+	while (left > 0) {
+		uint64_t tail = __atomic_load_n(&r->cons.pos, __ATOMIC_ACQUIRE);
+		uint64_t room = size - (head - tail);
+		size_t chunk, off, first;
+
+		if (room == 0) {
+			if (mbc_shm_wait(shm, &r->cons, tail, &r->prod.waiters)) {
+				errno = EPIPE;
+				return -1;
+			}
+			continue;
+		}
+
+		chunk = left < room ? left : room;
+		off = head & shm->mask;
+		first = size - off;
+		if (first > chunk) {
+			first = chunk;
+		}
+		memcpy(&data[off], buf, first);
+		memcpy(&data[0], buf + first, chunk - first);
+
+		buf += chunk;
+		left -= chunk;
+		head += chunk;
+
+		__atomic_store_n(&r->prod.pos, head, __ATOMIC_SEQ_CST);
+		mbc_shm_signal(&r->prod, &r->cons);
+	}
+
+	return n;
+}
+
+ssize_t
+mbc_shm_recvn(mbc_shm_t *shm, char *buf, size_t n, int flags)
+{
+	const int side = 1 - shm->side;
+	mbc_shm_ring_t *r = &shm->hdr->ring[side];
+	const char *data = shm->data[side];
+	const uint64_t size = shm->mask + 1;
+	uint64_t tail = r->cons.pos;
+	size_t got = 0;
+
+	while (got < n) {
+		uint64_t head = __atomic_load_n(&r->prod.pos, __ATOMIC_ACQUIRE);
+		uint64_t avail = head - tail;
+		size_t chunk, off, first;
+
+		if (avail == 0) {
+			if (got == 0 && (flags & MBC_SHM_DONTWAIT)) {
+				errno = EAGAIN;
+				return -1;
+			}
+
+			if (mbc_shm_wait(shm, &r->prod, head, &r->cons.waiters)) {
+				/* like recv(2) when the peer closed the connection */
+				break;
+			}
+			continue;
+		}
+
+		chunk = (n - got) < avail ? (n - got) : avail;
+		off = tail & shm->mask;
+		first = size - off;
+		if (first > chunk) {
+			first = chunk;
+		}
+		memcpy(buf + got, &data[off], first);
+		memcpy(buf + got + first, &data[0], chunk - first);
+
+		got += chunk;
+		tail += chunk;
+
+		__atomic_store_n(&r->cons.pos, tail, __ATOMIC_SEQ_CST);
+		mbc_shm_signal(&r->cons, &r->prod);
+	}
+
+	return got;
+}
+
+void
+mbc_shm_close(mbc_shm_t *shm)
+{
+	mbc_shm_header_t *hdr;
+	int side;
+
+	if (shm == NULL) {
+		return;
+	}
+
+	hdr = shm->hdr;
+	side = shm->side;
+
+	__atomic_store_n(&hdr->closed[side], 1, __ATOMIC_SEQ_CST);
+
+	/* wake up the peer, whether it waits for data or for room */
+	__atomic_add_fetch(&hdr->ring[side].prod.seq, 1, __ATOMIC_SEQ_CST);
+	mbc_shm_wake(&hdr->ring[side].prod.seq);
+	__atomic_add_fetch(&hdr->ring[1 - side].cons.seq, 1, __ATOMIC_SEQ_CST);
+	mbc_shm_wake(&hdr->ring[1 - side].cons.seq);
+
+	munmap(hdr, shm->maplen);
+
+	if (shm->name != NULL) {
+		if (side == 0) {
+			(void)shm_unlink(shm->name);
+		}
+		free(shm->name);
+	}
+
+	free(shm);
+}
+
+#else /* ! USE_SHM */
+
+mbc_shm_t *
+mbc_shm_create(const char *name, size_t size, int *perrno)
+{
+	if (perrno != NULL) {
+		*perrno = ENOSYS;
+	}
+	return NULL;
+}
+
+mbc_shm_t *
+mbc_shm_open(const char *name, int timeout, int *perrno)
+{
+	if (perrno != NULL) {
+		*perrno = ENOSYS;
+	}
+	return NULL;
+}
+
+ssize_t
+mbc_shm_sendn(mbc_shm_t *shm, const char *buf, size_t n)
+{
+	errno = ENOSYS;
+	return -1;
+}
+
+ssize_t
+mbc_shm_recvn(mbc_shm_t *shm, char *buf, size_t n, int flags)
+{
+	errno = ENOSYS;
+	return -1;
+}
+
+void
+mbc_shm_close(mbc_shm_t *shm)
+{
+	(void)shm;
+}
+
+#endif /* ! USE_SHM */
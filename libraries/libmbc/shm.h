@@ -0,0 +1,107 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Shared memory transport for co-simulation.
+ *
+ * A POSIX shared memory segment holds two lock-free single-producer,
+ * single-consumer byte rings, one for each direction.  The side that
+ * creates the segment (usually MBDyn) writes to ring 0 and reads from
+ * ring 1; the side that attaches to it does the opposite.  The rings
+ * are byte streams, so the same protocol used over sockets can be
+ * used unchanged.  A waiting peer spins for a while, then sleeps on a
+ * futex (where available) until the other side signals new data or
+ * new room.
+ */
+
+#ifndef MBC_SHM_H
+#define MBC_SHM_H
+
+#include "mbconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <sys/types.h>
+
+typedef struct mbc_shm mbc_shm_t;
+
+/* default size of each ring, in bytes */
+#define MBC_SHM_DEFAULT_SIZE	(1024*1024)
+
+/* flags for mbc_shm_recvn() */
+enum {
+	/* return -1 with errno == EAGAIN if no data is available */
+	MBC_SHM_DONTWAIT = 0x1
+};
+
+/** Creates a shared memory segment and attaches to it as side 0
+ *
+ *  param name Input name of the segment (e.g. "/mbdyn"; see shm_open(3))
+ *  param size Input size of each ring in bytes (rounded up to a power of 2;
+ *    0 means MBC_SHM_DEFAULT_SIZE)
+ *  param perrno Output errno in case of failure (may be NULL)
+ *
+ *  returns NULL in case of failure
+ */
+extern mbc_shm_t *
+mbc_shm_create(const char *name, size_t size, int *perrno);
+
+/** Attaches to an existing shared memory segment as side 1
+ *
+ *  param name Input name of the segment
+ *  param timeout Input as mbc_t::timeout: when the segment does not exist yet,
+ *    0 fails immediately, > 0 retries for timeout seconds, < 0 retries forever
+ *  param perrno Output errno in case of failure (may be NULL)
+ *
+ *  returns NULL in case of failure
+ */
+extern mbc_shm_t *
+mbc_shm_open(const char *name, int timeout, int *perrno);
+
+/* like sendn(); returns n, or -1 with errno == EPIPE if the peer is gone */
+extern ssize_t
+mbc_shm_sendn(mbc_shm_t *shm, const char *buf, size_t n);
+
+/* like recvn(); returns n, or less if the peer is gone */
+extern ssize_t
+mbc_shm_recvn(mbc_shm_t *shm, char *buf, size_t n, int flags);
+
+/* detaches from the segment, and removes it if this side created it */
+extern void
+mbc_shm_close(mbc_shm_t *shm);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* MBC_SHM_H */
@@ -64,6 +64,7 @@ CColMatrixHandler<off, idx_type>::Copy(void) const
 	     new CColMatrixHandler<off, idx_type>(*pax, this->Ai,
 						  this->Ap);
 	p->bMatDuplicate = true;
+	p->uPatternId = this->uPatternId;
 
 	return p;
 }
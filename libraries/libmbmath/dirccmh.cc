@@ -74,6 +74,7 @@ DirCColMatrixHandler<off, idx_type>::Copy(void) const
 	     new DirCColMatrixHandler<off, idx_type>(*pax, this->Ai,
 						     this->Ap);
 	p->bMatDuplicate = true;
+	p->uPatternId = this->uPatternId;
 
 	return p;
 }
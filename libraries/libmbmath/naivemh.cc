@@ -48,136 +48,47 @@
 NaiveMatrixHandler::NaiveMatrixHandler(const integer n,
         NaiveMatrixHandler *const nmh)
 :  iSize(n), bOwnsMemory(true),
-ppdRows(0), ppiRows(0), ppiCols(0), ppnonzero(0), piNzr(0), piNzc(0), m_end(*this, true)
+pMat(0), m_end(*this, true)
 {
         if (nmh) {
                 bOwnsMemory = false;
                 iSize = nmh->iSize;
-                ppdRows = nmh->ppdRows;
-                ppiRows = nmh->ppiRows;
-                ppiCols = nmh->ppiCols;
-                ppnonzero = nmh->ppnonzero;
-                piNzr = nmh->piNzr;
-                piNzc = nmh->piNzc;
+                pMat = nmh->pMat;
 
         } else {
                 ASSERT(iSize > 0);
-                try {
-                        SAFENEWARR(ppiRows, integer *, iSize);
-                        ppiRows[0] = 0;
-                        SAFENEWARR(ppiRows[0], integer, iSize*iSize);
-
-                        SAFENEWARR(ppiCols, integer *, iSize);
-                        ppiCols[0] = 0;
-                        SAFENEWARR(ppiCols[0], integer, iSize*iSize);
-
-                        SAFENEWARR(ppdRows, doublereal *, iSize);
-                        ppdRows[0] = NULL;
-                        SAFENEWARR(ppdRows[0], doublereal, iSize*iSize);
-
-                        SAFENEWARR(ppnonzero, char *, iSize);
-                        ppnonzero[0] = NULL;
-                        SAFENEWARR(ppnonzero[0], char, iSize*iSize);
-
-                        SAFENEWARR(piNzr, integer, iSize);
-                        SAFENEWARR(piNzc, integer, iSize);
-
-                }
-                catch (std::bad_alloc& ba) {
-                        size_t howmany = sizeof(integer *)*iSize*2
-                                + sizeof(doublereal *)*iSize
-                                + sizeof(char *)*iSize
-                                + sizeof(integer)*2*iSize*iSize
-                                + sizeof(doublereal)*iSize*iSize
-                                + sizeof(char)*iSize*iSize;
-
-                        silent_cerr("Error allocating memory for Naive matrix handler\n"
-                                "while trying to build a " << iSize << "x" << iSize  << " Naive (and full) square matrix,\n"
-                                "requiring " << howmany << " (yes: " << howmany/1024/1024/1024 << " Giga) bytes.\n"
-                                "Consider switching to a linear solver different from Naive, one that\n"
-                                "handles sparse matrices with sparse storage (possibly column-compressed;\n"
-                                "e.g. Umfpack or KLU)\n" << std::endl);
-                        throw(ba);
-                }
-                for (integer i = 1; i < iSize; i++) {
-                        ppiRows[i] = ppiRows[i - 1] + iSize;
-                        ppiCols[i] = ppiCols[i - 1] + iSize;
-                        ppdRows[i] = ppdRows[i - 1] + iSize;
-                        ppnonzero[i] = ppnonzero[i - 1] + iSize;
+                SAFENEW(pMat, naive_mat);
+                switch (naive_init(pMat, iSize)) {
+                case 0:
+                        break;
+
+                case NAIVE_ERANGE:
+                        SAFEDELETE(pMat);
+                        silent_cerr("Naive matrix handler: "
+                                "invalid size " << iSize << std::endl);
+                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+
+                default:
+                        SAFEDELETE(pMat);
+                        silent_cerr("Error allocating memory for Naive matrix handler "
+                                "of size " << iSize << std::endl);
+                        throw std::bad_alloc();
                 }
-
-#ifdef HAVE_MEMSET
-                memset(ppdRows[0], 0, sizeof(doublereal)*iSize*iSize);
-                memset(ppnonzero[0], 0, sizeof(char)*iSize*iSize);
-                memset(piNzr, 0, sizeof(integer)*iSize);
-                memset(piNzc, 0, sizeof(integer)*iSize);
-#else /* ! HAVE_MEMSET */
-                for (integer row = 0; row < iSize; row++) {
-                        for (integer col = 0; col < iSize; col++) {
-                                ppnonzero[row][col] = 0;
-                        }
-                        piNzr[row] = 0;
-                        piNzc[row] = 0;
-                }
-#endif /* ! HAVE_MEMSET */
         }
 }
 
 NaiveMatrixHandler::~NaiveMatrixHandler(void)
 {
-        if (bOwnsMemory) {
-                if (ppiRows) {
-                        if (ppiRows[0]) {
-                                SAFEDELETEARR(ppiRows[0]);
-                        }
-                        SAFEDELETEARR(ppiRows);
-                }
-
-                if (ppiCols) {
-                        if (ppiCols[0]) {
-                                SAFEDELETEARR(ppiCols[0]);
-                        }
-                        SAFEDELETEARR(ppiCols);
-                }
-
-                if (ppdRows) {
-                        if (ppdRows[0]) {
-                                SAFEDELETEARR(ppdRows[0]);
-                        }
-                        SAFEDELETEARR(ppdRows);
-                }
-
-                if (ppnonzero) {
-                        if (ppnonzero[0]) {
-                                SAFEDELETEARR(ppnonzero[0]);
-                        }
-                        SAFEDELETEARR(ppnonzero);
-                }
-
-                if (piNzr) {
-                        SAFEDELETEARR(piNzr);
-                }
-
-                if (piNzc) {
-                        SAFEDELETEARR(piNzc);
-                }
+        if (bOwnsMemory && pMat) {
+                naive_destroy(pMat);
+                SAFEDELETE(pMat);
         }
 }
 
 void
 NaiveMatrixHandler::Reset(void)
 {
-        for (integer row = 0; row < iSize; row++) {
-                integer ncols = piNzc[row];
-                integer *piCols = ppiCols[row];
-                char *pnonzero = ppnonzero[row];
-                for (integer col = 0; col < ncols; col++) {
-                        pnonzero[piCols[col]] = 0;
-                }
-
-                piNzr[row] = 0;
-                piNzc[row] = 0;
-        }
+        naive_reset(pMat);
 }
 
 /* Overload di += usato per l'assemblaggio delle matrici */
@@ -373,7 +284,7 @@ NaiveMatrixHandler::MakeCCStructure(std::vector<integer>& Ai,
                                     std::vector<integer>& Ap) {
         integer nnz = 0;
         for (integer i = 0; i < iSize; i++) {
-                nnz += piNzr[i];
+                nnz += pMat->nzr[i];
         }
 
         Ai.resize(nnz);
@@ -382,9 +293,9 @@ NaiveMatrixHandler::MakeCCStructure(std::vector<integer>& Ai,
         integer x_ptr = 0;
         for (integer col = 0; col < iSize; col++) {
                 Ap[col] = x_ptr;
-                integer nzr = piNzr[col];
+                integer nzr = pMat->nzr[col];
                 for (integer row = 0; row < nzr; row++) {
-                        Ai[x_ptr] = ppiRows[col][row];
+                        Ai[x_ptr] = pMat->ri[col][row];
                         x_ptr++;
                 }
         }
@@ -416,10 +327,10 @@ NaiveMatrixHandler::MatMatMul_base(
         integer in_ncols = in.iGetNumCols();
 
         for (integer ir = 0; ir < iSize; ir++) {
-                for (integer idx = 0; idx < piNzc[ir]; idx++) {
-                        integer ic = ppiCols[ir][idx];
+                for (integer idx = 0; idx < pMat->nzc[ir]; idx++) {
+                        integer ic = pMat->ci[ir][idx];
                         for (integer ik = 1; ik <= in_ncols; ik++) {
-                                (out.*op)(ir + 1, ik, ppdRows[ir][ic]*in(ic + 1, ik));
+                                (out.*op)(ir + 1, ik, pMat->a[ir][idx]*in(ic + 1, ik));
                         }
                 }
         }
@@ -439,10 +350,10 @@ NaiveMatrixHandler::MatTMatMul_base(
         integer in_ncols = in.iGetNumCols();
 
         for (integer ic = 0; ic < iSize; ic++) {
-                for (integer idx = 0; idx < piNzr[ic]; idx++) {
-                        integer ir = ppiRows[ic][idx];
+                for (integer idx = 0; idx < pMat->nzr[ic]; idx++) {
+                        integer ir = pMat->ri[ic][idx];
                         for (integer ik = 1; ik <= in_ncols; ik++) {
-                                (out.*op)(ic + 1, ik, ppdRows[ir][ic]*in(ir + 1, ik));
+                                (out.*op)(ic + 1, ik, pMat->a[ir][pMat->rs[ic][idx]]*in(ir + 1, ik));
                         }
                 }
         }
@@ -460,9 +371,9 @@ NaiveMatrixHandler::MatVecMul_base(
         ASSERT(out.iGetSize() == iSize);
 
         for (integer ir = 0; ir < iSize; ir++) {
-                for (integer idx = 0; idx < piNzc[ir]; idx++) {
-                        integer ic = ppiCols[ir][idx];
-                        (out.*op)(ir + 1, ppdRows[ir][ic]*in(ic + 1));
+                for (integer idx = 0; idx < pMat->nzc[ir]; idx++) {
+                        integer ic = pMat->ci[ir][idx];
+                        (out.*op)(ir + 1, pMat->a[ir][idx]*in(ic + 1));
                 }
         }
 
@@ -478,9 +389,9 @@ NaiveMatrixHandler::MatTVecMul_base(
         ASSERT(out.iGetSize() == iSize);
 
         for (integer ic = 0; ic < iSize; ic++) {
-                for (integer idx = 0; idx < piNzr[ic]; idx++) {
-                        integer ir = ppiRows[ic][idx];
-                        (out.*op)(ic + 1, ppdRows[ir][ic]*in(ir + 1));
+                for (integer idx = 0; idx < pMat->nzr[ic]; idx++) {
+                        integer ir = pMat->ri[ic][idx];
+                        (out.*op)(ic + 1, pMat->a[ir][pMat->rs[ic][idx]]*in(ir + 1));
                 }
         }
 
@@ -498,15 +409,15 @@ NaiveMatrixHandler::const_iterator::reset(bool is_end)
                 i_row = 0;
                 elem.iCol = 0;
 
-                while (m.piNzr[elem.iCol] == 0) {
+                while (m.pMat->nzr[elem.iCol] == 0) {
                         if (++elem.iCol == m.iSize) {
                                 elem.iRow = m.iSize;
                                 return;
                         }
                 }
 
-                elem.iRow = m.ppiRows[elem.iCol][i_row];
-                elem.dCoef = m.ppdRows[elem.iRow][elem.iCol];
+                elem.iRow = m.pMat->ri[elem.iCol][i_row];
+                elem.dCoef = m.pMat->a[elem.iRow][m.pMat->rs[elem.iCol][i_row]];
         }
 }
 
@@ -525,7 +436,7 @@ const NaiveMatrixHandler::const_iterator&
 NaiveMatrixHandler::const_iterator::operator ++ (void) const
 {
         i_row++;
-        while (i_row == m.piNzr[elem.iCol]) {
+        while (i_row == m.pMat->nzr[elem.iCol]) {
                 if (++elem.iCol == m.iSize) {
                         elem.iRow = m.iSize;
                         return *this;
@@ -534,8 +445,8 @@ NaiveMatrixHandler::const_iterator::operator ++ (void) const
                 i_row = 0;
         }
 
-        elem.iRow = m.ppiRows[elem.iCol][i_row];
-        elem.dCoef = m.ppdRows[elem.iRow][elem.iCol];
+        elem.iRow = m.pMat->ri[elem.iCol][i_row];
+        elem.dCoef = m.pMat->a[elem.iRow][m.pMat->rs[elem.iCol][i_row]];
 
         return *this;
 }
@@ -636,10 +547,10 @@ NaivePermMatrixHandler::MatMatMul_base(
         integer in_ncols = in.iGetNumCols();
 
         for (integer ir = 0; ir < iSize; ir++) {
-                for (integer idx = 0; idx < piNzc[ir]; idx++) {
-                        integer ic = ppiCols[ir][idx];
+                for (integer idx = 0; idx < pMat->nzc[ir]; idx++) {
+                        integer ic = pMat->ci[ir][idx];
                         for (integer ik = 1; ik <= in_ncols; ik++) {
-                                (out.*op)(ir + 1, ik, ppdRows[ir][ic]*in(invperm[ic] + 1, ik));
+                                (out.*op)(ir + 1, ik, pMat->a[ir][idx]*in(invperm[ic] + 1, ik));
                         }
                 }
         }
@@ -665,10 +576,10 @@ NaivePermMatrixHandler::MatTMatMul_base(
         integer in_ncols = in.iGetNumCols();
 
         for (integer ic = 0; ic < iSize; ic++) {
-                for (integer idx = 0; idx < piNzr[ic]; idx++) {
-                        integer ir = ppiRows[ic][idx];
+                for (integer idx = 0; idx < pMat->nzr[ic]; idx++) {
+                        integer ir = pMat->ri[ic][idx];
                         for (integer ik = 1; ik <= in_ncols; ik++) {
-                                (out.*op)(invperm[ic] + 1, ik, ppdRows[ir][ic]*in(ir + 1, ik));
+                                (out.*op)(invperm[ic] + 1, ik, pMat->a[ir][pMat->rs[ic][idx]]*in(ir + 1, ik));
                         }
                 }
         }
@@ -692,9 +603,9 @@ NaivePermMatrixHandler::MatVecMul_base(
         ASSERT(out.iGetSize() == iSize);
 
         for (integer ir = 0; ir < iSize; ir++) {
-                for (integer idx = 0; idx < piNzc[ir]; idx++) {
-                        integer ic = ppiCols[ir][idx];
-                        (out.*op)(ir + 1, ppdRows[ir][ic]*in(invperm[ic] + 1));
+                for (integer idx = 0; idx < pMat->nzc[ir]; idx++) {
+                        integer ic = pMat->ci[ir][idx];
+                        (out.*op)(ir + 1, pMat->a[ir][idx]*in(invperm[ic] + 1));
                 }
         }
 
@@ -716,9 +627,9 @@ NaivePermMatrixHandler::MatTVecMul_base(
         ASSERT(out.iGetSize() == iSize);
 
         for (integer ic = 0; ic < iSize; ic++) {
-                for (integer idx = 0; idx < piNzr[ic]; idx++) {
-                        integer ir = ppiRows[ic][idx];
-                        (out.*op)(invperm[ic] + 1, ppdRows[ir][ic]*in(ir + 1));
+                for (integer idx = 0; idx < pMat->nzr[ic]; idx++) {
+                        integer ir = pMat->ri[ic][idx];
+                        (out.*op)(invperm[ic] + 1, pMat->a[ir][pMat->rs[ic][idx]]*in(ir + 1));
                 }
         }
 
@@ -770,8 +681,8 @@ NaivePermMatrixHandler::const_iterator::reset(bool is_end)
         } else {
                 i_row = 0;
                 elem.iCol = 0;
-                elem.iRow = m.ppiRows[m.perm[elem.iCol]][i_row];
-                elem.dCoef = m.ppdRows[elem.iRow][m.perm[elem.iCol]];
+                elem.iRow = m.pMat->ri[m.perm[elem.iCol]][i_row];
+                elem.dCoef = m.pMat->a[elem.iRow][m.pMat->rs[m.perm[elem.iCol]][i_row]];
         }
 
 #ifdef DEBUG
@@ -785,15 +696,15 @@ NaivePermMatrixHandler::const_iterator::const_iterator(const NaivePermMatrixHand
 #ifdef DEBUG
         m.IsValid();
 #endif
-        while (m.piNzr[m.perm[elem.iCol]] == 0) {
+        while (m.pMat->nzr[m.perm[elem.iCol]] == 0) {
                 if (++elem.iCol == m.iSize) {
                         elem.iRow = m.iSize;
                         return;
                 }
         }
 
-        elem.iRow = m.ppiRows[m.perm[elem.iCol]][i_row];
-        elem.dCoef = m.ppdRows[elem.iRow][m.perm[elem.iCol]];
+        elem.iRow = m.pMat->ri[m.perm[elem.iCol]][i_row];
+        elem.dCoef = m.pMat->a[elem.iRow][m.pMat->rs[m.perm[elem.iCol]][i_row]];
 
 #ifdef DEBUG
         m.IsValid();
@@ -818,7 +729,7 @@ NaivePermMatrixHandler::const_iterator::operator ++ (void) const
         m.IsValid();
 #endif
         i_row++;
-        while (i_row == m.piNzr[m.perm[elem.iCol]]) {
+        while (i_row == m.pMat->nzr[m.perm[elem.iCol]]) {
                 if (++elem.iCol == m.iSize) {
                         elem.iRow = m.iSize;
 #ifdef DEBUG
@@ -830,8 +741,8 @@ NaivePermMatrixHandler::const_iterator::operator ++ (void) const
                 i_row = 0;
         }
 
-        elem.iRow = m.ppiRows[m.perm[elem.iCol]][i_row];
-        elem.dCoef = m.ppdRows[elem.iRow][m.perm[elem.iCol]];
+        elem.iRow = m.pMat->ri[m.perm[elem.iCol]][i_row];
+        elem.dCoef = m.pMat->a[elem.iRow][m.pMat->rs[m.perm[elem.iCol]][i_row]];
 
 #ifdef DEBUG
         m.IsValid();
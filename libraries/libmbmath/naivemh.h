@@ -34,11 +34,13 @@
 #ifndef NAIVEMH_H
 #define NAIVEMH_H
 
+#include <new>
 #include <vector>
 
 #include "myassert.h"
 #include "solman.h"
 #include "spmh.h"
+#include "mthrdslv.h"
 
 class NaiveSolver;
 class MultiThreadDataManager;
@@ -57,10 +59,7 @@ private:
 protected:
         integer iSize;
         bool bOwnsMemory;
-        doublereal **ppdRows;
-        integer **ppiRows, **ppiCols;
-        char **ppnonzero;
-        integer *piNzr, *piNzc;
+        naive_mat *pMat;
 public:
 #ifdef DEBUG
         virtual void IsValid(void) const override {
@@ -183,8 +182,9 @@ NaiveMatrixHandler::operator () (integer iRow, integer iCol) const
 
         --iRow;
         --iCol;
-        if (ppnonzero[iRow][iCol]) {
-                return ppdRows[iRow][iCol];
+        integer k = naive_find(pMat, iRow, iCol);
+        if (k >= 0) {
+                return pMat->a[iRow][k];
         }
         return ::Zero1;
 }
@@ -199,16 +199,16 @@ NaiveMatrixHandler::operator () (integer iRow, integer iCol)
 
         --iRow;
         --iCol;
-        if (!(ppnonzero[iRow][iCol])) {
-                ppnonzero[iRow][iCol] = 1;
-                ppiRows[iCol][piNzr[iCol]] = iRow;
-                ppiCols[iRow][piNzc[iRow]] = iCol;
-                piNzr[iCol]++;
-                piNzc[iRow]++;
-                ppdRows[iRow][iCol] = 0.;
+        integer k = naive_find(pMat, iRow, iCol);
+        if (k < 0) {
+                k = naive_insert(pMat, iRow, iCol);
+                if (k < 0) {
+                        throw std::bad_alloc();
+                }
+                pMat->a[iRow][k] = 0.;
         }
 
-        return ppdRows[iRow][iCol];
+        return pMat->a[iRow][k];
 }
 
 /* Sparse Matrix with unknowns permutation*/
@@ -41,7 +41,10 @@
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
+#include <new>
+#include <vector>
 
 #include "sp_gradient.h"
 #include "sp_matrix_base.h"
@@ -53,16 +56,201 @@
 #endif
 
 namespace sp_grad {
+     namespace {
+          class SpDerivArenaChunk {
+          public:
+               explicit SpDerivArenaChunk(size_t uSize)
+                    :iRefCnt(1), uSize(uSize), uUsed(0) {
+               }
+
+               char* pGetMem() {
+                    return reinterpret_cast<char*>(this + 1);
+               }
+
+               // one reference is held by the arena itself,
+               // one more by each block allocated from the chunk
+#ifdef USE_MULTITHREAD
+               std::atomic<index_type> iRefCnt;
+#else
+               index_type iRefCnt;
+#endif
+               size_t uSize;
+               size_t uUsed;
+          } SP_GRAD_ALIGNMENT(16);
+
+          // prepended to each derivative block; pChunk == nullptr
+          // means that the block was obtained from the heap
+          struct SpDerivMemHeader {
+               SpDerivArenaChunk* pChunk;
+          } SP_GRAD_ALIGNMENT(alignof(SpDerivRec));
+
+          static_assert(sizeof(SpDerivMemHeader) % alignof(SpDerivData) == 0, "alignment of SpDerivData not preserved");
+          static_assert(sizeof(SpDerivArenaChunk) % alignof(SpDerivMemHeader) == 0, "alignment of SpDerivMemHeader not preserved");
+
+          class SpDerivArena {
+          public:
+               SpDerivArena()
+                    :iDepth(0), pCurr(nullptr) {
+               }
+
+               ~SpDerivArena() {
+                    // chunks still referenced by some gradient
+                    // are released by the last one of them
+                    for (auto pChunk: rgChunks) {
+                         Release(pChunk);
+                    }
+               }
+
+               void Enter() {
+                    ++iDepth;
+               }
+
+               void Leave() {
+                    SP_GRAD_ASSERT(iDepth > 0);
+
+                    if (--iDepth == 0 && pCurr && pCurr->iRefCnt == 1) {
+                         pCurr->uUsed = 0;
+                    }
+               }
+
+               bool bIsActive() const {
+                    return iDepth > 0;
+               }
+
+               SpDerivMemHeader* pAlloc(size_t uSize) {
+                    SP_GRAD_ASSERT(uSize % alignof(SpDerivMemHeader) == 0);
+
+                    if (uSize > uChunkSize / 4) {
+                         return nullptr;
+                    }
+
+                    if (!pCurr || pCurr->uUsed + uSize > pCurr->uSize) {
+                         pCurr = pGetChunk();
+
+                         if (!pCurr) {
+                              return nullptr;
+                         }
+                    }
+
+                    char* const pMem = pCurr->pGetMem() + pCurr->uUsed;
+
+                    pCurr->uUsed += uSize;
+                    ++pCurr->iRefCnt;
+
+                    return new(pMem) SpDerivMemHeader{pCurr};
+               }
+
+               static void Release(SpDerivArenaChunk* pChunk) {
+                    if (--pChunk->iRefCnt == 0) {
+                         pChunk->~SpDerivArenaChunk();
+                         std::free(pChunk);
+                    }
+               }
+
+          private:
+               SpDerivArenaChunk* pGetChunk() {
+                    // only the arena may hold a reference to a chunk
+                    // which is not in use, and only the owning thread
+                    // allocates from it; so it can be safely recycled
+                    for (auto pChunk: rgChunks) {
+                         if (pChunk->iRefCnt == 1) {
+                              pChunk->uUsed = 0;
+                              return pChunk;
+                         }
+                    }
+
+                    if (rgChunks.size() >= uMaxChunks) {
+                         // too many long living gradients; use the heap
+                         return nullptr;
+                    }
+
+                    void* const pMem = std::malloc(sizeof(SpDerivArenaChunk) + uChunkSize);
+
+                    if (!pMem) {
+                         throw std::bad_alloc();
+                    }
+
+                    SpDerivArenaChunk* const pChunk = new(pMem) SpDerivArenaChunk(uChunkSize);
+
+                    rgChunks.push_back(pChunk);
+
+                    return pChunk;
+               }
+
+               static constexpr size_t uChunkSize = 1u << 20;
+               static constexpr size_t uMaxChunks = 64u;
+
+               index_type iDepth;
+               SpDerivArenaChunk* pCurr;
+               std::vector<SpDerivArenaChunk*> rgChunks;
+          };
+
+          SP_GRAD_THREAD_LOCAL SpDerivArena oDerivArena;
+
+          inline SpDerivMemHeader* pGetMemHeader(SpDerivData* ptr) {
+               return reinterpret_cast<SpDerivMemHeader*>(ptr) - 1;
+          }
+     }
+
+     SpGradientArenaScope::SpGradientArenaScope() {
+          oDerivArena.Enter();
+     }
+
+     SpGradientArenaScope::~SpGradientArenaScope() {
+          oDerivArena.Leave();
+     }
+
      SpDerivData SpGradient::oNullData{0., 0, 0, SpDerivData::DER_UNIQUE | SpDerivData::DER_SORTED, 1, nullptr};
 
      SpDerivData* SpGradient::pAllocMem(SpDerivData* ptr, index_type iSize) {
-          ptr = reinterpret_cast<SpDerivData*>(std::realloc(ptr, uGetAllocSize(iSize)));
+          const size_t uSize = sizeof(SpDerivMemHeader) + uGetAllocSize(iSize);
+
+          SpDerivMemHeader* const pHeadPrev = ptr ? pGetMemHeader(ptr) : nullptr;
+          SpDerivMemHeader* pHead;
 
-          if (!ptr) {
-               throw std::bad_alloc();
+          if (pHeadPrev && !pHeadPrev->pChunk) {
+               // heap blocks keep growing on the heap
+               pHead = reinterpret_cast<SpDerivMemHeader*>(std::realloc(pHeadPrev, uSize));
+
+               if (!pHead) {
+                    throw std::bad_alloc();
+               }
+
+               return reinterpret_cast<SpDerivData*>(pHead + 1);
+          }
+
+          pHead = oDerivArena.bIsActive() ? oDerivArena.pAlloc(uSize) : nullptr;
+
+          if (!pHead) {
+               void* const pMem = std::malloc(uSize);
+
+               if (!pMem) {
+                    throw std::bad_alloc();
+               }
+
+               pHead = new(pMem) SpDerivMemHeader{nullptr};
           }
 
-          return ptr;
+          if (pHeadPrev) {
+               // there is no realloc for arena blocks
+               std::memcpy(static_cast<void*>(pHead + 1),
+                           static_cast<const void*>(ptr),
+                           uGetAllocSize(ptr->iSizeRes));
+
+               SpDerivArena::Release(pHeadPrev->pChunk);
+          }
+
+          return reinterpret_cast<SpDerivData*>(pHead + 1);
+     }
+
+     void SpGradient::FreeMem(SpDerivData* ptr) {
+          SpDerivMemHeader* const pHead = pGetMemHeader(ptr);
+
+          if (pHead->pChunk) {
+               SpDerivArena::Release(pHead->pChunk);
+          } else {
+               std::free(pHead);
+          }
      }
 
      void SpGradient::Allocate(index_type iSizeRes, index_type iSizeInit, unsigned uFlags) {
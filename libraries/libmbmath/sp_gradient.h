@@ -828,7 +828,7 @@ namespace sp_grad {
           if (pData->pOwner) {
                pData->pOwner->Detach(this);
           } else if (!iRefCntCurr && pData != &oNullData) {
-               std::free(pData);
+               FreeMem(pData);
           }
      }
 
@@ -452,7 +452,9 @@ namespace sp_grad {
 
           inline static size_t uGetAllocSize(index_type iSizeRes);
 
-          inline static SpDerivData* pAllocMem(SpDerivData* ptr, index_type iSize);
+          static SpDerivData* pAllocMem(SpDerivData* ptr, index_type iSize);
+
+          static void FreeMem(SpDerivData* ptr);
 
           void Allocate(index_type iSizeRes, index_type iSizeInit, unsigned uFlags);
 
@@ -610,5 +612,21 @@ namespace sp_grad {
           doublereal dVal;
           doublereal dDer;
      };
+
+     /*
+      * While at least one instance is alive in the current thread, new
+      * derivative blocks of SpGradient are bump-allocated from a thread
+      * local arena instead of the heap. Memory is recycled in one go as
+      * soon as all blocks of a chunk have been released, so gradients
+      * which outlive the scope remain valid.
+      */
+     class SpGradientArenaScope {
+     public:
+          SpGradientArenaScope();
+          ~SpGradientArenaScope();
+
+          SpGradientArenaScope(const SpGradientArenaScope&) = delete;
+          SpGradientArenaScope& operator=(const SpGradientArenaScope&) = delete;
+     };
 }
 #endif
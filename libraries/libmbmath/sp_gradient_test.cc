@@ -4316,6 +4316,68 @@ namespace sp_grad_test {
           sp_grad_assert_equal(f45, fref, dTol);
           sp_grad_assert_equal(f46, fref, dTol);
      }
+
+     void test20(index_type inumloops, index_type inumnz, index_type inumdof)
+     {
+          using namespace std;
+
+          cerr << __PRETTY_FUNCTION__ << ":\n";
+
+          random_device rd;
+          mt19937 gen(rd());
+          uniform_real_distribution<doublereal> randval(-1.0, 1.0);
+          uniform_int_distribution<index_type> randdof(1, inumdof);
+          uniform_int_distribution<index_type> randnz(0, inumnz - 1);
+
+          gen.seed(0);
+
+          const doublereal dTol = sqrt(std::numeric_limits<doublereal>::epsilon());
+
+          for (index_type iloop = 0; iloop < inumloops; ++iloop) {
+               SpGradient u, v, fref;
+
+               sp_grad_rand_gen(u, randnz, randdof, randval, gen);
+               sp_grad_rand_gen(v, randnz, randdof, randval, gen);
+
+               fref = (u * v + sin(u)) * 2.;
+
+               // keeps a reference to arena memory after the scope ends
+               SpGradient fkeep;
+
+               for (index_type i = 0; i < 10; ++i) {
+                    SpGradientArenaScope oScope;
+
+                    // copies of u and v are not unique and must be reallocated
+                    SpGradient a{u}, b{v};
+
+                    a *= b;
+                    a += sin(u);
+
+                    // growing a block which belongs to the arena
+                    SpGradient g;
+
+                    for (index_type j = 1; j <= inumdof; ++j) {
+                         g += SpGradient{0., {{j, 1.}}};
+                    }
+
+                    sp_grad_assert_equal(g.dGetDeriv(randdof(gen)), 1., dTol);
+
+                    {
+                         SpGradientArenaScope oNestedScope;
+
+                         fkeep = a * 2.;
+                    }
+               }
+
+               sp_grad_assert_equal(fkeep, fref, dTol);
+
+               // heap blocks created outside the scope
+               fkeep *= 0.5;
+               fkeep += fkeep;
+
+               sp_grad_assert_equal(fkeep, fref, dTol);
+          }
+     }
 }
 
 int main(int argc, char* argv[])
@@ -4452,6 +4514,7 @@ int main(int argc, char* argv[])
           if (SP_GRAD_RUN_TEST(19.1)) test19();
           if (SP_GRAD_RUN_TEST(19.2)) test19b();
           if (SP_GRAD_RUN_TEST(19.3)) test19c();
+          if (SP_GRAD_RUN_TEST(20.1)) test20(inumloops, inumnz, inumdof);
 
           cerr << "All tests passed\n"
                << "\n\tloops performed: " << inumloops
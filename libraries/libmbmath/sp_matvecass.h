@@ -211,7 +211,7 @@ namespace sp_grad {
      class SpGradientAssVec<SpGradient>: public SpGradientAssVecBase {
      public:
           explicit SpGradientAssVec(SpGradientSubMatrixHandler& mh, SpAssMode mode = RESET)
-               :oWorkMat(mh) {
+               :oWorkMat(mh), pWorkVec(nullptr), iSubRow(0) {
 
                switch (mode) {
                case RESET:
@@ -227,6 +227,26 @@ namespace sp_grad {
 
           }
 
+          // the values of the gradients are the residual,
+          // so it is assembled into vh as well
+          SpGradientAssVec(SpGradientSubMatrixHandler& mh, SubVectorHandler& vh, SpAssMode mode = RESET)
+               :oWorkMat(mh), pWorkVec(&vh), iSubRow(0) {
+
+               switch (mode) {
+               case RESET:
+                    oWorkMat.Reset();
+                    pWorkVec->Resize(iSubRow);
+                    break;
+
+               case APPEND:
+                    iSubRow = pWorkVec->iGetSize();
+                    break;
+
+               default:
+                    SP_GRAD_ASSERT(0);
+               }
+          }
+
           template <typename T>
           static void AssJac(T* pElem,
                              SpGradientSubMatrixHandler& WorkMat,
@@ -236,6 +256,9 @@ namespace sp_grad {
                              SpFunctionCall func,
                              SpAssMode mode = RESET) {
 
+               // temporaries are released before the scope ends
+               SpGradientArenaScope oArenaScope;
+
                const SpGradientVectorHandler<SpGradient> XCurr_grad(XCurr);
                const SpGradientVectorHandler<SpGradient> XPrimeCurr_grad(XPrimeCurr);
 
@@ -244,6 +267,26 @@ namespace sp_grad {
                pElem->AssRes(WorkMat_grad, dCoef, XCurr_grad, XPrimeCurr_grad, func);
           }
 
+          template <typename T>
+          static void AssResJac(T* pElem,
+                                SubVectorHandler& WorkVec,
+                                SpGradientSubMatrixHandler& WorkMat,
+                                doublereal dCoef,
+                                const VectorHandler& XCurr,
+                                const VectorHandler& XPrimeCurr,
+                                SpFunctionCall func,
+                                SpAssMode mode = RESET) {
+
+               SpGradientArenaScope oArenaScope;
+
+               const SpGradientVectorHandler<SpGradient> XCurr_grad(XCurr);
+               const SpGradientVectorHandler<SpGradient> XPrimeCurr_grad(XPrimeCurr);
+
+               SpGradientAssVec WorkMat_grad(WorkMat, WorkVec, mode);
+
+               pElem->AssRes(WorkMat_grad, dCoef, XCurr_grad, XPrimeCurr_grad, func);
+          }
+
           template <typename T>
           static void InitialAssJac(T* pElem,
                                     SpGradientSubMatrixHandler& WorkMat,
@@ -251,6 +294,8 @@ namespace sp_grad {
                                     SpFunctionCall func,
                                     SpAssMode mode = RESET) {
 
+               SpGradientArenaScope oArenaScope;
+
                const SpGradientVectorHandler<SpGradient> XCurr_grad(XCurr);
 
                SpGradientAssVec WorkMat_grad(WorkMat, mode);
@@ -260,6 +305,15 @@ namespace sp_grad {
 
           void AddItem(integer iRow, const SpGradient& oGrad) {
                oWorkMat.AddItem(iRow, oGrad);
+
+               if (pWorkVec) {
+                    pWorkVec->Resize(++iSubRow);
+
+                    SP_GRAD_ASSERT(std::isfinite(oGrad.dGetValue()));
+                    SP_GRAD_ASSERT(iRow > 0);
+
+                    pWorkVec->PutItem(iSubRow, iRow, oGrad.dGetValue());
+               }
           }
 
           template <index_type N_rows>
@@ -272,6 +326,8 @@ namespace sp_grad {
           }
      private:
           SpGradientSubMatrixHandler& oWorkMat;
+          SubVectorHandler* const pWorkVec;
+          integer iSubRow;
      };
 
      template <>
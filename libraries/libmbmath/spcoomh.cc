@@ -0,0 +1,506 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 2003-2023
+ * 
+ * This code is a partial merge of HmFe and MBDyn.
+ *
+ * Pierangelo Masarati  <pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza     <paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <algorithm>
+
+#include "spcoomh.h"
+
+SpCooMatrixHandler::SpCooMatrixHandler(const integer &n, const integer &nn)
+: SparseMatrixHandler(n, nn)
+{
+	CAp.resize(NCols + 1, 0);
+}
+
+SpCooMatrixHandler::~SpCooMatrixHandler()
+{
+	NO_OP;
+}
+
+void
+SpCooMatrixHandler::Compact(void) const
+{
+	if (Pending.empty() && Overflow.empty()) {
+		return;
+	}
+
+	for (const auto& o: Overflow) {
+		Pending.push_back(Triplet{o.first.second, o.first.first, o.second});
+	}
+	Overflow.clear();
+
+	const size_t nItems = CAx.size() + Pending.size();
+
+	/* first pass: counting sort by row of old and new coefficients */
+	std::vector<integer> iCount(NRows + 1, 0);
+
+	for (size_t k = 0; k < CAi.size(); k++) {
+		++iCount[CAi[k] + 1];
+	}
+
+	for (const auto& t: Pending) {
+		++iCount[t.iRow + 1];
+	}
+
+	for (integer iRow = 0; iRow < NRows; iRow++) {
+		iCount[iRow + 1] += iCount[iRow];
+	}
+
+	std::vector<Triplet> ByRow(nItems);
+
+	for (integer iCol = 0; iCol < NCols; iCol++) {
+		for (integer k = CAp[iCol]; k < CAp[iCol + 1]; k++) {
+			ByRow[iCount[CAi[k]]++] = Triplet{CAi[k], iCol, CAx[k]};
+		}
+	}
+
+	for (const auto& t: Pending) {
+		ByRow[iCount[t.iRow]++] = t;
+	}
+
+	/* second pass: stable counting sort by column,
+	 * so that the rows remain sorted within each column */
+	iCount.assign(NCols + 1, 0);
+
+	for (const auto& t: ByRow) {
+		++iCount[t.iCol + 1];
+	}
+
+	for (integer iCol = 0; iCol < NCols; iCol++) {
+		iCount[iCol + 1] += iCount[iCol];
+	}
+
+	Pending.resize(nItems);
+
+	for (const auto& t: ByRow) {
+		Pending[iCount[t.iCol]++] = t;
+	}
+
+	std::vector<Triplet>().swap(ByRow);
+
+	/* merge the duplicated coefficients */
+	CAp.assign(NCols + 1, 0);
+	CAi.clear();
+	CAx.clear();
+
+	integer iLastCol = -1;
+	for (const auto& t: Pending) {
+		if (t.iCol == iLastCol && t.iRow == CAi.back()) {
+			CAx.back() += t.dCoef;
+
+		} else {
+			CAi.push_back(t.iRow);
+			CAx.push_back(t.dCoef);
+			++CAp[t.iCol + 1];
+			iLastCol = t.iCol;
+		}
+	}
+
+	for (integer iCol = 0; iCol < NCols; iCol++) {
+		CAp[iCol + 1] += CAp[iCol];
+	}
+
+	/* the triplets are only needed until the compressed form is built */
+	std::vector<Triplet>().swap(Pending);
+}
+
+integer
+SpCooMatrixHandler::iFind(integer iRow, integer iCol) const
+{
+	const auto row_begin = CAi.begin() + CAp[iCol];
+	const auto row_end = CAi.begin() + CAp[iCol + 1];
+	const auto it = std::lower_bound(row_begin, row_end, iRow);
+
+	if (it == row_end || *it != iRow) {
+		return -1;
+	}
+
+	return it - CAi.begin();
+}
+
+doublereal *
+SpCooMatrixHandler::pdFind(integer iRow, integer iCol) const
+{
+	integer idx = iFind(iRow, iCol);
+	if (idx >= 0) {
+		return &CAx[idx];
+	}
+
+	if (!Overflow.empty()) {
+		const auto it = Overflow.find(std::make_pair(iCol, iRow));
+		if (it != Overflow.end()) {
+			return &it->second;
+		}
+	}
+
+	return 0;
+}
+
+doublereal&
+SpCooMatrixHandler::operator()(integer i_row, integer i_col)
+{
+	ASSERTMSGBREAK(i_row > 0 && i_row <= NRows,
+			"Error in SpCooMatrixHandler::operator(), "
+			"row index out of range");
+	ASSERTMSGBREAK(i_col > 0 && i_col <= NCols,
+			"Error in SpCooMatrixHandler::operator(), "
+			"col index out of range");
+
+	/* the pending triplets never refer to coefficients
+	 * already in the pattern */
+	doublereal *pd = pdFind(i_row - 1, i_col - 1);
+	if (pd != 0) {
+		return *pd;
+	}
+
+	/* the coefficient may have pending contributions: move them
+	 * to the map, which is cheaper than compacting at each miss
+	 * when operator() and IncCoef() are interleaved */
+	for (const auto& t: Pending) {
+		Overflow[std::make_pair(t.iCol, t.iRow)] += t.dCoef;
+	}
+	Pending.clear();
+
+	/* new coefficient: merged at next compaction */
+	return Overflow[std::make_pair(i_col - 1, i_row - 1)];
+}
+
+const doublereal&
+SpCooMatrixHandler::operator()(integer i_row, integer i_col) const
+{
+	ASSERTMSGBREAK(i_row > 0 && i_row <= NRows,
+			"Error in SpCooMatrixHandler::operator(), "
+			"row index out of range");
+	ASSERTMSGBREAK(i_col > 0 && i_col <= NCols,
+			"Error in SpCooMatrixHandler::operator(), "
+			"col index out of range");
+
+	Compact();
+
+	integer idx = iFind(i_row - 1, i_col - 1);
+	if (idx < 0) {
+		return ::Zero1;
+	}
+
+	return CAx[idx];
+}
+
+template <typename idx_type>
+idx_type
+SpCooMatrixHandler::MakeCompressedColumnFormTpl(doublereal *const Ax,
+						idx_type *const Ai,
+						idx_type *const Ap,
+						int offset) const
+{
+	Compact();
+
+	const idx_type nz = CAx.size();
+
+	std::copy(CAx.begin(), CAx.end(), Ax);
+
+	for (idx_type k = 0; k < nz; k++) {
+		Ai[k] = CAi[k] + offset;
+	}
+
+	for (integer col = 0; col <= NCols; col++) {
+		Ap[col] = CAp[col] + offset;
+	}
+
+	return nz;
+}
+
+int32_t
+SpCooMatrixHandler::MakeCompressedColumnForm(doublereal *const Ax,
+					     int32_t *const Ai,
+					     int32_t *const Ap,
+					     int offset) const
+{
+	return MakeCompressedColumnFormTpl(Ax, Ai, Ap, offset);
+}
+
+int64_t
+SpCooMatrixHandler::MakeCompressedColumnForm(doublereal *const Ax,
+					     int64_t *const Ai,
+					     int64_t *const Ap,
+					     int offset) const
+{
+	return MakeCompressedColumnFormTpl(Ax, Ai, Ap, offset);
+}
+
+template <typename idx_type>
+idx_type
+SpCooMatrixHandler::MakeIndexFormTpl(doublereal *const Ax,
+				     idx_type *const Arow, idx_type *const Acol,
+				     idx_type *const Ap, int offset) const
+{
+	idx_type nz = MakeCompressedColumnFormTpl(Ax, Arow, Ap, offset);
+
+	for (integer col = 0; col < NCols; col++) {
+		for (integer k = CAp[col]; k < CAp[col + 1]; k++) {
+			Acol[k] = col + offset;
+		}
+	}
+
+	return nz;
+}
+
+int32_t
+SpCooMatrixHandler::MakeIndexForm(doublereal *const Ax,
+				  int32_t *const Arow, int32_t *const Acol,
+				  int32_t *const AcolSt,
+				  int offset) const
+{
+	return MakeIndexFormTpl(Ax, Arow, Acol, AcolSt, offset);
+}
+
+int64_t
+SpCooMatrixHandler::MakeIndexForm(doublereal *const Ax,
+				  int64_t *const Arow, int64_t *const Acol,
+				  int64_t *const AcolSt,
+				  int offset) const
+{
+	return MakeIndexFormTpl(Ax, Arow, Acol, AcolSt, offset);
+}
+
+void
+SpCooMatrixHandler::Reset(void)
+{
+	/* keep the pattern, as SpMapMatrixHandler does */
+	Compact();
+
+	std::fill(CAx.begin(), CAx.end(), 0.);
+}
+
+void
+SpCooMatrixHandler::Resize(integer n, integer nn)
+{
+	if (nn == 0) {
+		nn = n;
+	}
+
+	NRows = n;
+	NCols = nn;
+
+	std::vector<Triplet>().swap(Pending);
+	Overflow.clear();
+	CAp.assign(NCols + 1, 0);
+	CAi.clear();
+	CAx.clear();
+}
+
+/* Estrae una colonna da una matrice */
+VectorHandler&
+SpCooMatrixHandler::GetCol(integer icol, VectorHandler& out) const
+{
+	// NOTE: out must be zeroed by caller
+
+	if (icol > iGetNumCols()) {
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	Compact();
+
+	for (integer k = CAp[icol - 1]; k < CAp[icol]; k++) {
+		out(CAi[k] + 1) = CAx[k];
+	}
+
+	return out;
+}
+
+void
+SpCooMatrixHandler::Scale(const std::vector<doublereal>& oRowScale, const std::vector<doublereal>& oColScale)
+{
+	const bool bScaleRows = !oRowScale.empty();
+	const bool bScaleCols = !oColScale.empty();
+
+	ASSERT(!bScaleRows || oRowScale.size() == static_cast<size_t>(NRows));
+	ASSERT(!bScaleCols || oColScale.size() == static_cast<size_t>(NCols));
+
+	Compact();
+
+	for (integer col = 0; col < NCols; col++) {
+		for (integer k = CAp[col]; k < CAp[col + 1]; k++) {
+			if (bScaleRows) {
+				CAx[k] *= oRowScale[CAi[k]];
+			}
+
+			if (bScaleCols) {
+				CAx[k] *= oColScale[col];
+			}
+		}
+	}
+}
+
+integer
+SpCooMatrixHandler::Nz() const
+{
+	Compact();
+
+	return CAx.size();
+}
+
+/* Prodotto Matrice per Matrice */
+MatrixHandler&
+SpCooMatrixHandler::MatMatMul_base(void (MatrixHandler::*op)(integer iRow,
+			integer iCol, const doublereal& dCoef),
+			MatrixHandler& out, const MatrixHandler& in) const
+{
+	if ((in.iGetNumRows() != iGetNumCols())
+			|| (in.iGetNumCols() != out.iGetNumCols())
+			|| (out.iGetNumRows() != iGetNumRows()))
+	{
+		silent_cerr("Assertion fault "
+			"in SpCooMatrixHandler::MatMatMul_base" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	Compact();
+
+	integer ncols_in = in.iGetNumCols();
+	for (integer row_in = 0; row_in < NCols; row_in++) {
+		for (integer k = CAp[row_in]; k < CAp[row_in + 1]; k++) {
+			for (integer col_in = 1; col_in <= ncols_in; col_in++) {
+				(out.*op)(CAi[k] + 1, col_in,
+						CAx[k]*in(row_in + 1, col_in));
+			}
+		}
+	}
+
+	return out;
+}
+
+MatrixHandler&
+SpCooMatrixHandler::MatTMatMul_base(void (MatrixHandler::*op)(integer iRow,
+			integer iCol, const doublereal& dCoef),
+			MatrixHandler& out, const MatrixHandler& in) const
+{
+	if ((in.iGetNumRows() != iGetNumRows())
+			|| (in.iGetNumCols() != out.iGetNumCols())
+			|| (out.iGetNumRows() != iGetNumCols()))
+	{
+		silent_cerr("Assertion fault "
+			"in SpCooMatrixHandler::MatTMatMul_base" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	Compact();
+
+	integer ncols_in = in.iGetNumCols();
+	for (integer row_out = 0; row_out < NCols; row_out++) {
+		for (integer k = CAp[row_out]; k < CAp[row_out + 1]; k++) {
+			for (integer col_in = 1; col_in <= ncols_in; col_in++) {
+				(out.*op)(row_out + 1, col_in,
+						CAx[k]*in(CAi[k] + 1, col_in));
+			}
+		}
+	}
+
+	return out;
+}
+
+VectorHandler&
+SpCooMatrixHandler::MatVecMul_base(void (VectorHandler::*op)(integer iRow,
+			const doublereal &dCoef),
+		VectorHandler& out, const VectorHandler& in) const
+{
+	if (in.iGetSize() != iGetNumCols()
+			|| out.iGetSize() != iGetNumRows())
+	{
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	Compact();
+
+	for (integer col = 0; col < NCols; col++) {
+		for (integer k = CAp[col]; k < CAp[col + 1]; k++) {
+			(out.*op)(CAi[k] + 1, CAx[k]*in(col + 1));
+		}
+	}
+
+	return out;
+}
+
+VectorHandler&
+SpCooMatrixHandler::MatTVecMul_base(void (VectorHandler::*op)(integer iRow,
+			const doublereal &dCoef),
+		VectorHandler& out, const VectorHandler& in) const
+{
+	if (out.iGetSize() != iGetNumCols()
+			|| in.iGetSize() != iGetNumRows())
+	{
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	Compact();
+
+	for (integer col = 0; col < NCols; col++) {
+		doublereal d = 0.;
+		for (integer k = CAp[col]; k < CAp[col + 1]; k++) {
+			d += CAx[k]*in(CAi[k] + 1);
+		}
+		(out.*op)(col + 1, d);
+	}
+
+	return out;
+}
+
+void
+SpCooMatrixHandler::EnumerateNz(const std::function<EnumerateNzCallback>& func) const
+{
+	Compact();
+
+	for (integer col = 0; col < NCols; col++) {
+		for (integer k = CAp[col]; k < CAp[col + 1]; k++) {
+			func(CAi[k] + 1, col + 1, CAx[k]);
+		}
+	}
+}
+
+SpCooMatrixHandler*
+SpCooMatrixHandler::Copy() const
+{
+	SpCooMatrixHandler* pMH = nullptr;
+
+	SAFENEWWITHCONSTRUCTOR(pMH, SpCooMatrixHandler, SpCooMatrixHandler(iGetNumRows(), iGetNumCols()));
+
+	Compact();
+
+	ASSERT(Pending.empty() && Overflow.empty());
+
+	pMH->CAp = CAp;
+	pMH->CAi = CAi;
+	pMH->CAx = CAx;
+
+	return pMH;
+}
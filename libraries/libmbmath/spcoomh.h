@@ -0,0 +1,221 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SPCOOMH_H
+#define SPCOOMH_H
+
+#include <map>
+#include <utility>
+#include <vector>
+#include "myassert.h"
+#include "solman.h"
+#include "spmh.h"
+
+/*
+ * Sparse matrix used to build the pattern of the compressed column
+ * handlers.  The contributions of the elements to coefficients that are
+ * not yet in the pattern are appended as (row, column, value) triplets,
+ * with no search; the compressed column form is built with a two-pass
+ * counting sort (by row, then by column) that merges duplicated
+ * coefficients.  Contributions to coefficients already in the pattern
+ * are added in place.
+ *
+ * Coefficients created by operator() are kept in a map until the next
+ * compaction, so that the returned reference is not invalidated
+ * by further calls to IncCoef() or operator(); it is invalidated
+ * by any operation that compacts the matrix (reading coefficients
+ * through the const interface, products, Reset() and so on).
+ *
+ * Like SpMapMatrixHandler, Reset() zeroes the coefficients but keeps
+ * the pattern, so that a rebuilt matrix contains the union
+ * of the old and the new pattern.
+ */
+class SpCooMatrixHandler : public SparseMatrixHandler {
+private:
+	struct Triplet {
+		integer iRow;
+		integer iCol;
+		doublereal dCoef;
+	};
+
+	/* coefficients not yet compressed (0-based indices);
+	 * never in the pattern of CAx or Overflow */
+	mutable std::vector<Triplet> Pending;
+
+	/* coefficients created by operator(), by (column, row) */
+	mutable std::map<std::pair<integer, integer>, doublereal> Overflow;
+
+	/* compressed column form of the coefficients (0-based indices) */
+	mutable std::vector<integer> CAp;
+	mutable std::vector<integer> CAi;
+	mutable std::vector<doublereal> CAx;
+
+	// don't allow copy constructor!
+	SpCooMatrixHandler(const SpCooMatrixHandler&);
+
+	/* merges the pending triplets into the compressed form */
+	void Compact(void) const;
+
+	/* position of a coefficient (0-based) in CAx, or -1 */
+	integer iFind(integer iRow, integer iCol) const;
+
+	/* coefficient (0-based) in CAx or Overflow, or NULL */
+	doublereal *pdFind(integer iRow, integer iCol) const;
+
+	/* adds a contribution in place, or appends a triplet */
+	void AddCoef(integer iRow, integer iCol, doublereal d) {
+		doublereal *pd = pdFind(iRow, iCol);
+		if (pd != 0) {
+			*pd += d;
+
+		} else {
+			Pending.push_back(Triplet{iRow, iCol, d});
+		}
+	};
+
+	template <typename idx_type>
+	idx_type MakeCompressedColumnFormTpl(doublereal *const Ax,
+					     idx_type *const Ai,
+					     idx_type *const Ap,
+					     int offset) const;
+
+	template <typename idx_type>
+	idx_type MakeIndexFormTpl(doublereal *const Ax,
+				  idx_type *const Arow, idx_type *const Acol,
+				  idx_type *const AcolSt,
+				  int offset) const;
+
+#ifdef DEBUG
+	void IsValid(void) const {
+		NO_OP;
+	};
+#endif /* DEBUG */
+
+public:
+	SpCooMatrixHandler(const integer &n = 0, const integer &nn = 0);
+
+	virtual ~SpCooMatrixHandler(void);
+	using MatrixHandler::operator=;
+
+	doublereal& operator()(integer i_row, integer i_col) override;
+
+	const doublereal& operator()(integer i_row, integer i_col) const override;
+
+	void IncCoef(integer ix, integer iy, const doublereal& inc) override {
+		ASSERTMSGBREAK(ix > 0 && ix <= NRows,
+				"Error in SpCooMatrixHandler::IncCoef(), "
+				"row index out of range");
+		ASSERTMSGBREAK(iy > 0 && iy <= NCols,
+				"Error in SpCooMatrixHandler::IncCoef(), "
+				"col index out of range");
+		AddCoef(ix - 1, iy - 1, inc);
+	};
+
+	void DecCoef(integer ix, integer iy, const doublereal& inc) override {
+		ASSERTMSGBREAK(ix > 0 && ix <= NRows,
+				"Error in SpCooMatrixHandler::DecCoef(), "
+				"row index out of range");
+		ASSERTMSGBREAK(iy > 0 && iy <= NCols,
+				"Error in SpCooMatrixHandler::DecCoef(), "
+				"col index out of range");
+		AddCoef(ix - 1, iy - 1, -inc);
+	};
+
+	void PutCoef(integer ix, integer iy, const doublereal& val) override {
+		operator()(ix, iy) = val;
+	};
+
+	const doublereal& dGetCoef(integer ix, integer iy) const override {
+		return operator()(ix, iy);
+	};
+
+	using SparseMatrixHandler::MakeCompressedColumnForm;
+
+	int32_t MakeCompressedColumnForm(doublereal *const Ax,
+					 int32_t *const Ai,
+					 int32_t *const Ap,
+					 int offset = 0) const override;
+
+	int64_t MakeCompressedColumnForm(doublereal *const Ax,
+					 int64_t *const Ai,
+					 int64_t *const Ap,
+					 int offset = 0) const override;
+
+	using SparseMatrixHandler::MakeIndexForm;
+
+	int32_t MakeIndexForm(doublereal *const Ax,
+			      int32_t *const Arow, int32_t *const Acol,
+			      int32_t *const AcolSt,
+			      int offset = 0) const override;
+
+	int64_t MakeIndexForm(doublereal *const Ax,
+			      int64_t *const Arow, int64_t *const Acol,
+			      int64_t *const AcolSt,
+			      int offset = 0) const override;
+
+	void Reset(void) override;
+
+	void Resize(integer ir, integer ic) override;
+
+	/* Estrae una colonna da una matrice */
+	VectorHandler& GetCol(integer icol, VectorHandler& out) const override;
+
+	virtual void Scale(const std::vector<doublereal>& oRowScale, const std::vector<doublereal>& oColScale) override;
+
+	virtual integer Nz() const override;
+
+	/* Matrix Matrix product */
+protected:
+	MatrixHandler&
+	MatMatMul_base(void (MatrixHandler::*op)(integer iRow, integer iCol,
+				const doublereal& dCoef),
+			MatrixHandler& out, const MatrixHandler& in) const override;
+	MatrixHandler&
+	MatTMatMul_base(void (MatrixHandler::*op)(integer iRow, integer iCol,
+				const doublereal& dCoef),
+			MatrixHandler& out, const MatrixHandler& in) const override;
+
+	/* Matrix Vector product */
+	virtual VectorHandler&
+	MatVecMul_base(void (VectorHandler::*op)(integer iRow,
+				const doublereal& dCoef),
+			VectorHandler& out, const VectorHandler& in) const override;
+	virtual VectorHandler&
+	MatTVecMul_base(void (VectorHandler::*op)(integer iRow,
+				const doublereal& dCoef),
+			VectorHandler& out, const VectorHandler& in) const override;
+
+public:
+	virtual void EnumerateNz(const std::function<EnumerateNzCallback>& func) const override;
+	virtual SpCooMatrixHandler* Copy() const override;
+};
+
+#endif /* SPCOOMH_H */
@@ -0,0 +1,278 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * SpCooMatrixHandler: duplicated coefficients, references returned
+ * by operator() while new coefficients are inserted, conversion to
+ * the compressed column form; the results are compared with a full
+ * matrix that receives the same operations
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "spcoomh.h"
+#include "ccmh.h"
+
+static int
+Check(const char *sTest, const SpCooMatrixHandler& M,
+	const std::vector<doublereal>& D, integer n)
+{
+	int rc = 0;
+
+	for (integer c = 1; c <= n; c++) {
+		for (integer r = 1; r <= n; r++) {
+			doublereal d = D[(r - 1) + n*(c - 1)];
+			if (std::abs(M(r, c) - d) > 1e-12*(1. + std::abs(d))) {
+				std::cerr << sTest << ": M(" << r << ", " << c << ")="
+					<< M(r, c) << " != " << d << std::endl;
+				rc++;
+			}
+		}
+	}
+
+	return rc;
+}
+
+static int
+DuplicateTest(void)
+{
+	const integer n = 4;
+	SpCooMatrixHandler M(n, n);
+	std::vector<doublereal> D(n*n, 0.);
+	int rc = 0;
+
+	/* duplicates while the coefficient is only pending */
+	M.IncCoef(2, 3, 1.);
+	M.IncCoef(2, 3, 2.);
+	M.DecCoef(2, 3, .5);
+	M.IncCoef(4, 1, 1.);
+	D[1 + n*2] += 2.5;
+	D[3 + n*0] += 1.;
+
+	rc += Check("duplicates (pending)", M, D, n);
+
+	/* duplicates after the compaction triggered by the check */
+	M.IncCoef(2, 3, 1.);
+	M.IncCoef(4, 1, -1.);
+	M.IncCoef(1, 1, 3.);
+	M.IncCoef(1, 1, 3.);
+	D[1 + n*2] += 1.;
+	D[3 + n*0] -= 1.;
+	D[0 + n*0] += 6.;
+
+	rc += Check("duplicates (compacted)", M, D, n);
+
+	/* a cancelled coefficient stays in the pattern, once */
+	if (M.Nz() != 3) {
+		std::cerr << "duplicates: Nz()=" << M.Nz() << " != 3" << std::endl;
+		rc++;
+	}
+
+	/* Reset() keeps the pattern and zeroes the coefficients */
+	M.Reset();
+	std::fill(D.begin(), D.end(), 0.);
+	M.IncCoef(2, 3, 1.);
+	M.IncCoef(2, 3, 1.);
+	D[1 + n*2] += 2.;
+
+	rc += Check("duplicates (reset)", M, D, n);
+	if (M.Nz() != 3) {
+		std::cerr << "reset: Nz()=" << M.Nz() << " != 3" << std::endl;
+		rc++;
+	}
+
+	return rc;
+}
+
+static int
+ReferenceTest(void)
+{
+	const integer n = 50;
+	SpCooMatrixHandler M(n, n);
+	std::vector<doublereal> D(n*n, 0.);
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<integer> idx(1, n);
+	int rc = 0;
+
+	/* part of the pattern is compressed, part is not */
+	for (integer i = 1; i <= n; i++) {
+		M.IncCoef(i, i, 1.);
+		D[(i - 1) + n*(i - 1)] += 1.;
+	}
+	rc += Check("references (setup)", M, D, n);
+
+	/* references to new coefficients, both in and out of the pattern,
+	 * must survive the insertion of many other coefficients */
+	std::vector<doublereal *> Refs;
+	std::vector<integer> RefIdx;
+	for (integer k = 0; k < 20; k++) {
+		integer r = idx(gen), c = idx(gen);
+		Refs.push_back(&M(r, c));
+		RefIdx.push_back((r - 1) + n*(c - 1));
+
+		for (integer j = 0; j < 100; j++) {
+			integer r2 = idx(gen), c2 = idx(gen);
+			if (j % 2) {
+				M.IncCoef(r2, c2, 1.);
+
+			} else {
+				M(r2, c2) += 1.;
+			}
+			D[(r2 - 1) + n*(c2 - 1)] += 1.;
+		}
+	}
+
+	for (unsigned k = 0; k < Refs.size(); k++) {
+		*Refs[k] += k + 1.;
+		D[RefIdx[k]] += k + 1.;
+	}
+
+	rc += Check("references", M, D, n);
+
+	return rc;
+}
+
+static int
+CompressedColumnTest(void)
+{
+	const integer n = 30;
+	SpCooMatrixHandler M(n, n);
+	std::vector<doublereal> D(n*n, 0.);
+	std::mt19937 gen(2);
+	std::uniform_int_distribution<integer> idx(1, n);
+	std::uniform_real_distribution<doublereal> val(-1., 1.);
+	int rc = 0;
+
+	for (integer k = 0; k < 2000; k++) {
+		integer r = idx(gen), c = idx(gen);
+		doublereal d = val(gen);
+
+		switch (k % 4) {
+		case 0:
+			M.IncCoef(r, c, d);
+			D[(r - 1) + n*(c - 1)] += d;
+			break;
+
+		case 1:
+			M.DecCoef(r, c, d);
+			D[(r - 1) + n*(c - 1)] -= d;
+			break;
+
+		case 2:
+			M.PutCoef(r, c, d);
+			D[(r - 1) + n*(c - 1)] = d;
+			break;
+
+		case 3:
+			M(r, c) += d;
+			D[(r - 1) + n*(c - 1)] += d;
+			break;
+		}
+	}
+
+	for (int offset = 0; offset <= 1; offset++) {
+		std::vector<doublereal> Ax;
+		std::vector<integer> Ai, Ap;
+		integer nz = M.MakeCompressedColumnForm(Ax, Ai, Ap, offset);
+
+		if (nz != M.Nz() || Ap[n] - offset != nz) {
+			std::cerr << "CC: nz=" << nz << ", Nz()=" << M.Nz()
+				<< ", Ap[n]=" << Ap[n] << std::endl;
+			rc++;
+			continue;
+		}
+
+		/* rows strictly increasing in each column: no duplicates */
+		for (integer c = 0; c < n; c++) {
+			for (integer k = Ap[c] - offset + 1; k < Ap[c + 1] - offset; k++) {
+				if (Ai[k] <= Ai[k - 1]) {
+					std::cerr << "CC: column " << c + 1
+						<< " not sorted" << std::endl;
+					rc++;
+				}
+			}
+		}
+
+		std::vector<doublereal> DCC(n*n, 0.);
+		for (integer c = 0; c < n; c++) {
+			for (integer k = Ap[c] - offset; k < Ap[c + 1] - offset; k++) {
+				DCC[(Ai[k] - offset) + n*c] = Ax[k];
+			}
+		}
+
+		for (integer k = 0; k < n*n; k++) {
+			if (std::abs(DCC[k] - D[k]) > 1e-12) {
+				std::cerr << "CC(" << k % n + 1 << ", " << k/n + 1
+					<< ")=" << DCC[k] << " != " << D[k] << std::endl;
+				rc++;
+			}
+		}
+
+		if (offset == 0) {
+			const CColMatrixHandler<0> CC(Ax, Ai, Ap);
+			const SpCooMatrixHandler& CM = M;
+			for (integer c = 1; c <= n; c++) {
+				for (integer r = 1; r <= n; r++) {
+					if (CC(r, c) != CM(r, c)) {
+						std::cerr << "CColMatrixHandler(" << r << ", " << c
+							<< ")=" << CC(r, c) << " != "
+							<< CM(r, c) << std::endl;
+						rc++;
+					}
+				}
+			}
+		}
+	}
+
+	return rc;
+}
+
+int
+main(void)
+{
+	int rc = 0;
+
+	rc += DuplicateTest();
+	rc += ReferenceTest();
+	rc += CompressedColumnTest();
+
+	std::cout << "SpCooMatrixHandler test: "
+		<< (rc ? "failed" : "passed") << std::endl;
+
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -233,9 +233,12 @@ int64_t SparseMatrixHandler::MakeIndexForm(std::vector<doublereal>& Ax,
      return MakeIndexForm(&Ax.front(), &Arow.front(), &Acol.front(), &Ap.front(), offset);
 }
 
+std::atomic<unsigned long> CompactSparseMatrixHandler::uPatternCounter(0);
+
 CompactSparseMatrixHandler::CompactSparseMatrixHandler(const integer &n,
 						       const integer &nn)
-: SparseMatrixHandler(n, nn)
+: SparseMatrixHandler(n, nn),
+uPatternId(++uPatternCounter)
 {
 	
 }
@@ -275,6 +278,29 @@ const doublereal* CompactSparseMatrixHandler_tpl<off, idx_type>::pdGetMat(void)
      return &Ax.front();
 };
 
+template <int off, typename idx_type>
+doublereal* CompactSparseMatrixHandler_tpl<off, idx_type>::pdGetMat(void) {
+     return &Ax.front();
+};
+
+template <int off, typename idx_type>
+integer
+CompactSparseMatrixHandler_tpl<off, idx_type>::iGetIndex(integer iRow, integer iCol) const
+{
+	ASSERT(iRow > 0 && iRow <= iGetNumRows());
+	ASSERT(iCol > 0 && iCol <= iGetNumCols());
+
+	const auto row_begin = Ai.begin() + (Ap[iCol - 1] - off);
+	const auto row_end = Ai.begin() + (Ap[iCol] - off);
+	const auto it = std::lower_bound(row_begin, row_end, iRow - 1 + off);
+
+	if (it == row_end || *it != iRow - 1 + off) {
+		return -1;
+	}
+
+	return it - Ai.begin();
+}
+
 template <int off, typename idx_type>
 void
 CompactSparseMatrixHandler_tpl<off, idx_type>::Reset(void)
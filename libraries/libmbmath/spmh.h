@@ -35,6 +35,7 @@
 #define SPMH_H
 
 #include <stdint.h>
+#include <atomic>
 #include <vector>
 
 #include "myassert.h"
@@ -208,6 +209,15 @@ class CompactSparseMatrixHandler : public SparseMatrixHandler {
 	};
 #endif /* DEBUG */
 
+	static std::atomic<unsigned long> uPatternCounter;
+
+protected:
+	/* identifies the sparsity pattern; copies share it.
+	 * Since the handler cannot tell when the arrays it refers to
+	 * are rebuilt, the solution managers must create a new handler
+	 * each time the compact form is rebuilt (see MatrInitialize()) */
+	unsigned long uPatternId;
+
 public:
 	CompactSparseMatrixHandler(const integer &n, const integer &nn);
 
@@ -217,6 +227,14 @@ public:
 	 * while preserving the CC indices */
 	virtual CompactSparseMatrixHandler *Copy(void) const = 0;
 
+	unsigned long uGetPatternId(void) const {
+		return uPatternId;
+	};
+
+	/* position of coefficient (iRow, iCol) in the array returned
+	 * by pdGetMat(), or -1 if it is not part of the pattern */
+	virtual integer iGetIndex(integer iRow, integer iCol) const = 0;
+
 	/* used to sum CC matrices with identical indices */
         virtual void AddUnchecked(const CompactSparseMatrixHandler& m) = 0;
 
@@ -294,6 +312,9 @@ public:
 
 	/* Restituisce un puntatore all'array di reali della matrice */
         virtual const doublereal* pdGetMat(void) const override;
+        virtual doublereal* pdGetMat(void) override;
+
+        virtual integer iGetIndex(integer iRow, integer iCol) const override;
 
      	virtual void Reset(void) override;
 
@@ -34,9 +34,11 @@
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
 #include <string.h>     /* for memset() */
+#include <algorithm>
 #include <iomanip>
 
 #include <submat.h>
+#include <spmh.h>
 
 /* SubMatrixHandler - begin */
 
@@ -58,6 +60,87 @@ void SubMatrixHandler::EnumerateNz(const std::function<EnumerateNzCallback>& fun
 /* SubMatrixHandler - end */
 
 
+/* SubMatrixScatterPlan - begin */
+
+SubMatrixScatterPlan::SubMatrixScatterPlan(void)
+     : eType(NONE), uPatternId(0)
+{
+     NO_OP;
+}
+
+SubMatrixScatterPlan::~SubMatrixScatterPlan(void)
+{
+     NO_OP;
+}
+
+void
+SubMatrixScatterPlan::Invalidate(void)
+{
+     eType = NONE;
+     uPatternId = 0;
+}
+
+bool
+SubMatrixScatterPlan::bIsValid(Type eT, const CompactSparseMatrixHandler& MH,
+                               const integer* piRow, integer iNumRows,
+                               const integer* piCol, integer iNumCols) const
+{
+     return eType == eT
+          && uPatternId == MH.uGetPatternId()
+          && Rows.size() == static_cast<size_t>(iNumRows)
+          && Cols.size() == static_cast<size_t>(iNumCols)
+          && std::equal(Rows.begin(), Rows.end(), piRow)
+          && std::equal(Cols.begin(), Cols.end(), piCol);
+}
+
+void
+SubMatrixScatterPlan::Build(Type eT, const CompactSparseMatrixHandler& MH,
+                            const integer* piRow, integer iNumRows,
+                            const integer* piCol, integer iNumCols)
+{
+     ASSERT(eT == FULL || eT == SPARSE);
+     ASSERT(eT == FULL || iNumRows == iNumCols);
+
+     /* resta invalido se un coefficiente manca dal pattern */
+     Invalidate();
+
+     Offsets.clear();
+
+     /* stesso ordine dei metodi generici, dall'ultimo al primo */
+     if (eT == FULL) {
+          Offsets.reserve(iNumRows*iNumCols);
+
+          for (integer c = iNumCols - 1; c >= 0; c--) {
+               for (integer r = iNumRows - 1; r >= 0; r--) {
+                    integer idx = MH.iGetIndex(piRow[r], piCol[c]);
+                    if (idx < 0) {
+                         throw MatrixHandler::ErrRebuildMatrix(MBDYN_EXCEPT_ARGS);
+                    }
+                    Offsets.push_back(idx);
+               }
+          }
+
+     } else {
+          Offsets.reserve(iNumRows);
+
+          for (integer i = iNumRows - 1; i >= 0; i--) {
+               integer idx = MH.iGetIndex(piRow[i], piCol[i]);
+               if (idx < 0) {
+                    throw MatrixHandler::ErrRebuildMatrix(MBDYN_EXCEPT_ARGS);
+               }
+               Offsets.push_back(idx);
+          }
+     }
+
+     Rows.assign(piRow, piRow + iNumRows);
+     Cols.assign(piCol, piCol + iNumCols);
+     uPatternId = MH.uGetPatternId();
+     eType = eT;
+}
+
+/* SubMatrixScatterPlan - end */
+
+
 /* FullSubMatrixHandler - begin */
 
 FullSubMatrixHandler::FullSubMatrixHandler(integer iIntSize,
@@ -639,6 +722,38 @@ FullSubMatrixHandler::AddTo(MatrixHandler& MH) const
 }
 
 
+/* somma la matrice ad una matrice compatta con un piano precalcolato */
+MatrixHandler&
+FullSubMatrixHandler::AddTo(CompactSparseMatrixHandler& MH,
+                            SubMatrixScatterPlan& oPlan) const
+{
+     DEBUGCOUTFNAME("FullSubMatrixHandler::AddTo");
+
+     ASSERT(MH.iGetNumRows() >= iNumRows);
+     ASSERT(MH.iGetNumCols() >= iNumCols);
+
+     if (!oPlan.bIsValid(SubMatrixScatterPlan::FULL, MH,
+               &piRowm1[1], iNumRows, &piColm1[1], iNumCols))
+     {
+          oPlan.Build(SubMatrixScatterPlan::FULL, MH,
+               &piRowm1[1], iNumRows, &piColm1[1], iNumCols);
+     }
+
+     doublereal *pdAx = MH.pdGetMat();
+     const integer *piOff = oPlan.piGetOffsets();
+
+     for (integer c = iNumCols; c > 0; c--) {
+          const doublereal *pdCol = ppdColsm1[c];
+
+          for (integer r = iNumRows; r > 0; r--) {
+               pdAx[*piOff++] += pdCol[r];
+          }
+     }
+
+     return MH;
+}
+
+
 /* somma la matrice, trasposta, ad un matrix handler usando i metodi generici */
 MatrixHandler&
 FullSubMatrixHandler::AddToT(MatrixHandler& MH) const
@@ -1540,6 +1655,31 @@ SparseSubMatrixHandler::AddTo(MatrixHandler& MH) const
 }
 
 
+/* somma la matrice ad una matrice compatta con un piano precalcolato */
+MatrixHandler&
+SparseSubMatrixHandler::AddTo(CompactSparseMatrixHandler& MH,
+                              SubMatrixScatterPlan& oPlan) const
+{
+     DEBUGCOUTFNAME("SparseSubMatrixHandler::AddTo");
+
+     if (!oPlan.bIsValid(SubMatrixScatterPlan::SPARSE, MH,
+               &piRowm1[1], iNumItems, &piColm1[1], iNumItems))
+     {
+          oPlan.Build(SubMatrixScatterPlan::SPARSE, MH,
+               &piRowm1[1], iNumItems, &piColm1[1], iNumItems);
+     }
+
+     doublereal *pdAx = MH.pdGetMat();
+     const integer *piOff = oPlan.piGetOffsets();
+
+     for (integer i = iNumItems; i > 0; i--) {
+          pdAx[*piOff++] += pdMatm1[i];
+     }
+
+     return MH;
+}
+
+
 /* somma la matrice, trasposta, ad un matrix handler usando i metodi generici */
 MatrixHandler&
 SparseSubMatrixHandler::AddToT(MatrixHandler& MH) const
@@ -1986,6 +2126,25 @@ VariableSubMatrixHandler::~VariableSubMatrixHandler()
 {
 }
 
+MatrixHandler&
+VariableSubMatrixHandler::AddTo(CompactSparseMatrixHandler& MH,
+                                SubMatrixScatterPlan& oPlan) const
+{
+     switch (eStatus) {
+     case FULL:
+          return GetFull().AddTo(MH, oPlan);
+
+     case SPARSE:
+          return GetSparse().AddTo(MH, oPlan);
+
+     case NULLMATRIX:
+          return MH;
+
+     default:
+          return AddTo(static_cast<MatrixHandler&>(MH));
+     }
+}
+
 VariableSubMatrixHandlerNonAd::VariableSubMatrixHandlerNonAd(integer iIntSize, integer* piInt,
                                                              integer iDoubleSize, doublereal* pdDouble,
                                                              integer iMaxRows, integer iMaxCols)
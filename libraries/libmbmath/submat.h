@@ -172,6 +172,60 @@ public:
 /* SubMatrixHandler - end */
 
 
+/* SubMatrixScatterPlan - begin */
+
+class CompactSparseMatrixHandler;
+
+/*
+ * Posizioni dei coefficienti di una sottomatrice nell'array dei
+ * coefficienti di una CompactSparseMatrixHandler.
+ * Viene costruito la prima volta che la sottomatrice viene sommata,
+ * e riusato finche' non cambiano gli indici della sottomatrice
+ * o il pattern della matrice; evita la ricerca di ogni coefficiente.
+ */
+class SubMatrixScatterPlan {
+public:
+     enum Type {
+          NONE,
+          FULL,
+          SPARSE
+     };
+
+private:
+     Type eType;
+     unsigned long uPatternId;
+     std::vector<integer> Rows;
+     std::vector<integer> Cols;
+     std::vector<integer> Offsets;
+
+public:
+     SubMatrixScatterPlan(void);
+     ~SubMatrixScatterPlan(void);
+
+     void Invalidate(void);
+
+     /* vero se il piano e' stato costruito per gli stessi indici
+      * e per lo stesso pattern */
+     bool bIsValid(Type eT, const CompactSparseMatrixHandler& MH,
+          const integer* piRow, integer iNumRows,
+          const integer* piCol, integer iNumCols) const;
+
+     /* FULL: iNumRows*iNumCols posizioni, per colonne;
+      * SPARSE: iNumRows == iNumCols posizioni, una per coefficiente.
+      * Lancia MatrixHandler::ErrRebuildMatrix se un coefficiente
+      * non fa parte del pattern */
+     void Build(Type eT, const CompactSparseMatrixHandler& MH,
+          const integer* piRow, integer iNumRows,
+          const integer* piCol, integer iNumCols);
+
+     const integer* piGetOffsets(void) const {
+          return Offsets.data();
+     };
+};
+
+/* SubMatrixScatterPlan - end */
+
+
 /* FullSubMatrixHandler */
 
 /*
@@ -661,6 +715,13 @@ public:
       */
      MatrixHandler& AddToT(FullMatrixHandler& MH) const;
 
+     /*
+      * Somma la matrice ad una matrice compatta usando un piano
+      * di assemblaggio precalcolato (ricostruito se non valido)
+      */
+     MatrixHandler& AddTo(CompactSparseMatrixHandler& MH,
+                          SubMatrixScatterPlan& oPlan) const;
+
      VectorHandler& MultAddTo(VectorHandler& A, const VectorHandler& Y) const override;
      /*
       * Sottrae la matrice da un matrix handler usando i metodi generici
@@ -1105,6 +1166,13 @@ public:
       */
      MatrixHandler& AddToT(FullMatrixHandler& MH) const;
 
+     /*
+      * Somma la matrice ad una matrice compatta usando un piano
+      * di assemblaggio precalcolato (ricostruito se non valido)
+      */
+     MatrixHandler& AddTo(CompactSparseMatrixHandler& MH,
+                          SubMatrixScatterPlan& oPlan) const;
+
      VectorHandler& MultAddTo(VectorHandler& A, const VectorHandler& Y) const override;
 
      /*
@@ -1260,6 +1328,13 @@ public:
 
      virtual MatrixHandler& AddTo(MatrixHandler& MH) const = 0;
 
+     /*
+      * Si somma ad una matrice compatta; le sottomatrici piene e sparse
+      * usano il piano di assemblaggio, le altre i metodi generici.
+      */
+     MatrixHandler& AddTo(CompactSparseMatrixHandler& MH,
+                          SubMatrixScatterPlan& oPlan) const;
+
      virtual MatrixHandler& AddToT(MatrixHandler& MH) const = 0;
 
      virtual VectorHandler& MultAddTo(VectorHandler& A, const VectorHandler& Y) const = 0;
@@ -33,6 +33,91 @@
 
 #include "submat.h"
 #include "spmapmh.h"
+#include "ccmh.h"
+
+/*
+ * a scatter plan built on a compact matrix must be rejected
+ * once the pattern is rebuilt, as the solution managers do
+ * after MatrixHandler::ErrRebuildMatrix
+ */
+static int
+ScatterPlanRebuildTest(void)
+{
+	int rc = 0;
+
+	SpMapMatrixHandler SMH(4);
+	std::vector<doublereal> Ax;
+	std::vector<integer> Ai, Ap;
+
+	FullSubMatrixHandler FSMH(2, 2);
+	FSMH.ResizeReset(2, 2);
+	FSMH.PutRowIndex(1, 3);
+	FSMH.PutRowIndex(2, 4);
+	FSMH.PutColIndex(1, 3);
+	FSMH.PutColIndex(2, 4);
+	FSMH(1, 1) = 33.;
+	FSMH(1, 2) = 34.;
+	FSMH(2, 1) = 43.;
+	FSMH(2, 2) = 44.;
+
+	/* first pattern: the block only */
+	FSMH.AddTo(SMH);
+	SMH.MakeCompressedColumnForm(Ax, Ai, Ap, 0);
+
+	CColMatrixHandler<0> *pCC = new CColMatrixHandler<0>(Ax, Ai, Ap);
+	pCC->Reset();
+
+	SubMatrixScatterPlan oPlan;
+	FSMH.AddTo(*pCC, oPlan);
+
+	const integer piRow[] = { 3, 4 };
+	const integer *piCol = piRow;
+	if (!oPlan.bIsValid(SubMatrixScatterPlan::FULL, *pCC, piRow, 2, piCol, 2)) {
+		std::cerr << "scatter plan not valid after build" << std::endl;
+		rc++;
+	}
+
+	/* second pattern: entries added in front of the block,
+	 * so that the offsets of the block change */
+	SMH.Reset();
+	SMH(1, 3) = 1.;
+	SMH(1, 4) = 1.;
+	FSMH.AddTo(SMH);
+	SMH.MakeCompressedColumnForm(Ax, Ai, Ap, 0);
+
+	delete pCC;
+	pCC = new CColMatrixHandler<0>(Ax, Ai, Ap);
+	pCC->Reset();
+
+	if (oPlan.bIsValid(SubMatrixScatterPlan::FULL, *pCC, piRow, 2, piCol, 2)) {
+		std::cerr << "stale scatter plan accepted after rebuild" << std::endl;
+		rc++;
+	}
+
+	FSMH.AddTo(*pCC, oPlan);
+	for (integer r = 3; r <= 4; r++) {
+		for (integer c = 3; c <= 4; c++) {
+			if (pCC->dGetCoef(r, c) != FSMH(r - 2, c - 2)) {
+				std::cerr << "CC(" << r << ", " << c << ")="
+					<< pCC->dGetCoef(r, c) << " != "
+					<< FSMH(r - 2, c - 2) << std::endl;
+				rc++;
+			}
+		}
+	}
+
+	if (pCC->dGetCoef(1, 3) != 0. || pCC->dGetCoef(1, 4) != 0.) {
+		std::cerr << "scatter plan wrote outside of the block" << std::endl;
+		rc++;
+	}
+
+	delete pCC;
+
+	std::cout << "scatter plan rebuild test: "
+		<< (rc ? "failed" : "passed") << std::endl;
+
+	return rc;
+}
 
 int
 main(void)
@@ -96,5 +181,9 @@ main(void)
 
 	std::cout << "SMH = -FSMH^T: " << std::endl << SMH << std::endl;
 
+	if (ScatterPlanRebuildTest() != 0) {
+		return 1;
+	}
+
 	return 0;
 }
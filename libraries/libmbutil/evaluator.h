@@ -39,6 +39,8 @@
 
 #include "mathtyp.h"
 
+class EE_Program;
+
 class ExpressionElement {
 public:
 	enum EEFlags {
@@ -59,6 +61,8 @@ public:
 #endif
 	virtual TypedValue Eval(void) const = 0;
 	virtual std::ostream& Output(std::ostream& out) const = 0;
+	// lowers the expression into prog; false if not supported
+	virtual bool Compile(EE_Program& prog) const { return false; };
 
 	static unsigned GetFlags(void) { return m_uEEFlags; };
 	static void SetFlag(EEFlags f) { m_uEEFlags |= unsigned(f); };
@@ -0,0 +1,175 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Compares the evaluation of expressions by walking the
+ * ExpressionElement tree and by the flat EE_Program.
+ *
+ * usage: evaluator_bench [-n <loops>] ["<expr>" ...]
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+#include "mathp.h"
+#include "clock_time.h"
+
+#ifndef DO_NOT_USE_EE
+#include "evaluator_prog.h"
+
+static const char *sDefExpr[] = {
+	"2.*Time",
+	"1. - exp(-Time/.1)",
+	"(Time > .5)*sin(2.*pi*10.*Time)",
+	"100.*(1. - cos(pi*Time))^2 + Var/3.",
+	"Step % 2 + Time",	// not supported: left to the tree
+	"(Step + 1)*Time*.5",
+	0
+};
+
+int
+main(int argc, char *argv[])
+{
+	long iLoops = 1000000;
+	std::vector<const char *> vExpr;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+			iLoops = atol(argv[++i]);
+
+		} else {
+			vExpr.push_back(argv[i]);
+		}
+	}
+
+	if (vExpr.empty()) {
+		for (const char **s = sDefExpr; *s; s++) {
+			vExpr.push_back(*s);
+		}
+	}
+
+	Table T(true);
+	MathParser MP(T);
+
+	Var *pTime = T.Put("Time", TypedValue(Real(0.)));
+	Var *pVar = T.Put("Var", TypedValue(Real(0.)));
+	Var *pStep = T.Put("Step", TypedValue(Int(0)));
+
+	int rc = EXIT_SUCCESS;
+
+	for (std::vector<const char *>::const_iterator s = vExpr.begin(); s != vExpr.end(); ++s) {
+		ExpressionElement *ee = 0;
+
+		try {
+			std::istringstream in(*s);
+			InputStream In(in);
+			ee = MP.GetExpr(In);
+
+		} catch (MBDynErrBase& e) {
+			std::cout << "\"" << *s << "\": parse error (" << e.what() << ")" << std::endl;
+			continue;
+		}
+
+		EE_Program prog;
+		if (!prog.Compile(ee)) {
+			std::cout << "\"" << *s << "\": not compiled" << std::endl;
+			delete ee;
+			continue;
+		}
+
+		// check
+		Real dErr = 0.;
+		for (long i = 0; i < 1000; i++) {
+			pTime->SetVal(Real(i)*1e-3);
+			pVar->SetVal(std::sin(Real(i)));
+			pStep->SetVal(Int(i));
+
+			const Real d1 = ee->Eval().GetReal();
+			const Real d2 = prog.Eval();
+			dErr = std::max(dErr, std::abs(d1 - d2));
+		}
+
+		if (dErr > 0.) {
+			rc = EXIT_FAILURE;
+		}
+
+		// tree
+		Real dSum1 = 0.;
+		double t0 = mbdyn_clock_time();
+		for (long i = 0; i < iLoops; i++) {
+			pTime->SetVal(Real(i)*1e-6);
+			dSum1 += ee->Eval().GetReal();
+		}
+		double t1 = mbdyn_clock_time();
+
+		// flat
+		Real dSum2 = 0.;
+		for (long i = 0; i < iLoops; i++) {
+			pTime->SetVal(Real(i)*1e-6);
+			dSum2 += prog.Eval();
+		}
+		double t2 = mbdyn_clock_time();
+
+		const double dTree = (t1 - t0)/iLoops*1e9;
+		const double dProg = (t2 - t1)/iLoops*1e9;
+
+		std::cout << "\"" << *s << "\": "
+			<< prog.uGetSize() << " instr, "
+			<< "tree " << std::setprecision(4) << dTree << " ns/call, "
+			<< "program " << dProg << " ns/call, "
+			<< "speedup " << dTree/dProg << ", "
+			<< "max diff " << dErr
+			<< (dSum1 == dSum2 ? "" : " (sums differ)")
+			<< std::endl;
+
+		delete ee;
+	}
+
+	return rc;
+}
+
+#else // DO_NOT_USE_EE
+
+int
+main(void)
+{
+	std::cerr << "expression evaluator not available" << std::endl;
+	return EXIT_SUCCESS;
+}
+
+#endif // DO_NOT_USE_EE
@@ -43,6 +43,7 @@
 #include <limits>
 
 // "evaluator.h" must be explicitly included
+#include "evaluator_prog.h"
 
 // for storing constant values like "1","1.23"
 class EE_Value : public ExpressionElement {
@@ -60,6 +61,12 @@ public:
 		return m_Val;
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return prog.PushConst(m_Val);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -88,6 +95,12 @@ public:
 		return m_Var->GetVal();
 	};
 
+	virtual bool
+	Compile(EE_Program& prog) const
+	{
+		return prog.PushVar(m_Var);
+	};
+
 	virtual std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -114,6 +127,13 @@ public:
 		return m_pEE1->Eval() + m_pEE2->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_ADD, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -136,6 +156,13 @@ public:
 		return m_pEE1->Eval() - m_pEE2->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_SUB, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -192,6 +219,14 @@ public:
 		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		// integer only: can only be folded into a constant
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_LAST, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -213,6 +248,13 @@ public:
 		return m_pEE1->Eval() * m_pEE2->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_MUL, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -250,6 +292,13 @@ public:
 		return m_pEE1->Eval() / den;
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_DIV, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -271,6 +320,12 @@ public:
 		return -m_pEE1->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && prog.Unary(EE_Program::OP_NEG, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -292,6 +347,13 @@ public:
 		return m_pEE1->Eval() && m_pEE2->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_AND, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -313,6 +375,13 @@ public:
 		return m_pEE1->Eval() || m_pEE2->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_OR, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -334,6 +403,12 @@ public:
 		return !(m_pEE1->Eval());
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && prog.Unary(EE_Program::OP_NOT, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -358,6 +433,13 @@ public:
 		return ((!(v1 && v2)) && (v1 || v2));
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_XOR, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -379,6 +461,13 @@ public:
 		return m_pEE1->Eval() > m_pEE2->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_GT, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -400,6 +489,13 @@ public:
 		return m_pEE1->Eval() >= m_pEE2->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_GE, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -421,6 +517,13 @@ public:
 		return m_pEE1->Eval() < m_pEE2->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_LT, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -442,6 +545,13 @@ public:
 		return m_pEE1->Eval() <= m_pEE2->Eval();
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_LE, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -463,6 +573,13 @@ public:
 		return (m_pEE1->Eval()) == (m_pEE2->Eval());
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_EQ, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -484,6 +601,13 @@ public:
 		return (m_pEE1->Eval()) != (m_pEE2->Eval());
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_NE, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -523,6 +647,13 @@ public:
 		}
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		return m_pEE1->Compile(prog) && m_pEE2->Compile(prog)
+			&& prog.Binary(EE_Program::OP_POW, this);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
@@ -690,6 +821,19 @@ public:
 		return val;
 	};
 
+	bool
+	Compile(EE_Program& prog) const
+	{
+		for (unsigned i = 1; i < m_f->args.size(); i++) {
+			const ExpressionElement *ee = m_f->args[i]->GetExpr();
+			if (ee != 0 && !ee->Compile(prog)) {
+				return false;
+			}
+		}
+
+		return prog.Call(m_p, m_f);
+	};
+
 	std::ostream&
 	Output(std::ostream& out) const
 	{
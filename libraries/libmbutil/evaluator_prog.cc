@@ -0,0 +1,431 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <iostream>
+
+#include "mathp.h"
+
+#ifndef DO_NOT_USE_EE
+
+#include "evaluator_prog.h"
+
+EE_Program::EE_Program(void)
+: m_uMaxDepth(0), m_bCompiled(false)
+{
+	NO_OP;
+}
+
+EE_Program::~EE_Program(void)
+{
+	NO_OP;
+}
+
+void
+EE_Program::Reset(void)
+{
+	m_Code.clear();
+	m_Calls.clear();
+	m_Types.clear();
+	m_uMaxDepth = 0;
+	m_bCompiled = false;
+}
+
+bool
+EE_Program::Compile(const ExpressionElement *ee)
+{
+	Reset();
+
+	if (ee == 0) {
+		return false;
+	}
+
+	try {
+		if (!ee->Compile(*this) || m_Types.size() != 1) {
+			Reset();
+			return false;
+		}
+
+	} catch (...) {
+		// folding may fail exactly as the tree evaluation would;
+		// leave the error to the evaluation of the tree
+		Reset();
+		return false;
+	}
+
+	m_Types.clear();
+	m_bCompiled = true;
+
+	return true;
+}
+
+bool
+EE_Program::Push(const Instr& i, TypedValue::Type type, bool bConst)
+{
+	if (m_Types.size() >= MAX_STACK) {
+		return false;
+	}
+
+	m_Code.push_back(i);
+
+	TypeInfo t;
+	t.type = type;
+	t.bConst = bConst;
+	m_Types.push_back(t);
+
+	if (m_Types.size() > m_uMaxDepth) {
+		m_uMaxDepth = m_Types.size();
+	}
+
+	return true;
+}
+
+bool
+EE_Program::PushConst(const TypedValue& v)
+{
+	switch (v.GetType()) {
+	case TypedValue::VAR_BOOL:
+	case TypedValue::VAR_INT:
+	case TypedValue::VAR_REAL:
+		break;
+
+	default:
+		return false;
+	}
+
+	Instr i;
+	i.op = OP_CONST;
+	i.u.d = v.GetReal();
+
+	return Push(i, v.GetType(), true);
+}
+
+bool
+EE_Program::PushVar(const NamedValue *pVar)
+{
+	switch (pVar->GetType()) {
+	case TypedValue::VAR_BOOL:
+	case TypedValue::VAR_INT:
+	case TypedValue::VAR_REAL:
+		break;
+
+	default:
+		return false;
+	}
+
+	if (pVar->Const() && !pVar->MayChange()) {
+		return PushConst(pVar->GetVal());
+	}
+
+	Instr i;
+	const Var *pV = pVar->IsVar() ? dynamic_cast<const Var *>(pVar) : 0;
+	if (pV != 0) {
+		i.op = OP_VAR;
+		i.u.pVal = pV->pGetVal();
+
+	} else {
+		i.op = OP_NAMED;
+		i.u.pNV = pVar;
+	}
+
+	return Push(i, pVar->GetType(), false);
+}
+
+// replaces the last uNumArgs constants with the value of ee
+bool
+EE_Program::Fold(unsigned uNumArgs, const ExpressionElement *ee)
+{
+	ASSERT(m_Types.size() >= uNumArgs);
+	ASSERT(m_Code.size() >= uNumArgs);
+
+	m_Types.resize(m_Types.size() - uNumArgs);
+	m_Code.resize(m_Code.size() - uNumArgs);
+
+	return PushConst(ee->Eval());
+}
+
+bool
+EE_Program::Unary(Op op, const ExpressionElement *ee)
+{
+	ASSERT(!m_Types.empty());
+
+	const TypeInfo t = m_Types.back();
+	if (t.bConst) {
+		return Fold(1, ee);
+	}
+
+	TypedValue::Type type;
+	switch (op) {
+	case OP_NEG:
+		type = IsInt(t.type) ? TypedValue::VAR_INT : TypedValue::VAR_REAL;
+		break;
+
+	case OP_NOT:
+		type = TypedValue::VAR_BOOL;
+		break;
+
+	default:
+		ASSERT(0);
+		return false;
+	}
+
+	m_Types.pop_back();
+
+	Instr i;
+	i.op = op;
+	i.u.d = 0.;
+	m_Code.push_back(i);
+
+	TypeInfo r;
+	r.type = type;
+	r.bConst = false;
+	m_Types.push_back(r);
+
+	return true;
+}
+
+bool
+EE_Program::Binary(Op op, const ExpressionElement *ee)
+{
+	ASSERT(m_Types.size() >= 2);
+
+	const TypeInfo t2 = m_Types.back();
+	const TypeInfo t1 = m_Types[m_Types.size() - 2];
+
+	if (t1.bConst && t2.bConst) {
+		return Fold(2, ee);
+	}
+
+	const bool bInt = IsInt(t1.type) && IsInt(t2.type);
+
+	TypedValue::Type type;
+	switch (op) {
+	case OP_ADD:
+	case OP_SUB:
+	case OP_MUL:
+		// exact as long as integers fit in the mantissa
+		type = bInt ? TypedValue::VAR_INT : TypedValue::VAR_REAL;
+		break;
+
+	case OP_DIV:
+	case OP_POW:
+		// integer division and power cannot be represented
+		if (bInt) {
+			return false;
+		}
+		type = TypedValue::VAR_REAL;
+		break;
+
+	case OP_GT:
+	case OP_GE:
+	case OP_LT:
+	case OP_LE:
+	case OP_EQ:
+	case OP_NE:
+	case OP_AND:
+	case OP_OR:
+	case OP_XOR:
+		type = TypedValue::VAR_BOOL;
+		break;
+
+	default:
+		// e.g. modulus of non-constant operands
+		return false;
+	}
+
+	m_Types.pop_back();
+	m_Types.pop_back();
+
+	Instr i;
+	i.op = op;
+	i.u.d = 0.;
+	m_Code.push_back(i);
+
+	TypeInfo r;
+	r.type = type;
+	r.bConst = false;
+	m_Types.push_back(r);
+
+	return true;
+}
+
+bool
+EE_Program::Call(MathParser *pParser, MathParser::MathFunc_t *pFunc)
+{
+	// other namespaces may evaluate functions in their own way
+	if (dynamic_cast<MathParser::StaticNameSpace *>(pFunc->ns) == 0 || pFunc->f == 0) {
+		return false;
+	}
+
+	CallInfo c;
+	c.pParser = pParser;
+	c.pFunc = pFunc;
+	c.resType = pFunc->args[0]->Type();
+
+	TypedValue::Type type;
+	switch (c.resType) {
+	case MathParser::AT_BOOL:
+		type = TypedValue::VAR_BOOL;
+		break;
+
+	case MathParser::AT_INT:
+		type = TypedValue::VAR_INT;
+		break;
+
+	case MathParser::AT_REAL:
+		type = TypedValue::VAR_REAL;
+		break;
+
+	default:
+		return false;
+	}
+
+	// the arguments with an expression have been compiled in order
+	for (unsigned a = 1; a < pFunc->args.size(); ++a) {
+		if (pFunc->args[a]->GetExpr() == 0) {
+			continue;
+		}
+
+		switch (pFunc->args[a]->Type()) {
+		case MathParser::AT_BOOL:
+		case MathParser::AT_INT:
+		case MathParser::AT_REAL:
+			break;
+
+		default:
+			return false;
+		}
+
+		CallArg arg;
+		arg.uIdx = a;
+		arg.type = pFunc->args[a]->Type();
+		c.args.push_back(arg);
+	}
+
+	ASSERT(m_Types.size() >= c.args.size());
+
+	// functions are never folded (e.g. random numbers)
+	m_Types.resize(m_Types.size() - c.args.size());
+
+	m_Calls.push_back(c);
+
+	Instr i;
+	i.op = OP_CALL;
+	i.u.uCall = m_Calls.size() - 1;
+
+	return Push(i, type, false);
+}
+
+void
+EE_Program::Call(const CallInfo& c, Real *pArgs) const
+{
+	MathParser::MathFunc_t *f = c.pFunc;
+
+	for (unsigned a = 0; a < c.args.size(); ++a) {
+		MathParser::MathArg_t *pArg = f->args[c.args[a].uIdx];
+
+		// same conversions of TypedValue::GetBool/GetInt/GetReal
+		switch (c.args[a].type) {
+		case MathParser::AT_BOOL:
+			(*static_cast<MathParser::MathArgBool_t *>(pArg))() = (pArgs[a] != 0.);
+			break;
+
+		case MathParser::AT_INT:
+			(*static_cast<MathParser::MathArgInt_t *>(pArg))() = Int(pArgs[a]);
+			break;
+
+		default:
+			(*static_cast<MathParser::MathArgReal_t *>(pArg))() = pArgs[a];
+			break;
+		}
+	}
+
+	if (f->t != 0 && f->t(f->args)) {
+		throw MathParser::ErrGeneric(c.pParser, MBDYN_EXCEPT_ARGS,
+			f->fname + ": error " + f->errmsg);
+	}
+
+	f->f(f->args);
+
+	switch (c.resType) {
+	case MathParser::AT_BOOL:
+		pArgs[0] = (*static_cast<MathParser::MathArgBool_t *>(f->args[0]))();
+		break;
+
+	case MathParser::AT_INT:
+		pArgs[0] = (*static_cast<MathParser::MathArgInt_t *>(f->args[0]))();
+		break;
+
+	default:
+		pArgs[0] = (*static_cast<MathParser::MathArgReal_t *>(f->args[0]))();
+		break;
+	}
+}
+
+std::ostream&
+EE_Program::Output(std::ostream& out) const
+{
+	static const char *sOp[] = {
+		"const", "var", "named",
+		"add", "sub", "mul", "div", "pow", "neg",
+		"gt", "ge", "lt", "le", "eq", "ne",
+		"and", "or", "xor", "not",
+		"call"
+	};
+
+	static_assert(sizeof(sOp)/sizeof(sOp[0]) == OP_LAST, "opcode names out of sync");
+
+	for (std::vector<Instr>::const_iterator i = m_Code.begin(); i != m_Code.end(); ++i) {
+		out << sOp[i->op];
+		switch (i->op) {
+		case OP_CONST:
+			out << " " << i->u.d;
+			break;
+
+		case OP_NAMED:
+			out << " " << i->u.pNV->GetName();
+			break;
+
+		case OP_CALL:
+			out << " " << m_Calls[i->u.uCall].pFunc->fname;
+			break;
+
+		default:
+			break;
+		}
+		out << std::endl;
+	}
+
+	return out;
+}
+
+#endif // DO_NOT_USE_EE
@@ -0,0 +1,275 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVALUATOR_PROG_H
+#define EVALUATOR_PROG_H
+
+#include <vector>
+#include <cmath>
+
+#include "mathp.h"
+
+#ifndef DO_NOT_USE_EE
+
+/*
+ * Flat stack-machine program obtained by lowering an ExpressionElement
+ * tree; only numeric expressions are supported (no strings, no
+ * assignments, no declarations, only functions of the static
+ * namespace with numeric arguments).  Values are stored as Real;
+ * the compiler tracks the type of each subexpression, so that integer
+ * operations whose result would differ (division, power, modulus)
+ * are only accepted when they can be folded into a constant.
+ *
+ * Variable types are assumed not to change after compilation.
+ */
+class EE_Program {
+public:
+	enum Op {
+		OP_CONST,
+		OP_VAR,		// Var: direct access to its TypedValue
+		OP_NAMED,	// any other NamedValue (e.g. plugins)
+
+		OP_ADD,
+		OP_SUB,
+		OP_MUL,
+		OP_DIV,
+		OP_POW,
+		OP_NEG,
+
+		OP_GT,
+		OP_GE,
+		OP_LT,
+		OP_LE,
+		OP_EQ,
+		OP_NE,
+
+		OP_AND,
+		OP_OR,
+		OP_XOR,
+		OP_NOT,
+
+		OP_CALL,
+
+		OP_LAST
+	};
+
+	// maximum evaluation stack depth
+	static const unsigned MAX_STACK = 64;
+
+private:
+	struct Instr {
+		Op op;
+		union {
+			Real d;
+			const TypedValue *pVal;
+			const NamedValue *pNV;
+			unsigned uCall;
+		} u;
+	};
+
+	struct CallArg {
+		unsigned uIdx;
+		MathParser::ArgType type;
+	};
+
+	struct CallInfo {
+		MathParser *pParser;
+		MathParser::MathFunc_t *pFunc;
+		MathParser::ArgType resType;
+		std::vector<CallArg> args;
+	};
+
+	// compile time only
+	struct TypeInfo {
+		TypedValue::Type type;
+		bool bConst;
+	};
+
+	std::vector<Instr> m_Code;
+	std::vector<CallInfo> m_Calls;
+	std::vector<TypeInfo> m_Types;
+	unsigned m_uMaxDepth;
+	bool m_bCompiled;
+
+	bool Push(const Instr& i, TypedValue::Type type, bool bConst);
+	bool Fold(unsigned uNumArgs, const ExpressionElement *ee);
+	void Call(const CallInfo& c, Real *pArgs) const;
+
+	static bool IsInt(TypedValue::Type type) {
+		return type == TypedValue::VAR_INT || type == TypedValue::VAR_BOOL;
+	};
+
+public:
+	EE_Program(void);
+	~EE_Program(void);
+
+	// returns false (and leaves the program empty) if ee cannot be lowered
+	bool Compile(const ExpressionElement *ee);
+	void Reset(void);
+
+	bool bIsCompiled(void) const { return m_bCompiled; };
+	unsigned uGetSize(void) const { return m_Code.size(); };
+	unsigned uGetMaxDepth(void) const { return m_uMaxDepth; };
+
+	inline Real Eval(void) const;
+
+	std::ostream& Output(std::ostream& out) const;
+
+	// used by ExpressionElement::Compile()
+	bool PushConst(const TypedValue& v);
+	bool PushVar(const NamedValue *pVar);
+	bool Unary(Op op, const ExpressionElement *ee);
+	bool Binary(Op op, const ExpressionElement *ee);
+	bool Call(MathParser *pParser, MathParser::MathFunc_t *pFunc);
+};
+
+inline Real
+EE_Program::Eval(void) const
+{
+	ASSERT(m_bCompiled);
+
+	Real stack[MAX_STACK];
+	Real *pTop = stack - 1;
+
+	for (std::vector<Instr>::const_iterator i = m_Code.begin(); i != m_Code.end(); ++i) {
+		switch (i->op) {
+		case OP_CONST:
+			*++pTop = i->u.d;
+			break;
+
+		case OP_VAR:
+			*++pTop = i->u.pVal->GetReal();
+			break;
+
+		case OP_NAMED:
+			*++pTop = i->u.pNV->GetVal().GetReal();
+			break;
+
+		case OP_ADD:
+			pTop[-1] += pTop[0];
+			--pTop;
+			break;
+
+		case OP_SUB:
+			pTop[-1] -= pTop[0];
+			--pTop;
+			break;
+
+		case OP_MUL:
+			pTop[-1] *= pTop[0];
+			--pTop;
+			break;
+
+		case OP_DIV:
+			pTop[-1] /= pTop[0];
+			--pTop;
+			break;
+
+		case OP_POW:
+			pTop[-1] = std::pow(pTop[-1], pTop[0]);
+			--pTop;
+			break;
+
+		case OP_NEG:
+			pTop[0] = -pTop[0];
+			break;
+
+		case OP_GT:
+			pTop[-1] = (pTop[-1] > pTop[0]);
+			--pTop;
+			break;
+
+		case OP_GE:
+			pTop[-1] = (pTop[-1] >= pTop[0]);
+			--pTop;
+			break;
+
+		case OP_LT:
+			pTop[-1] = (pTop[-1] < pTop[0]);
+			--pTop;
+			break;
+
+		case OP_LE:
+			pTop[-1] = (pTop[-1] <= pTop[0]);
+			--pTop;
+			break;
+
+		case OP_EQ:
+			pTop[-1] = (pTop[-1] == pTop[0]);
+			--pTop;
+			break;
+
+		case OP_NE:
+			pTop[-1] = (pTop[-1] != pTop[0]);
+			--pTop;
+			break;
+
+		case OP_AND:
+			pTop[-1] = (pTop[-1] && pTop[0]);
+			--pTop;
+			break;
+
+		case OP_OR:
+			pTop[-1] = (pTop[-1] || pTop[0]);
+			--pTop;
+			break;
+
+		case OP_XOR:
+			pTop[-1] = ((pTop[-1] != 0.) != (pTop[0] != 0.));
+			--pTop;
+			break;
+
+		case OP_NOT:
+			pTop[0] = !pTop[0];
+			break;
+
+		case OP_CALL: {
+			// arguments are consumed, the result takes their place
+			const CallInfo& c = m_Calls[i->u.uCall];
+			Real *pArgs = pTop - c.args.size() + 1;
+			Call(c, pArgs);
+			pTop = pArgs;
+			} break;
+
+		default:
+			ASSERT(0);
+			break;
+		}
+	}
+
+	ASSERT(pTop == stack);
+
+	return *pTop;
+}
+
+#endif // DO_NOT_USE_EE
+
+#endif // EVALUATOR_PROG_H
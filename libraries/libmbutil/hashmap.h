@@ -0,0 +1,329 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/* Tabelle hash ad indirizzamento aperto per le tabelle dei simboli
+ * e per la ricerca di nodi ed elementi per label */
+
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+
+#include "myassert.h"
+
+/* funzioni hash (FNV-1a) e confronto per stringhe */
+struct strhash {
+	size_t operator()(const std::string& s) const {
+		size_t h = 2166136261U;
+		for (std::string::size_type i = 0; i < s.size(); i++) {
+			h = (h ^ (unsigned char)s[i])*16777619U;
+		}
+		return h;
+	};
+};
+
+/* case-insensitive, come ltstrcase */
+struct strcasehash {
+	size_t operator()(const std::string& s) const {
+		size_t h = 2166136261U;
+		for (std::string::size_type i = 0; i < s.size(); i++) {
+			h = (h ^ (unsigned char)tolower((unsigned char)s[i]))*16777619U;
+		}
+		return h;
+	};
+};
+
+struct eqstrcase {
+	bool operator()(const std::string& s1, const std::string& s2) const {
+		return s1.size() == s2.size() && strcasecmp(s1.c_str(), s2.c_str()) == 0;
+	};
+};
+
+/* label di nodi ed elementi */
+struct labelhash {
+	size_t operator()(unsigned u) const {
+		/* hash moltiplicativo di Fibonacci */
+		return size_t(u*2654435769U);
+	};
+};
+
+/* HashMap - begin */
+
+/*
+ * Tabella hash ad indirizzamento aperto con sondaggio lineare.
+ * Le coppie (chiave, valore) sono memorizzate in un vettore nell'ordine
+ * di inserimento, che e' anche l'ordine di iterazione; la tabella
+ * contiene solo gli indici nel vettore, quindi la ricerca non segue
+ * puntatori come in std::map.
+ *
+ * L'interfaccia e' il sottoinsieme di std::map usato dal programma;
+ * non e' prevista la cancellazione di singoli elementi.
+ * L'inserimento invalida iteratori e riferimenti.
+ */
+template <class K, class V, class H, class E = std::equal_to<K> >
+class HashMap {
+public:
+	typedef K key_type;
+	typedef V mapped_type;
+	typedef std::pair<K, V> value_type;
+
+private:
+	typedef std::vector<value_type> EntryVecType;
+
+public:
+	typedef typename EntryVecType::iterator iterator;
+	typedef typename EntryVecType::const_iterator const_iterator;
+
+private:
+	EntryVecType Entries;
+	/* hash delle chiavi, per evitare i confronti e il ricalcolo */
+	std::vector<size_t> Hashes;
+	/* 0: vuoto; altrimenti, indice in Entries + 1 */
+	std::vector<unsigned> Slots;
+	size_t Mask;
+	H hash;
+	E eq;
+
+	/* posizione della chiave, o della casella vuota in cui inserirla */
+	size_t FindSlot(const K& k, size_t h) const {
+		ASSERT(!Slots.empty());
+
+		for (size_t s = h & Mask; ; s = (s + 1) & Mask) {
+			unsigned e = Slots[s];
+			if (e == 0 || (Hashes[e - 1] == h && eq(Entries[e - 1].first, k))) {
+				return s;
+			}
+		}
+	};
+
+	void Rehash(size_t n) {
+		ASSERT((n & (n - 1)) == 0);
+
+		Slots.assign(n, 0U);
+		Mask = n - 1;
+		for (size_t e = 0; e < Entries.size(); e++) {
+			size_t s = Hashes[e] & Mask;
+			while (Slots[s] != 0) {
+				s = (s + 1) & Mask;
+			}
+			Slots[s] = unsigned(e + 1);
+		}
+	};
+
+public:
+	HashMap(void) : Mask(0) { NO_OP; };
+
+	size_t size(void) const { return Entries.size(); };
+	bool empty(void) const { return Entries.empty(); };
+
+	iterator begin(void) { return Entries.begin(); };
+	iterator end(void) { return Entries.end(); };
+	const_iterator begin(void) const { return Entries.begin(); };
+	const_iterator end(void) const { return Entries.end(); };
+
+	void clear(void) {
+		Entries.clear();
+		Hashes.clear();
+		Slots.clear();
+		Mask = 0;
+	};
+
+	/* fattore di carico massimo 1/2 */
+	void reserve(size_t n) {
+		size_t s = 16;
+		while (s < 2*n) {
+			s *= 2;
+		}
+		Entries.reserve(n);
+		Hashes.reserve(n);
+		if (s > Slots.size()) {
+			Rehash(s);
+		}
+	};
+
+	iterator find(const K& k) {
+		if (Entries.empty()) {
+			return Entries.end();
+		}
+		unsigned e = Slots[FindSlot(k, hash(k))];
+		return e == 0 ? Entries.end() : Entries.begin() + (e - 1);
+	};
+
+	const_iterator find(const K& k) const {
+		if (Entries.empty()) {
+			return Entries.end();
+		}
+		unsigned e = Slots[FindSlot(k, hash(k))];
+		return e == 0 ? Entries.end() : Entries.begin() + (e - 1);
+	};
+
+	std::pair<iterator, bool> insert(const value_type& v) {
+		if (2*(Entries.size() + 1) > Slots.size()) {
+			reserve(Entries.size() + 1);
+		}
+
+		size_t h = hash(v.first);
+		size_t s = FindSlot(v.first, h);
+		if (Slots[s] != 0) {
+			return std::pair<iterator, bool>(Entries.begin() + (Slots[s] - 1), false);
+		}
+
+		Entries.push_back(v);
+		Hashes.push_back(h);
+		Slots[s] = unsigned(Entries.size());
+
+		return std::pair<iterator, bool>(Entries.end() - 1, true);
+	};
+
+	V& operator[](const K& k) {
+		return insert(value_type(k, V())).first->second;
+	};
+};
+
+/* HashMap - end */
+
+
+/* LabelMap - begin */
+
+/*
+ * Mappa label -> puntatore per nodi ed elementi.  Finche' le label
+ * sono abbastanza compatte (come di solito accade nei modelli generati),
+ * usa un vettore indicizzato direttamente con la label; altrimenti
+ * passa ad una HashMap.
+ */
+template <class T>
+class LabelMap {
+private:
+	typedef HashMap<unsigned, T *, labelhash> SparseType;
+
+	std::vector<T *> Dense;
+	SparseType Sparse;
+	size_t iNum;
+	bool bDense;
+
+	/* il vettore puo' essere al piu' grande il doppio del numero
+	 * di label, piu' una costante */
+	static const size_t iDenseSlack = 1024;
+
+public:
+	LabelMap(void) : iNum(0), bDense(true) { NO_OP; };
+
+	size_t size(void) const { return iNum; };
+	bool empty(void) const { return iNum == 0; };
+
+	void clear(void) {
+		Dense.clear();
+		Sparse.clear();
+		iNum = 0;
+		bDense = true;
+	};
+
+	/* inserisce o sostituisce, come std::map::operator[] */
+	void insert(unsigned uLabel, T *p) {
+		ASSERT(p != 0);
+
+		if (bDense) {
+			if (uLabel < Dense.size()) {
+				if (Dense[uLabel] == 0) {
+					iNum++;
+				}
+				Dense[uLabel] = p;
+				return;
+			}
+
+			if (uLabel < 2*(iNum + 1) + iDenseSlack) {
+				Dense.resize(uLabel + 1, 0);
+				Dense[uLabel] = p;
+				iNum++;
+				return;
+			}
+
+			/* label troppo sparse: passa alla tabella hash */
+			Sparse.reserve(iNum + 1);
+			for (size_t i = 0; i < Dense.size(); i++) {
+				if (Dense[i] != 0) {
+					Sparse.insert(typename SparseType::value_type(unsigned(i), Dense[i]));
+				}
+			}
+			std::vector<T *>().swap(Dense);
+			bDense = false;
+		}
+
+		std::pair<typename SparseType::iterator, bool> r
+			= Sparse.insert(typename SparseType::value_type(uLabel, p));
+		if (r.second) {
+			iNum++;
+
+		} else {
+			r.first->second = p;
+		}
+	};
+
+	/* 0 se la label non esiste */
+	T *find(unsigned uLabel) const {
+		if (bDense) {
+			return uLabel < Dense.size() ? Dense[uLabel] : 0;
+		}
+
+		typename SparseType::const_iterator i = Sparse.find(uLabel);
+		return i == Sparse.end() ? 0 : i->second;
+	};
+
+	/* label piu' piccola, come std::map::begin(); 0 se vuota */
+	T *first(void) const {
+		if (bDense) {
+			for (size_t i = 0; i < Dense.size(); i++) {
+				if (Dense[i] != 0) {
+					return Dense[i];
+				}
+			}
+			return 0;
+		}
+
+		typename SparseType::const_iterator iMin = Sparse.end();
+		for (typename SparseType::const_iterator i = Sparse.begin(); i != Sparse.end(); ++i) {
+			if (iMin == Sparse.end() || i->first < iMin->first) {
+				iMin = i;
+			}
+		}
+		return iMin == Sparse.end() ? 0 : iMin->second;
+	};
+};
+
+/* LabelMap - end */
+
+#endif // HASHMAP_H
@@ -33,74 +33,260 @@
 
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <charconv>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif /* HAVE_SYS_MMAN_H */
+
 #include "input.h"
 
 /* InputStream - begin */
 
+InputStream::InputStream(void)
+: pStrm(0), uLineNumber(1),
+pBuf(0), pCur(0), pEnd(0), bEOF(false), bFail(false)
+{
+   NO_OP;
+}
+
 /* Costruttore - inizializza il filtro con un reference ad un istream */
 InputStream::InputStream(std::istream& in) 
-: iStrm(in), uLineNumber(1) 
+: pStrm(&in), uLineNumber(1),
+pBuf(0), pCur(0), pEnd(0), bEOF(false), bFail(false)
 {
    NO_OP;
 }
 
+InputStream::InputStream(const char *p, size_t size)
+: pStrm(0), uLineNumber(1),
+pBuf(0), pCur(0), pEnd(0), bEOF(false), bFail(false)
+{
+   SetBuffer(p, size);
+}
+
 /* Distruttore banale */
 InputStream::~InputStream(void) { 
    NO_OP;
 }  
 
-InputStream& operator >> (InputStream& in, int& i)
+void
+InputStream::SetBuffer(const char *p, size_t size)
 {
-   in.iStrm >> i;
+   ASSERT(pStrm == 0);
+
+   pBuf = p;
+   pCur = p;
+   pEnd = p + size;
+}
+
+void
+InputStream::putback_buf(char ch)
+{
+   if (bEOF) {
+      /* come per l'istream dopo SetEOF(), EOF non puo' essere annullato */
+      if (ch == char(EOF)) {
+         return;
+      }
+      bEOF = false;
+   }
+
+   sPutBack.push_back(ch);
+}
+
+void
+InputStream::SetEOF(void)
+{
+   if (pStrm) {
+      pStrm->setstate(std::ios::eofbit);
+      return;
+   }
+
+   sPutBack.clear();
+   pCur = pEnd;
+   bEOF = true;
+}
+
+/* legge un numero dal buffer; usa from_chars() direttamente sul buffer,
+ * oppure un istringstream se ci sono caratteri restituiti con putback()
+ * o se from_chars() non e' disponibile */
+template <class T>
+InputStream&
+InputStream::get_num(InputStream& in, T& t)
+{
+   ASSERT(in.pStrm == 0);
+
+   in.bFail = false;
+
+   char ch;
+   for (ch = in.get(); !in.eof() && isspace(ch); ch = in.get()) {
+      NO_OP;
+   }
+
+   if (in.eof()) {
+      in.bFail = true;
+      return in;
+   }
+
+   in.putback(ch);
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+   if (in.sPutBack.empty()) {
+      const char *p = in.pCur;
+
+      /* from_chars() non accetta il segno '+' */
+      if (*p == '+' && p + 1 < in.pEnd && p[1] != '-') {
+         p++;
+      }
+
+      std::from_chars_result r = std::from_chars(p, in.pEnd, t);
+      if (r.ec != std::errc()) {
+         in.bFail = true;
+         t = T(0);
+         if (r.ec == std::errc::result_out_of_range) {
+            in.pCur = r.ptr;
+         }
+         return in;
+      }
+
+      in.pCur = r.ptr;
+      return in;
+   }
+#endif /* __cpp_lib_to_chars */
+
+   std::string s;
+   for (ch = in.get(); !in.eof(); ch = in.get()) {
+      if (!isdigit(ch) && (ch == '\0' || std::strchr("+-.eExX", ch) == 0)) {
+         break;
+      }
+      s.push_back(ch);
+   }
+   in.putback(ch);
+
+   std::istringstream iss(s);
+   iss >> t;
+
+   std::string::size_type n = s.size();
+   if (iss.fail()) {
+      in.bFail = true;
+      t = T(0);
+      n = 0;
+
+   } else if (!iss.eof()) {
+      n = std::string::size_type(iss.tellg());
+   }
+
+   /* restituisce i caratteri non usati */
+   for (std::string::size_type i = s.size(); i > n; i--) {
+      in.putback(s[i - 1]);
+   }
+
    return in;
 }
 
+InputStream& operator >> (InputStream& in, int& i)
+{
+   if (in.pStrm) {
+      *in.pStrm >> i;
+      return in;
+   }
+   return InputStream::get_num(in, i);
+}
+
 InputStream& operator >> (InputStream& in, long int& i)
 {
-   in.iStrm >> i;
-   return in;
+   if (in.pStrm) {
+      *in.pStrm >> i;
+      return in;
+   }
+   return InputStream::get_num(in, i);
 }
 
 InputStream& operator >> (InputStream& in, short int& i)
 {
-   in.iStrm >> i;
-   return in;
+   if (in.pStrm) {
+      *in.pStrm >> i;
+      return in;
+   }
+   return InputStream::get_num(in, i);
 }
 
 InputStream& operator >> (InputStream& in, unsigned int& i)
 {
-   in.iStrm >> i;
-   return in;
+   if (in.pStrm) {
+      *in.pStrm >> i;
+      return in;
+   }
+   return InputStream::get_num(in, i);
 }
 
 InputStream& operator >> (InputStream& in, unsigned long int& i)
 {
-   in.iStrm >> i;
-   return in;
+   if (in.pStrm) {
+      *in.pStrm >> i;
+      return in;
+   }
+   return InputStream::get_num(in, i);
 }
 
 InputStream& operator >> (InputStream& in, unsigned short int& i)
 {
-   in.iStrm >> i;
-   return in;
+   if (in.pStrm) {
+      *in.pStrm >> i;
+      return in;
+   }
+   return InputStream::get_num(in, i);
 }
 
 InputStream& operator >> (InputStream& in, char& i)
 {
-   in.iStrm >> i;
+   if (in.pStrm) {
+      *in.pStrm >> i;
+      return in;
+   }
+
+   in.bFail = false;
+
+   char ch;
+   for (ch = in.get(); !in.eof() && isspace(ch); ch = in.get()) {
+      NO_OP;
+   }
+
+   if (in.eof()) {
+      in.bFail = true;
+
+   } else {
+      i = ch;
+   }
+
    return in;
 }
 
 InputStream& operator >> (InputStream& in, float& i)
 {
-   in.iStrm >> i;
-   return in;
+   if (in.pStrm) {
+      *in.pStrm >> i;
+      return in;
+   }
+   return InputStream::get_num(in, i);
 }
 
 InputStream& operator >> (InputStream& in, double& i)
 {
-   in.iStrm >> i;
-   return in;
+   if (in.pStrm) {
+      *in.pStrm >> i;
+      return in;
+   }
+   return InputStream::get_num(in, i);
 }
 
 #if 0
@@ -113,3 +299,99 @@ InputStream& operator >> (InputStream& in, long double& i)
 
 /* InputStream - end */
 
+
+/* MappedInputStream - begin */
+
+bool MappedInputStream::bEnabled = true;
+
+MappedInputStream::MappedInputStream(const char *sFileName)
+: InputStream(), pMap(0), uMapSize(0), bOpen(false)
+{
+   int flags = O_RDONLY;
+#ifdef O_BINARY
+   flags |= O_BINARY;
+#endif /* O_BINARY */
+
+   int fd = open(sFileName, flags);
+   if (fd == -1) {
+      return;
+   }
+
+   struct stat st;
+   if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+      close(fd);
+      return;
+   }
+
+   size_t size = size_t(st.st_size);
+
+#ifdef HAVE_SYS_MMAN_H
+   if (size > 0) {
+      void *p = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+         madvise(p, size, MADV_SEQUENTIAL);
+#endif /* MADV_SEQUENTIAL */
+         close(fd);
+
+         pMap = p;
+         uMapSize = size;
+         SetBuffer(static_cast<const char *>(p), size);
+         bOpen = true;
+         return;
+      }
+   }
+#endif /* HAVE_SYS_MMAN_H */
+
+   /* il file non puo' essere mappato: lo legge per intero */
+   Data.resize(size + 1);
+   size_t n = 0;
+   while (n < size) {
+      ssize_t r = read(fd, &Data[n], size - n);
+      if (r == -1 && errno == EINTR) {
+         continue;
+      }
+      if (r <= 0) {
+         break;
+      }
+      n += size_t(r);
+   }
+   close(fd);
+
+   if (n < size) {
+      Data.clear();
+      return;
+   }
+
+   SetBuffer(&Data[0], size);
+   bOpen = true;
+}
+
+MappedInputStream::~MappedInputStream(void)
+{
+#ifdef HAVE_SYS_MMAN_H
+   if (pMap != 0) {
+      munmap(pMap, uMapSize);
+   }
+#endif /* HAVE_SYS_MMAN_H */
+}
+
+bool
+MappedInputStream::IsOpen(void) const
+{
+   return bOpen;
+}
+
+void
+MappedInputStream::Enable(bool b)
+{
+   bEnabled = b;
+}
+
+bool
+MappedInputStream::bIsEnabled(void)
+{
+   return bEnabled;
+}
+
+/* MappedInputStream - end */
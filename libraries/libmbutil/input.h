@@ -35,9 +35,14 @@
 #define INPUT_H
 
 #include <iostream>
+#include <string>
+#include <vector>
 #include <myassert.h>
 
-/* Filtro per la classe istream che conta il numero di righe. */
+/* Filtro per la classe istream che conta il numero di righe.
+ * In alternativa all'istream, legge da un buffer in memoria
+ * (vedi MappedInputStream); in questo caso get() e putback()
+ * si riducono allo spostamento di un puntatore. */
 
 /* InputStream - begin */
 
@@ -53,32 +58,66 @@ class InputStream {
 	friend InputStream& operator >> (InputStream& in, double& i);
 
 private:
-	std::istream& iStrm;
-	unsigned long uLineNumber;      
-   
+	std::istream* pStrm;
+	unsigned long uLineNumber;
+
+	/* buffer in memoria: pStrm == 0 */
+	const char *pBuf;
+	const char *pCur;
+	const char *pEnd;
+	bool bEOF;
+	bool bFail;
+
+	/* caratteri restituiti con putback() diversi dagli ultimi letti */
+	std::string sPutBack;
+
+	inline char get_buf(void);
+	void putback_buf(char ch);
+
+	/* legge un numero dal buffer */
+	template <class T>
+	static InputStream& get_num(InputStream& in, T& t);
+
+protected:
+	/* Costruttore per le classi derivate; il buffer va assegnato
+	 * con SetBuffer() */
+	InputStream(void);
+
+	void SetBuffer(const char *p, size_t size);
+
 public:
 	/* Costruttore - inizializza il filtro con un reference ad un istream */
 	InputStream(std::istream& in);
-   
+
+	/* Costruttore - legge dal buffer p di lunghezza size,
+	 * che deve restare valido per tutta la vita dell'oggetto */
+	InputStream(const char *p, size_t size);
+
 	/* Distruttore banale */
-	~InputStream(void);
-   
+	virtual ~InputStream(void);
+
 	/* Legge un carattere; se e' un fine-riga, aggiorna il contatore */
 	inline char get(void);
-   
+
 	/* Legge un carattere; se e' un fine-riga, aggiorna il contatore */
-	inline std::istream& get(char& ch);
-   
+	inline InputStream& get(char& ch);
+
 	/* Esegue il putback di un carattere */
 	inline InputStream& putback(char ch);
-   
+
 	/* Restituisce il valore del contatore */
 	inline unsigned long int GetLineNumber(void) const;
-   
+
 	/* eof */
 	inline bool eof(void) const;
-   
-	/* Restituisce l'istream */
+
+	/* forza la condizione di fine file */
+	void SetEOF(void);
+
+	/* true se l'ultima lettura di un numero e' fallita */
+	inline bool fail(void) const;
+
+	/* Restituisce l'istream (non disponibile se legge da un buffer) */
 	inline const std::istream& GetStream(void) const;
 	inline std::istream& GetStream(void);
 };
@@ -94,33 +133,65 @@ extern InputStream& operator >> (InputStream& in, char& i);
 extern InputStream& operator >> (InputStream& in, float& i);
 extern InputStream& operator >> (InputStream& in, double& i);
 
+inline char
+InputStream::get_buf(void)
+{
+	if (!sPutBack.empty()) {
+		char ch = sPutBack.back();
+		sPutBack.pop_back();
+		return ch;
+	}
+
+	if (pCur == pEnd) {
+		bEOF = true;
+		return char(EOF);
+	}
+
+	return *pCur++;
+}
+
 /* Legge un carattere; se e' un fine-riga, aggiorna il contatore */
 inline char
 InputStream::get(void)
 {
-	char ch = iStrm.get();
+	char ch = pStrm ? char(pStrm->get()) : get_buf();
 	if (ch == '\n') {
 		uLineNumber++;
 	}
 	return ch;
 }
-   
+
 /* Legge un carattere; se e' un fine-riga, aggiorna il contatore */
-inline std::istream&
-InputStream::get(char& ch) 
+inline InputStream&
+InputStream::get(char& ch)
 {
-	std::istream& i = iStrm.get(ch);
+	if (pStrm) {
+		pStrm->get(ch);
+
+	} else {
+		ch = get_buf();
+	}
+
 	if (ch == '\n') {
 		uLineNumber++;
 	}
-	return i;
+	return *this;
 }
 
 /* Esegue il putback di un carattere */
 inline InputStream&
 InputStream::putback(char ch)
 {
-	iStrm.putback(ch);
+	if (pStrm) {
+		pStrm->putback(ch);
+
+	} else if (!bEOF && sPutBack.empty() && pCur > pBuf && pCur[-1] == ch) {
+		pCur--;
+
+	} else {
+		putback_buf(ch);
+	}
+
 	if (ch == '\n') {
 		uLineNumber--;
 	}
@@ -129,7 +200,7 @@ InputStream::putback(char ch)
 
 /* Restituisce il valore del contatore */
 inline unsigned long int
-InputStream::GetLineNumber(void) const 
+InputStream::GetLineNumber(void) const
 {
 	return uLineNumber;
 }
@@ -138,23 +209,59 @@ InputStream::GetLineNumber(void) const
 inline bool
 InputStream::eof(void) const
 {
-	return iStrm.eof();
+	return pStrm ? pStrm->eof() : bEOF;
+}
+
+inline bool
+InputStream::fail(void) const
+{
+	return pStrm ? pStrm->fail() : bFail;
 }
 
 /* Restituisce l'istream */
 inline const std::istream&
 InputStream::GetStream(void) const
 {
-	return iStrm;
+	ASSERT(pStrm != 0);
+	return *pStrm;
 }
 
 inline std::istream&
 InputStream::GetStream(void)
 {
-	return iStrm;
+	ASSERT(pStrm != 0);
+	return *pStrm;
 }
 
 /* InputStream - end */
 
-#endif /* INPUT_H */
 
+/* MappedInputStream - begin */
+
+/* Legge un file mappandolo in memoria (o, se non e' possibile,
+ * caricandolo per intero); da usare al posto di un ifstream
+ * per i file di ingresso di grandi dimensioni */
+class MappedInputStream : public InputStream {
+private:
+	static bool bEnabled;
+
+	void *pMap;
+	size_t uMapSize;
+	std::vector<char> Data;
+	bool bOpen;
+
+public:
+	MappedInputStream(const char *sFileName);
+	virtual ~MappedInputStream(void);
+
+	/* false se il file non puo' essere letto */
+	bool IsOpen(void) const;
+
+	/* abilita l'uso dei file mappati da parte del parser */
+	static void Enable(bool b);
+	static bool bIsEnabled(void);
+};
+
+/* MappedInputStream - end */
+
+#endif /* INPUT_H */
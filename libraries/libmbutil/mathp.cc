@@ -42,6 +42,7 @@
 #include <climits>
 #include <limits>
 #include <sstream>
+#include <charconv>
 
 #include "mathp.h"
 #include "parser.h"
@@ -1875,6 +1876,12 @@ Var::GetVal(void) const
 	return value;
 }
 
+const TypedValue *
+Var::pGetVal(void) const
+{
+	return &value;
+}
+
 void
 Var::SetVal(const bool& v)
 {
@@ -3147,13 +3154,22 @@ start_parsing:;
 			// force EOF because on some archs (e.g. arm) char is unsigned,
 			// thus putback won't restore EOF
 			in->putback(char(c));
-			in->GetStream().setstate(std::ios::eofbit);
+			in->SetEOF();
 		} else {
 			in->putback(char(c));
 		}
 		char *endptr = 0;
 		if (!f) {
 			value.SetType(TypedValue::VAR_INT);
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+			// fast path; errors are diagnosed below
+			Int iv;
+			std::from_chars_result r = std::from_chars(s, s + i, iv);
+			if (r.ec == std::errc() && r.ptr == s + i && (s[0] != '0' || i == 1)) {
+				value.Set(iv);
+				return (currtoken = NUM);
+			}
+#endif // __cpp_lib_to_chars
 #ifdef HAVE_STRTOL
 			errno = 0;
 			long l = strtol(s, &endptr, 10);
@@ -3199,6 +3215,15 @@ start_parsing:;
 			}
 		} else {
 			value.SetType(TypedValue::VAR_REAL);
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+			// fast path, locale independent; errors are diagnosed below
+			Real dv;
+			std::from_chars_result r = std::from_chars(s, s + i, dv);
+			if (r.ec == std::errc() && r.ptr == s + i && !(dv != 0. && std::abs(dv) < DBL_MIN)) {
+				value.Set(dv);
+				return (currtoken = NUM);
+			}
+#endif // __cpp_lib_to_chars
 #ifdef HAVE_STRTOD
 			errno = 0;
 			double d = strtod(s, &endptr);
@@ -4731,6 +4756,42 @@ MathParser::Get(const TypedValue& /* v */ )
 	return vv;
 }
 
+/* the most common argument is a plain number: it is returned
+ * without building and evaluating the expression */
+bool
+MathParser::GetPlainNumber(TypedValue& v)
+{
+	const Token t0 = currtoken;
+
+	if (t0 == MINUS) {
+		if (GetToken() != NUM) {
+			TokenPush(currtoken);
+			currtoken = MINUS;
+			return false;
+		}
+
+	} else if (t0 != NUM) {
+		return false;
+	}
+
+	const TypedValue num = value;
+	GetToken();
+	if (currtoken == STMTSEP || currtoken == ARGSEP) {
+		v = (t0 == MINUS) ? -num : num;
+		return true;
+	}
+
+	/* restore the tokens */
+	TokenPush(currtoken);
+	value = num;
+	if (t0 == MINUS) {
+		TokenPush(NUM);
+	}
+	currtoken = t0;
+
+	return false;
+}
+
 TypedValue
 MathParser::Get(const InputStream& strm, const TypedValue& v)
 {
@@ -4738,7 +4799,7 @@ MathParser::Get(const InputStream& strm, const TypedValue& v)
 	in = (InputStream*)&strm;
 	GetToken();
 	TypedValue vv = v;
-	if (currtoken != STMTSEP && currtoken != ARGSEP) {
+	if (currtoken != STMTSEP && currtoken != ARGSEP && !GetPlainNumber(vv)) {
 #ifndef DO_NOT_USE_EE
 		ExpressionElement *e = stmt();
 		vv = e->Eval();
@@ -54,6 +54,7 @@
 
 #include "mathtyp.h"
 #include "table.h"
+#include "hashmap.h"
 #include "input.h"
 
 #ifndef DO_NOT_USE_EE
@@ -204,7 +205,7 @@ public:
 	/* Static namespace */
 	class StaticNameSpace : public MathParser::NameSpace {
 	private:
-		typedef std::map<std::string, MathParser::MathFunc_t *> funcType;
+		typedef HashMap<std::string, MathParser::MathFunc_t *, strhash> funcType;
 		funcType func;
 		Table *m_pTable;
 
@@ -348,7 +349,7 @@ protected:
 	StaticNameSpace* defaultNameSpace;
 
 public:
-	typedef std::map<std::string, NameSpace *> NameSpaceMap;
+	typedef HashMap<std::string, NameSpace *, strhash> NameSpaceMap;
 	const NameSpaceMap& GetNameSpaceMap(void) const;
 
 protected:
@@ -385,6 +386,10 @@ protected:
 	/* lexer */
 	enum Token GetToken(void);
 
+	/* numero, eventualmente negativo, seguito da un separatore;
+	 * altrimenti rimette i token sulla stack */
+	bool GetPlainNumber(TypedValue& v);
+
 	void trim_arg(char *const s);
 
 	/*
@@ -190,6 +190,8 @@ public:
 	bool Const(void) const;
 	bool MayChange(void) const;
 	TypedValue GetVal(void) const;
+	// direct access, avoids copying the value
+	const TypedValue *pGetVal(void) const;
 
 	void SetVal(const bool& b);
 	void SetVal(const Int& v);
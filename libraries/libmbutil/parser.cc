@@ -36,7 +36,7 @@
 #include <cstring>
 #include <stdlib.h>
 #include <stack>
-#include <map>
+#include "hashmap.h"
 
 #include "mathtyp.h"
 #include "parser.h"
@@ -301,7 +301,7 @@ const char* KeyTable::pGetDescription(integer iIndex) const
 
 /* bag that contains functions to parse descriptions */
 
-typedef std::map<std::string, DescRead *, ltstrcase> DescFuncMapType;
+typedef HashMap<std::string, DescRead *, strcasehash, eqstrcase> DescFuncMapType;
 static DescFuncMapType DescFuncMap;
 
 struct DescWordSetType : public HighParser::WordSet {
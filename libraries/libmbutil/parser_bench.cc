@@ -0,0 +1,182 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Parse throughput of the input stream backends: a file of cards
+ * like those of large generated models (labels, coordinates,
+ * remarks, variables and function calls that stress the symbol
+ * tables) is included by a main file and parsed through
+ * std::ifstream and through the memory mapped input stream.
+ *
+ * usage: parser_bench [-n <cards>]
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "parsinc.h"
+#include "clock_time.h"
+
+struct BenchResult {
+	double dTime;
+	long iNumbers;
+	double dSum;
+	int iLine;
+};
+
+static BenchResult
+parse(MathParser& MP, const std::string& sMain, bool bMap)
+{
+	MappedInputStream::Enable(bMap);
+
+	std::ifstream in(sMain.c_str());
+	InputStream In(in);
+	IncludeParser HP(MP, In, sMain.c_str());
+
+	BenchResult r = { 0., 0, 0., 0 };
+
+	double t0 = mbdyn_clock_time();
+	try {
+		while (true) {
+			HP.GetDescription();
+			while (HP.IsArg()) {
+				r.dSum += HP.GetReal();
+				r.iNumbers++;
+			}
+			r.iLine = HP.GetLineNumber();
+		}
+
+	} catch (EndOfFile& e) {
+		NO_OP;
+	}
+	r.dTime = mbdyn_clock_time() - t0;
+
+	return r;
+}
+
+int
+main(int argc, char *argv[])
+{
+	long iCards = 200000;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+			iCards = atol(argv[++i]);
+
+		} else {
+			std::cerr << "usage: parser_bench [-n <cards>]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	char sDir[] = "/tmp/parser_benchXXXXXX";
+	if (mkdtemp(sDir) == 0) {
+		std::cerr << "unable to create a temporary directory" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::string sData = std::string(sDir) + "/data.dat";
+	const std::string sMain = std::string(sDir) + "/main.dat";
+
+	{
+		std::ofstream out(sData.c_str());
+		out << std::setprecision(16);
+		for (long i = 0; i < iCards; i++) {
+			if (i % 100 == 0) {
+				out << "# node block " << i/100 << std::endl
+					<< "/* position, orientation and velocity */" << std::endl
+					<< "set: real X_" << i/100 << " = " << double(i)/iCards << ";" << std::endl;
+			}
+			const double d = double(i)/iCards;
+			out << "node: " << i + 1 << ", "
+				<< d << ", " << -2.5*d << ", " << 1.e-3*i << ",\n"
+				<< "\t" << 1. << ", " << 0. << ", " << .5 << ",\n"
+				<< "\t" << d*d << ", " << 3e-7 << ", " << i % 7 << ",\n"
+				<< "\t" << "X_" << i/100 << "*pi, cos(X_" << i/100 << "), " << d << "*deg2rad;" << std::endl;
+		}
+	}
+
+	{
+		std::ofstream out(sMain.c_str());
+		out << "include: \"" << sData << "\";" << std::endl;
+	}
+
+	struct stat st;
+	stat(sData.c_str(), &st);
+	const double dMB = double(st.st_size)/(1024.*1024.);
+
+	Table T(true);
+	/* the variables are set again at each run */
+	MathParser MP(T, true);
+
+	/* keeps the descriptions (e.g. "include") registered
+	 * across the runs */
+	std::istringstream EmptyIn("");
+	InputStream EmptyStream(EmptyIn);
+	IncludeParser HPKeep(MP, EmptyStream);
+
+	/* discard the first run, that loads the file in the cache */
+	parse(MP, sMain, false);
+	BenchResult rs = parse(MP, sMain, false);
+	BenchResult rm = parse(MP, sMain, true);
+
+	int rc = EXIT_SUCCESS;
+	if (rs.iNumbers != rm.iNumbers || rs.dSum != rm.dSum || rs.iLine != rm.iLine) {
+		std::cerr << "results differ: "
+			<< rs.iNumbers << " vs. " << rm.iNumbers << " numbers, "
+			<< "sum " << rs.dSum << " vs. " << rm.dSum << ", "
+			<< "line " << rs.iLine << " vs. " << rm.iLine << std::endl;
+		rc = EXIT_FAILURE;
+	}
+
+	std::cout << std::setprecision(4)
+		<< dMB << " MB, " << rs.iNumbers << " numbers, " << rs.iLine << " lines" << std::endl
+		<< "ifstream: " << rs.dTime << " s, " << dMB/rs.dTime << " MB/s" << std::endl
+		<< "mmap:     " << rm.dTime << " s, " << dMB/rm.dTime << " MB/s" << std::endl
+		<< "speedup " << rs.dTime/rm.dTime << std::endl;
+
+	unlink(sData.c_str());
+	unlink(sMain.c_str());
+	rmdir(sDir);
+
+	return rc;
+}
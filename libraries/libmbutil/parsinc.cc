@@ -158,8 +158,8 @@ void IncludeParser::Close(void)
 	if (!myinput.empty()) {
 		pmi = myinput.top();
       		ASSERT(pmi != NULL);
-      		/* Nota: deve esserci solo l'ultimo file */
-      		ASSERT(pf != NULL);
+      		/* Nota: deve esserci solo l'ultimo file
+		 * (pf e' NULL se il file e' mappato in memoria) */
       		ASSERT(pIn != NULL);
 
 #ifdef USE_INCLUDE_PARSER
@@ -231,17 +231,19 @@ IncludeParser::fCheckStack(void)
       		ASSERT(pmi != NULL);
       		/* 
        		 * Nota: se la stack e' piena, allora sia pf che pIn
-		 * devono essere diversi da NULL; viceversa, se la stack
+		 * devono essere diversi da NULL (pf e' NULL se il file
+		 * e' mappato in memoria); viceversa, se la stack
 		 * e' vuota, pf deve essere NULL.
 		 */
-      		ASSERT(pf != NULL);
       		ASSERT(pIn != NULL);
 #ifdef USE_INCLUDE_PARSER
       		ASSERT(sCurrPath != NULL);
       		ASSERT(sCurrFile != NULL);
 #endif /* USE_INCLUDE_PARSER */
       
-      		SAFEDELETE(pf); 
+      		if (pf != NULL) {
+      			SAFEDELETE(pf);
+      		}
       		SAFEDELETE(pIn);
 #ifdef USE_INCLUDE_PARSER
       		DEBUGCOUT("Leaving directory <" << sCurrPath 
@@ -330,34 +332,48 @@ IncludeParser::Include_int()
    	pf = NULL;
    	pIn = NULL;
 
+	/* file mappato in memoria; in caso di errore usa l'ifstream */
+	if (MappedInputStream::bIsEnabled()) {
+		MappedInputStream *pMIn = NULL;
+		SAFENEWWITHCONSTRUCTOR(pMIn, MappedInputStream, MappedInputStream(sfname));
+		if (pMIn->IsOpen()) {
+			pIn = pMIn;
+
+		} else {
+			SAFEDELETE(pMIn);
+		}
+	}
+
+	if (pIn == NULL) {
 #ifdef _WIN32
-	// open the file in non translated mode in order not to break seek operations
-   	SAFENEWWITHCONSTRUCTOR(pf, std::ifstream, std::ifstream(sfname, std::ios::binary));
+		// open the file in non translated mode in order not to break seek operations
+		SAFENEWWITHCONSTRUCTOR(pf, std::ifstream, std::ifstream(sfname, std::ios::binary));
 #else
-   	SAFENEWWITHCONSTRUCTOR(pf, std::ifstream, std::ifstream(sfname));
+		SAFENEWWITHCONSTRUCTOR(pf, std::ifstream, std::ifstream(sfname));
 #endif
-   	if (!(*pf)) {
+		if (!(*pf)) {
 #ifdef DEBUG
-		char *buf = getcwd(NULL, 0);
-		if (buf != NULL) {
-			DEBUGCERR("Current directory \"" << buf << "\"" 
-					<< std::endl);
-			free(buf);
-		}
+			char *buf = getcwd(NULL, 0);
+			if (buf != NULL) {
+				DEBUGCERR("Current directory \"" << buf << "\"" 
+						<< std::endl);
+				free(buf);
+			}
 #endif /* DEBUG */
 
-		/* restore */
-		pf = pf_old;
-		pIn = pIn_old;
-		sCurrPath = sOldPath;
-		sCurrFile = sOldFile;
+			/* restore */
+			pf = pf_old;
+			pIn = pIn_old;
+			sCurrPath = sOldPath;
+			sCurrFile = sOldFile;
    
-		silent_cerr("Invalid file <" << sfname << "> "
-			"at line " << GetLineData() << std::endl);
-      		throw ErrFile(MBDYN_EXCEPT_ARGS);
-   	}
+			silent_cerr("Invalid file <" << sfname << "> "
+				"at line " << GetLineData() << std::endl);
+			throw ErrFile(MBDYN_EXCEPT_ARGS);
+		}
    
-   	SAFENEWWITHCONSTRUCTOR(pIn, InputStream, InputStream(*pf));
+		SAFENEWWITHCONSTRUCTOR(pIn, InputStream, InputStream(*pf));
+	}
 
    	/* Cambio di directory */
 #ifdef USE_INCLUDE_PARSER
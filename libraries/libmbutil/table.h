@@ -35,7 +35,8 @@
 #define TABLE_H
 
 #include <cstring>
-#include <map>
+
+#include "hashmap.h"
 
 #include "except.h"
 #include "mathtyp.h"
@@ -50,7 +51,7 @@ public:
 			: MBDynErrBase(MBDYN_EXCEPT_ARGS_PASSTHRU) {};
 	};
 
-	typedef std::map<std::string, NamedValue *> VM;
+	typedef HashMap<std::string, NamedValue *, strhash> VM;
 
 private:
 	VM vm;
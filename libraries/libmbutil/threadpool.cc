@@ -0,0 +1,398 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <signal.h>
+#include <atomic>
+
+#include "myassert.h"
+#include "except.h"
+#include "ac/sys_sysinfo.h"
+#include "task2cpu.h"
+#include "threadpool.h"
+
+unsigned ThreadPool::uMaxThreads = 0;
+bool ThreadPool::bCreated = false;
+thread_local bool ThreadPool::bInTask = false;
+thread_local unsigned ThreadPool::uSerialTasks = 0;
+
+void
+ThreadPool::SetMaxThreads(unsigned n)
+{
+	if (bCreated) {
+		silent_cerr("ThreadPool: number of threads cannot be changed "
+			"after the pool has been created" << std::endl);
+		return;
+	}
+
+	uMaxThreads = n;
+}
+
+unsigned
+ThreadPool::iGetMaxThreads(void)
+{
+#ifdef USE_MULTITHREAD
+	if (uMaxThreads == 0) {
+		int n = Task2CPU::GetGlobalState().iGetCount();
+		if (n <= 0) {
+			n = get_nprocs();
+		}
+
+		uMaxThreads = (n > 0) ? unsigned(n) : 1;
+	}
+
+	return uMaxThreads;
+#else /* ! USE_MULTITHREAD */
+	return 1;
+#endif /* ! USE_MULTITHREAD */
+}
+
+ThreadPool&
+ThreadPool::Get(void)
+{
+	static ThreadPool oPool(iGetMaxThreads());
+
+	return oPool;
+}
+
+ThreadPool::ThreadPool(unsigned nt)
+: nThreads(nt)
+#ifdef USE_MULTITHREAD
+,
+uGeneration(0),
+pTask(0),
+nTasks(0),
+nPending(0),
+bExit(false),
+nBarrier(0),
+uBarrierGeneration(0)
+#endif /* USE_MULTITHREAD */
+{
+	bCreated = true;
+
+#ifdef USE_MULTITHREAD
+	pthread_mutex_init(&run_mutex, NULL);
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&start_cond, NULL);
+	pthread_cond_init(&done_cond, NULL);
+	pthread_cond_init(&barrier_cond, NULL);
+
+	/* bind the threads to the CPUs only if there are enough */
+	const Task2CPU& oCPUSet = Task2CPU::GetGlobalState();
+	const bool bBind = (unsigned(oCPUSet.iGetCount()) >= nThreads);
+	int iCPUIndex = bBind ? oCPUSet.iGetFirstCPU() : -1;
+
+	SetAffinity(0, iCPUIndex);
+
+	Workers.resize(nThreads);
+	for (unsigned i = 1; i < nThreads; i++) {
+		if (bBind) {
+			iCPUIndex = oCPUSet.iGetNextCPU(iCPUIndex);
+		}
+
+		Workers[i].pPool = this;
+		Workers[i].iThread = i;
+		Workers[i].iCPUIndex = iCPUIndex;
+
+		if (pthread_create(&Workers[i].thread, NULL, Worker, &Workers[i]) != 0) {
+			silent_cerr("ThreadPool: pthread_create() failed "
+				"for thread " << i << " of " << nThreads
+				<< "; using " << i << " threads" << std::endl);
+			nThreads = i;
+			Workers.resize(nThreads);
+			break;
+		}
+	}
+
+	silent_cout("ThreadPool: " << nThreads << " threads" << std::endl);
+#endif /* USE_MULTITHREAD */
+}
+
+ThreadPool::~ThreadPool(void)
+{
+#ifdef USE_MULTITHREAD
+	pthread_mutex_lock(&mutex);
+	bExit = true;
+	pthread_cond_broadcast(&start_cond);
+	pthread_mutex_unlock(&mutex);
+
+	for (unsigned i = 1; i < nThreads; i++) {
+		pthread_join(Workers[i].thread, NULL);
+	}
+
+	pthread_cond_destroy(&barrier_cond);
+	pthread_cond_destroy(&done_cond);
+	pthread_cond_destroy(&start_cond);
+	pthread_mutex_destroy(&mutex);
+	pthread_mutex_destroy(&run_mutex);
+#endif /* USE_MULTITHREAD */
+}
+
+unsigned
+ThreadPool::iGetAvailThreads(void) const
+{
+	return bInTask ? 1 : nThreads;
+}
+
+void
+ThreadPool::Exec(const Task& f, unsigned iTask, unsigned nt)
+{
+	const bool bWasInTask = bInTask;
+
+	bInTask = true;
+	try {
+		f(iTask, nt);
+
+	} catch (...) {
+		bInTask = bWasInTask;
+		throw;
+	}
+	bInTask = bWasInTask;
+}
+
+void
+ThreadPool::Run(unsigned nt, const Task& f)
+{
+	if (nt == 0) {
+		return;
+	}
+
+	if (nt > iGetAvailThreads()) {
+		if (!bInTask) {
+			silent_cerr("ThreadPool: " << nt << " tasks requested, "
+				"only " << nThreads << " threads available" << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+
+		/* nested: the tasks must not synchronize */
+		const unsigned uPrev = uSerialTasks;
+		uSerialTasks = nt;
+		try {
+			for (unsigned i = 0; i < nt; i++) {
+				Exec(f, i, nt);
+			}
+
+		} catch (...) {
+			uSerialTasks = uPrev;
+			throw;
+		}
+		uSerialTasks = uPrev;
+
+		return;
+	}
+
+	if (nt == 1) {
+		Exec(f, 0, 1);
+		return;
+	}
+
+#ifdef USE_MULTITHREAD
+	pthread_mutex_lock(&run_mutex);
+
+	pthread_mutex_lock(&mutex);
+	pTask = &f;
+	nTasks = nt;
+	nPending = nt - 1;
+	nBarrier = 0;
+	except = std::exception_ptr();
+	uGeneration++;
+	pthread_cond_broadcast(&start_cond);
+	pthread_mutex_unlock(&mutex);
+
+	try {
+		Exec(f, 0, nt);
+
+	} catch (...) {
+		pthread_mutex_lock(&mutex);
+		if (!except) {
+			except = std::current_exception();
+		}
+		pthread_mutex_unlock(&mutex);
+	}
+
+	pthread_mutex_lock(&mutex);
+	while (nPending > 0) {
+		pthread_cond_wait(&done_cond, &mutex);
+	}
+	std::exception_ptr e = except;
+	except = std::exception_ptr();
+	pTask = 0;
+	nTasks = 0;
+	pthread_mutex_unlock(&mutex);
+
+	pthread_mutex_unlock(&run_mutex);
+
+	if (e) {
+		std::rethrow_exception(e);
+	}
+#endif /* USE_MULTITHREAD */
+}
+
+void
+ThreadPool::Barrier(void)
+{
+	ASSERT(bInTask);
+
+	if (uSerialTasks > 1) {
+		silent_cerr("ThreadPool: barrier within "
+			"sequentially executed tasks" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+#ifdef USE_MULTITHREAD
+	pthread_mutex_lock(&mutex);
+	if (nTasks > 1) {
+		const unsigned long uGen = uBarrierGeneration;
+
+		if (++nBarrier == nTasks) {
+			nBarrier = 0;
+			uBarrierGeneration++;
+			pthread_cond_broadcast(&barrier_cond);
+
+		} else {
+			while (uGen == uBarrierGeneration) {
+				pthread_cond_wait(&barrier_cond, &mutex);
+			}
+		}
+	}
+	pthread_mutex_unlock(&mutex);
+#endif /* USE_MULTITHREAD */
+}
+
+void
+ThreadPool::ParallelFor(unsigned n, const std::function<void (unsigned)>& f,
+	unsigned nMaxTasks)
+{
+	unsigned nt = iGetAvailThreads();
+	if (nMaxTasks > 0 && nMaxTasks < nt) {
+		nt = nMaxTasks;
+	}
+	if (nt > n) {
+		nt = n;
+	}
+
+	if (nt <= 1) {
+		for (unsigned i = 0; i < n; i++) {
+			f(i);
+		}
+		return;
+	}
+
+	std::atomic<unsigned> uNext(0);
+
+	Run(nt, [&uNext, n, &f](unsigned, unsigned) {
+		for (unsigned i = uNext++; i < n; i = uNext++) {
+			f(i);
+		}
+	});
+}
+
+#ifdef USE_MULTITHREAD
+void
+ThreadPool::SetAffinity(unsigned iThread, int iCPUIndex)
+{
+	if (iCPUIndex >= 0) {
+		Task2CPU oCPUSet;
+
+		pedantic_cerr("Setting affinity of thread " << iThread
+			<< " to CPU " << iCPUIndex << " ...\n");
+
+		oCPUSet.SetCPU(iCPUIndex);
+
+		if (!oCPUSet.bSetAffinity()) {
+			silent_cerr("Failed to set affinity of thread " << iThread
+				<< " to CPU " << iCPUIndex << "\n");
+		}
+	}
+}
+
+void *
+ThreadPool::Worker(void *arg)
+{
+	WorkerData *pWD = static_cast<WorkerData *>(arg);
+	ThreadPool *pPool = pWD->pPool;
+
+#ifdef HAVE_PTHREAD_SIGMASK
+	/* signals are dealt with by the main thread */
+	sigset_t newset;
+	sigemptyset(&newset);
+	sigaddset(&newset, SIGTERM);
+	sigaddset(&newset, SIGINT);
+	sigaddset(&newset, SIGHUP);
+	pthread_sigmask(SIG_BLOCK, &newset, NULL);
+#endif /* HAVE_PTHREAD_SIGMASK */
+
+	SetAffinity(pWD->iThread, pWD->iCPUIndex);
+
+	/* workers are created before the first Run() */
+	unsigned long uSeen = 0;
+
+	pthread_mutex_lock(&pPool->mutex);
+	while (true) {
+		while (uSeen == pPool->uGeneration && !pPool->bExit) {
+			pthread_cond_wait(&pPool->start_cond, &pPool->mutex);
+		}
+
+		if (pPool->bExit) {
+			break;
+		}
+
+		uSeen = pPool->uGeneration;
+		if (pWD->iThread >= pPool->nTasks) {
+			continue;
+		}
+
+		const Task *pTask = pPool->pTask;
+		const unsigned nt = pPool->nTasks;
+		pthread_mutex_unlock(&pPool->mutex);
+
+		std::exception_ptr e;
+		try {
+			pPool->Exec(*pTask, pWD->iThread, nt);
+
+		} catch (...) {
+			e = std::current_exception();
+		}
+
+		pthread_mutex_lock(&pPool->mutex);
+		if (e && !pPool->except) {
+			pPool->except = e;
+		}
+		if (--pPool->nPending == 0) {
+			pthread_cond_signal(&pPool->done_cond);
+		}
+	}
+	pthread_mutex_unlock(&pPool->mutex);
+
+	return NULL;
+}
+#endif /* USE_MULTITHREAD */
@@ -0,0 +1,141 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Process-wide pool of worker threads.
+ *
+ * The pool is created on first use with the number of threads set
+ * by SetMaxThreads() (the -N command line option), the calling thread
+ * included; the workers are bound to the CPUs of the global Task2CPU
+ * state when there are enough of them.  Multithreaded assembly,
+ * linear solvers and any other parallel section submit their work
+ * to the pool, so the CPU budget is shared rather than multiplied.
+ *
+ * Run() executes nTasks instances of a task, the calling thread
+ * being task 0, and returns when all of them completed.  Within
+ * a task, Barrier() synchronizes the tasks of the current Run().
+ * Calls to Run() from different threads are serialized; a Run()
+ * issued from within a task executes its tasks sequentially in the
+ * calling thread, so tasks that use Barrier() must be started
+ * with at most iGetAvailThreads() tasks.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <exception>
+#include <functional>
+#include <vector>
+
+#include "ac/pthread.h"
+
+class ThreadPool {
+public:
+	/* iTask is in [0, nTasks) */
+	typedef std::function<void (unsigned iTask, unsigned nTasks)> Task;
+
+	/* number of threads, including the calling one; 0 means
+	 * as many as the CPUs in the affinity set, or as the online CPUs.
+	 * Must be called before the pool is created */
+	static void SetMaxThreads(unsigned n);
+	static unsigned iGetMaxThreads(void);
+
+	/* the pool; created on first use */
+	static ThreadPool& Get(void);
+
+	/* threads available to a Run() issued now by the caller */
+	unsigned iGetAvailThreads(void) const;
+
+	/* executes f on nTasks threads; rethrows the first exception
+	 * thrown by any of the tasks after all of them completed */
+	void Run(unsigned nTasks, const Task& f);
+
+	/* to be called by all the tasks of the current Run() */
+	void Barrier(void);
+
+	/* calls f(i) for i in [0, n), distributing the items
+	 * dynamically over at most nMaxTasks tasks (0: all available) */
+	void ParallelFor(unsigned n, const std::function<void (unsigned)>& f,
+		unsigned nMaxTasks = 0);
+
+private:
+	ThreadPool(unsigned nt);
+	~ThreadPool(void);
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator = (const ThreadPool&) = delete;
+
+	static unsigned uMaxThreads;
+	static bool bCreated;
+
+	/* set while executing a task */
+	static thread_local bool bInTask;
+	/* set while executing the tasks of a nested Run() sequentially */
+	static thread_local unsigned uSerialTasks;
+
+	unsigned nThreads;
+
+	void Exec(const Task& f, unsigned iTask, unsigned nt);
+
+#ifdef USE_MULTITHREAD
+	struct WorkerData {
+		ThreadPool *pPool;
+		unsigned iThread;
+		int iCPUIndex;
+		pthread_t thread;
+	};
+	std::vector<WorkerData> Workers;
+
+	/* serializes Run() from different threads */
+	pthread_mutex_t run_mutex;
+
+	/* protects what follows */
+	pthread_mutex_t mutex;
+	pthread_cond_t start_cond;
+	pthread_cond_t done_cond;
+	pthread_cond_t barrier_cond;
+
+	unsigned long uGeneration;
+	const Task *pTask;
+	unsigned nTasks;
+	unsigned nPending;
+	bool bExit;
+	std::exception_ptr except;
+
+	unsigned nBarrier;
+	unsigned long uBarrierGeneration;
+
+	static void *Worker(void *arg);
+	static void SetAffinity(unsigned iThread, int iCPUIndex);
+#endif /* USE_MULTITHREAD */
+};
+
+#endif /* THREADPOOL_H */
@@ -37,6 +37,10 @@
 
 #ifdef USE_MULTITHREAD
 #include <signal.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
 #include "ac/spinlock.h"
 #endif /* USE_MULTITHREAD */
 
@@ -252,6 +256,250 @@ public:
 	};
 };
 
+/*
+ * Cost-aware chunked scheduling of an array shared by a group of threads.
+ *
+ * The array is split into contiguous chunks of approximately equal
+ * estimated cost; each thread claims the next chunk by atomically
+ * incrementing a single cursor, so a pass costs one atomic operation
+ * per chunk instead of one per item and per thread as in MT_VecIter.
+ *
+ * The cost of each item is measured by the MT_ChunkVecIter that visits it
+ * (wall time between consecutive bGetNext() calls), and Rebalance()
+ * recomputes the chunk boundaries from the smoothed measured costs;
+ * initial estimates can be provided by SetCost().
+ *
+ * Reset() and Rebalance() must be called by one thread only, while no
+ * iteration is in progress.
+ */
+class MT_ChunkSchedule {
+protected:
+	std::atomic<unsigned> iNextChunk;
+	unsigned iSize;
+	unsigned nChunks;
+	std::vector<unsigned> Chunks;
+	std::vector<double> dCost;
+	std::vector<double> dMeasured;
+	bool bMeasured;
+
+	/* number of chunks handed out to each thread, on average;
+	 * more chunks improve the balance of the tail of each pass */
+	static const unsigned iChunksPerThread = 4;
+
+	/* weight of the last measure in the cost estimate */
+	static constexpr double dAlpha = 0.5;
+
+public:
+	MT_ChunkSchedule(void)
+	: iNextChunk(0), iSize(0), nChunks(0), bMeasured(false)
+	{
+		NO_OP;
+	};
+
+	virtual ~MT_ChunkSchedule(void)
+	{
+		NO_OP;
+	};
+
+	void Init(unsigned i, unsigned nThreads)
+	{
+		ASSERT(i > 0);
+		ASSERT(nThreads > 0);
+
+		iSize = i;
+		nChunks = std::min(iSize, nThreads*iChunksPerThread);
+		Chunks.resize(nChunks + 1);
+		dCost.assign(iSize, 1.);
+		dMeasured.assign(iSize, 0.);
+		bMeasured = false;
+		iNextChunk = 0;
+
+		Partition();
+	};
+
+	/* initial estimate of the cost of item i (arbitrary units) */
+	void SetCost(unsigned i, double d)
+	{
+		ASSERT(i < iSize);
+		ASSERT(d >= 0.);
+
+		dCost[i] = d;
+	};
+
+	inline void SetMeasured(unsigned i, double d)
+	{
+		ASSERT(i < iSize);
+
+		dMeasured[i] = d;
+	};
+
+	/* NOTE: it must be called before each pass, and not concurrently */
+	inline void Reset(void)
+	{
+		iNextChunk.store(0, std::memory_order_relaxed);
+	};
+
+	/* claims the next chunk [iBegin, iEnd); false when none is left */
+	inline bool bGetChunk(unsigned& iBegin, unsigned& iEnd)
+	{
+		unsigned iChunk = iNextChunk.fetch_add(1, std::memory_order_relaxed);
+		if (iChunk >= nChunks) {
+			return false;
+		}
+
+		iBegin = Chunks[iChunk];
+		iEnd = Chunks[iChunk + 1];
+
+		return true;
+	};
+
+	/* NOTE: it must be called after a complete pass, and not concurrently */
+	void Rebalance(void)
+	{
+		if (!bMeasured) {
+			dCost = dMeasured;
+			bMeasured = true;
+
+		} else {
+			for (unsigned i = 0; i < iSize; i++) {
+				dCost[i] += dAlpha*(dMeasured[i] - dCost[i]);
+			}
+		}
+
+		Partition();
+	};
+
+protected:
+	void Partition(void)
+	{
+		double dTotal = 0.;
+		for (unsigned i = 0; i < iSize; i++) {
+			dTotal += dCost[i];
+		}
+
+		Chunks[0] = 0;
+		unsigned iChunk = 1;
+		double dAcc = 0.;
+		for (unsigned i = 0; i < iSize && iChunk < nChunks; i++) {
+			dAcc += dCost[i];
+
+			/* leave at least one item for each remaining chunk */
+			if (dAcc*nChunks >= dTotal*iChunk
+				|| iSize - (i + 1) == nChunks - iChunk)
+			{
+				Chunks[iChunk++] = i + 1;
+			}
+		}
+
+		ASSERT(iChunk == nChunks);
+		Chunks[nChunks] = iSize;
+	};
+};
+
+/*
+ * Iterator over the chunks of a MT_ChunkSchedule; each thread owns one.
+ */
+template<class T>
+class MT_ChunkVecIter : public VecIter<T> {
+protected:
+	MT_ChunkSchedule *pSchedule;
+	mutable T* pChunkEnd;
+	mutable std::chrono::steady_clock::time_point tStart;
+
+	inline bool bGetChunk(T& TReturn) const
+	{
+		unsigned iBegin, iEnd;
+
+		if (!pSchedule->bGetChunk(iBegin, iEnd)) {
+			VecIter<T>::pCount = VecIter<T>::pStart + VecIter<T>::iSize;
+			return false;
+		}
+
+		VecIter<T>::pCount = VecIter<T>::pStart + iBegin;
+		pChunkEnd = VecIter<T>::pStart + iEnd;
+		TReturn = *VecIter<T>::pCount;
+
+		return true;
+	};
+
+public:
+	MT_ChunkVecIter(void) : VecIter<T>(), pSchedule(0), pChunkEnd(0) { NO_OP; };
+
+	virtual ~MT_ChunkVecIter(void)
+	{
+		NO_OP;
+	};
+
+	void Init(const T* p, unsigned i, MT_ChunkSchedule *pS)
+	{
+		ASSERT(pS != 0);
+
+		VecIter<T>::Init(p, i);
+		pSchedule = pS;
+		pChunkEnd = VecIter<T>::pStart;
+	};
+
+	inline bool bGetFirst(T& TReturn) const
+	{
+		ASSERT(VecIter<T>::pStart != NULL);
+		ASSERT(VecIter<T>::iSize > 0);
+		ASSERT(pSchedule != 0);
+
+		if (!bGetChunk(TReturn)) {
+			return false;
+		}
+
+		tStart = std::chrono::steady_clock::now();
+
+		return true;
+	};
+
+	inline bool bGetCurr(T& TReturn) const
+	{
+		ASSERT(VecIter<T>::pStart != NULL);
+		ASSERT(VecIter<T>::iSize > 0);
+
+		if (VecIter<T>::pCount == VecIter<T>::pStart + VecIter<T>::iSize) {
+			return false;
+		}
+
+		TReturn = *VecIter<T>::pCount;
+
+		return true;
+	};
+
+	/* position of the current item in the vector */
+	inline unsigned iGetIndex(void) const
+	{
+		ASSERT(VecIter<T>::pCount >= VecIter<T>::pStart
+			&& VecIter<T>::pCount < pChunkEnd);
+
+		return VecIter<T>::pCount - VecIter<T>::pStart;
+	};
+
+	inline bool bGetNext(T& TReturn) const
+	{
+		ASSERT(VecIter<T>::pStart != NULL);
+		ASSERT(VecIter<T>::iSize > 0);
+		ASSERT(VecIter<T>::pCount >= VecIter<T>::pStart
+			&& VecIter<T>::pCount < pChunkEnd);
+
+		/* the item just visited is owned by this thread */
+		std::chrono::steady_clock::time_point tEnd = std::chrono::steady_clock::now();
+		pSchedule->SetMeasured(VecIter<T>::pCount - VecIter<T>::pStart,
+			std::chrono::duration<double>(tEnd - tStart).count());
+		tStart = tEnd;
+
+		++VecIter<T>::pCount;
+		if (VecIter<T>::pCount < pChunkEnd) {
+			TReturn = *VecIter<T>::pCount;
+			return true;
+		}
+
+		return bGetChunk(TReturn);
+	};
+};
+
 #endif /* USE_MULTITHREAD */
 
 #endif /* VECITER_H */
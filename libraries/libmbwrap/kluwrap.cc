@@ -441,6 +441,7 @@ KLUSparseSolutionManager<MatrixHandlerType>::pSolHdl(void) const
 }
 
 template class KLUSparseSolutionManager<SpMapMatrixHandler>;
+template class KLUSparseSolutionManager<SpCooMatrixHandler>;
 template class KLUSparseSolutionManager<SpGradientSparseMatrixHandler>;
 
 /* KLUSparseSolutionManager - end */
@@ -449,7 +450,7 @@ template <class CC>
 KLUSparseCCSolutionManager<CC>::KLUSparseCCSolutionManager(integer Dim,
 		doublereal dPivot,
 		const ScaleOpt& scale)
-     : KLUSparseSolutionManager<SpMapMatrixHandler>(Dim, dPivot, scale),
+     : KLUSparseSolutionManager<SpCooMatrixHandler>(Dim, dPivot, scale),
 CCReady(false),
 Ac(0)
 {
@@ -81,6 +81,7 @@ extern "C" {
 #include "ls.h"
 #include "solman.h"
 #include "spmapmh.h"
+#include "spcoomh.h"
 #include "ccmh.h"
 #include "dgeequ.h"
 #include "linsol.h"
@@ -195,7 +196,7 @@ public:
 /* KLUSparseCCSolutionManager - begin */
 
 template <class CC>
-class KLUSparseCCSolutionManager: public KLUSparseSolutionManager<SpMapMatrixHandler> {
+class KLUSparseCCSolutionManager: public KLUSparseSolutionManager<SpCooMatrixHandler> {
 protected:
 	bool CCReady;
 	CC *Ac;
@@ -0,0 +1,266 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Scaling benchmark of the naive sparse solver on multibody-like
+ * matrices: a chain of 6 dof nodes connected by two-node elements,
+ * with an additional element every 10 nodes closing a loop.
+ * The Jacobian is assembled, factored and solved twice, as in two
+ * Newton iterations; the timings of the second pass are reported.
+ *
+ * usage: naivebench [-c] [-t <threads>] [<NDof> ...]
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include "ac/getopt.h"
+
+#include "solman.h"
+#include "submat.h"
+#include "naivewrap.h"
+#include "parnaivewrap.h"
+#include "threadpool.h"
+
+static void
+usage(int rc)
+{
+	std::cerr << "usage: naivebench [-c] [-t <threads>] [<NDof> ...]" << std::endl
+		<< "\t-c\t\tuse colamd ordering" << std::endl
+		<< "\t-t <threads>\tnumber of threads" << std::endl;
+	exit(rc);
+}
+
+/* element stiffness between nodes n1 and n2 (0-based) */
+static void
+AssElem(MatrixHandler& MH, FullSubMatrixHandler& WM, integer n1, integer n2)
+{
+	WM.ResizeReset(12, 12);
+	for (integer i = 1; i <= 6; i++) {
+		WM.PutRowIndex(i, 6*n1 + i);
+		WM.PutColIndex(i, 6*n1 + i);
+		WM.PutRowIndex(6 + i, 6*n2 + i);
+		WM.PutColIndex(6 + i, 6*n2 + i);
+	}
+
+	for (integer r = 1; r <= 6; r++) {
+		for (integer c = 1; c <= 6; c++) {
+			doublereal d = (r == c) ? 1. : 1./(10. + r + 2*c);
+			WM.PutCoef(r, c, d);
+			WM.PutCoef(6 + r, 6 + c, d);
+			WM.PutCoef(r, 6 + c, -.5*d);
+			WM.PutCoef(6 + r, c, -.5*d);
+		}
+	}
+
+	MH += WM;
+}
+
+static void
+Assemble(SolutionManager *pSM, integer NNodes, MyVectorHandler& X)
+{
+	FullSubMatrixHandler WM(12, 12);
+	MatrixHandler& MH = *pSM->pMatHdl();
+
+	pSM->MatrReset();
+	for (integer n = 0; n < NNodes - 1; n++) {
+		AssElem(MH, WM, n, n + 1);
+		if (n % 10 == 0 && n + 5 < NNodes) {
+			AssElem(MH, WM, n, n + 5);
+		}
+	}
+
+	/* RHS such that the solution is X */
+	pSM->pResHdl()->Reset();
+	MH.MatVecMul(*pSM->pResHdl(), X);
+}
+
+int
+main(int argc, char *argv[])
+{
+	bool bColamd = false;
+	unsigned nThreads = 1;
+
+	while (true) {
+		int opt = getopt(argc, argv, "ct:");
+		if (opt == EOF) {
+			break;
+		}
+
+		switch (opt) {
+		case 'c':
+			bColamd = true;
+			break;
+
+		case 't':
+			nThreads = std::atoi(optarg);
+			if (nThreads < 1) {
+				usage(EXIT_FAILURE);
+			}
+			break;
+
+		default:
+			usage(EXIT_FAILURE);
+		}
+	}
+
+#ifndef USE_NAIVE_MULTITHREAD
+	if (nThreads > 1) {
+		std::cerr << "multithread naive solver support not compiled" << std::endl;
+		return EXIT_FAILURE;
+	}
+#endif /* ! USE_NAIVE_MULTITHREAD */
+
+	ThreadPool::SetMaxThreads(nThreads);
+
+	std::vector<integer> Sizes;
+	for (int i = optind; i < argc; i++) {
+		Sizes.push_back(std::atoi(argv[i]));
+	}
+
+	if (Sizes.empty()) {
+		const integer DefaultSizes[] = { 10000, 20000, 50000, 100000, 200000, 500000 };
+		Sizes.assign(std::begin(DefaultSizes), std::end(DefaultSizes));
+	}
+
+	std::cout << "# NDof, nonzeros (with fill-in), assembly [s], factor [s], solve [s],"
+		" max error, peak RSS [MB]" << std::endl;
+
+	typedef std::chrono::steady_clock Clock;
+	typedef std::chrono::duration<double> Seconds;
+
+	for (std::vector<integer>::const_iterator i = Sizes.begin(); i != Sizes.end(); ++i) {
+		const integer NNodes = *i/6;
+		if (NNodes < 2) {
+			std::cerr << "invalid number of dofs " << *i << std::endl;
+			return EXIT_FAILURE;
+		}
+		const integer NDof = 6*NNodes;
+
+		SolutionManager *pSM = 0;
+		if (bColamd) {
+#ifdef USE_NAIVE_MULTITHREAD
+			if (nThreads > 1) {
+				SAFENEWWITHCONSTRUCTOR(pSM,
+					ParNaiveSparsePermSolutionManager,
+					ParNaiveSparsePermSolutionManager(nThreads, NDof, 1.e-5));
+			} else
+#endif /* USE_NAIVE_MULTITHREAD */
+			{
+				SAFENEWWITHCONSTRUCTOR(pSM,
+					NaiveSparsePermSolutionManager<Colamd_ordering>,
+					NaiveSparsePermSolutionManager<Colamd_ordering>(NDof, 1.e-5));
+			}
+
+		} else {
+#ifdef USE_NAIVE_MULTITHREAD
+			if (nThreads > 1) {
+				SAFENEWWITHCONSTRUCTOR(pSM,
+					ParNaiveSparseSolutionManager,
+					ParNaiveSparseSolutionManager(nThreads, NDof, 1.e-5));
+			} else
+#endif /* USE_NAIVE_MULTITHREAD */
+			{
+				SAFENEWWITHCONSTRUCTOR(pSM,
+					NaiveSparseSolutionManager,
+					NaiveSparseSolutionManager(NDof, 1.e-5));
+			}
+		}
+
+		MyVectorHandler X(NDof);
+		for (integer r = 1; r <= NDof; r++) {
+			X(r) = 1. + doublereal(r % 7)/7.;
+		}
+
+		pSM->MatrInitialize();
+
+		/* first pass: computes the ordering, if any */
+		Assemble(pSM, NNodes, X);
+		pSM->Solve();
+
+		Clock::time_point t0 = Clock::now();
+		Assemble(pSM, NNodes, X);
+		Clock::time_point t1 = Clock::now();
+
+		MyVectorHandler B(NDof);
+		B = *pSM->pResHdl();
+
+		Clock::time_point t2 = Clock::now();
+		pSM->Solve();
+		Clock::time_point t3 = Clock::now();
+
+		/* the factors are stored in place of the matrix */
+		integer iNnz = 0;
+		pSM->pMatHdl()->EnumerateNz([&iNnz](integer, integer, doublereal) { iNnz++; });
+
+		/* solve only, reusing the factorization */
+		*pSM->pResHdl() = B;
+		Clock::time_point t4 = Clock::now();
+		pSM->Solve();
+		Clock::time_point t5 = Clock::now();
+
+		doublereal dErr = 0.;
+		for (integer r = 1; r <= NDof; r++) {
+			dErr = std::max(dErr, std::abs(pSM->pSolHdl()->operator()(r) - X(r)));
+		}
+
+		doublereal dSolve = Seconds(t5 - t4).count();
+
+		struct rusage ru;
+		getrusage(RUSAGE_SELF, &ru);
+
+		std::cout << std::setw(7) << NDof
+			<< " " << std::setw(9) << iNnz
+			<< " " << std::setw(10) << Seconds(t1 - t0).count()
+			<< " " << std::setw(10) << Seconds(t3 - t2).count() - dSolve
+			<< " " << std::setw(10) << dSolve
+			<< " " << std::setw(10) << dErr
+			<< " " << std::setw(8) << ru.ru_maxrss/1024
+			<< std::endl;
+
+		SAFEDELETE(pSM);
+
+		if (!(dErr <= 1e-6)) {
+			std::cerr << "solution error too large" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
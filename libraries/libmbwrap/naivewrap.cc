@@ -55,6 +55,8 @@ NaiveSolver::NaiveSolver(const integer &size, const doublereal& dMP,
 iSize(size),
 dMinPiv(dMP < 0 ? 0 : dMP),
 piv(size),
+todo(size),
+fwd(size),
 A(a)
 {
         NO_OP;
@@ -88,8 +90,8 @@ NaiveSolver::Solve(void) const
                 bHasBeenReset = false;
         }
 
-        integer rc = naivslv(A->ppdRows, iSize, A->piNzc, A->ppiCols,
-                        LinearSolver::pdRhs, LinearSolver::pdSol, &piv[0]);
+        integer rc = naivslv(A->pMat,
+                        LinearSolver::pdRhs, LinearSolver::pdSol, &piv[0], &fwd[0]);
         integer err = (rc & NAIVE_MASK);
         if (err) {
                 switch (err) {
@@ -115,13 +117,9 @@ void
 NaiveSolver::Factor(void)
 /*throw(LinearSolver::ErrFactor)*/
 {
-        integer rc = naivfct(A->ppdRows, iSize,
-                        A->piNzr, A->ppiRows,
-                        A->piNzc, A->ppiCols,
-                        A->ppnonzero,
-                        &piv[0], dMinPiv);
+        integer rc = naivfct(A->pMat, &piv[0], &todo[0], dMinPiv);
 
-        integer err = (rc & NAIVE_MASK);
+        unsigned err = (rc & NAIVE_MASK);
         if (err) {
                 integer idx = (rc & NAIVE_MAX);
                 switch (err) {
@@ -140,6 +138,11 @@ NaiveSolver::Factor(void)
                                 << std::endl);
                         break;
 
+                case NAIVE_ENOMEM:
+                        silent_cerr("NaiveSolver: ENOMEM while storing the fill-in"
+                                << std::endl);
+                        break;
+
                 default:
                         silent_cerr("NaiveSolver: (" << rc << ")"
                                 << std::endl);
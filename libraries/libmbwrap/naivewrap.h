@@ -54,6 +54,8 @@ private:
         integer iSize;
         doublereal dMinPiv;
         mutable std::vector<integer> piv;
+        std::vector<integer> todo;
+        mutable std::vector<doublereal> fwd;
         NaiveMatrixHandler *A;
 
         void Factor(void) /*throw(LinearSolver::ErrFactor)*/;
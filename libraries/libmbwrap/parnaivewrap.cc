@@ -47,18 +47,11 @@
 /* FIXME: incompatible with RTAI at present */
 #ifndef USE_RTAI
 
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <sys/ioctl.h>
-#include <cstdio>
-
-#include <unistd.h>
-#include <signal.h>
+#include <algorithm>
 
 #include "parnaivewrap.h"
 #include "mthrdslv.h"
-#include "task2cpu.h"
+#include "threadpool.h"
 
 #include "pmthrdslv.h"
 
@@ -71,27 +64,15 @@ ParNaiveSolver::ParNaiveSolver(unsigned nt, const integer &size,
 : LinearSolver(0),
 iSize(size),
 dMinPiv(dMP),
-ppril(0),
 pnril(0),
 A(a),
-nThreads(nt),
-thread_data(0)
+nThreads(nt)
 {
         piv.resize(iSize);
         fwd.resize(iSize);
         todo.resize(iSize);
         row_locks.resize(iSize + 2);
-        col_locks.resize(iSize, AO_TS_INITIALIZER);
-
-        pthread_mutex_init(&thread_mutex, NULL);
-        pthread_cond_init(&thread_cond, NULL);
 
-        SAFENEWARR(ppril, integer *, iSize);
-        ppril[0] = 0;
-        SAFENEWARR(ppril[0], integer, iSize*iSize);
-        for (integer i = 1; i < iSize; i++) {
-                ppril[i] = ppril[i - 1] + iSize;
-        }
         SAFENEWARR(pnril, integer, iSize);
 #ifdef HAVE_MEMSET_H
         memset(pnril, 0, sizeof(integer)*iSize);
@@ -101,222 +82,30 @@ thread_data(0)
         }
 #endif /* ! HAVE_MEMSET_H */
 
-
-        SAFENEWARRNOFILL(thread_data, thread_data_t, nThreads);
-
-        const Task2CPU& oCPUStateGlobal = Task2CPU::GetGlobalState();
-
-        if (static_cast<unsigned>(oCPUStateGlobal.iGetCount()) >= nThreads) {
-             int iCPUIdx = oCPUStateGlobal.iGetFirstCPU();
-
-             for (unsigned i = 0; i < nThreads; ++i) {
-                  thread_data[i].iCPUIndex = iCPUIdx;
-                  iCPUIdx = oCPUStateGlobal.iGetNextCPU(iCPUIdx);
-             }
-        } else {
-             for (unsigned i = 0; i < nThreads; ++i) {
-                  thread_data[i].iCPUIndex = -1;
-             }
-        }
-
-        SetAffinity(thread_data[0]);
-
-        for (unsigned t = 0; t < nThreads; t++) {
-                thread_data[t].pSLUS = this;
-                thread_data[t].threadNumber = t;
-                thread_data[t].retval = 0;
-
-                sem_init(&thread_data[t].sem, 0, 0);
-                if (pthread_create(&thread_data[t].thread, NULL, thread_op, &thread_data[t]) != 0) {
-                        silent_cerr("ParNaiveSolver: pthread_create() failed "
-                                        "for thread " << t
-                                        << " of " << nThreads << std::endl);
-                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-                }
+        /* the threads are those of the shared pool */
+        unsigned nMax = ThreadPool::iGetMaxThreads();
+        if (nThreads > nMax) {
+                silent_cerr("ParNaiveSolver: " << nThreads << " threads requested, "
+                                << nMax << " available; using " << nMax << std::endl);
+                nThreads = nMax;
         }
 }
 
 /* Distruttore */
 ParNaiveSolver::~ParNaiveSolver(void)
 {
-
-        thread_operation = ParNaiveSolver::EXIT;
-        thread_count = nThreads;
-
-        for (unsigned i = 0; i < nThreads; i++) {
-                sem_post(&thread_data[i].sem);
-        }
-
-        /* thread cleanup func? */
-
-        pthread_mutex_lock(&thread_mutex);
-        if (thread_count > 0) {
-                pthread_cond_wait(&thread_cond, &thread_mutex);
-        }
-        pthread_mutex_unlock(&thread_mutex);
-
-        for (unsigned i = 0; i < nThreads; ++i) {
-             pthread_join(thread_data[i].thread, nullptr);
-             
-             DEBUGCERR("thread[" << i << "] returned\n");
-        }
-
-        for (unsigned i = 1; i < nThreads; i++) {
-                sem_destroy(&thread_data[i].sem);
-        }
-
-        pthread_mutex_destroy(&thread_mutex);
-        pthread_cond_destroy(&thread_cond);
-
-        if (ppril) {
-                if (ppril[0]) {
-                        SAFEDELETEARR(ppril[0]);
-                }
-                SAFEDELETEARR(ppril);
-        }
         if (pnril) {
                 SAFEDELETEARR(pnril);
         }
-
-        /* other cleanup... */
-        SAFEDELETEARR(thread_data);
 }
 
-void *
-ParNaiveSolver::thread_op(void *arg)
+unsigned
+ParNaiveSolver::iGetNumTasks(void) const
 {
-        thread_data_t *td = (thread_data_t *)arg;
-
-        silent_cout("ParNaiveSolver: thread " << td->threadNumber
-                        << " [self=" << pthread_self()
-                        << ",pid=" << getpid() << "]"
-                        << " starting..." << std::endl);
-
-        /* deal with signals ... */
-        sigset_t newset /* , oldset */ ;
-        sigemptyset(&newset);
-        sigaddset(&newset, SIGTERM);
-        sigaddset(&newset, SIGINT);
-        sigaddset(&newset, SIGHUP);
-        pthread_sigmask(SIG_BLOCK, &newset, /* &oldset */ NULL);
-
-        SetAffinity(*td);
-
-        bool bKeepGoing(true);
-
-        while (bKeepGoing) {
-                sem_wait(&td->sem);
-
-                switch (td->pSLUS->thread_operation) {
-                case ParNaiveSolver::FACTOR:
-                        td->retval = pnaivfct(td->pSLUS->A->ppdRows,
-                                td->pSLUS->A->iSize,
-                                td->pSLUS->A->piNzr,
-                                td->pSLUS->A->ppiRows,
-                                td->pSLUS->A->piNzc,
-                                td->pSLUS->A->ppiCols,
-                                td->pSLUS->pnril,
-                                td->pSLUS->ppril,
-                                td->pSLUS->A->ppnonzero,
-                                &td->pSLUS->piv[0],
-                                &td->pSLUS->todo[0],
-                                td->pSLUS->dMinPiv,
-                                &td->pSLUS->row_locks[0],
-                                &td->pSLUS->col_locks[0],
-                                td->threadNumber,
-                                td->pSLUS->nThreads
-                        );
-
-                        if (td->retval) {
-                                if (td->retval & NAIVE_ENULCOL) {
-                                        silent_cerr("NaiveSolver: NAIVE_ENULCOL("
-                                                        << (td->retval & ~NAIVE_ENULCOL) << ")" << std::endl);
-                                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-                                }
-
-                                if (td->retval & NAIVE_ENOPIV) {
-                                        silent_cerr("NaiveSolver: NAIVE_ENOPIV("
-                                                        << (td->retval & ~NAIVE_ENOPIV) << ")" << std::endl);
-                                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-                                }
-
-                                /* default */
-                                throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-                        }
-                        break;
-
-                case ParNaiveSolver::SOLVE:
-                        pnaivslv(td->pSLUS->A->ppdRows,
-                                td->pSLUS->A->iSize,
-                                td->pSLUS->A->piNzc,
-                                td->pSLUS->A->ppiCols,
-                                td->pSLUS->LinearSolver::pdRhs,
-                                &td->pSLUS->piv[0],
-                                &td->pSLUS->fwd[0],
-                                td->pSLUS->LinearSolver::pdSol,
-                                &td->pSLUS->row_locks[0],
-                                td->threadNumber,
-                                td->pSLUS->nThreads
-                        );
-                        break;
-
-                case ParNaiveSolver::EXIT:
-                        bKeepGoing = false;
-                        break;
-
-                default:
-                        silent_cerr("ParNaiveSolver: unhandled op"
-                                        << std::endl);
-                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-                }
-
-                td->pSLUS->EndOfOp();
-        }
-
-        DEBUGCERR("ParNaiveSolver: thread " << td->threadNumber
-                  << " [self=" << pthread_self()
-                  << ",pid=" << getpid() << "]"
-                  << " terminating ..." << std::endl);
-        
-        pthread_exit(NULL);
-}
-
-void
-ParNaiveSolver::EndOfOp(void)
-{
-        bool last;
-
-        /* decrement the thread counter */
-        pthread_mutex_lock(&thread_mutex);
-        thread_count--;
-        last = (thread_count == 0);
-
-        /* if last thread, signal to restart */
-        if (last) {
-#if 0
-                pthread_cond_broadcast(&thread_cond);
-#else
-                pthread_cond_signal(&thread_cond);
-#endif
-        }
-        pthread_mutex_unlock(&thread_mutex);
-}
-
-void
-ParNaiveSolver::SetAffinity(const thread_data_t& oThreadData)
-{
-     if (oThreadData.iCPUIndex >= 0) {
-          Task2CPU oCPUSet;
-
-          pedantic_cerr("Setting affinity of thread " << oThreadData.threadNumber << " to CPU " << oThreadData.iCPUIndex << " ...\n");
-
-          oCPUSet.SetCPU(oThreadData.iCPUIndex);
-
-          if (!oCPUSet.bSetAffinity()) {
-               silent_cerr("Failed to set affinity of thread " << oThreadData.threadNumber
-                           << " to CPU " << oThreadData.iCPUIndex << "\n");
-          }
-     }
+        /* when called from within another parallel section
+         * (e.g. multiple factorizations in eigenanalysis)
+         * only the calling thread is available */
+        return std::min(nThreads, ThreadPool::Get().iGetAvailThreads());
 }
 
 #ifdef DEBUG
@@ -340,9 +129,6 @@ ParNaiveSolver::Factor(void)
 
         // ASSERT(iNonZeroes > 0);
 
-        thread_operation = ParNaiveSolver::FACTOR;
-        thread_count = nThreads;
-
         for (int i = 0; i < iSize; i++) {
                         piv[i] = -1;
                         todo[i] = -1;
@@ -355,20 +141,47 @@ ParNaiveSolver::Factor(void)
         row_locks[iSize] = 0;
         row_locks[iSize + 1] = 0;
 
-        /* NOTE: no need to reset col_locks because they're
-         * always left equal to zero after use */
+        const unsigned nt = iGetNumTasks();
+        std::vector<int> retval(nt, 0);
+
+        ThreadPool::Get().Run(nt, [this, &retval](unsigned iTask, unsigned nTasks) {
+                retval[iTask] = pnaivfct(A->pMat,
+                        &piv[0],
+                        &todo[0],
+                        pnril,
+                        dMinPiv,
+                        &row_locks[0],
+                        iTask,
+                        nTasks
+                );
+        });
+
+        for (unsigned t = 0; t < nt; t++) {
+                unsigned err = retval[t];
+                if (err == 0) {
+                        continue;
+                }
+
+                if (err & NAIVE_ENULCOL) {
+                        silent_cerr("NaiveSolver: NAIVE_ENULCOL("
+                                        << (err & ~NAIVE_ENULCOL) << ")" << std::endl);
+                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+                }
 
-        for (unsigned t = 0; t < nThreads; t++) {
-                thread_data[t].retval = 0;
-                sem_post(&thread_data[t].sem);
-        }
+                if (err & NAIVE_ENOPIV) {
+                        silent_cerr("NaiveSolver: NAIVE_ENOPIV("
+                                        << (err & ~NAIVE_ENOPIV) << ")" << std::endl);
+                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+                }
 
-        pthread_mutex_lock(&thread_mutex);
-        if (thread_count > 0) {
-                pthread_cond_wait(&thread_cond, &thread_mutex);
-        }
-        pthread_mutex_unlock(&thread_mutex);
+                if (err & NAIVE_ENOMEM) {
+                        silent_cerr("NaiveSolver: NAIVE_ENOMEM" << std::endl);
+                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+                }
 
+                /* default */
+                throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+        }
 }
 
 /* Risolve */
@@ -388,20 +201,17 @@ ParNaiveSolver::Solve(void) const
                 row_locks[i] = 0;
         }
 
-        thread_operation = ParNaiveSolver::SOLVE;
-        thread_count = nThreads;
-
-        for (unsigned t = 0; t < nThreads; t++) {
-                thread_data[t].retval = 0;
-                sem_post(&thread_data[t].sem);
-        }
-
-
-        pthread_mutex_lock(&thread_mutex);
-        if (thread_count > 0) {
-                pthread_cond_wait(&thread_cond, &thread_mutex);
-        }
-        pthread_mutex_unlock(&thread_mutex);
+        ThreadPool::Get().Run(iGetNumTasks(), [this](unsigned iTask, unsigned nTasks) {
+                pnaivslv(A->pMat,
+                        LinearSolver::pdRhs,
+                        &piv[0],
+                        &fwd[0],
+                        LinearSolver::pdSol,
+                        &row_locks[0],
+                        iTask,
+                        nTasks
+                );
+        });
 }
 
 void
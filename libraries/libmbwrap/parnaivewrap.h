@@ -50,7 +50,6 @@
 #include <atomic_ops.h>
 
 #include <iostream>
-#include "ac/pthread.h"
 #include <vector>
 
 #include "myassert.h"
@@ -78,46 +77,21 @@ private:
 
 	doublereal dMinPiv;
 	mutable std::vector<integer> piv;
-	integer **ppril;
 	integer *pnril;
 	mutable std::vector<doublereal> fwd;
 	std::vector<integer>	todo; 
 	mutable std::vector<AO_t> row_locks;
-	mutable std::vector<AO_TS_t> col_locks;
 
 	NaiveMatrixHandler *A;
 
 	unsigned nThreads;
 
-	enum Op {
-		FACTOR,
-		SOLVE,
-		EXIT
-	};
-
-	struct thread_data_t {
-		pthread_t		thread;
-		ParNaiveSolver		*pSLUS;
-		unsigned		threadNumber;
-                int                     iCPUIndex;
-		sem_t			sem;
-		int			retval;
-	} *thread_data;
-
-	mutable Op	thread_operation;
-	mutable unsigned thread_count;
-	mutable pthread_mutex_t	thread_mutex;
-	mutable pthread_cond_t	thread_cond;
-
-	/* Thread process */
-	static void *thread_op(void *arg);
+	/* number of tasks a factorization or solution can use now */
+	unsigned iGetNumTasks(void) const;
 
 	/* Fattorizza la matrice */
 	void Factor(void);
 
-	void EndOfOp(void);
-
-        static void SetAffinity(const thread_data_t& oThreadData);
 public:
 	/* Costruttore: si limita ad allocare la memoria */
 	ParNaiveSolver(unsigned nt, const integer &size, 
@@ -581,6 +581,7 @@ UmfpackSparseSolutionManager<SparseMatrixHandlerType>::pSolHdl(void) const
 }
 
 template class UmfpackSparseSolutionManager<SpMapMatrixHandler>;
+template class UmfpackSparseSolutionManager<SpCooMatrixHandler>;
 template class UmfpackSparseSolutionManager<SpGradientSparseMatrixHandler>;
 
 /* UmfpackSparseSolutionManager - end */
@@ -648,7 +649,7 @@ UmfpackSparseCCSolutionManager<CC>::MatrInitialize()
 		Ac = nullptr;
 	}
 
-        UmfpackSparseSolutionManager<SpMapMatrixHandler>::MatrInitialize();
+        UmfpackSparseSolutionManager<SpCooMatrixHandler>::MatrInitialize();
 }
 	
 /* Rende disponibile l'handler per la matrice */
@@ -81,6 +81,7 @@ extern "C" {
 #include "ls.h"
 #include "solman.h"
 #include "spmapmh.h"
+#include "spcoomh.h"
 #include "ccmh.h"
 #include "dgeequ.h"
 #include "sp_gradient_spmh.h"
@@ -218,7 +219,7 @@ public:
 /* UmfpackSparseCCSolutionManager - begin */
 
 template <class CC>
-class UmfpackSparseCCSolutionManager: public UmfpackSparseSolutionManager<SpMapMatrixHandler> {
+class UmfpackSparseCCSolutionManager: public UmfpackSparseSolutionManager<SpCooMatrixHandler> {
 protected:
 	bool CCReady;
 	CC *Ac;
@@ -714,6 +714,14 @@ Y12SparseCCSolutionManager<CC>::MatrInitialize(void)
 {
 	CCReady = false;
 
+	if (Ac) {
+		/* the compact form is rebuilt from scratch; a new handler
+		 * gets a new pattern id, which invalidates the scatter
+		 * plans of the elements (and the indices of DirCCol) */
+		SAFEDELETE(Ac);
+		Ac = 0;
+	}
+
 	MatrReset();
 }
 	
@@ -28,27 +28,6 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-/*
-neq:		is the matrix size;
-a:		is used to store matrix elements; a[row][col] is the element in row
-  		row and column col;
-nzr and nzc:	are vectors of size neq, used to count the nonzero elements of a particular row or
-		column, respectively;
-ri and ci:	are neq x neq matrices used to store nonzero element indices; ri[col][i]
-		(resp. ci[row][i]), with i < nzr[col] (i < nzc[row]), is the row (column)
-		index of one of the nzr[col] (nzc[row]) nonzero elements in
-		column col (row row); note that indices in ri[col] and ci[row] are
-		not ordered;
-nz:		nz[row][col] is true if the element in row row and column col is
-		nonzero, false otherwise;
-piv:		is a vector of size neq. 
-
-
-The subroutine naivfct perform the LU factorization, naivslv the back-solve.
-
-*/
-
-
 #ifdef HAVE_CONFIG_H
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
@@ -64,6 +43,7 @@ typedef double doublereal;
 #endif /* !HAVE_CONFIG_H */
 
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 #include "mthrdslv.h"
@@ -72,19 +52,223 @@ typedef double doublereal;
 
 #define MINPIV   1.0e-5
 
+/* initial size of rows and columns */
+#define MINSZ    4
+
+int
+naive_init(naive_mat *m, integer neq)
+{
+	memset(m, 0, sizeof(naive_mat));
+
+	if (neq <= 0 || (unsigned long)neq > NAIVE_MAX) {
+		return NAIVE_ERANGE;
+	}
+
+	m->neq = neq;
+	m->a = (doublereal **)calloc(neq, sizeof(doublereal *));
+	m->ci = (integer **)calloc(neq, sizeof(integer *));
+	m->nzc = (integer *)calloc(neq, sizeof(integer));
+	m->csz = (integer *)calloc(neq, sizeof(integer));
+	m->ht = (integer **)calloc(neq, sizeof(integer *));
+	m->ri = (integer **)calloc(neq, sizeof(integer *));
+	m->rs = (integer **)calloc(neq, sizeof(integer *));
+	m->nzr = (integer *)calloc(neq, sizeof(integer));
+	m->rsz = (integer *)calloc(neq, sizeof(integer));
+
+	if (m->a == 0 || m->ci == 0 || m->nzc == 0 || m->csz == 0
+		|| m->ht == 0 || m->ri == 0 || m->rs == 0 || m->nzr == 0
+		|| m->rsz == 0)
+	{
+		naive_destroy(m);
+		return NAIVE_ENOMEM;
+	}
+
+	return 0;
+}
+
+void
+naive_destroy(naive_mat *m)
+{
+	integer i;
+
+	for (i = 0; i < m->neq; i++) {
+		if (m->a) { free(m->a[i]); }
+		if (m->ci) { free(m->ci[i]); }
+		if (m->ht) { free(m->ht[i]); }
+		if (m->ri) { free(m->ri[i]); }
+		if (m->rs) { free(m->rs[i]); }
+	}
+
+	free(m->a);
+	free(m->ci);
+	free(m->nzc);
+	free(m->csz);
+	free(m->ht);
+	free(m->ri);
+	free(m->rs);
+	free(m->nzr);
+	free(m->rsz);
+
+	memset(m, 0, sizeof(naive_mat));
+}
+
+void
+naive_reset(naive_mat *m)
+{
+	integer i, k;
+
+	for (i = 0; i < m->neq; i++) {
+		if (m->nzc[i]) {
+			if (NAIVE_DENSE(m, m->csz[i])) {
+				for (k = 0; k < m->nzc[i]; k++) {
+					m->ht[i][m->ci[i][k]] = 0;
+				}
+
+			} else {
+				memset(m->ht[i], 0, 4*m->csz[i]*sizeof(integer));
+			}
+			m->nzc[i] = 0;
+		}
+		m->nzr[i] = 0;
+	}
+}
+
+static inline void
+naive_hash_insert(integer *pht, integer mask, integer c, integer k)
+{
+	integer h = NAIVE_HASH(c, mask);
+
+	while (pht[2*h] != 0) {
+		h = (h + 1) & mask;
+	}
+	pht[2*h] = c + 1;
+	pht[2*h + 1] = k;
+}
+
+static void
+naive_rehash(naive_mat *m, integer r)
+{
+	integer mask = 2*m->csz[r] - 1, k;
+	integer *pht = m->ht[r], *pci = m->ci[r];
+
+	if (NAIVE_DENSE(m, m->csz[r])) {
+		memset(pht, 0, m->neq*sizeof(integer));
+		for (k = 0; k < m->nzc[r]; k++) {
+			pht[pci[k]] = k + 1;
+		}
+		return;
+	}
+
+	memset(pht, 0, 4*m->csz[r]*sizeof(integer));
+	for (k = 0; k < m->nzc[r]; k++) {
+		naive_hash_insert(pht, mask, pci[k], k);
+	}
+}
+
+integer
+naive_row_insert(naive_mat *m, integer r, integer c)
+{
+	integer k = m->nzc[r];
+
+	if (k == m->csz[r]) {
+		integer sz = k ? 2*k : MINSZ;
+		doublereal *pa;
+		integer *pci, *pht;
+
+		pa = (doublereal *)realloc(m->a[r], sz*sizeof(doublereal));
+		if (pa == 0) {
+			return -1;
+		}
+		m->a[r] = pa;
+
+		pci = (integer *)realloc(m->ci[r], sz*sizeof(integer));
+		if (pci == 0) {
+			return -1;
+		}
+		m->ci[r] = pci;
+
+		/* a direct map never needs to grow */
+		if (k == 0 || !NAIVE_DENSE(m, k)) {
+			if (NAIVE_DENSE(m, sz)) {
+				pht = (integer *)realloc(m->ht[r], m->neq*sizeof(integer));
+
+			} else {
+				pht = (integer *)realloc(m->ht[r], 4*sz*sizeof(integer));
+			}
+			if (pht == 0) {
+				return -1;
+			}
+			m->ht[r] = pht;
+			m->csz[r] = sz;
+
+			naive_rehash(m, r);
+
+		} else {
+			m->csz[r] = sz;
+		}
+	}
+
+	m->ci[r][k] = c;
+	m->nzc[r]++;
+	if (NAIVE_DENSE(m, m->csz[r])) {
+		m->ht[r][c] = k + 1;
+
+	} else {
+		naive_hash_insert(m->ht[r], 2*m->csz[r] - 1, c, k);
+	}
+
+	return k;
+}
+
+int
+naive_col_insert(naive_mat *m, integer c, integer r, integer k)
+{
+	integer n = m->nzr[c];
+
+	if (n == m->rsz[c]) {
+		integer sz = n ? 2*n : MINSZ;
+		integer *pri, *prs;
+
+		pri = (integer *)realloc(m->ri[c], sz*sizeof(integer));
+		if (pri == 0) {
+			return -1;
+		}
+		m->ri[c] = pri;
+
+		prs = (integer *)realloc(m->rs[c], sz*sizeof(integer));
+		if (prs == 0) {
+			return -1;
+		}
+		m->rs[c] = prs;
+		m->rsz[c] = sz;
+	}
+
+	m->ri[c][n] = r;
+	m->rs[c][n] = k;
+	m->nzr[c]++;
+
+	return 0;
+}
+
+integer
+naive_insert(naive_mat *m, integer r, integer c)
+{
+	integer k = naive_row_insert(m, r, c);
+
+	if (k < 0 || naive_col_insert(m, c, r, k) != 0) {
+		return -1;
+	}
+
+	return k;
+}
+
 int
-naivfct(RMAT a, integer neq, integer *nzr, IMAT ri,
-		integer *nzc, IMAT ci, NZMAT nz, 
-		integer *piv, doublereal minpiv)
+naivfct(naive_mat *m, integer *piv, integer *todo, doublereal minpiv)
 {
-	char todo[neq];
-	integer i, j, k, pvr, pvc, nr, nc, r;
-	integer *pri, *pci;
-	char *prik;
+	integer neq = m->neq;
+	integer i, j, k, pvr, pvk, pvc, nr, nc, r, kr, dense;
+	integer *pri, *prs, *pci, *pht;
 	doublereal den, mul, mulpiv, fari;
-#if 0
-	doublereal fapvr;
-#endif
 	doublereal *par, *papvr;
 
 	if (neq <= 0 || (unsigned long)neq > NAIVE_MAX) {
@@ -98,36 +282,19 @@ naivfct(RMAT a, integer neq, integer *nzr, IMAT ri,
 		todo[pvr] = 1;
 	}
 	for (i = 0; i < neq; i++) {
-		if (!nzr[i]) { return NAIVE_ENULCOL + i; }
+		if (!m->nzr[i]) { return NAIVE_ENULCOL + i; }
 		nc = neq + 1;	
-		nr = nzr[i];
+		nr = m->nzr[i];
 		mul = 0.0;
-		pri = ri[i];
+		pri = m->ri[i];
+		prs = m->rs[i];
 		pvr = pri[0];
+		pvk = prs[0];
 		mulpiv = 0.;
-#if 0
-		fapvr = 0.;
- 		for (k = 0; k < nr; k++) {
- 			r = pri[k];
- 			if (todo[r]) {
- 				fari = fabs(a[r][i]);
- 				if (fari > mul) {
- 					mulpiv = fari*minpiv;
- 					if (nzc[r] <= nc  || mulpiv > fapvr) {
- 						nc = nzc[pvr = r];
- 						fapvr = fari;
- 					}
- 					mul = fari;
- 				} else if (nzc[r] < nc && fari > mulpiv) {
- 					nc = nzc[pvr = r];
- 				}
- 			}
- 		}
-#endif
 		for (k = 0; k < nr; k++) {
 			r = pri[k];
 			if (todo[r]) {
-				fari = fabs(a[r][i]);
+				fari = fabs(m->a[r][prs[k]]);
 				if (fari > mul) {
 					mul = fari;
 				}
@@ -137,9 +304,10 @@ naivfct(RMAT a, integer neq, integer *nzr, IMAT ri,
 		for (k = 0; k < nr; k++) {
 			r = pri[k];
 			if (todo[r]) {
-				fari = fabs(a[r][i]);
-				if (fari >= mulpiv && nzc[r] < nc) {
-					nc = nzc[pvr = r];
+				fari = fabs(m->a[r][prs[k]]);
+				if (fari >= mulpiv && m->nzc[r] < nc) {
+					nc = m->nzc[pvr = r];
+					pvk = prs[k];
 				}
 			}
 		}
@@ -148,24 +316,29 @@ naivfct(RMAT a, integer neq, integer *nzr, IMAT ri,
 
 		piv[i] = pvr;
 		todo[pvr] = 0;
-		papvr = a[pvr];
-		den = papvr[i] = 1.0/papvr[i];
+		papvr = m->a[pvr];
+		den = papvr[pvk] = 1.0/papvr[pvk];
+		pci = m->ci[pvr];
 
 		for (k = 0; k < nr; k++) {
 			if (!todo[r = pri[k]]) { continue; }
-			par = a[r];
-			mul = par[i] = par[i]*den;
-			prik = nz[r];
-			pci = ci[pvr];
+			par = m->a[r];
+			mul = par[prs[k]] = par[prs[k]]*den;
+			pht = m->ht[r];
+			dense = NAIVE_DENSE(m, m->csz[r]);
 			for (j = 0; j < nc; j++) {
 				if ((pvc = pci[j]) <= i) { continue; }
-				if (prik[pvc]) {
-					par[pvc] -= mul*papvr[pvc];
+				kr = dense ? pht[pvc] - 1 : naive_find(m, r, pvc);
+				if (kr >= 0) {
+					par[kr] -= mul*papvr[j];
 				} else {
-					par[pvc] = -mul*papvr[pvc];
-					prik[pvc] = 1;
-					ri[pvc][nzr[pvc]++] = r;
-					ci[r][nzc[r]++] = pvc;
+					if ((kr = naive_insert(m, r, pvc)) < 0) {
+						return NAIVE_ENOMEM;
+					}
+					par = m->a[r];
+					par[kr] = -mul*papvr[j];
+					pht = m->ht[r];
+					dense = NAIVE_DENSE(m, m->csz[r]);
 				}
 			}
 		}
@@ -187,15 +360,13 @@ naivfct(RMAT a, integer neq, integer *nzr, IMAT ri,
  * second step: P * U * x = P * f
  */
 int
-naivslv(RMAT a, integer neq, integer *nzc, IMAT ci, 
-		doublereal *rhs, doublereal * sol,
-		integer *piv)
+naivslv(const naive_mat *m, doublereal *rhs, doublereal *sol,
+		integer *piv, doublereal *fwd)
 {
-	doublereal fwd[neq];
-
+	integer neq = m->neq;
 	integer i, k, nc, r, c;
 	integer *pci;
-	doublereal s;
+	doublereal s, d;
 	doublereal *par;
 
 	if (neq <= 0 || (unsigned long)neq > NAIVE_MAX) {
@@ -204,33 +375,33 @@ naivslv(RMAT a, integer neq, integer *nzc, IMAT ci,
 
 	fwd[0] = rhs[piv[0]];
 	for (i = 1; i < neq; i++) {
-		nc = nzc[r = piv[i]];
+		nc = m->nzc[r = piv[i]];
 		s = rhs[r];
-		par = a[r];
-		pci = ci[r];
+		par = m->a[r];
+		pci = m->ci[r];
 		for (k = 0; k < nc; k++) {
 			if ((c = pci[k]) < i) {
-				s -= par[c]*fwd[c];
+				s -= par[k]*fwd[c];
 			}
 		}
 		fwd[i] = s;
 	}
 
-	r = piv[--neq];
-	sol[neq] = fwd[neq]*a[r][neq];
 	for (i = neq - 1; i >= 0; i--) {
-		nc = nzc[r = piv[i]];
+		nc = m->nzc[r = piv[i]];
 		s = fwd[i];
-		par = a[r];
-		pci = ci[r];
+		d = 0.;
+		par = m->a[r];
+		pci = m->ci[r];
 		for (k = 0; k < nc; k++) {
 			if ((c = pci[k]) > i) {
-				s -= par[c]*sol[c];
+				s -= par[k]*sol[c];
+			} else if (c == i) {
+				d = par[k];
 			}
 		}
-		sol[i] = s*par[i];
+		sol[i] = s*d;
 	}
 
 	return 0;
 }
-
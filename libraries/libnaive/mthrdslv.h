@@ -30,20 +30,32 @@
 
 
 /*
-neq:		is the matrix size;
-a:		is used to store matrix elements; a[row][col] is the element in row
-  		row and column col;
-nzr and nzc:	are vectors of size neq, used to count the nonzero elements of a particular row or
-		column, respectively;
-ri and ci:	are neq x neq matrices used to store nonzero element indices; ri[col][i]
-		(resp. ci[row][i]), with i < nzr[col] (i < nzc[row]), is the row (column)
-		index of one of the nzr[col] (nzc[row]) nonzero elements in
-		column col (row row); note that indices in ri[col] and ci[row] are
-		not ordered;
-nz:		nz[row][col] is true if the element in row row and column col is
-		nonzero, false otherwise;
-piv:		is a vector of size neq. 
+The matrix is stored in a naive_mat structure, which keeps the nonzero
+entries of each row in compressed form, and a compressed index of the
+nonzero entries of each column; memory is proportional to the number
+of nonzeros (including the fill-in generated by the factorization)
+rather than to neq^2.
 
+neq:		is the matrix size;
+a and ci:	a[row][k] and ci[row][k], with k < nzc[row], are the value and
+		the column index of the k-th nonzero element of row row;
+		indices in ci[row] are not ordered;
+csz and ht:	csz[row] is the allocated size of a[row] and ci[row] (a power
+		of 2, or 0); ht[row] is an open addressing hash table of
+		2*csz[row] slots that maps column indices to positions in row;
+		slot h holds col + 1 (0 means empty) in ht[row][2*h] and k
+		in ht[row][2*h + 1].  When csz[row] >= neq/16, ht[row] is
+		instead a direct map of size neq, with ht[row][col] == k + 1
+		(0 means empty);
+ri and rs:	ri[col][k] and rs[col][k], with k < nzr[col], are the row index
+		of the k-th nonzero element of column col and its position
+		in that row, i.e. ci[ri[col][k]][rs[col][k]] == col;
+rsz:		rsz[col] is the allocated size of ri[col] and rs[col];
+piv:		is a vector of size neq.
+
+Rows grow by doubling as entries are added, either during assembly
+or as fill-in during the factorization; naive_reset() empties the matrix
+while retaining the allocated storage.
 
 The subroutine naivfct perform the LU factorization, naivslv the back-solve.
 
@@ -75,16 +87,78 @@ enum {
 #define NAIVE_ERANGE	(0x40000000U)
 
 
-typedef integer** IMAT;
-typedef doublereal** RMAT;
-typedef char** NZMAT;
+#define NAIVE_ENOMEM	(0x80000000U)
+
+typedef struct naive_mat {
+	integer neq;
+
+	/* rows */
+	doublereal **a;
+	integer **ci;
+	integer *nzc;
+	integer *csz;
+	integer **ht;
+
+	/* columns */
+	integer **ri;
+	integer **rs;
+	integer *nzr;
+	integer *rsz;
+} naive_mat;
+
+extern int naive_init(naive_mat *m, integer neq);
+extern void naive_destroy(naive_mat *m);
+extern void naive_reset(naive_mat *m);
+
+#define NAIVE_HASH(c, mask)	((integer)(((unsigned)(c)*2654435761U) & (unsigned)(mask)))
+
+/* rows this large use a direct map of neq entries instead of the hash;
+ * it is faster, and it costs at most a few times the row itself */
+#define NAIVE_DENSE(m, sz)	((sz) >= (m)->neq/16)
+
+/* returns the position of column c in row r, or -1 */
+static inline integer
+naive_find(const naive_mat *m, integer r, integer c)
+{
+	integer mask, h;
+	const integer *pht;
+
+	if (m->csz[r] == 0) {
+		return -1;
+	}
+
+	pht = m->ht[r];
+	if (NAIVE_DENSE(m, m->csz[r])) {
+		return pht[c] - 1;
+	}
+
+	mask = 2*m->csz[r] - 1;
+	for (h = NAIVE_HASH(c, mask); pht[2*h] != 0; h = (h + 1) & mask) {
+		if (pht[2*h] == c + 1) {
+			return pht[2*h + 1];
+		}
+	}
+
+	return -1;
+}
+
+/* appends column c to row r (which must not contain it yet);
+ * returns its position, or -1 if memory is exhausted */
+extern integer naive_row_insert(naive_mat *m, integer r, integer c);
+
+/* appends row r to column c, where it is at position k */
+extern int naive_col_insert(naive_mat *m, integer c, integer r, integer k);
+
+/* appends the entry (r, c) to both indices; returns its position
+ * in row r, or -1 if memory is exhausted.  The value is undefined */
+extern integer naive_insert(naive_mat *m, integer r, integer c);
 
-extern int naivfct(RMAT a, integer neq, integer *nzr, IMAT ri,
-		integer *nzc, IMAT ci, NZMAT nz, 
-		integer *piv, doublereal minpiv);
+/* todo and fwd (neq) are workspace */
+extern int naivfct(naive_mat *m, integer *piv, integer *todo,
+		doublereal minpiv);
 
-extern int naivslv(RMAT a, integer neq, integer *nzc, IMAT ci,
-		doublereal *rhs, doublereal *sol, integer *piv);
+extern int naivslv(const naive_mat *m, doublereal *rhs, doublereal *sol,
+		integer *piv, doublereal *fwd);
 
 #ifdef __cplusplus
 }
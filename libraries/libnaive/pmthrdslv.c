@@ -54,64 +54,49 @@ typedef double  doublereal;
 
 #define MINPIV   (1.0e-5)
 
+/*
+ * rows are partitioned among tasks (r%ncpu == task), and each task
+ * appends the fill-in to the rows it owns; nril[k] records the size
+ * of row pri[k] before the update, so that after the barrier task 0
+ * can add the fill-in to the column indices in the same order
+ * the sequential naivfct() would
+ */
 int
-pnaivfct(doublereal** a,
-	integer neq,
-	integer *nzr, integer** ri,
-	integer *nzc, integer** ci,
-	integer* nril, integer **ril,
-	char** nz,
+pnaivfct(naive_mat *m,
 	integer *piv,
 	integer *todo,
+	integer *nril,
 	doublereal minpiv,
 	AO_t *row_locks,
-	volatile AO_TS_t *col_locks,
 	int task,
 	int ncpu)
 {
-	integer i, j, k, pvr = 0, pvc, nr, nc, r;
-	integer *pri, *pci;
-	char *pnzk;
+	integer neq = m->neq;
+	integer i, j, k, pvr = 0, pvk = 0, pvc, nr, nc, r, kr;
+	integer *pri, *prs, *pci;
 	doublereal den, mul, mulpiv, fari;
 	doublereal *par, *papvr;
+	int rc = 0;
 
 	if (minpiv == 0.) {
 		minpiv = MINPIV;
 	}
 
 	for (i = 0; i < neq; i++) {
-		pri = ri[i];
 		if (task == 0) {
-			doublereal fapvr;
-
-			nr = nzr[i];
+			nr = m->nzr[i];
 			if (nr == 0) {
-				return NAIVE_ENULCOL + i; 
+				rc = NAIVE_ENULCOL + i;
+				goto error;
 			}
+			pri = m->ri[i];
+			prs = m->rs[i];
 			nc = neq + 1;	
-			mul = mulpiv = fapvr = 0.0;
-/*
- * 			for (k = 0; k < nr; k++) {
- * 				r = pri[k];
- * 				if (todo[r]) {
- * 					fari = fabs(a[r][i]);
- * 					if (fari > mul) {
- * 						mulpiv = fari*minpiv;
- * 						if (nzc[r] <= m  || mulpiv > fapvr) {
- * 							m = nzc[pvr = r];
- * 							fapvr = fari;
- * 						}
- * 						mul = fari;
- * 					} else if (nzc[r] < m && fari > mulpiv) {
- * 						m = nzc[pvr = r];
- * 					}
- * 				}
- * 			}
- */
+			mul = mulpiv = 0.0;
 			for (k = 0; k < nr; k++) {
 				r = pri[k];
 				if (todo[r]) {
-					fari = fabs(a[r][i]);
+					fari = fabs(m->a[r][prs[k]]);
 					if (fari > mul) {
 						mul = fari;
 					}
@@ -121,66 +106,64 @@ pnaivfct(doublereal** a,
 			for (k = 0; k < nr; k++) {
 				r = pri[k];
 				if (todo[r]) {
-					fari = fabs(a[r][i]);
-					if (fari >= mulpiv && nzc[r] < nc) {
-						nc = nzc[pvr = r];
+					fari = fabs(m->a[r][prs[k]]);
+					if (fari >= mulpiv && m->nzc[r] < nc) {
+						nc = m->nzc[pvr = r];
+						pvk = prs[k];
 					}
 				}
 			}
-			if (nc == neq + 1) { return NAIVE_ENOPIV + i; }
-			if (mulpiv == 0.)  { return NAIVE_ENOPIV + i; }
+			if (nc == neq + 1 || mulpiv == 0.) {
+				rc = NAIVE_ENOPIV + i;
+				goto error;
+			}
 
 			todo[pvr] = 0;
-			papvr = a[pvr];
-			den = papvr[i] = 1.0/papvr[i];
+			papvr = m->a[pvr];
+			den = papvr[pvk] = 1.0/papvr[pvk];
 			AO_nop_full();
 
-			//set_wmb(piv[i], pvr);
 			piv[i] = pvr;
 
-
 		} else {
 			while ((pvr = AO_int_load_full((unsigned int *)&piv[i])) < 0);
-			papvr = a[pvr];
-			nr = nzr[i];
-			if (nr == 0) {
-				return NAIVE_ENULCOL + i; 
-			}			
-			den = papvr[i];
+			if (pvr == neq) {
+				/* task 0 failed */
+				return 0;
+			}
+			nr = m->nzr[i];
+			pri = m->ri[i];
+			prs = m->rs[i];
+			papvr = m->a[pvr];
+			den = papvr[naive_find(m, pvr, i)];
 		}
 
-		nc  = nzc[pvr];
-		pci = ci[pvr];
+		nc  = m->nzc[pvr];
+		pci = m->ci[pvr];
 		
 		for (k = 0; k < nr; k++) {
-		//for (k = task; k < nr; k += ncpu) {
 			r = pri[k];
 			if (todo[r] == 0 || r%ncpu != task) {
-			//if (todo[r] == 0) {
 				continue;
 			}
-			pnzk = nz[r];
-			par = a[r];
-			mul = par[i] = par[i]*den;
+			nril[k] = m->nzc[r];
+			par = m->a[r];
+			mul = par[prs[k]] = par[prs[k]]*den;
 			for (j = 0; j < nc; j++) {
 				pvc = pci[j];
 				if (pvc <= i) {
 					continue;
 				}
-				if (pnzk[pvc]) {
-					par[pvc] -= mul*papvr[pvc];
+				if ((kr = naive_find(m, r, pvc)) >= 0) {
+					par[kr] -= mul*papvr[j];
 				} else {
-					par[pvc] = -mul*papvr[pvc];
-					ci[r][nzc[r]++] = pvc;
-#if 0
-					while (atomic_inc_and_test((atomic_t *)&col_locks[pvc]));
-#endif
-					//while (mbdyn_cmpxchgl((int32_t *)&col_locks[pvc], 1, 0) != 0);
-					while (AO_test_and_set_full(&col_locks[pvc]) == AO_TS_CLEAR);
-					pnzk[pvc] = 1;
-					ril[k][nril[k]++] = pvc;
-					AO_CLEAR(&col_locks[pvc]);
-					//atomic_set((atomic_t *)&col_locks[pvc], 0); 
+					if ((kr = naive_row_insert(m, r, pvc)) < 0) {
+						/* detected by task 0 */
+						nril[k] = -1;
+						break;
+					}
+					par = m->a[r];
+					par[kr] = -mul*papvr[j];
 				}
 			}
 		}
@@ -191,23 +174,37 @@ pnaivfct(doublereal** a,
 		if (task == 0) {
 			for (k = 0; k < nr; k++) {
 				r = pri[k];
-				for (j = 0; j < nril[k]; j++) {
-					pvc = ril[k][j];
-					ri[pvc][nzr[pvc]++] = r;
+				if (todo[r] == 0) {
+					continue;
+				}
+				if (nril[k] < 0) {
+					rc = NAIVE_ENOMEM;
+					goto error;
+				}
+				for (kr = nril[k]; kr < m->nzc[r]; kr++) {
+					if (naive_col_insert(m, m->ci[r][kr], r, kr) != 0) {
+						rc = NAIVE_ENOMEM;
+						goto error;
+					}
 				}
-				nril[k] = 0;
 			}
 		}
 	}
 
 	return 0;
+
+error:;
+	/* let the other tasks terminate */
+	for (j = i; j < neq; j++) {
+		piv[j] = neq;
+	}
+	AO_nop_full();
+
+	return rc;
 }
 
 int
-pnaivslv(doublereal** a,
-		integer neq,
-		integer *nzc,
-		integer** ci, 
+pnaivslv(const naive_mat *m,
 		doublereal *rhs,
 		integer *piv, 
 		doublereal *fwd,
@@ -216,10 +213,10 @@ pnaivslv(doublereal** a,
 		int task,
 		int ncpu)
 {
-
+	integer neq = m->neq;
 	integer i, k, nc, r, c;
 	integer *pci;
-	doublereal s;
+	doublereal s, d;
 	doublereal *par;
 
 	if (!task) {
@@ -229,144 +226,50 @@ pnaivslv(doublereal** a,
 	}
 
 	for (i = 1; i < neq; i++) {
-#if 0
-	for (i = 1 + task; i < neq; i+=ncpu) {
-#endif
 		if (i%ncpu != task) { continue; }
-		//used[task + 2]++;
-		nc = nzc[r = piv[i]];
+		nc = m->nzc[r = piv[i]];
 		s = rhs[r];
-		par = a[r];
-		pci = ci[r];
+		par = m->a[r];
+		pci = m->ci[r];
 		for (k = 0; k < nc; k++) {
 			c = pci[k];
 			if (c < i) {
 				while (!AO_load_full(&locks[c]));
-				s -= par[c]*fwd[c];
+				s -= par[k]*fwd[c];
 			}
 		}
 		AO_nop_full();
 		fwd[i] = s;
 		AO_nop_full();
-#if 0
-		fwd[i] = s;
-#endif
 		AO_store_full(&locks[i], 1);
 	}
 
 	AO_fetch_and_add1_full(&locks[neq]);
 	while (AO_load_full(&locks[neq]) < ncpu);
 
-	neq--;
-	r = piv[neq];
-	if (!task) {
-		sol[neq] = fwd[neq]*a[r][neq];
-		AO_store_full(&locks[neq], 0);
-	}
 	for (i = neq - 1; i >= 0; i--) {
-#if 0
-	for (i = neq - 1 - task; i >= 0; i-=ncpu) {
-#endif
 		if (i%ncpu != task) { continue; }
-#if 0
-		used[task + 4]++;
-#endif
 		r = piv[i];
-		nc = nzc[r];
+		nc = m->nzc[r];
 		s = fwd[i];
-		par = a[r];
-		pci = ci[r];
+		d = 0.;
+		par = m->a[r];
+		pci = m->ci[r];
 		for (k = 0; k < nc; k++) {
 			if ((c = pci[k]) > i) {
 				while (AO_load_full(&locks[c]));
-				s -= par[c]*sol[c];
+				s -= par[k]*sol[c];
+			} else if (c == i) {
+				d = par[k];
 			}
 		}
 		AO_nop_full();
-		sol[i] = s*par[i];
+		sol[i] = s*d;
 		AO_nop_full();
-		
-#if 0
-		sol[i] = s*par[i];
-#endif
 		AO_store_full(&locks[i], 0);
 	}
 
 	return 0;
 }
 
-void
-naivesad(doublereal** a,
-	integer** ri,
-	integer *nzr,
-	integer** ci,
-	integer *nzc,
-	char ** nz,
-	integer neq,
-	integer *rowindx,
-	integer *colindx,
-	doublereal *elmat,
-	integer elr,
-	integer elc,
-	integer eldc)
-{
-	integer i, k, r, c, er;
-	doublereal *par;
-
-	er = 0;
-	for (i = 0; i < elr; i++) {
-		if ((r = rowindx[i]) >= 0) {
-			par = a[r];
-			for (k = 0; k < elc; k++) {
-				c = colindx[k];
-				if (!elmat[er + k] && c >= 0) {
-					if (nz[r][c]) {
-						par[c] += elmat[er + k];
-					} else {
-						par[c] = elmat[er + k];
-						nz[r][c] = 1;
-						ri[c][nzr[c]++] = r;
-						ci[r][nzc[r]++] = c;
-					}
-				}
-			}
-		}
-		er += eldc;
-	}
-}
-
-void
-naivepsad(doublereal** ga,
-	integer** gri,
-	integer *gnzr,
-	integer** gci,
-	integer *gnzc,
-	char ** nz,
-	doublereal** a,
-	integer** ci,
-	integer *nzc,
-	integer from,
-	integer to)
-{
-	integer i, r, c, nc;
-	doublereal *pgar, *par;
-
-	for (r = from; r <= to; r++) {
-		if ((nc = nzc[r])) {
-			pgar = ga[r];
-			par  = a[r];
-			for (i = 0; i < nc; i++) {
-				if (nz[r][c = ci[r][i]]) {
-					pgar[c] += par[c];
-				} else {
-					pgar[c] = par[c];
-					nz[r][c] = 1;
-					gri[c][gnzr[c]++] = r;
-					gci[r][gnzc[r]++] = c;
-				}
-			}
-		}
-	}
-}
-
 #endif /* USE_NAIVE_MULTITHREAD */
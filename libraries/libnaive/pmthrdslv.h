@@ -40,13 +40,12 @@
 extern "C" {
 #endif /* __cplusplus */
 
-extern int pnaivfct(RMAT a, integer neq, integer *nzr, IMAT ri,
-	integer *nzc, IMAT ci, integer* nril, IMAT ril, NZMAT nz,
-	integer *piv, integer *todo, doublereal minpiv,
-	AO_t *row_locks, volatile AO_TS_t *col_locks, int task, int ncpu);
+extern int pnaivfct(naive_mat *m, integer *piv, integer *todo,
+	integer *nril, doublereal minpiv,
+	AO_t *row_locks, int task, int ncpu);
 
-extern int pnaivslv(RMAT a, integer neq, integer *nzc, IMAT ci, 
-	doublereal *rhs, integer *piv, doublereal *fwd, doublereal *sol,
+extern int pnaivslv(const naive_mat *m, doublereal *rhs, integer *piv,
+	doublereal *fwd, doublereal *sol,
 	unsigned long *locks, int task, int ncpu);
 
 #ifdef __cplusplus
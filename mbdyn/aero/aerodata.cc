@@ -173,7 +173,7 @@ AeroMemory::GetNumPoints(void) const
 /* C81Data - begin */
 
 C81Data::C81Data(unsigned int uLabel)
-: WithLabel(uLabel)
+: WithLabel(uLabel), c81_data()
 {
 	NO_OP;
 }
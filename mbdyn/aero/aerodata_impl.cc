@@ -109,6 +109,35 @@ STAHRAeroData::GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6&
 
 #endif // USE_AEROD2_F
 
+/* C81AeroDataHolder - begin */
+
+/*
+ * senza modello instazionario le forze dipendono solo da W, per cui
+ * le 7 valutazioni delle differenze in avanti vengono fatte insieme
+ * da c81_aerod2_u_jac(), con gli stessi risultati di
+ * GetForcesJacForwardDiff_int()
+ */
+int
+C81AeroDataHolder::GetForcesJacC81_int(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA, const c81_data* d)
+{
+	if (unsteadyflag != AeroData::STEADY) {
+		return AeroData::GetForcesJacForwardDiff_int(i, W, TNG, J, OUTA);
+	}
+
+	doublereal JJ[6*6];
+	int rc = c81_aerod2_u_jac(W, &VAM, TNG, JJ, &OUTA, d);
+
+	for (unsigned c = 0; c < 6; c++) {
+		for (unsigned r = 0; r < 6; r++) {
+			J.Put(r + 1, c + 1, JJ[6*c + r]);
+		}
+	}
+
+	return rc;
+}
+
+/* C81AeroDataHolder - end */
+
 /* C81AeroData - begin */
 
 C81AeroData::C81AeroData(int i_p, int i_dim,
@@ -153,7 +182,7 @@ C81AeroData::GetForces(int i, const doublereal* W, doublereal* TNG, outa_t& OUTA
 int
 C81AeroData::GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA)
 {
-	return AeroData::GetForcesJacForwardDiff_int(i, W, TNG, J, OUTA);
+	return GetForcesJacC81_int(i, W, TNG, J, OUTA, data);
 }
 
 /* C81AeroData - end */
@@ -240,7 +269,7 @@ C81MultipleAeroData::GetForces(int i, const doublereal* W, doublereal* TNG, outa
 int
 C81MultipleAeroData::GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA)
 {
-	return AeroData::GetForcesJacForwardDiff_int(i, W, TNG, J, OUTA);
+	return GetForcesJacC81_int(i, W, TNG, J, OUTA, data[curr_data]);
 }
 
 /* C81MultipleAeroData - end */
@@ -354,7 +383,7 @@ C81InterpolatedAeroData::GetForces(int i, const doublereal* W, doublereal* TNG,
 int
 C81InterpolatedAeroData::GetForcesJac(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA)
 {
-	return AeroData::GetForcesJacForwardDiff_int(i, W, TNG, J, OUTA);
+	return GetForcesJacC81_int(i, W, TNG, J, OUTA, &i_data[i]);
 }
 
 /* C81InterpolatedAeroData - end */
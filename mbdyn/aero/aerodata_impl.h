@@ -58,6 +58,9 @@ public:
 /* C81AeroData - begin */
 
 class C81AeroDataHolder : public AeroData {
+protected:
+	int GetForcesJacC81_int(int i, const doublereal* W, doublereal* TNG, Mat6x6& J, outa_t& OUTA, const c81_data* d);
+
 public:
 	C81AeroDataHolder(int i_p, int i_dim,
 		AeroData::UnsteadyModel u, DriveCaller *ptime) : AeroData(i_p, i_dim, u, ptime) {};
@@ -72,7 +72,7 @@ C DM*W da' la velocita' nel punto a 3/4 della corda
 
 static int
 get_coef(int nm, doublereal* m, int na, doublereal* a,
-		doublereal alpha, doublereal mach,
+		const c81_index *idx, doublereal alpha, doublereal mach,
 		doublereal* c, doublereal* c0);
 
 static doublereal
@@ -91,11 +91,51 @@ c81_data_get_coef(int nm, doublereal* m, int na, doublereal* a, doublereal alpha
 {
 	doublereal c;
 	
-	get_coef(nm, m, na, a, alpha, mach, &c, NULL);
+	get_coef(nm, m, na, a, NULL, alpha, mach, &c, NULL);
 
 	return c;
 }
 
+/*
+ * valuta i coefficienti per n coppie (alpha, mach) dello stesso profilo;
+ * cl, cd e cm, se non NULL, devono avere dimensione n; cl0 e cd0,
+ * se non NULL, ricevono i coefficienti ad incidenza nulla e richiedono
+ * che sia richiesto anche cl, rispettivamente cd.
+ */
+int
+c81_data_get_coefs(const c81_data *data, int n,
+		const doublereal *alpha, const doublereal *mach,
+		doublereal *cl, doublereal *cd, doublereal *cm,
+		doublereal *cl0, doublereal *cd0)
+{
+	int i;
+
+	if (cl != NULL) {
+		for (i = 0; i < n; i++) {
+			get_coef(data->NML, data->ml, data->NAL, data->al,
+				&data->il, alpha[i], mach[i], &cl[i],
+				cl0 ? &cl0[i] : NULL);
+		}
+	}
+
+	if (cd != NULL) {
+		for (i = 0; i < n; i++) {
+			get_coef(data->NMD, data->md, data->NAD, data->ad,
+				&data->id, alpha[i], mach[i], &cd[i],
+				cd0 ? &cd0[i] : NULL);
+		}
+	}
+
+	if (cm != NULL) {
+		for (i = 0; i < n; i++) {
+			get_coef(data->NMM, data->mm, data->NAM, data->am,
+				&data->im, alpha[i], mach[i], &cm[i], NULL);
+		}
+	}
+
+	return 0;
+}
+
 int 
 c81_aerod2(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA, c81_data* data)
 {
@@ -181,11 +221,11 @@ c81_aerod2(doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA, c81_d
 	/*
 	 * Note: all angles in c81 files MUST be in degrees
 	 */
-	get_coef(data->NML, data->ml, data->NAL, data->al,
+	get_coef(data->NML, data->ml, data->NAL, data->al, &data->il,
 			OUTA->alpha, mach, &cl, &cl0);
-	get_coef(data->NMD, data->md, data->NAD, data->ad,
+	get_coef(data->NMD, data->md, data->NAD, data->ad, &data->id,
 			OUTA->alpha, mach, &cd, &cd0);
-	get_coef(data->NMM, data->mm, data->NAM, data->am,
+	get_coef(data->NMM, data->mm, data->NAM, data->am, &data->im,
 			OUTA->alpha, mach, &cm, NULL);
 
 	dcla = get_dcla(data->NML, data->ml, data->stall, mach);
@@ -339,11 +379,11 @@ c81_aerod2_u(const doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUT
 		/*
 		 * Note: all angles in c81 files MUST be in degrees
 		 */
-		get_coef(data->NML, data->ml, data->NAL, data->al, 
+		get_coef(data->NML, data->ml, data->NAL, data->al, &data->il, 
 				OUTA->alpha, mach, &cl, &cl0);
-		get_coef(data->NMD, data->md, data->NAD, data->ad, 
+		get_coef(data->NMD, data->md, data->NAD, data->ad, &data->id, 
 				OUTA->alpha, mach, &cd, &cd0);
-		get_coef(data->NMM, data->mm, data->NAM, data->am, 
+		get_coef(data->NMM, data->mm, data->NAM, data->am, &data->im, 
 				OUTA->alpha, mach, &cm, NULL);
 
 		dcla = get_dcla(data->NML, data->ml, data->stall, mach);
@@ -554,13 +594,13 @@ c81_aerod2_u(const doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUT
 		}
 
 		alphaN = (alpha - DAN)*RAD2DEG;
-		get_coef(data->NML, data->ml, data->NAL, data->al, 
+		get_coef(data->NML, data->ml, data->NAL, data->al, &data->il, 
 				alphaN, mach, &cl, &cl0);
-		get_coef(data->NMD, data->md, data->NAD, data->ad, 
+		get_coef(data->NMD, data->md, data->NAD, data->ad, &data->id, 
 				alphaN, mach, &cd, &cd0);
 
 		alphaM = (alpha - DAM)*RAD2DEG;
-		get_coef(data->NMM, data->mm, data->NAM, data->am, 
+		get_coef(data->NMM, data->mm, data->NAM, data->am, &data->im, 
 				alphaM, mach, &cm, NULL);
 
 		dcla = get_dcla(data->NML, data->ml, data->stall, mach);
@@ -625,6 +665,196 @@ c81_aerod2_u(const doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUT
 	return 0;
 }
 
+/*
+ * come c81_aerod2_u() senza modello instazionario, ma per n punti dello
+ * stesso profilo e nelle stesse condizioni (VAM); W e TNG hanno dimensione
+ * 6*n, OUTA dimensione n.  I coefficienti vengono letti dalle tabelle
+ * un blocco di punti alla volta con c81_data_get_coefs(), cosi' che
+ * la ricerca nelle tabelle scorra gli stessi dati per tutti i punti;
+ * l'aritmetica e' la stessa di c81_aerod2_u(), per cui i risultati
+ * coincidono bit a bit.
+ */
+int
+c81_aerod2_u_n(int n, const doublereal* W, const vam_t *VAM,
+		doublereal* TNG, outa_t* OUTA, const c81_data* data)
+{
+	enum { BLOCK = 16 };
+	enum { V_X = 0, V_Y = 1, V_Z = 2, W_X = 3, W_Y = 4, W_Z = 5 };
+
+	doublereal rho = VAM->density;
+	doublereal cs = VAM->sound_celerity;
+	doublereal chord = VAM->chord;
+	doublereal ca = VAM->force_position;
+	doublereal c34 = VAM->bc_position;
+
+	const doublereal RAD2DEG = 180.*M_1_PI;
+	const doublereal M_PI_3 = M_PI/3.;
+
+	int i0;
+
+	for (i0 = 0; i0 < n; i0 += BLOCK) {
+		doublereal v[BLOCK][3];
+		doublereal vp[BLOCK], vp2[BLOCK];
+		doublereal alpha[BLOCK], cosgam[BLOCK];
+		doublereal adeg[BLOCK], mach[BLOCK];
+		doublereal cl[BLOCK], cl0[BLOCK], cd[BLOCK], cd0[BLOCK], cm[BLOCK];
+		int idx[BLOCK];
+		int nb = n - i0 < BLOCK ? n - i0 : BLOCK;
+		int na = 0;
+		int i, k;
+
+		/* cinematica; i punti a velocita' trascurabile escono subito */
+		for (i = 0; i < nb; i++) {
+			const doublereal *w = &W[6*(i0 + i)];
+			doublereal *tng = &TNG[6*(i0 + i)];
+			outa_t *outa = &OUTA[i0 + i];
+			doublereal vtot, gamma, m;
+
+			v[na][V_X] = w[V_X];
+			v[na][V_Y] = w[V_Y] + c34*w[W_Z];
+			v[na][V_Z] = w[V_Z] - c34*w[W_Y];
+
+			vp2[na] = v[na][V_X]*v[na][V_X] + v[na][V_Y]*v[na][V_Y];
+			vp[na] = sqrt(vp2[na]);
+
+			vtot = sqrt(vp2[na] + v[na][V_Z]*v[na][V_Z]);
+
+			if (vp[na]/cs < 1.e-6) {
+				tng[V_X] = 0.;
+				tng[V_Y] = 0.;
+				tng[V_Z] = 0.;
+				tng[W_X] = 0.;
+				tng[W_Y] = 0.;
+				tng[W_Z] = 0.;
+
+				outa->alpha = 0.;
+				outa->gamma = 0.;
+				outa->mach = 0.;
+				outa->cl = 0.;
+				outa->cd = 0.;
+				outa->cm = 0.;
+				outa->clalpha = 0.;
+
+				continue;
+			}
+
+			alpha[na] = atan2(-v[na][V_Y], v[na][V_X]);
+			outa->alpha = alpha[na]*RAD2DEG;
+			gamma = atan2(-v[na][V_Z], fabs(v[na][V_X]));
+			outa->gamma = gamma*RAD2DEG;
+
+			if (fabs(gamma) > M_PI_3) {
+				gamma = M_PI_3;
+			}
+
+			cosgam[na] = cos(gamma);
+			m = (vtot*sqrt(cosgam[na]))/cs;
+			outa->mach = m;
+
+			if (m > .99) {
+				m = .99;
+			}
+
+			adeg[na] = outa->alpha;
+			mach[na] = m;
+			idx[na] = i;
+			na++;
+		}
+
+		if (na == 0) {
+			continue;
+		}
+
+		/* coefficienti dalle tabelle */
+		c81_data_get_coefs(data, na, adeg, mach, cl, cd, cm, cl0, cd0);
+
+		/* correzione per freccia e forze, come in c81_aerod2_u() */
+		for (k = 0; k < na; k++) {
+			doublereal *tng = &TNG[6*(i0 + idx[k])];
+			outa_t *outa = &OUTA[i0 + idx[k]];
+			doublereal dcla, q;
+
+			dcla = get_dcla(data->NML, data->ml, data->stall, mach[k]);
+			dcla *= RAD2DEG;
+			if (fabs(alpha[k]) > 1.e-6) {
+				doublereal dclatmp = (cl[k] - cl0[k])/(alpha[k]*cosgam[k]);
+				if (dclatmp < dcla) {
+					dcla = dclatmp;
+					cl[k] = cl0[k] + dcla*alpha[k];
+				}
+			}
+
+			outa->cl = cl[k];
+			outa->cd = cd[k];
+			outa->cm = cm[k];
+			outa->clalpha = dcla;
+
+			q = .5*rho*chord*vp2[k];
+
+			tng[V_X] = -q*(cl[k]*v[k][V_Y] + cd[k]*v[k][V_X])/vp[k];
+			tng[V_Y] = q*(cl[k]*v[k][V_X] - cd[k]*v[k][V_Y])/vp[k];
+			tng[V_Z] = -q*cd0[k]*v[k][V_Z]/vp[k];
+			tng[W_X] = 0.;
+			tng[W_Y] = -ca*tng[V_Z];
+			tng[W_Z] = q*chord*cm[k] + ca*tng[V_Y];
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * jacobiano per differenze in avanti delle forze di c81_aerod2_u() senza
+ * modello instazionario: il punto nominale e le 6 perturbazioni vengono
+ * valutati insieme da c81_aerod2_u_n(); perturbazioni ed operazioni sono
+ * quelle di AeroData::GetForcesJacForwardDiff_int(), compreso OUTA, che
+ * contiene l'ultima valutazione perturbata.  J e' 6x6, per colonne.
+ */
+int
+c81_aerod2_u_jac(const doublereal* W, const vam_t *VAM, doublereal* TNG,
+		doublereal* J, outa_t* OUTA, const c81_data* data)
+{
+	const doublereal epsilon = 1.e-3;
+	const doublereal nu = 1.e-9;
+
+	doublereal dv = sqrt(W[0]*W[0] + W[1]*W[1] + W[2]*W[2]);
+	doublereal dw = sqrt(W[3]*W[3] + W[4]*W[4] + W[5]*W[5]);
+
+	doublereal WW[7*6];
+	doublereal TT[7*6];
+	doublereal delta[6];
+	outa_t oo[7];
+	int k, r, c, rc;
+
+	for (k = 0; k < 7; k++) {
+		for (r = 0; r < 6; r++) {
+			WW[6*k + r] = W[r];
+		}
+		oo[k] = *OUTA;
+	}
+
+	for (c = 0; c < 6; c++) {
+		delta[c] = (c < 3 ? dv : dw)*epsilon + nu;
+		WW[6*(c + 1) + c] = W[c] + delta[c];
+	}
+
+	rc = c81_aerod2_u_n(7, WW, VAM, TT, oo, data);
+
+	for (r = 0; r < 6; r++) {
+		TNG[r] = TT[r];
+	}
+
+	for (c = 0; c < 6; c++) {
+		for (r = 0; r < 6; r++) {
+			J[6*c + r] = (TT[6*(c + 1) + r] - TNG[r])/delta[c];
+		}
+	}
+
+	*OUTA = oo[6];
+
+	return rc;
+}
+
 /*
  * trova un coefficiente dato l'angolo ed il numero di Mach
  *
@@ -635,7 +865,39 @@ c81_aerod2_u(const doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUT
  * mach e alpha viene restituito.
  */
 static int
-get_coef(int nm, doublereal* m, int na, doublereal* a, doublereal alpha, doublereal mach,
+find_alpha(int na, doublereal* a, const c81_index *idx, doublereal alpha)
+{
+	int ia, k;
+
+	/* fuori dalla tabella (o NaN) si usa bisec() */
+	if (idx == NULL || idx->b == NULL || !(alpha >= a[0] && alpha <= a[na - 1])) {
+		return bisec_d(a, alpha, 0, na - 1);
+	}
+
+	k = (int)((alpha - a[0])*idx->dbi);
+	if (k >= idx->nb) {
+		k = idx->nb - 1;
+	}
+
+	/*
+	 * b[k] puo' differire di uno per effetto dell'arrotondamento
+	 * dell'estremo dell'intervallo; si corregge in entrambe le direzioni
+	 * in modo da restituire esattamente cio' che restituirebbe bisec()
+	 */
+	ia = idx->b[k];
+	while (ia > 0 && a[ia] > alpha) {
+		ia--;
+	}
+	while (ia < na - 2 && a[ia + 1] <= alpha) {
+		ia++;
+	}
+
+	return ia;
+}
+
+static int
+get_coef(int nm, doublereal* m, int na, doublereal* a, const c81_index *idx,
+		doublereal alpha, doublereal mach,
 		doublereal* c, doublereal* c0)
 {
    	int im;
@@ -662,10 +924,15 @@ get_coef(int nm, doublereal* m, int na, doublereal* a, doublereal alpha, doubler
 	 * l'approssimazione per difetto di alpha
 	 */
 	if (c0 != NULL) {
-		ia0 = bisec_d(a, 0., 0, na - 1);
+		if (idx != NULL && idx->b != NULL) {
+			ia0 = idx->ia0;
+
+		} else {
+			ia0 = bisec_d(a, 0., 0, na - 1);
+		}
 	}
 
-	ia = bisec_d(a, alpha, 0, na - 1);
+	ia = find_alpha(na, a, idx, alpha);
 
 	if (im == nm - 1) {
 		if (c0 != NULL) {
@@ -140,6 +140,27 @@ typedef struct vam_t {
  *   - un vettore di angoli ai quali si perde linearita' (-)
  *   - un vettore con il Cp/alpha
  */
+
+/*
+ * indice per la ricerca rapida dell'angolo di incidenza
+ * nella prima colonna di una tabella (vedi c81_data_do_index()):
+ * l'intervallo [a[0], a[NA-1]] e' diviso in nb intervalli uniformi
+ * di ampiezza 1/dbi, e b[k] e' l'indice che bisec() restituisce
+ * per l'estremo inferiore del k-esimo intervallo; la ricerca
+ * parte da b[k] e avanza di pochi elementi, dando lo stesso
+ * risultato di bisec() a costo costante.
+ * ia0 e' l'indice che bisec() restituisce per alpha = 0.
+ *
+ * Se b == NULL l'indice non e' stato costruito
+ * e si ricorre a bisec().
+ */
+typedef struct c81_index {
+	int ia0;
+	int nb;
+	doublereal dbi;
+	int *b;
+} c81_index;
+
 typedef struct c81_data {
    	char header[31];
    
@@ -166,6 +187,11 @@ typedef struct c81_data {
    	int NAM;
    	doublereal *mm;
    	doublereal *am;
+
+	/* indici delle tabelle di CL, CD e CM */
+	c81_index il;
+	c81_index id;
+	c81_index im;
 } c81_data;
 
 extern int 
@@ -175,6 +201,14 @@ extern int
 c81_aerod2_u(const doublereal* W, const vam_t *VAM, doublereal* TNG, outa_t* OUTA, 
 		const c81_data* data, long unsteadyflag);
 
+extern int
+c81_aerod2_u_n(int n, const doublereal* W, const vam_t *VAM,
+		doublereal* TNG, outa_t* OUTA, const c81_data* data);
+
+extern int
+c81_aerod2_u_jac(const doublereal* W, const vam_t *VAM, doublereal* TNG,
+		doublereal* J, outa_t* OUTA, const c81_data* data);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
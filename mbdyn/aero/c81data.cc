@@ -49,6 +49,7 @@ extern "C" {
 }
 
 #include "c81data.h"
+#include "bisec.h"
 
 /*
  * header NML,NAL,NMD,NAD,NMM,NAM	A30,6I2
@@ -286,6 +287,10 @@ c81_data_destroy(c81_data* data)
 
 	delete[] data->stall;
 	delete[] data->mstall;
+
+	delete[] data->il.b;
+	delete[] data->id.b;
+	delete[] data->im.b;
 }
 
 extern "C" int
@@ -388,6 +393,7 @@ c81_data_read(std::istream& in, c81_data* data, const doublereal dcltol, int *ff
 
 	/* FIXME: maybe this is not the best place */
 	c81_data_do_stall(data, dcltol);
+	c81_data_do_index(data);
 
    	return 0;
 }
@@ -607,6 +613,7 @@ c81_data_merge(
 
 	// FIXME: maybe this is not the best place
 	c81_data_do_stall(i_data, dcltol);
+	c81_data_do_index(i_data);
 
 	return 0;
 }
@@ -871,6 +878,7 @@ c81_data_fc511_read(std::istream& in, c81_data* data, const doublereal dcltol)
 
 	/* FIXME: maybe this is not the best place */
 	c81_data_do_stall(data, dcltol);
+	c81_data_do_index(data);
 
    	return 0;
 }
@@ -958,6 +966,7 @@ c81_data_nrel_read(std::istream& in, c81_data* data, const doublereal dcltol)
 
 	/* FIXME: maybe this is not the best place */
 	c81_data_do_stall(data, dcltol);
+	c81_data_do_index(data);
 
    	return 0;
 }
@@ -1062,6 +1071,7 @@ c81_data_read_free_format(std::istream& in, c81_data* data, const doublereal dcl
 
 	/* FIXME: maybe this is not the best place */
 	c81_data_do_stall(data, dcltol);
+	c81_data_do_index(data);
 
    	return 0;
 }
@@ -1261,6 +1271,56 @@ c81_data_do_stall(c81_data *data, const doublereal dcltol)
 	return 0;
 }
 
+static int
+do_index(int NA, const doublereal *a, c81_index *idx)
+{
+	delete[] idx->b;
+	idx->b = 0;
+	idx->nb = 0;
+
+	idx->ia0 = bisec<doublereal>(a, 0., 0, NA - 1);
+
+	doublereal da = a[NA - 1] - a[0];
+	if (NA < 2 || !(da > 0.)) {
+		return 0;
+	}
+
+	/*
+	 * a few buckets per interval keep the linear search
+	 * short even when the angles are clustered
+	 * (e.g. finely tabulated around stall)
+	 */
+	idx->nb = 4*(NA - 1);
+	idx->dbi = idx->nb/da;
+	idx->b = new int[idx->nb];
+	for (int k = 0; k < idx->nb; k++) {
+		int i = bisec<doublereal>(a, a[0] + k/idx->dbi, 0, NA - 1);
+		if (i < 0) {
+			i = 0;
+
+		} else if (i > NA - 2) {
+			i = NA - 2;
+		}
+		idx->b[k] = i;
+	}
+
+	return 0;
+}
+
+extern "C" int
+c81_data_do_index(c81_data *data)
+{
+	if (data == NULL || data->NAL <= 0 || data->NAD <= 0 || data->NAM <= 0) {
+		return -1;
+	}
+
+	do_index(data->NAL, data->al, &data->il);
+	do_index(data->NAD, data->ad, &data->id);
+	do_index(data->NAM, data->am, &data->im);
+
+	return 0;
+}
+
 static int
 flip_one(int NM, int NA, doublereal *v, int ss)
 {
@@ -1303,6 +1363,11 @@ c81_data_flip(c81_data *data)
 	}
 
 	rc = flip_one(data->NMM, data->NAM, data->am, -1);
-	return rc;
+	if (rc) {
+		return rc;
+	}
+
+	/* the angles of attack changed; rebuild the indexes */
+	return c81_data_do_index(data);
 }
 
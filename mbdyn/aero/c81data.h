@@ -43,7 +43,12 @@ extern int c81_data_set(long int jpro, c81_data* data);
 extern int c81_data_merge(unsigned ndata, const c81_data **data, const doublereal *upper_bounds,
 	doublereal dCsi, doublereal dcltol, c81_data *i_data);
 extern int c81_data_do_stall(c81_data *data, const doublereal dcltol);
+extern int c81_data_do_index(c81_data *data);
 extern doublereal c81_data_get_coef(int nm, doublereal* m, int na, doublereal* a, doublereal alpha, doublereal mach);
+extern int c81_data_get_coefs(const c81_data *data, int n,
+	const doublereal *alpha, const doublereal *mach,
+	doublereal *cl, doublereal *cd, doublereal *cm,
+	doublereal *cl0, doublereal *cd0);
 extern int c81_data_flip(c81_data *data);
 
 #ifdef __cplusplus
@@ -362,12 +362,208 @@ FactorTSR::Read(Solver *s, MBDynParser& HP)
 		iMaxIters);
 }
 
+LocalError::LocalError(doublereal dRelTol,
+	doublereal dAbsTol,
+	doublereal dOrder,
+	doublereal dSafety,
+	doublereal dMinFactor,
+	doublereal dMaxFactor)
+: dRelTol(dRelTol),
+dAbsTol(dAbsTol),
+dOrder(dOrder),
+dSafety(dSafety),
+dMinFactor(dMinFactor),
+dMaxFactor(dMaxFactor),
+dReductionFactor(0.5),
+dMinTimeStep(::dDefaultMinTimeStep),
+dErr(-1.),
+dErrPrev(-1.),
+bRejected(false)
+{
+	NO_OP;
+}
+
+doublereal
+LocalError::dGetNewStepTime(StepIntegrator::StepChange Why, doublereal iPerformedIters)
+{
+	doublereal dMaxTimeStep = MaxTimeStep.dGet();
+	doublereal dFactor = 1.;
+
+	switch (Why) {
+	case StepIntegrator::REPEATSTEP:
+		if (bRejected) {
+			// converged, but the error was too large
+			dFactor = std::max(dMinFactor, dSafety*std::pow(dErr, -1./dOrder));
+			bRejected = false;
+
+		} else {
+			// no convergence: plain reduction
+			dFactor = dReductionFactor;
+		}
+		dErr = -1.;
+		break;
+
+	case StepIntegrator::NEWSTEP:
+		if (dErr < 0.) {
+			// no estimate available (e.g. startup steps)
+			return dCurrTimeStep;
+		}
+
+		// avoid overflow of the negative power when the error vanishes
+		dErr = std::max(dErr, 1.e-10);
+		dFactor = dSafety*std::pow(dErr, -0.7/dOrder);
+		if (dErrPrev > 0.) {
+			dFactor *= std::pow(dErrPrev, 0.4/dOrder);
+		}
+		dFactor = std::min(std::max(dFactor, dMinFactor), dMaxFactor);
+
+		dErrPrev = dErr;
+		dErr = -1.;
+		break;
+
+	default:
+		// Should Not Reach Over here
+		ASSERT(0);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	return (dCurrTimeStep = std::min(std::max(dCurrTimeStep*dFactor, dMinTimeStep), dMaxTimeStep));
+}
+
+void
+LocalError::Init(integer iMaxIterations, doublereal dMinTimeStep, const DriveOwner& MaxTimeStep, doublereal dInitialTimeStep)
+{
+	this->dCurrTimeStep = dInitialTimeStep;
+	this->MaxTimeStep.Set(MaxTimeStep.pGetDriveCaller()->pCopy());
+	this->dMinTimeStep = dMinTimeStep;
+
+	doublereal dInitialMaxTimeStep = MaxTimeStep.dGet();
+
+	{
+		auto ts_drv = MaxTimeStep.pGetDriveCaller();
+		if (dynamic_cast<ConstDriveCaller*>(ts_drv) != 0
+				&& dInitialMaxTimeStep == std::numeric_limits<doublereal>::max())
+		{
+			silent_cerr("warning: maximum time step not set; the time step will not be bounded from above" << std::endl);
+		}
+	}
+
+	if (dMinTimeStep == ::dDefaultMinTimeStep) {
+		silent_cerr("warning: minimum time step not set; the initial time step value " << dInitialTimeStep << " will be used" << std::endl);
+		this->dMinTimeStep = dInitialTimeStep;
+	}
+
+	if (this->dMinTimeStep > dInitialMaxTimeStep) {
+		silent_cerr("error: minimum time step " << this->dMinTimeStep << " is greater than (initial) maximum time step " << dInitialMaxTimeStep << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+void
+LocalError::SetStepIntegrator(StepIntegrator* pSI)
+{
+	if (pSI == 0 || !pSI->SetLocalErrorTolerance(dRelTol, dAbsTol)) {
+		silent_cerr("error: \"local error\" time step strategy "
+			"not supported by the selected integrator" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+bool
+LocalError::bRejectStep(doublereal dLocalErr)
+{
+	dErr = dLocalErr;
+	bRejected = (dErr > 1. && dCurrTimeStep > dMinTimeStep);
+
+	return bRejected;
+}
+
+class LocalErrorTSR : public TimeStepRead {
+public:
+	TimeStepControl *Read(Solver *s, MBDynParser& HP);
+};
+
+TimeStepControl *
+LocalErrorTSR::Read(Solver *s, MBDynParser& HP)
+{
+	doublereal dRelTol;
+	try {
+		dRelTol = HP.GetReal(1.e-3, HighParser::range_gt<doublereal>(0.));
+
+	} catch (HighParser::ErrValueOutOfRange<doublereal>& e) {
+		silent_cerr("error: invalid relative tolerance " << e.Get() << " (must be positive) [" << e.what() << "] at line " << HP.GetLineData() << std::endl);
+		throw e;
+	}
+
+	doublereal dAbsTol = dRelTol;
+	doublereal dOrder = 2.;
+	doublereal dSafety = .9;
+	doublereal dMinFactor = .2;
+	doublereal dMaxFactor = 5.;
+
+	while (HP.IsArg()) {
+		if (HP.IsKeyWord("absolute" "tolerance")) {
+			try {
+				dAbsTol = HP.GetReal(dRelTol, HighParser::range_gt<doublereal>(0.));
+
+			} catch (HighParser::ErrValueOutOfRange<doublereal>& e) {
+				silent_cerr("error: invalid absolute tolerance " << e.Get() << " (must be positive) [" << e.what() << "] at line " << HP.GetLineData() << std::endl);
+				throw e;
+			}
+
+		} else if (HP.IsKeyWord("order")) {
+			try {
+				dOrder = HP.GetReal(2., HighParser::range_ge<doublereal>(1.));
+
+			} catch (HighParser::ErrValueOutOfRange<doublereal>& e) {
+				silent_cerr("error: invalid order " << e.Get() << " (must be greater than (or equal to) one) [" << e.what() << "] at line " << HP.GetLineData() << std::endl);
+				throw e;
+			}
+
+		} else if (HP.IsKeyWord("safety" "factor")) {
+			try {
+				dSafety = HP.GetReal(.9, HighParser::range_gt_le<doublereal>(0., 1.));
+
+			} catch (HighParser::ErrValueOutOfRange<doublereal>& e) {
+				silent_cerr("error: invalid safety factor " << e.Get() << " (must be positive and less than (or equal to) one) [" << e.what() << "] at line " << HP.GetLineData() << std::endl);
+				throw e;
+			}
+
+		} else if (HP.IsKeyWord("min" "factor")) {
+			try {
+				dMinFactor = HP.GetReal(.2, HighParser::range_gt_lt<doublereal>(0., 1.));
+
+			} catch (HighParser::ErrValueOutOfRange<doublereal>& e) {
+				silent_cerr("error: invalid min factor " << e.Get() << " (must be positive and less than one) [" << e.what() << "] at line " << HP.GetLineData() << std::endl);
+				throw e;
+			}
+
+		} else if (HP.IsKeyWord("max" "factor")) {
+			try {
+				dMaxFactor = HP.GetReal(5., HighParser::range_gt<doublereal>(1.));
+
+			} catch (HighParser::ErrValueOutOfRange<doublereal>& e) {
+				silent_cerr("error: invalid max factor " << e.Get() << " (must be greater than one) [" << e.what() << "] at line " << HP.GetLineData() << std::endl);
+				throw e;
+			}
+
+		} else {
+			silent_cerr("error: unknown \"local error\" time step strategy parameter at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+	}
+
+	return new LocalError(dRelTol, dAbsTol, dOrder,
+		dSafety, dMinFactor, dMaxFactor);
+}
+
 void
 InitTimeStepData(void)
 {
 	SetTimeStepData("no" "change", new NoChangeTSR);
 	SetTimeStepData("change", new ChangeStepTSR);
 	SetTimeStepData("factor", new FactorTSR);
+	SetTimeStepData("local" "error", new LocalErrorTSR);
 }
 
 void
@@ -59,6 +59,13 @@ public:
 	virtual doublereal dGetNewStepTime(StepIntegrator::StepChange currStep, doublereal iPerformedIters) = 0;
 	virtual void SetDriveHandler(const DriveHandler* driveHandler) = 0;
 	virtual void Init(integer iMaxIterations, doublereal dMinTimeStep, const DriveOwner& MaxTimeStep, doublereal dInitialTimeStep) = 0;
+
+	// strategies based on an error estimate need the integrator
+	virtual void SetStepIntegrator(StepIntegrator* pSI) { NO_OP; };
+
+	// dLocalErr is normalized by the tolerances (1 is on the limit);
+	// returns true if the converged step must be repeated
+	virtual bool bRejectStep(doublereal dLocalErr) { return false; };
 };
 
 extern TimeStepControl *ReadTimeStepData(Solver *s, MBDynParser& HP);
@@ -129,4 +136,43 @@ public:
 	void Init(integer iMaxIterations, doublereal dMinTimeStep, const DriveOwner& MaxTimeStep, doublereal dInitialTimeStep);
 };
 
+/*
+ * Local truncation error control: the step is rejected when the
+ * normalized estimate exceeds one; otherwise the next step is computed
+ * with a PI controller,
+ *
+ *	h_{n+1} = h_n * s * e_n^{-0.7/k} * e_{n-1}^{0.4/k}
+ *
+ * clamped in [fmin, fmax] and within the minimum/maximum time step
+ */
+class LocalError : public TimeStepControl {
+private:
+	doublereal dRelTol;
+	doublereal dAbsTol;
+	doublereal dOrder;
+	doublereal dSafety;
+	doublereal dMinFactor;
+	doublereal dMaxFactor;
+	doublereal dReductionFactor;
+	doublereal dMinTimeStep;
+	DriveOwner MaxTimeStep;
+	doublereal dErr;
+	doublereal dErrPrev;
+	bool bRejected;
+
+public:
+	LocalError(doublereal dRelTol,
+		doublereal dAbsTol,
+		doublereal dOrder,
+		doublereal dSafety,
+		doublereal dMinFactor,
+		doublereal dMaxFactor);
+	~LocalError(void) { NO_OP; };
+	doublereal dGetNewStepTime(StepIntegrator::StepChange Why, doublereal iPerformedIters);
+	void SetDriveHandler(const DriveHandler* driveHandler) { NO_OP; };
+	void Init(integer iMaxIterations, doublereal dMinTimeStep, const DriveOwner& MaxTimeStep, doublereal dInitialTimeStep);
+	void SetStepIntegrator(StepIntegrator* pSI);
+	bool bRejectStep(doublereal dLocalErr);
+};
+
 #endif // TIMESTEPCONTROL_H
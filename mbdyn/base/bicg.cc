@@ -56,12 +56,14 @@
 
 BiCGStab::BiCGStab(const Preconditioner::PrecondType PType, 
 		const integer iPStep,
+		const Preconditioner::Param& PParam,
 		doublereal ITol,
 		integer MaxIt,
 		doublereal etaMx,
 		doublereal T,
+		bool bFDProd,
 		const NonlinearSolverTestOptions& options)
-: MatrixFreeSolver(PType, iPStep, ITol, MaxIt, etaMx, T, options)
+: MatrixFreeSolver(PType, iPStep, PParam, ITol, MaxIt, etaMx, T, bFDProd, options)
 {
 	NO_OP;
 }
@@ -96,7 +98,7 @@ BiCGStab::Solve(const NonlinearProblem* pNLP,
 		bBuildMat = true;
 	}
 
-	if (!PrecondIter) {
+	if (!PrecondIter && dRebuildRatio <= 0.) {
 		bBuildMat = true;
 	}
 	
@@ -140,6 +142,8 @@ BiCGStab::Solve(const NonlinearProblem* pNLP,
 
 	doublereal dOldErr = 1.; //initialize to silence g++ warning
 	doublereal dErrFactor = 1.;
+	bool bResConverged = pGetResTest()->GetType() == NonlinearSolverTest::NONE;
+	bool bSolConverged = pGetSolTest()->GetType() == NonlinearSolverTest::NONE;
 	doublereal dErrDiff = 0.;
 
 	while (true) {
@@ -165,7 +169,7 @@ BiCGStab::Solve(const NonlinearProblem* pNLP,
 			pS->PrintResidual(*pRes, iIterCnt);
       		}
 
-		bool bTest = MakeResTest(pS, pNLP, *pRes, Tol, dErr, dErrDiff);
+		bResConverged = MakeResTest(pS, pNLP, *pRes, Tol, dErr, dErrDiff);
 		if (iIterCnt > 0) {
 			dErrFactor *= dErr/dOldErr;
 		}
@@ -181,7 +185,7 @@ BiCGStab::Solve(const NonlinearProblem* pNLP,
 #endif /* USE_MPI */
 			{
 				silent_cout("\tIteration(" << iIterCnt << ") " << dErr);
-				if (bBuildMat && !bTest) {
+				if (bBuildMat && !bResConverged) {
 					silent_cout(" J");
 				}
 				silent_cout(std::endl);
@@ -190,7 +194,7 @@ BiCGStab::Solve(const NonlinearProblem* pNLP,
 		
 		pS->CheckTimeStepLimit(dErr, dErrDiff);
 
-		if (bTest) {
+		if (bResConverged && bSolConverged) {
 	 		return;
       		}
       		if (!std::isfinite(dErr)) {
@@ -235,28 +239,8 @@ BiCGStab::Solve(const NonlinearProblem* pNLP,
 		dx.Reset();
 		
 		if (bBuildMat) {
-			pSM->MatrReset();
-
-rebuild_matrix:;
-			try {
-      				pNLP->Jacobian(pSM->pMatHdl());
-
-			} catch (MatrixHandler::ErrRebuildMatrix& e) {
-				silent_cout("NewtonRaphsonSolver: "
-						"rebuilding matrix..."
-						<< std::endl);
-
-				/* need to rebuild the matrix... */
-      				pSM->MatrInitialize();
-				goto rebuild_matrix;
-
-			} catch (...) {
-				throw;
-			}
-
-			bBuildMat = false;
+			BuildPrecond(pNLP, pSM);
 			TotalIter = 0;
-			TotJac++;
 
 #ifdef DEBUG_ITERATIVE			
 			std::cerr << "Jacobian " << std::endl;
@@ -296,7 +280,7 @@ rebuild_matrix:;
 			}
 			/* right preconditioning */
 			pPM->Precond(p, pHat, pSM);
-			pNLP->EvalProd(Tau, rHat, pHat, v);
+			JacobianProd(pNLP, rHat, pHat, v);
 #if 0			
 			(pSM->pMatHdl())->MatVecMul(v,pHat);
 #endif			
@@ -327,12 +311,12 @@ rebuild_matrix:;
 				break;
 			}
 			pPM->Precond(s, sHat, pSM);
-			pNLP->EvalProd(Tau, rHat, sHat, t);
+			JacobianProd(pNLP, rHat, sHat, t);
 #if 0
 			(pSM->pMatHdl())->MatVecMul(t,sHat);
 #endif
 			omega = t.Norm();
-			omega = t.InnerProd(s) / omega;
+			omega = t.InnerProd(s) / (omega*omega);
 
 #ifdef DEBUG_ITERATIVE
 			std::cerr << "omega " << omega << std::endl;
@@ -362,7 +346,7 @@ rebuild_matrix:;
 		}
 		/* se ha impiegato troppi passi riassembla lo jacobiano */
 		
-		if (TotalIter >= PrecondIter && PrecondIter) {
+		if (bRebuildPrecond(It, TotalIter)) {
 			bBuildMat = true;
 		}
 		/* calcola il nuovo eta */
@@ -387,7 +371,7 @@ rebuild_matrix:;
 		
       		pNLP->Update(&dx);
 
-		bTest = MakeSolTest(pS, dx, SolTol, dSolErr);
+		bSolConverged = MakeSolTest(pS, dx, SolTol, dSolErr);
 		if (outputIters()) {
 #ifdef USE_MPI
 			if (!bParallel || MBDynComm.Get_rank() == 0)
@@ -398,7 +382,7 @@ rebuild_matrix:;
 			}
 		}
 
-		if (bTest) {
+		if (bResConverged && bSolConverged) {
 			throw ConvergenceOnSolution(MBDYN_EXCEPT_ARGS);
 		}
 
@@ -50,10 +50,12 @@ private:
 public:
 	BiCGStab(const Preconditioner::PrecondType PType, 
 			const integer iPStep,
+			const Preconditioner::Param& PParam,
 			doublereal ITol,
 			integer MaxIt,
 			doublereal etaMx,
 			doublereal T,
+			bool bFDProd,
 			const NonlinearSolverTestOptions& options);
 	~BiCGStab(void);
 	
@@ -0,0 +1,350 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+
+#include "myassert.h"
+#include "mynewmem.h"
+#include "checkpoint.h"
+
+/* CheckpointOut - begin */
+
+CheckpointOut::CheckpointOut(void)
+{
+	NO_OP;
+}
+
+CheckpointOut::~CheckpointOut(void)
+{
+	NO_OP;
+}
+
+void
+CheckpointOut::Put(const void *p, size_t size)
+{
+	const char *pc = static_cast<const char *>(p);
+	m_Buf.insert(m_Buf.end(), pc, pc + size);
+}
+
+void
+CheckpointOut::Put(const doublereal& d)
+{
+	Put(&d, sizeof(d));
+}
+
+void
+CheckpointOut::Put(const integer& i)
+{
+	Put(&i, sizeof(i));
+}
+
+void
+CheckpointOut::Put(const unsigned& u)
+{
+	Put(&u, sizeof(u));
+}
+
+void
+CheckpointOut::Put(const bool& b)
+{
+	char c = b;
+	Put(&c, sizeof(c));
+}
+
+void
+CheckpointOut::Put(const Vec3& v)
+{
+	Put(v.pGetVec(), 3*sizeof(doublereal));
+}
+
+void
+CheckpointOut::Put(const Mat3x3& m)
+{
+	Put(m.pGetMat(), 9*sizeof(doublereal));
+}
+
+void
+CheckpointOut::Put(const VectorHandler& v)
+{
+	integer iSize = v.iGetSize();
+	Put(iSize);
+	Put(v.pdGetVec(), iSize*sizeof(doublereal));
+}
+
+size_t
+CheckpointOut::BeginBlock(void)
+{
+	size_t token = m_Buf.size();
+	uint64_t size = 0;
+	Put(&size, sizeof(size));
+	return token;
+}
+
+void
+CheckpointOut::EndBlock(size_t token)
+{
+	ASSERT(token + sizeof(uint64_t) <= m_Buf.size());
+
+	uint64_t size = m_Buf.size() - token - sizeof(uint64_t);
+	std::memcpy(&m_Buf[token], &size, sizeof(size));
+}
+
+/* CheckpointOut - end */
+
+/* CheckpointIn - begin */
+
+CheckpointIn::CheckpointIn(const char *p, size_t size)
+: m_pCur(p), m_pEnd(p + size)
+{
+	NO_OP;
+}
+
+CheckpointIn::~CheckpointIn(void)
+{
+	NO_OP;
+}
+
+void
+CheckpointIn::Get(void *p, size_t size)
+{
+	if (size > Left()) {
+		silent_cerr("checkpoint: unexpected end of data "
+			"(" << size << " bytes requested, "
+			<< Left() << " available)" << std::endl);
+		throw ErrCorrupted(MBDYN_EXCEPT_ARGS);
+	}
+
+	std::memcpy(p, m_pCur, size);
+	m_pCur += size;
+}
+
+void
+CheckpointIn::Get(doublereal& d)
+{
+	Get(&d, sizeof(d));
+}
+
+void
+CheckpointIn::Get(integer& i)
+{
+	Get(&i, sizeof(i));
+}
+
+void
+CheckpointIn::Get(unsigned& u)
+{
+	Get(&u, sizeof(u));
+}
+
+void
+CheckpointIn::Get(bool& b)
+{
+	char c;
+	Get(&c, sizeof(c));
+	b = (c != 0);
+}
+
+void
+CheckpointIn::Get(Vec3& v)
+{
+	Get(v.pGetVec(), 3*sizeof(doublereal));
+}
+
+void
+CheckpointIn::Get(Mat3x3& m)
+{
+	Get(m.pGetMat(), 9*sizeof(doublereal));
+}
+
+void
+CheckpointIn::Get(VectorHandler& v)
+{
+	integer iSize;
+	Get(iSize);
+	if (iSize != v.iGetSize()) {
+		silent_cerr("checkpoint: vector size mismatch "
+			"(stored " << iSize << ", expected "
+			<< v.iGetSize() << ")" << std::endl);
+		throw ErrCorrupted(MBDYN_EXCEPT_ARGS);
+	}
+	Get(v.pdGetVec(), iSize*sizeof(doublereal));
+}
+
+CheckpointIn
+CheckpointIn::GetBlock(void)
+{
+	uint64_t size;
+	Get(&size, sizeof(size));
+	if (size > Left()) {
+		silent_cerr("checkpoint: truncated block "
+			"(" << size << " bytes, "
+			<< Left() << " available)" << std::endl);
+		throw ErrCorrupted(MBDYN_EXCEPT_ARGS);
+	}
+
+	CheckpointIn block(m_pCur, size);
+	m_pCur += size;
+
+	return block;
+}
+
+/* CheckpointIn - end */
+
+/* CheckpointWriter - begin */
+
+CheckpointWriter::CheckpointWriter(void)
+: m_bFailed(false)
+#ifdef USE_MULTITHREAD
+, m_bRunning(false)
+#endif /* USE_MULTITHREAD */
+{
+	NO_OP;
+}
+
+CheckpointWriter::~CheckpointWriter(void)
+{
+	Wait();
+}
+
+void
+CheckpointWriter::WriteFile(void)
+{
+	std::string sTmpName = m_sFileName + ".tmp";
+
+	m_bFailed = true;
+
+	FILE *fd = std::fopen(sTmpName.c_str(), "wb");
+	if (fd == 0) {
+		return;
+	}
+
+	bool bOK = (m_Buf.empty()
+			|| std::fwrite(&m_Buf[0], 1, m_Buf.size(), fd) == m_Buf.size())
+		&& (std::fflush(fd) == 0);
+#ifdef HAVE_UNISTD_H
+	/* the checkpoint must survive the node going away */
+	bOK = bOK && (fsync(fileno(fd)) == 0);
+#endif /* HAVE_UNISTD_H */
+	bOK = (std::fclose(fd) == 0) && bOK;
+
+	if (bOK && std::rename(sTmpName.c_str(), m_sFileName.c_str()) == 0) {
+		m_bFailed = false;
+	}
+}
+
+#ifdef USE_MULTITHREAD
+void *
+CheckpointWriter::Writer(void *p)
+{
+	static_cast<CheckpointWriter *>(p)->WriteFile();
+
+	return 0;
+}
+#endif /* USE_MULTITHREAD */
+
+void
+CheckpointWriter::Write(const std::string& sFileName, CheckpointOut& out)
+{
+	Wait();
+
+	m_sFileName = sFileName;
+	out.Swap(m_Buf);
+
+#ifdef USE_MULTITHREAD
+	if (pthread_create(&m_Thread, NULL, Writer, this) == 0) {
+		m_bRunning = true;
+		return;
+	}
+
+	silent_cerr("CheckpointWriter: pthread_create() failed; "
+		"checkpoint will be written by the main thread" << std::endl);
+#endif /* USE_MULTITHREAD */
+
+	WriteFile();
+	Wait();
+}
+
+void
+CheckpointWriter::Wait(void)
+{
+#ifdef USE_MULTITHREAD
+	if (m_bRunning) {
+		pthread_join(m_Thread, NULL);
+		m_bRunning = false;
+	}
+#endif /* USE_MULTITHREAD */
+
+	if (m_bFailed) {
+		/* a failed checkpoint is not fatal: the previous one,
+		 * if any, is left in place */
+		silent_cerr("CheckpointWriter: unable to write "
+			"checkpoint file \"" << m_sFileName << "\""
+			<< std::endl);
+		m_bFailed = false;
+	}
+
+	m_Buf.clear();
+}
+
+/* CheckpointWriter - end */
+
+bool
+ReadCheckpointFile(const std::string& sFileName, std::vector<char>& buf)
+{
+	std::ifstream in(sFileName.c_str(), std::ios::in | std::ios::binary);
+	if (!in) {
+		return false;
+	}
+
+	in.seekg(0, std::ios::end);
+	std::streamoff size = in.tellg();
+	in.seekg(0, std::ios::beg);
+	if (size < 0) {
+		return false;
+	}
+
+	buf.resize(size);
+	if (size > 0) {
+		in.read(&buf[0], size);
+	}
+
+	return bool(in);
+}
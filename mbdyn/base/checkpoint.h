@@ -0,0 +1,154 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <mbconfig.h>
+
+#include <string>
+#include <vector>
+
+#ifdef USE_MULTITHREAD
+#include <pthread.h>
+#endif /* USE_MULTITHREAD */
+
+#include "except.h"
+#include "matvec3.h"
+#include "vh.h"
+
+/* Binary checkpoint - begin */
+
+/*
+ * A checkpoint is a flat, native-endian byte stream; it can only be
+ * restored by the same executable on the same model.  Each entity
+ * writes its private state in a separate block (see
+ * SimulationEntity::SaveState()), whose size is checked on restore,
+ * so a mismatch between what is written and what is read is detected
+ * instead of silently corrupting the state of the following entities.
+ */
+
+class CheckpointOut {
+protected:
+	std::vector<char> m_Buf;
+
+public:
+	CheckpointOut(void);
+	~CheckpointOut(void);
+
+	void Put(const void *p, size_t size);
+	void Put(const doublereal& d);
+	void Put(const integer& i);
+	void Put(const unsigned& u);
+	void Put(const bool& b);
+	void Put(const Vec3& v);
+	void Put(const Mat3x3& m);
+	/* writes the size of the vector, followed by its contents */
+	void Put(const VectorHandler& v);
+
+	/* opens a block; returns the token that closes it */
+	size_t BeginBlock(void);
+	void EndBlock(size_t token);
+
+	size_t Size(void) const { return m_Buf.size(); };
+	void Swap(std::vector<char>& buf) { m_Buf.swap(buf); };
+};
+
+class CheckpointIn {
+public:
+	class ErrCorrupted : public MBDynErrBase {
+	public:
+		ErrCorrupted(MBDYN_EXCEPT_ARGS_DECL) : MBDynErrBase(MBDYN_EXCEPT_ARGS_PASSTHRU) {};
+	};
+
+protected:
+	const char *m_pCur;
+	const char *m_pEnd;
+
+public:
+	CheckpointIn(const char *p, size_t size);
+	~CheckpointIn(void);
+
+	void Get(void *p, size_t size);
+	void Get(doublereal& d);
+	void Get(integer& i);
+	void Get(unsigned& u);
+	void Get(bool& b);
+	void Get(Vec3& v);
+	void Get(Mat3x3& m);
+	/* the size of the vector must match the stored one */
+	void Get(VectorHandler& v);
+
+	/* returns a reader limited to the next block, and skips it */
+	CheckpointIn GetBlock(void);
+
+	size_t Left(void) const { return m_pEnd - m_pCur; };
+};
+
+/*
+ * Writes checkpoint buffers to file, replacing the previous checkpoint
+ * atomically (a temporary file is renamed over the old one).
+ * With multithread support, the file is written by a separate thread,
+ * so the solver only waits if the previous checkpoint is still being
+ * written when the next one is ready.
+ */
+class CheckpointWriter {
+protected:
+	std::string m_sFileName;
+	std::vector<char> m_Buf;
+	bool m_bFailed;
+
+#ifdef USE_MULTITHREAD
+	bool m_bRunning;
+	pthread_t m_Thread;
+
+	static void *Writer(void *p);
+#endif /* USE_MULTITHREAD */
+
+	void WriteFile(void);
+
+public:
+	CheckpointWriter(void);
+	~CheckpointWriter(void);
+
+	/* takes over the contents of out */
+	void Write(const std::string& sFileName, CheckpointOut& out);
+
+	/* waits for the pending write, if any */
+	void Wait(void);
+};
+
+/* reads the whole file in buf; returns false if it cannot be opened */
+extern bool ReadCheckpointFile(const std::string& sFileName, std::vector<char>& buf);
+
+/* Binary checkpoint - end */
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,378 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * Compares the two ways the multithreaded data manager assembles
+ * a compact Jacobian matrix:
+ * - each thread assembles its elements into a copy of the matrix,
+ *   and the copies are summed afterwards (the default);
+ * - the elements are colored so that those of the same color share
+ *   no row, and each color is assembled concurrently into the same
+ *   matrix (the "colored" option of "threads").
+ * The elements are beams connecting the nodes of a grid; each one
+ * contributes a full 12x12 block, whose computation costs about
+ * as much as requested by -w.
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include "ac/getopt.h"
+
+#ifdef USE_MULTITHREAD
+
+#include "filename.h"
+#include "veciter.h"
+#include "threadpool.h"
+#include "submat.h"
+#include "spmapmh.h"
+#include "ccmh.h"
+
+static const integer iNumDofs = 6;
+
+struct Beam {
+	integer iNode1;
+	integer iNode2;
+	SubMatrixScatterPlan oPlan;
+};
+
+static unsigned uWork = 100;
+
+/* the Jacobian of a beam; depends on the labels only, so that
+ * the result does not depend on the assembly */
+static void
+AssJac(const Beam& b, FullSubMatrixHandler& WM)
+{
+	WM.ResizeReset(2*iNumDofs, 2*iNumDofs);
+	for (integer i = 1; i <= iNumDofs; i++) {
+		WM.PutRowIndex(i, b.iNode1*iNumDofs + i);
+		WM.PutColIndex(i, b.iNode1*iNumDofs + i);
+		WM.PutRowIndex(iNumDofs + i, b.iNode2*iNumDofs + i);
+		WM.PutColIndex(iNumDofs + i, b.iNode2*iNumDofs + i);
+	}
+
+	doublereal d = b.iNode1 + 1e-3*b.iNode2;
+	for (unsigned k = 0; k < uWork; k++) {
+		d = std::sqrt(d + 1.);
+	}
+
+	for (integer c = 1; c <= 2*iNumDofs; c++) {
+		for (integer r = 1; r <= 2*iNumDofs; r++) {
+			WM(r, c) = d + r - c;
+		}
+	}
+}
+
+/* greedy (first fit) coloring, as in MultiThreadDataManager */
+static unsigned
+Color(const std::vector<Beam>& Beams, integer iNumNodes,
+	std::vector<unsigned>& Order, std::vector<unsigned>& ColorOffsets)
+{
+	std::vector<unsigned> ElemColor(Beams.size());
+	std::vector<std::vector<unsigned> > NodeColors(iNumNodes);
+	std::vector<unsigned> Forbidden;
+	unsigned nColors = 0;
+
+	for (unsigned e = 0; e < Beams.size(); e++) {
+		integer aiNodes[2] = { Beams[e].iNode1, Beams[e].iNode2 };
+
+		for (unsigned n = 0; n < 2; n++) {
+			const std::vector<unsigned>& NC = NodeColors[aiNodes[n]];
+			for (unsigned c = 0; c < NC.size(); c++) {
+				Forbidden[NC[c]] = e + 1;
+			}
+		}
+
+		unsigned iColor = 0;
+		while (iColor < nColors && Forbidden[iColor] == e + 1) {
+			iColor++;
+		}
+
+		if (iColor == nColors) {
+			Forbidden.push_back(0);
+			nColors++;
+		}
+
+		ElemColor[e] = iColor;
+		for (unsigned n = 0; n < 2; n++) {
+			NodeColors[aiNodes[n]].push_back(iColor);
+		}
+	}
+
+	ColorOffsets.assign(nColors + 1, 0);
+	for (unsigned e = 0; e < Beams.size(); e++) {
+		ColorOffsets[ElemColor[e] + 1]++;
+	}
+
+	for (unsigned c = 0; c < nColors; c++) {
+		ColorOffsets[c + 1] += ColorOffsets[c];
+	}
+
+	Order.resize(Beams.size());
+	std::vector<unsigned> ColorFill(ColorOffsets.begin(), ColorOffsets.end() - 1);
+	for (unsigned e = 0; e < Beams.size(); e++) {
+		Order[ColorFill[ElemColor[e]]++] = e;
+	}
+
+	return nColors;
+}
+
+int
+main(int argc, char* argv[])
+{
+	unsigned nx = 100;
+	unsigned ny = 100;
+	unsigned nt = 1;
+	unsigned nLoops = 20;
+
+	while (true) {
+		char	*next;
+		int	opt = getopt(argc, argv, "hl:t:w:x:y:");
+
+		if (opt == EOF) {
+			break;
+		}
+
+		switch (opt) {
+		case 'l':
+			nLoops = strtoul(optarg, &next, 10);
+			break;
+
+		case 't':
+			nt = strtoul(optarg, &next, 10);
+			break;
+
+		case 'w':
+			uWork = strtoul(optarg, &next, 10);
+			break;
+
+		case 'x':
+			nx = strtoul(optarg, &next, 10);
+			break;
+
+		case 'y':
+			ny = strtoul(optarg, &next, 10);
+			break;
+
+		default:
+		{
+			char *s = std::strrchr(argv[0], DIR_SEP);
+
+			if (s) {
+				s++;
+			} else {
+				s = argv[0];
+			}
+
+			std::cout << "usage: " << s << " [hltwxy]" << std::endl
+				<< "\t-l <loops>" << std::endl
+				<< "\t-t <threads number>" << std::endl
+				<< "\t-w <work per element>" << std::endl
+				<< "\t-x <nodes along x>" << std::endl
+				<< "\t-y <nodes along y>" << std::endl;
+			exit(opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		}
+	}
+
+	if (nt < 1) {
+		nt = 1;
+	}
+
+	if (nx < 2 || ny < 1 || nLoops < 1) {
+		std::cerr << "invalid model size" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	ThreadPool::SetMaxThreads(nt);
+	nt = ThreadPool::Get().iGetAvailThreads();
+
+	/* the grid */
+	const integer iNumNodes = nx*ny;
+	const integer iSize = iNumNodes*iNumDofs;
+	std::vector<Beam> Beams;
+	for (unsigned j = 0; j < ny; j++) {
+		for (unsigned i = 0; i < nx; i++) {
+			integer n = j*nx + i;
+			if (i + 1 < nx) {
+				Beams.push_back(Beam{n, n + 1});
+			}
+			if (j + 1 < ny) {
+				Beams.push_back(Beam{n, n + integer(nx)});
+			}
+		}
+	}
+
+	/* the pattern, and the reference */
+	SpMapMatrixHandler SMH(iSize);
+	FullSubMatrixHandler WM(2*iNumDofs, 2*iNumDofs);
+	for (unsigned e = 0; e < Beams.size(); e++) {
+		AssJac(Beams[e], WM);
+		SMH += WM;
+	}
+
+	std::vector<doublereal> Ax;
+	std::vector<integer> Ai, Ap;
+	SMH.MakeCompressedColumnForm(Ax, Ai, Ap, 0);
+	const std::vector<doublereal> AxRef(Ax);
+	doublereal dNorm = 0.;
+	for (unsigned k = 0; k < AxRef.size(); k++) {
+		dNorm = std::max(dNorm, std::abs(AxRef[k]));
+	}
+
+	CColMatrixHandler<0> CC(Ax, Ai, Ap);
+
+	std::cout << Beams.size() << " elements, " << iSize << " equations, "
+		<< nt << " threads" << std::endl;
+
+	/* copy and sum */
+	std::vector<CompactSparseMatrixHandler *> Copies(nt);
+	Copies[0] = &CC;
+	for (unsigned t = 1; t < nt; t++) {
+		Copies[t] = CC.Copy();
+	}
+
+	std::vector<Beam> CopyBeams(Beams);
+	MT_ChunkSchedule oSchedule;
+	oSchedule.Init(CopyBeams.size(), nt);
+
+	std::chrono::duration<double> tCopy(0);
+	for (unsigned l = 0; l < nLoops; l++) {
+		auto t0 = std::chrono::steady_clock::now();
+
+		oSchedule.Reset();
+		ThreadPool::Get().Run(nt, [&](unsigned iTask, unsigned) {
+			CompactSparseMatrixHandler& MH = *Copies[iTask];
+			FullSubMatrixHandler WorkMat(2*iNumDofs, 2*iNumDofs);
+			MH.Reset();
+
+			unsigned iBegin, iEnd;
+			while (oSchedule.bGetChunk(iBegin, iEnd)) {
+				for (unsigned e = iBegin; e < iEnd; e++) {
+					AssJac(CopyBeams[e], WorkMat);
+					WorkMat.AddTo(MH, CopyBeams[e].oPlan);
+				}
+			}
+		});
+
+		for (unsigned t = 1; t < nt; t++) {
+			CC.AddUnchecked(*Copies[t]);
+		}
+
+		tCopy += std::chrono::steady_clock::now() - t0;
+	}
+
+	doublereal dErrCopy = 0.;
+	for (unsigned k = 0; k < Ax.size(); k++) {
+		dErrCopy = std::max(dErrCopy, std::abs(Ax[k] - AxRef[k]));
+	}
+
+	for (unsigned t = 1; t < nt; t++) {
+		delete Copies[t];
+	}
+
+	/* colored */
+	std::vector<unsigned> Order, ColorOffsets;
+	unsigned nColors = Color(Beams, iNumNodes, Order, ColorOffsets);
+
+	std::vector<Beam> ColoredBeams;
+	for (unsigned e = 0; e < Order.size(); e++) {
+		ColoredBeams.push_back(Beam{Beams[Order[e]].iNode1, Beams[Order[e]].iNode2});
+	}
+
+	std::vector<MT_ChunkSchedule> ColorSchedule(nColors);
+	for (unsigned c = 0; c < nColors; c++) {
+		ColorSchedule[c].Init(ColorOffsets[c + 1] - ColorOffsets[c], nt);
+	}
+
+	std::chrono::duration<double> tColored(0);
+	for (unsigned l = 0; l < nLoops; l++) {
+		auto t0 = std::chrono::steady_clock::now();
+
+		CC.Reset();
+		for (unsigned c = 0; c < nColors; c++) {
+			ColorSchedule[c].Reset();
+		}
+
+		ThreadPool::Get().Run(nt, [&](unsigned iTask, unsigned) {
+			FullSubMatrixHandler WorkMat(2*iNumDofs, 2*iNumDofs);
+			for (unsigned c = 0; c < nColors; c++) {
+				unsigned iBegin, iEnd;
+				while (ColorSchedule[c].bGetChunk(iBegin, iEnd)) {
+					for (unsigned e = ColorOffsets[c] + iBegin; e < ColorOffsets[c] + iEnd; e++) {
+						AssJac(ColoredBeams[e], WorkMat);
+						WorkMat.AddTo(CC, ColoredBeams[e].oPlan);
+					}
+				}
+
+				ThreadPool::Get().Barrier();
+			}
+		});
+
+		tColored += std::chrono::steady_clock::now() - t0;
+	}
+
+	doublereal dErrColored = 0.;
+	for (unsigned k = 0; k < Ax.size(); k++) {
+		dErrColored = std::max(dErrColored, std::abs(Ax[k] - AxRef[k]));
+	}
+
+	std::cout << std::setprecision(3)
+		<< "copy and sum: " << 1e3*tCopy.count()/nLoops << " ms/assembly"
+		<< " (max error " << dErrCopy << ")" << std::endl
+		<< "colored:      " << 1e3*tColored.count()/nLoops << " ms/assembly"
+		<< " (" << nColors << " colors, max error " << dErrColored << ")"
+		<< std::endl;
+
+	if (dErrCopy > 1e-12*dNorm || dErrColored > 1e-12*dNorm) {
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+#else /* ! USE_MULTITHREAD */
+
+int
+main(void)
+{
+	std::cerr << "need --enable-multithread" << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+#endif /* ! USE_MULTITHREAD */
@@ -312,6 +312,22 @@ ConstitutiveLawAd<T, Tder>::Update(const sp_grad::SpColVector<sp_grad::SpGradien
      ASSERT(this->iGetNumDof() == 0);
      ASSERT((this->GetConstLawType() & ConstLawType::VISCOUS) == 0);
 
+     // F and FDE come from the last update with doublereal;
+     // it was at the same strain, unless the residual was not assembled before
+     // (e.g. Elem::AssResJac() with a single pass with SpGradient)
+     bool bUpdate = false;
+
+     for (index_type i = 1; i <= iDim; ++i) {
+          if (Eps(i).dGetValue() != this->Epsilon(i)) {
+               this->Epsilon(i) = Eps(i).dGetValue();
+               bUpdate = true;
+          }
+     }
+
+     if (bUpdate) {
+          this->Update(this->Epsilon, this->EpsilonPrime);
+     }
+
      SpGradDofStat oDofStat;
 
      for (const SpGradient& g: Eps) {
@@ -385,6 +401,25 @@ ConstitutiveLawAd<T, Tder>::Update(const sp_grad::SpColVector<sp_grad::SpGradien
      ASSERT(this->iGetNumDof() == 0);
      ASSERT((this->GetConstLawType() & ConstLawType::VISCOUS) != 0);
 
+     // see above
+     bool bUpdate = false;
+
+     for (index_type i = 1; i <= iDim; ++i) {
+          if (Eps(i).dGetValue() != this->Epsilon(i)) {
+               this->Epsilon(i) = Eps(i).dGetValue();
+               bUpdate = true;
+          }
+
+          if (EpsPrime(i).dGetValue() != this->EpsilonPrime(i)) {
+               this->EpsilonPrime(i) = EpsPrime(i).dGetValue();
+               bUpdate = true;
+          }
+     }
+
+     if (bUpdate) {
+          this->Update(this->Epsilon, this->EpsilonPrime);
+     }
+
      SpGradDofStat oDofStat;
 
      for (const SpGradient& g: Eps) {
@@ -38,6 +38,8 @@ extern "C" {
 #include <time.h>
 }
 
+#include <cstring>
+
 #include "dataman.h"
 #include "fdjac.h"
 #include "friction.h"
@@ -143,10 +145,17 @@ iCurrRestartIter(0),
 dLastRestartTime(dInitialTime),
 saveXSol(false),
 solArrFileName(0),
+bCheckpoint(false),
+bCheckpointPending(false),
+bCheckpointOptional(false),
 pOutputMeter(0),
 bOutputNextStep(false),
 iOutputCount(0),
 pFDJac(nullptr),
+pElemProf(nullptr),
+bElemProf(false),
+uElemProfTopN(10),
+iElemProfSteps(0),
 ResMode(RES_TEXT),
 #ifdef USE_NETCDF
 // NetCDF stuff
@@ -476,6 +485,12 @@ bAutoDiff(false)
 		  }
 	     }
 
+	     if (bElemProf) {
+		  SAFENEWWITHCONSTRUCTOR(pElemProf, ElemProfiler,
+			  ElemProfiler(Elems, uElemProfTopN, iElemProfSteps));
+		  OutHdl.Open(OutputHandler::PROFILE);
+	     }
+
 	     /* Verifica dei dati di controllo */
 #ifdef DEBUG
 	     if (DEBUG_LEVEL_MATCH(MYDEBUG_INIT)) {
@@ -544,6 +559,31 @@ bAutoDiff(false)
 		  }
 	     }
 
+	     /* the state stored in a checkpoint is already assembled */
+	     if (!sCheckpointFileName.empty()) {
+		  if (ReadCheckpointFile(sCheckpointFileName, CheckpointBuf)) {
+		       if (CheckpointBuf.empty()) {
+			    silent_cerr("Checkpoint file \"" << sCheckpointFileName
+					<< "\" is empty" << std::endl);
+			    throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		       }
+		       silent_cout("Restoring from checkpoint \""
+				   << sCheckpointFileName << "\"" << std::endl);
+		       bSkipInitialJointAssembly = true;
+
+		  } else if (bCheckpointOptional) {
+		       CheckpointBuf.clear();
+		       silent_cout("Checkpoint \"" << sCheckpointFileName
+				   << "\" not found; starting from initial conditions"
+				   << std::endl);
+
+		  } else {
+		       silent_cerr("Unable to read checkpoint file \""
+				   << sCheckpointFileName << "\"" << std::endl);
+		       throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		  }
+	     }
+
 	     if (bInitialJointAssemblyToBeDone) {
 		  if (!bSkipInitialJointAssembly && !bInverseDynamics) {
 		       InitialJointAssembly();
@@ -630,7 +670,8 @@ DataManager::~DataManager(void)
 	 * crea il file e forza gli oggetti a scrivere il loro contributo nel modo
 	 * opportuno
 	 */
-	if (RestartEvery == ATEND) {
+	/* with binary checkpoints, the final one is made by the solver */
+	if (RestartEvery == ATEND && !bCheckpoint) {
 		MakeRestart();
 	}
 
@@ -649,6 +690,13 @@ DataManager::~DataManager(void)
 		pFDJac = nullptr;
 	}
 
+	if (pElemProf) {
+		pElemProf->Report(OutHdl.Profile(),
+			DrvHdl.iGetStep(), DrvHdl.dGetTime());
+		SAFEDELETE(pElemProf);
+		pElemProf = nullptr;
+	}
+
 	if (pRBK) {
 		SAFEDELETE(pRBK);
 		pRBK = 0;
@@ -702,6 +750,13 @@ DataManager::bOutput(ResType t) const
 
 void DataManager::MakeRestart(void)
 {
+	if (bCheckpoint) {
+		/* the solver writes it at the end of the time step,
+		 * when the integration history is complete */
+		bCheckpointPending = true;
+		return;
+	}
+
 	silent_cout("Making restart file ..." << std::endl);
 	OutHdl.RestartOpen(saveXSol);
 	/* Inizializzazione del file di restart */
@@ -838,6 +893,187 @@ void DataManager::MakeRestart(void)
 	OutHdl.Close(OutputHandler::RESTART);
 }
 
+static const char sCheckpointMagic[] = "MBDYNCKP";
+static const unsigned uCheckpointVersion = 1;
+
+void
+DataManager::CheckpointIfPending(bool bFinal)
+{
+	if (bCheckpointPending || (bFinal && bCheckpoint)) {
+		MakeCheckpoint();
+		bCheckpointPending = false;
+	}
+}
+
+void
+DataManager::MakeCheckpoint(void)
+{
+	silent_cout("Making checkpoint ..." << std::endl);
+
+	CheckpointOut out;
+	out.Put(sCheckpointMagic, STRLENOF(sCheckpointMagic));
+	out.Put(uCheckpointVersion);
+	out.Put(iTotDofs);
+
+	/* solution and integration history */
+	size_t token = out.BeginBlock();
+	pSolver->SaveState(out);
+	out.EndBlock(token);
+
+	out.Put(iCurrRestartTime);
+	out.Put(iCurrRestartIter);
+	out.Put(dLastRestartTime);
+
+	/* private state of nodes and elements, tagged for checking */
+	unsigned uCnt = Nodes.size();
+	out.Put(uCnt);
+	for (NodeVecType::const_iterator n = Nodes.begin(); n != Nodes.end(); ++n) {
+		unsigned uType = (*n)->GetNodeType();
+		unsigned uLabel = (*n)->GetLabel();
+		out.Put(uType);
+		out.Put(uLabel);
+		token = out.BeginBlock();
+		(*n)->SaveState(out);
+		out.EndBlock(token);
+	}
+
+	uCnt = Elems.size();
+	out.Put(uCnt);
+	for (ElemVecType::const_iterator e = Elems.begin(); e != Elems.end(); ++e) {
+		unsigned uType = (*e)->GetElemType();
+		unsigned uLabel = (*e)->GetLabel();
+		out.Put(uType);
+		out.Put(uLabel);
+		token = out.BeginBlock();
+		(*e)->SaveState(out);
+		out.EndBlock(token);
+	}
+
+	out.Put(sCheckpointMagic, STRLENOF(sCheckpointMagic));
+
+	/* the buffer is handed over; the file is written asynchronously */
+	CkpWriter.Write(OutHdl._sPutExt(".chk"), out);
+}
+
+void
+DataManager::RestoreCheckpoint(void)
+{
+	ASSERT(!CheckpointBuf.empty());
+
+	try {
+		CheckpointIn in(&CheckpointBuf[0], CheckpointBuf.size());
+
+		char sMagic[STRLENOF(sCheckpointMagic)];
+		unsigned uVersion;
+		in.Get(sMagic, sizeof(sMagic));
+		in.Get(uVersion);
+		if (std::memcmp(sMagic, sCheckpointMagic, sizeof(sMagic)) != 0
+			|| uVersion != uCheckpointVersion)
+		{
+			silent_cerr("not an MBDyn checkpoint, "
+				"or unsupported version" << std::endl);
+			throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+		}
+
+		integer iDofs;
+		in.Get(iDofs);
+		if (iDofs != iTotDofs) {
+			silent_cerr("checkpoint has " << iDofs << " dofs, "
+				"model has " << iTotDofs << std::endl);
+			throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+		}
+
+		CheckpointIn block(in.GetBlock());
+		pSolver->RestoreState(block);
+		if (block.Left() != 0) {
+			silent_cerr("solver state size mismatch" << std::endl);
+			throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+		}
+
+		in.Get(iCurrRestartTime);
+		in.Get(iCurrRestartIter);
+		in.Get(dLastRestartTime);
+
+		unsigned uCnt;
+		in.Get(uCnt);
+		if (uCnt != Nodes.size()) {
+			silent_cerr("checkpoint has " << uCnt << " nodes, "
+				"model has " << Nodes.size() << std::endl);
+			throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+		}
+		for (NodeVecType::iterator n = Nodes.begin(); n != Nodes.end(); ++n) {
+			unsigned uType, uLabel;
+			in.Get(uType);
+			in.Get(uLabel);
+			if (uType != unsigned((*n)->GetNodeType())
+				|| uLabel != (*n)->GetLabel())
+			{
+				silent_cerr("checkpoint node " << uLabel
+					<< " does not match "
+					<< psNodeNames[(*n)->GetNodeType()]
+					<< "(" << (*n)->GetLabel() << ")"
+					<< std::endl);
+				throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+			}
+
+			block = in.GetBlock();
+			(*n)->RestoreState(block);
+			if (block.Left() != 0) {
+				silent_cerr(psNodeNames[(*n)->GetNodeType()]
+					<< "(" << (*n)->GetLabel() << "): "
+					"state size mismatch" << std::endl);
+				throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+			}
+		}
+
+		in.Get(uCnt);
+		if (uCnt != Elems.size()) {
+			silent_cerr("checkpoint has " << uCnt << " elements, "
+				"model has " << Elems.size() << std::endl);
+			throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+		}
+		for (ElemVecType::iterator e = Elems.begin(); e != Elems.end(); ++e) {
+			unsigned uType, uLabel;
+			in.Get(uType);
+			in.Get(uLabel);
+			if (uType != unsigned((*e)->GetElemType())
+				|| uLabel != (*e)->GetLabel())
+			{
+				silent_cerr("checkpoint element " << uLabel
+					<< " does not match "
+					<< psElemNames[(*e)->GetElemType()]
+					<< "(" << (*e)->GetLabel() << ")"
+					<< std::endl);
+				throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+			}
+
+			block = in.GetBlock();
+			(*e)->RestoreState(block);
+			if (block.Left() != 0) {
+				silent_cerr(psElemNames[(*e)->GetElemType()]
+					<< "(" << (*e)->GetLabel() << "): "
+					"state size mismatch" << std::endl);
+				throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+			}
+		}
+
+		in.Get(sMagic, sizeof(sMagic));
+		if (std::memcmp(sMagic, sCheckpointMagic, sizeof(sMagic)) != 0
+			|| in.Left() != 0)
+		{
+			silent_cerr("trailing data" << std::endl);
+			throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+		}
+	}
+	catch (CheckpointIn::ErrCorrupted& e) {
+		silent_cerr("Checkpoint \"" << sCheckpointFileName << "\" "
+			"is corrupted or does not match the model" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	std::vector<char>().swap(CheckpointBuf);
+}
+
 NamedValue *
 DataManager::InsertSym(const char* const s, const Real& v, int redefine)
 {
@@ -43,6 +43,7 @@
 #include "mynewmem.h"
 #include "except.h"
 #include "demangle.h"
+#include "hashmap.h"
 
 #include "mbpar.h"
 #include "constltp.h"
@@ -56,6 +57,8 @@
 #include "elem.h"      /* Classe di base di tutti gli elementi */
 #include "driven.h"
 #include "output.h"
+#include "checkpoint.h"
+#include "elemprof.h"
 
 #include "drive.h"     /* Drive vari */
 #include "tpldrive.h"  /* Drive vari */
@@ -176,6 +179,16 @@ protected:
 	bool saveXSol;
 	char * solArrFileName;
 
+	/* binary checkpoint stuff */
+	bool bCheckpoint;		/* restarts are binary checkpoints */
+	mutable bool bCheckpointPending;
+	std::string sCheckpointFileName;	/* checkpoint to restore */
+	bool bCheckpointOptional;
+	std::vector<char> CheckpointBuf;
+	CheckpointWriter CkpWriter;
+
+	void MakeCheckpoint(void);
+
 	/* raw output stuff */
 	DriveCaller *pOutputMeter;
         mutable bool bOutputNextStep; // Save the last positive result from pOutputMeter->dGet()
@@ -184,6 +197,12 @@ protected:
 protected:
         FiniteDifferenceJacobianBase* pFDJac;
 
+	/* element profiling stuff; null when disabled */
+	ElemProfiler* pElemProf;
+	bool bElemProf;
+	unsigned uElemProfTopN;
+	integer iElemProfSteps;
+
 public:
         void FDJacCheck(const NonlinearProblem* pNLP, const MatrixHandler* pJac);
 	/* specialized output stuff */
@@ -359,6 +378,10 @@ public:
 	/* Assembla il residuo */
 	virtual void AssRes(VectorHandler &ResHdl, doublereal dCoef, VectorHandler*const pAbsResHdl = 0);
 
+	/* Assembla residuo e jacobiano con un solo passaggio sugli elementi */
+	virtual void AssResJac(VectorHandler& ResHdl, MatrixHandler& JacHdl,
+		doublereal dCoef, VectorHandler*const pAbsResHdl = 0);
+
 	/* sets the dimesnions of the equation components */
 	virtual void SetElemDimensionIndices(std::map<OutputHandler::Dimensions, std::set<integer>>* pDimMap);
 	virtual void SetNodeDimensionIndices(std::map<OutputHandler::Dimensions, std::set<integer>>* pDimMap);
@@ -383,6 +406,10 @@ protected:
 	virtual void AssJac(MatrixHandler& JacHdl, doublereal dCoef,
 			VecIter<Elem *> &Iter,
 			VariableSubMatrixHandler& WorkMat);
+	/* as above, but JacHdl is not reset */
+	void ElemAssJac(MatrixHandler& JacHdl, doublereal dCoef,
+			VecIter<Elem *> &Iter,
+			VariableSubMatrixHandler& WorkMat);
 	virtual void AssMats(MatrixHandler& A_Hdl, MatrixHandler& B_Hdl,
 			VecIter<Elem *> &Iter,
 			VariableSubMatrixHandler& WorkMatA,
@@ -391,6 +418,12 @@ protected:
 			VecIter<Elem *> &Iter,
 			SubVectorHandler& WorkVec,
 			VectorHandler*const pAbsResHdl = 0);
+	void AssResJac(VectorHandler& ResHdl, MatrixHandler& JacHdl,
+			doublereal dCoef,
+			VecIter<Elem *> &Iter,
+			SubVectorHandler& WorkVec,
+			VariableSubMatrixHandler& WorkMat,
+			VectorHandler*const pAbsResHdl = 0);
 
         virtual void AssJac(VectorHandler& JacY,
                             const VectorHandler& Y,
@@ -484,6 +517,15 @@ public:
 
 	/* Funzioni di aggiornamento dati durante la simulazione */
 	virtual void MakeRestart(void);
+
+	/* Binary checkpoint: written by the solver between time steps,
+	 * when requested by MakeRestart() or, if bFinal, at the end
+	 * of the simulation */
+	void CheckpointIfPending(bool bFinal = false);
+	bool bRestoreCheckpoint(void) const {
+		return !CheckpointBuf.empty();
+	};
+	void RestoreCheckpoint(void);
 	virtual void DerivativesUpdate(void) const;
 	virtual void BeforePredict(VectorHandler& X, VectorHandler& XP,
 		std::deque<VectorHandler*>& qXPr,
@@ -573,7 +615,7 @@ public:
 	typedef std::map<std::string, DataManager::ElemRead *, ltstrcase> ElemReadType;
 	typedef std::pair<unsigned, Elem*> KeyElemPair;
 	typedef std::list<KeyElemPair> ElemContainerType;
-	typedef std::map<unsigned, ElemContainerType::iterator> ElemMapToListType;
+	typedef LabelMap<KeyElemPair> ElemMapToListType;
 
 protected:
 
@@ -615,7 +657,7 @@ protected:
 
 	Elem ** InsertElem(ElemDataStructure& eldata, unsigned int uLabel, Elem * pE) {
 		eldata.ElemContainer.push_back(ElemContainerType::value_type(uLabel, pE));
-		eldata.ElemMapToList[uLabel] = --eldata.ElemContainer.end();
+		eldata.ElemMapToList.insert(uLabel, &eldata.ElemContainer.back());
 		return &eldata.ElemContainer.back().second;
 	};
 
@@ -734,7 +776,7 @@ public:
 	typedef std::map<std::string, DataManager::NodeRead *, ltstrcase> NodeReadType;
 	typedef std::pair<unsigned, Node*> KeyNodePair;
 	typedef std::list<KeyNodePair> NodeContainerType;
-	typedef std::map<unsigned, NodeContainerType::iterator> NodeMapToListType;
+	typedef LabelMap<KeyNodePair> NodeMapToListType;
 
 protected:
 
@@ -761,7 +803,7 @@ protected:
 
 	Node ** InsertNode(NodeDataStructure& nodedata, unsigned int uLabel, Node * pN) {
 		nodedata.NodeContainer.push_back(NodeContainerType::value_type(uLabel, pN));
-		nodedata.NodeMapToList[uLabel] = --nodedata.NodeContainer.end();
+		nodedata.NodeMapToList.insert(uLabel, &nodedata.NodeContainer.back());
 		return &nodedata.NodeContainer.back().second;
 	};
 
@@ -835,6 +877,11 @@ public:
 	/* Restituisce il numero di dof per la costruzione delle matrici ecc. */
 	integer iGetNumDofs(void) const { return iTotDofs; };
 
+	/* partition of the dofs in blocks, one for each DofOwner:
+	 * BlockPtr[i] is the first (0-based) index of block i,
+	 * the last element is the number of dofs */
+	void GetDofBlocks(std::vector<integer>& BlockPtr) const;
+
 protected:
 	integer iTotDofs;                /* numero totale di Dof */
 	DofVecType Dofs;
@@ -1450,6 +1450,42 @@ DataManager::DofOwnerSet(void)
 	}
 } /* end of DofOwnerSet() */
 
+void
+DataManager::GetDofBlocks(std::vector<integer>& BlockPtr) const
+{
+	std::vector<std::pair<integer, integer> > Owned;
+	Owned.reserve(DofOwners.size());
+	for (std::vector<DofOwner>::const_iterator i = DofOwners.begin();
+		i != DofOwners.end(); ++i)
+	{
+		if (i->iNumDofs > 0) {
+			Owned.push_back(std::make_pair(i->iFirstIndex, integer(i->iNumDofs)));
+		}
+	}
+	std::sort(Owned.begin(), Owned.end());
+
+	/* dofs not owned by any DofOwner make blocks by themselves */
+	BlockPtr.clear();
+	BlockPtr.reserve(Owned.size() + 1);
+	integer iNext = 0;
+	for (std::vector<std::pair<integer, integer> >::const_iterator i = Owned.begin();
+		i != Owned.end(); ++i)
+	{
+		while (iNext < i->first) {
+			BlockPtr.push_back(iNext++);
+		}
+		if (i->first < iNext) {
+			continue;
+		}
+		BlockPtr.push_back(i->first);
+		iNext = i->first + i->second;
+	}
+	while (iNext < iTotDofs) {
+		BlockPtr.push_back(iNext++);
+	}
+	BlockPtr.push_back(iTotDofs);
+}
+
 
 void
 DataManager::SetValue(VectorHandler& X, VectorHandler& XP)
@@ -1650,8 +1686,8 @@ DataManager::OutputEigFullMatrices(const MatrixHandler* pMatA,
 		ncStartPos.push_back(0); // implicit cast here ok?
 		ncCount.push_back(nrows);
 		ncCount.push_back(ncols);
-		Var_Eig_dAplus.putVar(MatB.pdGetMat()); // seems that there is no purpose in giving matrix size as for old c++ (legacy) interface...
-		Var_Eig_dAminus.putVar(MatA.pdGetMat());
+		OutHdl.WriteNcVar(Var_Eig_dAplus, *MatB.pdGetMat(), ncStartPos, ncCount);
+		OutHdl.WriteNcVar(Var_Eig_dAminus, *MatA.pdGetMat(), ncStartPos, ncCount);
 
 	}
 #endif /* USE_NETCDF */
@@ -2183,141 +2219,100 @@ DataManager::OutputEigenvectors(const VectorHandler *pBeta,
 		dim_v[2] = m_Dim_Eig_iSize;
 
 		/* start corner and count vector for NetCDF matrix output.
-		 * Since we are writing a matrix element-by-element, count will
-		 * always be (1, 1, 1) and start will move to the desired place in the
-		 * matrix */
-		std::vector<size_t> start (3, 0);
-		const std::vector<size_t> count (3, 1);
-
-		if (pVL) {
-			// VL
-			OutputHandler::AttrValVec attrs3(3);
-			attrs3[0] = OutputHandler::AttrVal("units", "-");
-			attrs3[1] = OutputHandler::AttrVal("type", "doublereal");
-			attrs3[2] = OutputHandler::AttrVal("description", "VL - Left eigenvectors matrix");
-
-			std::stringstream varname_ss;
-			varname_ss << "eig." << uCurrEigSol << ".VL";
-			Var_Eig_dVL = OutHdl.CreateVar(varname_ss.str(), MbNcDouble, attrs3, dim_v);
-
-			doublereal re;
-			doublereal im;
-
-
-			for (integer r = 1; r <= iSize; r++) {
-				start[1] = 0;
-				for (integer c = 1; c <= iNVec; c++) {
-					if (!vOut[c - 1]) {
-						continue;
-					}
-
-					start[2] = r - 1;
-					if (I(c) != 0.) {
-						ASSERTMSG(c < iNVec, "partial eigenanalysis output: complex eigenvalue with real part of left eigenvector only");
-						ASSERT(I(c) > 0.);
-
-						re = (*pVL)(r, c); // see above comment
-						im = (c < iNVec) ? (*pVL)(r, c + 1) : 0.;
-
-						// NetCDF indexing is zero-based!
-						start[0] = 0;	// real part in first "page" of VL
-						OutHdl.WriteNcVar(Var_Eig_dVL, re, start, count);
-
-						start[0] = 1;	// imaginary part in second "page"
-						OutHdl.WriteNcVar(Var_Eig_dVL, re, start, count);
-
-						start[1]++;
-
-						if (vOut[c]) {
-							im = -im;
-
-							start[0] = 0;
-							OutHdl.WriteNcVar(Var_Eig_dVL, re, start, count);
-
-							start[0] = 1;
-							OutHdl.WriteNcVar(Var_Eig_dVL, im, start, count);
-
-							start[1]++;
-						}
-						c++;
-					} else {
-						re = (*pVL)(r, c);
-						im = 0.;
-
-						start[0] = 0;
-						OutHdl.WriteNcVar(Var_Eig_dVL, re, start, count);
-
-						start[0] = 1;
-						OutHdl.WriteNcVar(Var_Eig_dVL, im, start, count);
-
-						start[1]++;
-					}
-				}
-			}
-		}
-
-		// VR
-		attrs3[0] = OutputHandler::AttrVal("units", "-");
-		attrs3[1] = OutputHandler::AttrVal("type", "doublereal");
-		attrs3[2] = OutputHandler::AttrVal("description", "VR - Right eigenvectors matrix");
-
-		varname_ss.str("");
-		varname_ss.clear();
-		varname_ss << "eig." << uCurrEigSol << ".VR";
-		Var_Eig_dVR = OutHdl.CreateVar(varname_ss.str(), MbNcDouble, attrs3, dim_v);
-
-		doublereal re;
-		doublereal im;
-		for (integer r = 1; r <= iSize; r++) {
+		 * Each eigenvector is written as a whole: count is (1, 1, iSize)
+		 * and start moves to the page (real or imaginary part)
+		 * and to the mode */
+		std::vector<size_t> start(3, 0);
+		std::vector<size_t> count(3, 1);
+		count[2] = iSize;
+
+		std::vector<doublereal> re(iSize);
+		std::vector<doublereal> im(iSize);
+
+		// writes the eigenvectors in V to Var, one mode at a time
+		auto WriteEigenvectors = [&](const MBDynNcVar& Var, const MatrixHandler& V) {
 			start[1] = 0;
 			for (integer c = 1; c <= iNVec; c++) {
 				if (!vOut[c - 1]) {
 					continue;
 				}
 
-				start[2] = r - 1;
+				for (integer r = 1; r <= iSize; r++) {
+					re[r - 1] = V(r, c);
+				}
+
 				if (I(c) != 0.) {
-					ASSERTMSG(c < iNVec, "partial eigenanalysis output: complex eigenvalue with real part of right eigenvector only");
+					ASSERTMSG(c < iNVec, "partial eigenanalysis output: complex eigenvalue with real part of eigenvector only");
 					ASSERT(I(c) > 0.);
 
-					re = VR(r, c); // see above comments
-					im = (c < iNVec) ? VR(r, c + 1) : 0.;
+					// see above comments
+					for (integer r = 1; r <= iSize; r++) {
+						im[r - 1] = (c < iNVec) ? V(r, c + 1) : 0.;
+					}
 
 					// NetCDF indexing is zero-based!
-					start[0] = 0;	// real part in first 'page' of VR
-					OutHdl.WriteNcVar(Var_Eig_dVR, re, start, count);
+					start[0] = 0;	// real part in first 'page'
+					OutHdl.WriteNcVar(Var, re[0], start, count);
 
 					start[0] = 1;	// imaginary part in second 'page'
-					OutHdl.WriteNcVar(Var_Eig_dVR, im, start, count);
+					OutHdl.WriteNcVar(Var, im[0], start, count);
 
 					start[1]++;
 
 					if (vOut[c]) {
-						im = -im;
+						for (integer r = 0; r < iSize; r++) {
+							im[r] = -im[r];
+						}
 
 						start[0] = 0;
-						OutHdl.WriteNcVar(Var_Eig_dVR, re, start, count);
+						OutHdl.WriteNcVar(Var, re[0], start, count);
 
 						start[0] = 1;
-						OutHdl.WriteNcVar(Var_Eig_dVR, im, start, count);
+						OutHdl.WriteNcVar(Var, im[0], start, count);
+
 						start[1]++;
 					}
 					c++;
+
 				} else {
-					re = VR(r, c);
-					im = 0.;
+					std::fill(im.begin(), im.end(), 0.);
 
 					start[0] = 0;
-					OutHdl.WriteNcVar(Var_Eig_dVR, re, start, count);
+					OutHdl.WriteNcVar(Var, re[0], start, count);
 
 					start[0] = 1;
-					OutHdl.WriteNcVar(Var_Eig_dVR, im, start, count);
+					OutHdl.WriteNcVar(Var, im[0], start, count);
 
 					start[1]++;
 				}
 			}
+		};
+
+		if (pVL) {
+			// VL
+			OutputHandler::AttrValVec attrs3(3);
+			attrs3[0] = OutputHandler::AttrVal("units", "-");
+			attrs3[1] = OutputHandler::AttrVal("type", "doublereal");
+			attrs3[2] = OutputHandler::AttrVal("description", "VL - Left eigenvectors matrix");
+
+			std::stringstream varname_ss;
+			varname_ss << "eig." << uCurrEigSol << ".VL";
+			Var_Eig_dVL = OutHdl.CreateVar(varname_ss.str(), MbNcDouble, attrs3, dim_v);
+
+			WriteEigenvectors(Var_Eig_dVL, *pVL);
 		}
 
+		// VR
+		attrs3[0] = OutputHandler::AttrVal("units", "-");
+		attrs3[1] = OutputHandler::AttrVal("type", "doublereal");
+		attrs3[2] = OutputHandler::AttrVal("description", "VR - Right eigenvectors matrix");
+
+		varname_ss.str("");
+		varname_ss.clear();
+		varname_ss << "eig." << uCurrEigSol << ".VR";
+		Var_Eig_dVR = OutHdl.CreateVar(varname_ss.str(), MbNcDouble, attrs3, dim_v);
+
+		WriteEigenvectors(Var_Eig_dVR, VR);
 	}
 #endif /* USE_NETCDF */
 }
@@ -2352,6 +2347,10 @@ DataManager::Output(long lStep,
 
 	DriveTrace(OutHdl); // trace output will be written for every time step
 
+	if (pElemProf) {
+		pElemProf->Step(OutHdl.Profile(), lStep, dTime);
+	}
+
         /* output only when allowed by the output meter */
         if (!(force || bOutputNextStep)) {
                 return false;
@@ -2384,7 +2383,7 @@ DataManager::Output(long lStep,
 	OutHdl.IncCurrentStep();
 #ifdef USE_NETCDF
 	if (bNetCDFsync) {
-		OutHdl.pGetBinFile()->sync(); // only works with netcdf-cxx4 >= 4.3.0, check implemented in configure.ac (see also https://github.com/Unidata/netcdf-cxx4/commit/e013ab35f0219fff92ed8237d2f385e89fd1cf77#diff-59778321f93df82ff613be3e32d9a3ec)
+		OutHdl.NetCDFSync(); // only works with netcdf-cxx4 >= 4.3.0, check implemented in configure.ac (see also https://github.com/Unidata/netcdf-cxx4/commit/e013ab35f0219fff92ed8237d2f385e89fd1cf77#diff-59778321f93df82ff613be3e32d9a3ec)
 
 	}
 #endif /* USE_NETCDF */
@@ -2515,6 +2514,7 @@ DataManager::AfterConvergence(void) const
 	Elem* pEl = NULL;
 	if (ElemIter.bGetFirst(pEl)) {
 		do {
+			ElemProfiler::Sample ps(pElemProf, pEl, ElemProfiler::AFTERCONVERGENCE);
 			pEl->AfterConvergence(*pXCurr,
 				*pXPrimeCurr);
 		} while (ElemIter.bGetNext(pEl));
@@ -163,6 +163,7 @@ DataManager::ReadControl(MBDynParser& HP,
 		"finite" "difference" "jacobian" "meter",
                 "jacobian" "check",
 		"read" "solution" "array",
+		"read" "checkpoint",
 
 		"select" "timeout",
 		"model",
@@ -170,6 +171,8 @@ DataManager::ReadControl(MBDynParser& HP,
 		"rigid" "body" "kinematics",
                 
                 "use" "automatic" "differentiation",
+
+		"element" "profiling",
                 
 		0
 	};
@@ -262,11 +265,14 @@ DataManager::ReadControl(MBDynParser& HP,
                 JACOBIAN_CHECK,
 
 		READSOLUTIONARRAY,
+		READCHECKPOINT,
 
 		SELECTTIMEOUT,
 		MODEL,
 		RIGIDBODYKINEMATICS,
                 USE_AUTOMATIC_DIFFERENTIATION,
+
+		ELEMENTPROFILING,
                 
 		LASTKEYWORD
 	};
@@ -908,6 +914,11 @@ EndOfUse:
 							<< pdRestartTimes[0]
 							<< std::endl);
 					}
+				} else if (HP.IsKeyWord("binary" "checkpoint")) {
+					/* at the end of the simulation only */
+					RestartEvery = ATEND;
+					bCheckpoint = true;
+
 				} else {
 					silent_cerr("Error: unrecognized restart option at line "
 						<< HP.GetLineData() << std::endl);
@@ -921,6 +932,10 @@ EndOfUse:
 			if (HP.IsKeyWord("with" "solution" "array")) {
 				saveXSol = true;
 			}
+
+			if (HP.IsKeyWord("binary" "checkpoint")) {
+				bCheckpoint = true;
+			}
 			break;
 
 		case OUTPUTFILENAME:
@@ -1064,6 +1079,59 @@ EndOfUse:
 						bNetCDFnoText = true;
 #endif // USE_NETCDF
 					}
+					if (HP.IsKeyWord("buffer")) {
+						integer iSteps = HP.GetInt();
+						if (iSteps < 1) {
+							silent_cerr("invalid netcdf buffer size " << iSteps
+								<< " at line " << HP.GetLineData()
+								<< std::endl);
+							throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+
+						bool bWriterThread = false;
+						if (HP.IsKeyWord("writer" "thread")) {
+							bWriterThread = HP.GetYesNoOrBool();
+						}
+#ifdef USE_NETCDF
+						OutHdl.NetCDFSetBuffer(iSteps, bWriterThread);
+#else // ! USE_NETCDF
+						(void)bWriterThread;
+#endif // ! USE_NETCDF
+					}
+
+					integer iDeflateLevel = 0;
+					integer iChunkSteps = 0;
+					if (HP.IsKeyWord("deflate")) {
+						iDeflateLevel = HP.GetInt();
+						if (iDeflateLevel < 0 || iDeflateLevel > 9) {
+							silent_cerr("invalid netcdf deflate level " << iDeflateLevel
+								<< " at line " << HP.GetLineData()
+								<< "; must be between 0 and 9"
+								<< std::endl);
+							throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+					}
+					if (HP.IsKeyWord("chunk")) {
+						iChunkSteps = HP.GetInt();
+						if (iChunkSteps < 1) {
+							silent_cerr("invalid netcdf chunk size " << iChunkSteps
+								<< " at line " << HP.GetLineData()
+								<< std::endl);
+							throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+					}
+#ifdef USE_NETCDF
+					if ((iDeflateLevel > 0 || iChunkSteps > 0)
+						&& NetCDF_Format != netCDF::NcFile::nc4
+						&& NetCDF_Format != netCDF::NcFile::nc4classic)
+					{
+						silent_cerr("netcdf \"deflate\" and \"chunk\" "
+							"require \"nc4\" or \"nc4classic\" format; "
+							"ignored at line " << HP.GetLineData()
+							<< std::endl);
+					}
+					OutHdl.NetCDFSetCompression(iDeflateLevel, iChunkSteps);
+#endif // USE_NETCDF
 #ifndef USE_NETCDF
 					silent_cerr("\"netcdf\" ignored; please rebuild with NetCDF output enabled"
 						" at line " << HP.GetLineData() << std::endl);
@@ -1421,6 +1489,17 @@ EndOfUse:
 			snprintf(solArrFileName, len, "%s.X", sInputFileName);
 		} break;
 
+		case READCHECKPOINT:
+			/* default: the checkpoint written by this model */
+			sCheckpointFileName = OutHdl._sPutExt(".chk");
+			if (HP.IsArg() && HP.IsStringWithDelims()) {
+				sCheckpointFileName = HP.GetFileName();
+			}
+			if (HP.IsKeyWord("if" "exists")) {
+				bCheckpointOptional = true;
+			}
+			break;
+
 		case SELECTTIMEOUT:
 #ifdef USE_SOCKET
 			if (HP.IsKeyWord("forever")) {
@@ -1586,6 +1665,18 @@ EndOfUse:
                         DEBUGCERR("Support for automatic differentiation is enabled\n");
                         bAutoDiff = true;
                         break;
+
+		case ELEMENTPROFILING:
+			bElemProf = HP.GetYesNoOrBool();
+			if (HP.IsKeyWord("top")) {
+				uElemProfTopN = HP.GetInt(0, HighParser::range_ge<integer>(0));
+			}
+			if (HP.IsKeyWord("steps")) {
+				iElemProfSteps = HP.GetInt(0, HighParser::range_ge<integer>(0));
+			}
+			DEBUGLCOUT(MYDEBUG_INPUT, "element profiling: "
+				<< (bElemProf ? "yes" : "no") << std::endl);
+			break;
                         
 		case UNKNOWN:
 			/*
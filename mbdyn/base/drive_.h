@@ -49,6 +49,9 @@
 
 /* include del programma */
 #include "mathp.h"
+#ifndef DO_NOT_USE_EE
+#include "evaluator_prog.h"
+#endif // DO_NOT_USE_EE
 #include "output.h"
 #include "withlab.h"
 
@@ -70,10 +73,15 @@ private:
 	class SharedExpr : public std::enable_shared_from_this<SharedExpr> {
 	private:
 		const ExpressionElement *m_expr;
+		// flat version of m_expr, when it can be compiled
+		EE_Program m_prog;
 	public:
-		SharedExpr(const ExpressionElement *expr) : m_expr(expr) {};
+		SharedExpr(const ExpressionElement *expr) : m_expr(expr) { m_prog.Compile(m_expr); };
 		~SharedExpr(void) { delete m_expr; };
 		const ExpressionElement *Get(void) const { return m_expr; };
+		doublereal dEval(void) const {
+			return m_prog.bIsCompiled() ? m_prog.Eval() : m_expr->Eval().GetReal();
+		};
         	std::shared_ptr<const SharedExpr> pCopy(void) const { return shared_from_this(); };
 	};
 
@@ -116,7 +124,7 @@ StringDriveCaller::dGet(void) const
 #ifndef DO_NOT_USE_EE
 	doublereal val;
 	try {
-		val = m_expr->Get()->Eval().GetReal();
+		val = m_expr->dEval();
 	} catch (MBDynErrBase& e) {
 		silent_cerr("StringDriveCaller::dGet(): " << e.what() << std::endl);
 		throw e;
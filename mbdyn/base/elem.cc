@@ -35,6 +35,7 @@
 #include "elem.h"
 #include "gravity.h"
 #include "aerodyn.h"
+#include "hashmap.h"
 
 /* Elem - begin */
 
@@ -79,6 +80,21 @@ Elem::AssJac(VectorHandler& JacY,
      WorkMat.MultAddTo(JacY, Y);
 }
 
+SubVectorHandler&
+Elem::AssResJac(SubVectorHandler& WorkVec,
+	VariableSubMatrixHandler& WorkMat,
+	VariableSubMatrixHandler*& pJac,
+	doublereal dCoef,
+	const VectorHandler& XCurr,
+	const VectorHandler& XPrimeCurr)
+{
+	SubVectorHandler& ResVec = AssRes(WorkVec, dCoef, XCurr, XPrimeCurr);
+
+	pJac = &AssJac(WorkMat, dCoef, XCurr, XPrimeCurr);
+
+	return ResVec;
+}
+
 bool
 Elem::bInverseDynamics(void) const
 {
@@ -188,7 +204,7 @@ str2elemtype(const char *const s)
 /* Elem - end */
 
 /* database of registered element types */
-typedef std::map<std::string, ElemRead *, ltstrcase> ElemFuncMapType;
+typedef HashMap<std::string, ElemRead *, strcasehash, eqstrcase> ElemFuncMapType;
 static ElemFuncMapType ElemFuncMap;
 
 /* element parsing checkers */
@@ -80,6 +80,10 @@ class Elem : public WithLabel, public SimulationEntity, public ToBeOutput
 private:
 	unsigned m_uInverseDynamicsFlags;
 
+	/* posizioni dello jacobiano nella matrice compatta, usate
+	 * da DataManager::ElemAssJac */
+	SubMatrixScatterPlan m_JacScatterPlan;
+
 	/*
 	 * Tipi di Elem. Lasciare sempre UNKNOWN = -1, cosi' il primo elemento
 	 * ha tipo zero, e l'ultima entry dell'enum, LAST...TYPE, e' uguale
@@ -184,6 +188,11 @@ public:
 	/* Dimensioni del workspace */
 	virtual void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const = 0;
 
+	/* piano di assemblaggio dello jacobiano in una matrice compatta */
+	SubMatrixScatterPlan& GetJacScatterPlan(void) {
+		return m_JacScatterPlan;
+	};
+
 	/* assemblaggio matrici per autovalori */
 	virtual void
 	AssMats(VariableSubMatrixHandler& WorkMatA,
@@ -215,6 +224,21 @@ public:
                const VectorHandler& XPrimeCurr,
                VariableSubMatrixHandler& WorkMat);
 
+	/* assemblaggio congiunto di residuo e jacobiano nello stesso punto;
+	 * come AssRes() restituisce il residuo, mentre lo jacobiano
+	 * (come restituito da AssJac()) viene messo in pJac.
+	 * La versione di default chiama AssRes() e AssJac();
+	 * gli elementi che possono condividere i calcoli tra le due fasi
+	 * possono ridefinirla.  Se AssRes() solleva ChangedEquationStructure,
+	 * l'eccezione viene propagata con il residuo gia' in WorkVec */
+	virtual SubVectorHandler&
+	AssResJac(SubVectorHandler& WorkVec,
+		VariableSubMatrixHandler& WorkMat,
+		VariableSubMatrixHandler*& pJac,
+		doublereal dCoef,
+		const VectorHandler& XCurr,
+		const VectorHandler& XPrimeCurr);
+
 	/* inverse dynamics capable element */
 	virtual bool bInverseDynamics(void) const;
 
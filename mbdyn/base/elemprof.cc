@@ -0,0 +1,233 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "elemprof.h"
+#include "nestedelem.h"
+#include "userelem.h"
+
+ElemProfiler::Stats::Stats(void)
+{
+	for (unsigned i = 0; i < LASTPHASE; i++) {
+		dt[i] = Clock::duration::zero();
+		n[i] = 0;
+	}
+}
+
+ElemProfiler::Stats&
+ElemProfiler::Stats::operator += (const Stats& s)
+{
+	for (unsigned i = 0; i < LASTPHASE; i++) {
+		dt[i] += s.dt[i];
+		n[i] += s.n[i];
+	}
+
+	return *this;
+}
+
+ElemProfiler::Clock::duration
+ElemProfiler::Stats::Total(void) const
+{
+	Clock::duration d = Clock::duration::zero();
+	for (unsigned i = 0; i < LASTPHASE; i++) {
+		d += dt[i];
+	}
+
+	return d;
+}
+
+ElemProfiler::ElemProfiler(const std::vector<Elem *>& Elems,
+	unsigned uTopN, integer iSteps)
+: m_Elems(Elems.begin(), Elems.end()),
+m_uTopN(uTopN),
+m_iSteps(iSteps),
+m_iCurrStep(0)
+{
+	/* the map is never modified after this point,
+	 * so concurrent lookups are safe */
+	m_Stats.reserve(Elems.size());
+	for (std::vector<Elem *>::const_iterator i = Elems.begin();
+		i != Elems.end(); ++i)
+	{
+		m_Stats.insert(StatsMapType::value_type(*i, Stats()));
+	}
+}
+
+ElemProfiler::~ElemProfiler(void)
+{
+	NO_OP;
+}
+
+ElemProfiler::Stats *
+ElemProfiler::pGet(const Elem *pEl)
+{
+	StatsMapType::iterator i = m_Stats.find(pEl);
+	if (i == m_Stats.end()) {
+		return 0;
+	}
+
+	return &i->second;
+}
+
+void
+ElemProfiler::Step(std::ostream& out, long lStep, const doublereal& dTime) const
+{
+	if (m_iSteps <= 0) {
+		return;
+	}
+
+	if (++m_iCurrStep >= m_iSteps) {
+		m_iCurrStep = 0;
+		Report(out, lStep, dTime);
+	}
+}
+
+static const char *psPhaseNames[] = {
+	"AssRes",
+	"AssJac",
+	"AssResJac",
+	"Output",
+	"AfterConvergence",
+	0
+};
+
+struct ProfRecord {
+	std::string sName;
+	unsigned uCount;
+	ElemProfiler::Stats s;
+
+	ProfRecord(void) : uCount(0) { NO_OP; };
+};
+
+static bool
+ProfRecordGreater(const ProfRecord& a, const ProfRecord& b)
+{
+	return a.s.Total() > b.s.Total();
+}
+
+static void
+ProfPrint(std::ostream& out, const char *sKind,
+	std::vector<ProfRecord>& v, unsigned uMax)
+{
+	typedef std::chrono::duration<double> Seconds;
+
+	std::sort(v.begin(), v.end(), ProfRecordGreater);
+
+	if (uMax > v.size()) {
+		uMax = v.size();
+	}
+
+	for (unsigned r = 0; r < uMax; r++) {
+		const ProfRecord& pr = v[r];
+
+		out << sKind << " \"" << pr.sName << "\" " << pr.uCount
+			<< " " << Seconds(pr.s.Total()).count();
+		for (unsigned i = 0; i < ElemProfiler::LASTPHASE; i++) {
+			out << " " << pr.s.n[i] << " " << Seconds(pr.s.dt[i]).count();
+		}
+		out << std::endl;
+	}
+}
+
+void
+ElemProfiler::Report(std::ostream& out, long lStep, const doublereal& dTime) const
+{
+	std::vector<ProfRecord> Types(Elem::LASTELEMTYPE);
+	std::map<std::string, ProfRecord> Modules;
+	std::vector<ProfRecord> Labels;
+	Labels.reserve(m_Elems.size());
+
+	for (std::vector<const Elem *>::const_iterator i = m_Elems.begin();
+		i != m_Elems.end(); ++i)
+	{
+		const Elem *pEl = *i;
+		const Stats& s = m_Stats.find(pEl)->second;
+		Elem::Type t = pEl->GetElemType();
+
+		Types[t].uCount++;
+		Types[t].s += s;
+
+		/* user-defined elements may be wrapped */
+		const NestedElem *pNE = dynamic_cast<const NestedElem *>(pEl);
+		const UserDefinedElem *pUDE = dynamic_cast<const UserDefinedElem *>(pNE ? pNE->pGetElem() : pEl);
+		if (pUDE != 0 && !pUDE->GetModuleName().empty()) {
+			ProfRecord& m = Modules[pUDE->GetModuleName()];
+			m.uCount++;
+			m.s += s;
+		}
+
+		if (m_uTopN > 0) {
+			std::ostringstream os;
+			os << psElemNames[t] << "(" << pEl->GetLabel() << ")";
+
+			Labels.push_back(ProfRecord());
+			Labels.back().sName = os.str();
+			Labels.back().uCount = 1;
+			Labels.back().s = s;
+		}
+	}
+
+	std::vector<ProfRecord> TypesInUse;
+	for (unsigned t = 0; t < Types.size(); t++) {
+		if (Types[t].uCount > 0) {
+			TypesInUse.push_back(Types[t]);
+			TypesInUse.back().sName = psElemNames[t];
+		}
+	}
+
+	std::vector<ProfRecord> ModulesInUse;
+	for (std::map<std::string, ProfRecord>::const_iterator m = Modules.begin();
+		m != Modules.end(); ++m)
+	{
+		ModulesInUse.push_back(m->second);
+		ModulesInUse.back().sName = m->first;
+	}
+
+	out << "# step " << lStep << " time " << dTime << std::endl
+		<< "# kind, name, number of elements, total time [s],"
+		" then calls and time [s] of";
+	for (unsigned i = 0; i < LASTPHASE; i++) {
+		out << " " << psPhaseNames[i];
+	}
+	out << std::endl;
+
+	ProfPrint(out, "type", TypesInUse, TypesInUse.size());
+	ProfPrint(out, "module", ModulesInUse, ModulesInUse.size());
+	ProfPrint(out, "elem", Labels, m_uTopN);
+
+	out << std::endl;
+}
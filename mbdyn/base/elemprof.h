@@ -0,0 +1,126 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ELEMPROF_H
+#define ELEMPROF_H
+
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "elem.h"
+
+/* Element profiler - begin */
+
+/*
+ * Collects the wall time and the number of calls of the main element
+ * functions, one record per element.  Records are allocated once,
+ * before the simulation starts, so that each assembly thread only
+ * looks them up and updates the ones of the elements it processes;
+ * they are aggregated by element type, by user-defined module
+ * and by label only when a report is written.
+ */
+
+class ElemProfiler {
+public:
+	enum Phase {
+		ASSRES = 0,
+		ASSJAC,
+		ASSRESJAC,
+		OUTPUT,
+		AFTERCONVERGENCE,
+
+		LASTPHASE
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+	struct Stats {
+		Clock::duration dt[LASTPHASE];
+		unsigned long n[LASTPHASE];
+
+		Stats(void);
+		Stats& operator += (const Stats& s);
+		Clock::duration Total(void) const;
+	};
+
+protected:
+	typedef std::unordered_map<const Elem *, Stats> StatsMapType;
+	StatsMapType m_Stats;
+	std::vector<const Elem *> m_Elems;
+
+	unsigned m_uTopN;
+	integer m_iSteps;
+	mutable integer m_iCurrStep;
+
+	Stats *pGet(const Elem *pEl);
+
+public:
+	ElemProfiler(const std::vector<Elem *>& Elems,
+		unsigned uTopN, integer iSteps);
+	~ElemProfiler(void);
+
+	/* scoped sample of an element call; does nothing
+	 * when profiling is disabled (null profiler) */
+	class Sample {
+	protected:
+		Stats *m_pStats;
+		Phase m_Phase;
+		Clock::time_point m_Start;
+
+	public:
+		Sample(ElemProfiler *pProf, const Elem *pEl, Phase ph)
+		: m_pStats(pProf ? pProf->pGet(pEl) : 0), m_Phase(ph)
+		{
+			if (m_pStats) {
+				m_Start = Clock::now();
+			}
+		};
+
+		~Sample(void)
+		{
+			if (m_pStats) {
+				m_pStats->dt[m_Phase] += Clock::now() - m_Start;
+				m_pStats->n[m_Phase]++;
+			}
+		};
+	};
+
+	/* writes a report every m_iSteps calls, if m_iSteps > 0 */
+	void Step(std::ostream& out, long lStep, const doublereal& dTime) const;
+
+	void Report(std::ostream& out, long lStep, const doublereal& dTime) const;
+};
+
+/* Element profiler - end */
+
+#endif /* ELEMPROF_H */
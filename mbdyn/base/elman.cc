@@ -36,6 +36,7 @@
 #include <limits>
 
 #include "dataman.h"
+#include "spmh.h"
 #include "search.h"
 #include "gravity.h"
 #include "aerodyn.h"
@@ -474,13 +475,34 @@ DataManager::AssJac(MatrixHandler& JacHdl, doublereal dCoef,
 		}
 	}
 #endif
-	
+
+	ElemAssJac(JacHdl, dCoef, Iter, WorkMat);
+}
+
+/* Somma i contributi degli elementi senza azzerare la matrice */
+void
+DataManager::ElemAssJac(MatrixHandler& JacHdl, doublereal dCoef,
+		VecIter<Elem *> &Iter,
+		VariableSubMatrixHandler& WorkMat)
+{
+	/* le matrici compatte usano i piani di assemblaggio degli elementi */
+	CompactSparseMatrixHandler *pCSC
+		= dynamic_cast<CompactSparseMatrixHandler *>(&JacHdl);
+
 	Elem* pTmpEl = NULL;
 	if (Iter.bGetFirst(pTmpEl)) {
 		do {
 			try {
-				JacHdl += pTmpEl->AssJac(WorkMat, dCoef,
+				ElemProfiler::Sample ps(pElemProf, pTmpEl, ElemProfiler::ASSJAC);
+				const VariableSubMatrixHandler& WM
+					= pTmpEl->AssJac(WorkMat, dCoef,
 						*pXCurr, *pXPrimeCurr);
+				if (pCSC) {
+					WM.AddTo(*pCSC, pTmpEl->GetJacScatterPlan());
+
+				} else {
+					JacHdl += WM;
+				}
 			}
 			catch (ErrDivideByZero& e) {
 				silent_cerr("AssJac: divide by zero "
@@ -512,6 +534,7 @@ DataManager::AssJac(VectorHandler& JacY,
 	if (Iter.bGetFirst(pTmpEl)) {
 		do {
 			try {
+                             ElemProfiler::Sample ps(pElemProf, pTmpEl, ElemProfiler::ASSJAC);
                              pTmpEl->AssJac(JacY, Y, dCoef, *pXCurr, *pXPrimeCurr, WorkMat);
 			}
 			catch (ErrDivideByZero& e) {
@@ -597,6 +620,7 @@ DataManager::AssRes(VectorHandler& ResHdl, doublereal dCoef,
 	if (Iter.bGetFirst(pTmpEl)) {
 		do {
 			try {
+				ElemProfiler::Sample ps(pElemProf, pTmpEl, ElemProfiler::ASSRES);
 				ResHdl += pTmpEl->AssRes(WorkVec, dCoef,
 					*pXCurr, *pXPrimeCurr);
 				if (pAbsResHdl) WorkVec.AddAbsValuesTo(*pAbsResHdl);
@@ -626,6 +650,84 @@ DataManager::AssRes(VectorHandler& ResHdl, doublereal dCoef,
 	}
 }
 
+/* Assemblaggio congiunto di residuo e jacobiano */
+void
+DataManager::AssResJac(VectorHandler& ResHdl, MatrixHandler& JacHdl,
+	doublereal dCoef, VectorHandler*const pAbsResHdl)
+{
+	DEBUGCOUT("Entering DataManager::AssResJac()" << std::endl);
+
+	ASSERT(pWorkMat != NULL);
+	ASSERT(pWorkVec != NULL);
+
+	NodesUpdateJac(dCoef, NodeIter);
+
+	JacHdl.Reset();
+
+	AssResJac(ResHdl, JacHdl, dCoef, ElemIter, *pWorkVec, *pWorkMat,
+		pAbsResHdl);
+}
+
+void
+DataManager::AssResJac(VectorHandler& ResHdl, MatrixHandler& JacHdl,
+		doublereal dCoef,
+		VecIter<Elem *> &Iter,
+		SubVectorHandler& WorkVec,
+		VariableSubMatrixHandler& WorkMat,
+		VectorHandler*const pAbsResHdl)
+{
+	/* le matrici compatte usano i piani di assemblaggio degli elementi */
+	CompactSparseMatrixHandler *pCSC
+		= dynamic_cast<CompactSparseMatrixHandler *>(&JacHdl);
+
+	Elem* pTmpEl = NULL;
+	bool ChangedEqStructure(false);
+	if (Iter.bGetFirst(pTmpEl)) {
+		do {
+			try {
+				ElemProfiler::Sample ps(pElemProf, pTmpEl, ElemProfiler::ASSRESJAC);
+				VariableSubMatrixHandler *pWM = 0;
+
+				try {
+					const SubVectorHandler& ResVec
+						= pTmpEl->AssResJac(WorkVec, WorkMat,
+							pWM, dCoef,
+							*pXCurr, *pXPrimeCurr);
+					ResHdl += ResVec;
+					if (pAbsResHdl) ResVec.AddAbsValuesTo(*pAbsResHdl);
+				}
+				catch (Elem::ChangedEquationStructure& e) {
+					/* il residuo e' valido; lo jacobiano
+					 * viene assemblato a parte */
+					ResHdl += WorkVec;
+					if (pAbsResHdl) WorkVec.AddAbsValuesTo(*pAbsResHdl);
+					ChangedEqStructure = true;
+
+					pWM = &pTmpEl->AssJac(WorkMat, dCoef,
+						*pXCurr, *pXPrimeCurr);
+				}
+
+				if (pCSC) {
+					pWM->AddTo(*pCSC, pTmpEl->GetJacScatterPlan());
+
+				} else {
+					JacHdl += *pWM;
+				}
+			}
+			catch (ErrDivideByZero& e) {
+				silent_cerr("AssResJac: divide by zero "
+					"in " << psElemNames[pTmpEl->GetElemType()]
+					<< "(" << pTmpEl->GetLabel() << ")"
+					<< std::endl);
+				throw ErrDivideByZero(MBDYN_EXCEPT_ARGS);
+			}
+		} while (Iter.bGetNext(pTmpEl));
+	}
+	if (ChangedEqStructure) {
+		throw ChangedEquationStructure(MBDYN_EXCEPT_ARGS);
+	}
+}
+
 void
 DataManager::SetElemDimensionIndices(std::map<OutputHandler::Dimensions, std::set<integer>>* pDimMap) {
 	Elem* pTmpEl = NULL;
@@ -743,6 +845,7 @@ DataManager::ElemOutput(OutputHandler& OH) const
 
 	if (ElemIter.bGetFirst(pTmpEl)) {
 		do {
+			ElemProfiler::Sample ps(pElemProf, pTmpEl, ElemProfiler::OUTPUT);
 			pTmpEl->Output(OH);
 		} while (ElemIter.bGetNext(pTmpEl));
 	}
@@ -756,6 +859,7 @@ DataManager::ElemOutput( OutputHandler& OH, const VectorHandler& X,
 
 	if (ElemIter.bGetFirst(pTmpEl)) {
 		do {
+			ElemProfiler::Sample ps(pElemProf, pTmpEl, ElemProfiler::OUTPUT);
 			pTmpEl->Output(OH, X, XP);
 		} while (ElemIter.bGetNext(pTmpEl));
 	}
@@ -766,18 +870,19 @@ Elem *
 DataManager::pFindElem(Elem::Type Typ, unsigned int uL) const
 {
 	if (ElemData[Typ].bIsUnique() && uL == (unsigned)(-1)) {
-		if (!ElemData[Typ].ElemMapToList.empty()) {
-			return ElemData[Typ].ElemMapToList.begin()->second->second;
+		KeyElemPair *p = ElemData[Typ].ElemMapToList.first();
+		if (p != 0) {
+			return p->second;
 		}
 		return 0;
 	}
 
-	ElemMapToListType::const_iterator p = ElemData[Typ].ElemMapToList.find(uL);
-	if (p == ElemData[Typ].ElemMapToList.end()) {
+	KeyElemPair *p = ElemData[Typ].ElemMapToList.find(uL);
+	if (p == 0) {
 		return 0;
 	}
 
-	return p->second->second;
+	return p->second;
 }
 
 
@@ -786,20 +891,21 @@ Elem **
 DataManager::ppFindElem(Elem::Type Typ, unsigned int uL) const
 {
 	if (ElemData[Typ].bIsUnique() && uL == (unsigned)(-1)) {
-		if (!ElemData[Typ].ElemMapToList.empty()) {
-			return &ElemData[Typ].ElemMapToList.begin()->second->second;
+		KeyElemPair *p = ElemData[Typ].ElemMapToList.first();
+		if (p != 0) {
+			return &p->second;
 		}
 		return 0;
 	}
 
 	ASSERT(uL > 0);
 
-	ElemMapToListType::const_iterator p = ElemData[Typ].ElemMapToList.find(uL);
-	if (p == ElemData[Typ].ElemMapToList.end()) {
+	KeyElemPair *p = ElemData[Typ].ElemMapToList.find(uL);
+	if (p == 0) {
 		return 0;
 	}
 
-	return const_cast<Elem **>(&p->second->second);
+	return &p->second;
 }
 
 /* cerca un elemento qualsiasi */
@@ -810,20 +916,21 @@ DataManager::pFindElem(Elem::Type Typ, unsigned int uL,
 	ASSERT(iDeriv == int(ELEM) || ElemData[Typ].iDerivation & iDeriv);
 
 	if (ElemData[Typ].bIsUnique() && uL == (unsigned)(-1)) {
-		if (!ElemData[Typ].ElemMapToList.empty()) {
-			return pChooseElem(ElemData[Typ].ElemMapToList.begin()->second->second, iDeriv);
+		KeyElemPair *p = ElemData[Typ].ElemMapToList.first();
+		if (p != 0) {
+			return pChooseElem(p->second, iDeriv);
 		}
 		return 0;
 	}
 
 	ASSERT(uL > 0);
 
-	ElemMapToListType::const_iterator p = ElemData[Typ].ElemMapToList.find(uL);
-	if (p == ElemData[Typ].ElemMapToList.end()) {
+	KeyElemPair *p = ElemData[Typ].ElemMapToList.find(uL);
+	if (p == 0) {
 		return 0;
 	}
 
-	return pChooseElem(p->second->second, iDeriv);
+	return pChooseElem(p->second, iDeriv);
 }
 
 /* Usata dalle due funzioni precedenti */
@@ -35,6 +35,7 @@
 #include "extforce.h"
 #include "extedge.h"
 #include "extsocket.h"
+#include "extshm.h"
 #include "except.h"
 #include "solver.h"
 
@@ -107,6 +108,26 @@ ExtFileHandlerBase::GetRecvFlags(void) const
 	// return 0;
 }
 
+ssize_t
+ExtFileHandlerBase::SendN(const char *buf, size_t len, int flags)
+{
+#ifdef USE_SOCKET
+	return sendn(GetOutFileDes(), buf, len, flags);
+#else // ! USE_SOCKET
+	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+#endif // ! USE_SOCKET
+}
+
+ssize_t
+ExtFileHandlerBase::RecvN(char *buf, size_t len, int flags)
+{
+#ifdef USE_SOCKET
+	return recvn(GetInFileDes(), buf, len, flags);
+#else // ! USE_SOCKET
+	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+#endif // ! USE_SOCKET
+}
+
 /* ExtFileHandlerBase - end */
 
 /* ExtFileHandler - begin */
@@ -648,6 +669,9 @@ ReadExtFileHandler(DataManager* pDM,
 
 	} else if (HP.IsKeyWord("socket")) {
 		return ReadExtSocketHandler(pDM, HP, uLabel);
+
+	} else if (HP.IsKeyWord("shared" "memory")) {
+		return ReadExtShmHandler(pDM, HP, uLabel);
 	} else {
 	    silent_cerr("ExtForce(" << uLabel << "): "
 			"unrecognised communicator type "
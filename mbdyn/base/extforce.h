@@ -76,6 +76,7 @@ public:
 	    TYPE_FILE,
 	    TYPE_SOCKET,
 	    TYPE_EDGE,
+	    TYPE_SHM,
 	};
 
 protected:
@@ -112,6 +113,10 @@ public:
 	virtual int GetSendFlags(void) const;
 	virtual int GetInFileDes(void);
 	virtual int GetRecvFlags(void) const;
+
+	// binary data exchange; by default, sendn()/recvn() on the file descriptors
+	virtual ssize_t SendN(const char *buf, size_t len, int flags);
+	virtual ssize_t RecvN(char *buf, size_t len, int flags);
 };
 
 /* ExtFileHandlerBase - end */
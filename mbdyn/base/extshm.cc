@@ -0,0 +1,292 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <cerrno>
+#include <cstring>
+
+#include "dataman.h"
+#include "solver.h"
+#include "extshm.h"
+
+ExtShmHandler::ExtShmHandler(const std::string& name, size_t size,
+	mbsleep_t SleepTime)
+: ExtRemoteHandler(SleepTime, true, false),
+name(name), pShm(nullptr)
+{
+	int err = 0;
+
+	pShm = mbc_shm_create(name.c_str(), size, &err);
+	if (pShm == nullptr) {
+		silent_cerr("ExtShmHandler: unable to create shared memory "
+			"\"" << name << "\" "
+			"(" << err << ": " << strerror(err) << ")"
+			<< std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+ExtShmHandler::~ExtShmHandler(void)
+{
+	uint8_t u = ES_ABORT;
+
+	// ignore result
+	(void)mbc_shm_sendn(pShm, (const char *)&u, sizeof(u));
+
+	mbc_shm_close(pShm);
+}
+
+bool
+ExtShmHandler::SendCmd(uint8_t u, const char *what)
+{
+	ssize_t rc = mbc_shm_sendn(pShm, (const char *)&u, sizeof(u));
+	if (rc != sizeof(u)) {
+		int save_errno = errno;
+		silent_cerr("ExtShmHandler: " << what << " send failed "
+			"(" << save_errno << ": " << strerror(save_errno) << ")"
+			<< std::endl);
+		return false;
+	}
+
+	return true;
+}
+
+bool
+ExtShmHandler::RecvCmd(uint8_t& u, int flags, const char *what)
+{
+	ssize_t rc = mbc_shm_recvn(pShm, (char *)&u, sizeof(u), flags);
+	if (rc != sizeof(u)) {
+		if (rc == -1 && errno == EAGAIN) {
+			return false;
+		}
+
+		silent_cerr("ExtShmHandler: " << what << " recv failed "
+			"(peer gone)" << std::endl);
+		return false;
+	}
+
+	return true;
+}
+
+ExtFileHandlerBase::Negotiate
+ExtShmHandler::NegotiateRequest(void) const
+{
+	// MBDyn creates the segment and the peer attaches to it,
+	// so the peer requests the negotiation
+	return ExtFileHandlerBase::NEGOTIATE_SERVER;
+}
+
+bool
+ExtShmHandler::Prepare_pre(void)
+{
+	uint8_t u;
+
+	if (!RecvCmd(u, 0, "negotiation request")) {
+		return (bOK = false);
+	}
+
+	if (u != ES_NEGOTIATION) {
+		silent_cerr("ExtShmHandler: unexpected negotiation request "
+			"(" << unsigned(u) << ")" << std::endl);
+		return (bOK = false);
+	}
+
+	return true;
+}
+
+void
+ExtShmHandler::Prepare_post(bool ok)
+{
+	if (!SendCmd(ok ? ES_OK : ES_ABORT, "negotiation response")) {
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+void
+ExtShmHandler::AfterPredict(void)
+{
+	bLastReadForce = false;
+	bReadForces = true;
+}
+
+bool
+ExtShmHandler::Send_pre(SendWhen when)
+{
+	if (!bReadForces || !bOK) {
+		return false;
+	}
+
+	uint8_t u;
+	if (when == SEND_AFTER_CONVERGENCE) {
+		u = ES_REGULAR_DATA_AND_GOTO_NEXT_STEP;
+	} else {
+		u = ES_REGULAR_DATA;
+	}
+
+	if (!SendCmd(u, "command")) {
+		mbdyn_set_stop_at_end_of_iteration();
+		return (bOK = false);
+	}
+
+	return true;
+}
+
+void
+ExtShmHandler::Send_post(SendWhen when)
+{
+	NO_OP;
+}
+
+bool
+ExtShmHandler::Recv_pre(void)
+{
+	if (!bReadForces) {
+		return false;
+	}
+
+	uint8_t u = 0;
+
+	if (SleepTime != 0) {
+		// poll, so that the simulation can be interrupted
+		for ( ; ; ) {
+			ssize_t rc = mbc_shm_recvn(pShm, (char *)&u, sizeof(u), MBC_SHM_DONTWAIT);
+			if (rc == sizeof(u)) {
+				break;
+			}
+
+			if (rc != -1 || errno != EAGAIN) {
+				silent_cerr("ExtShmHandler: recv failed (peer gone)" << std::endl);
+				mbdyn_set_stop_at_end_of_iteration();
+				return (bOK = false);
+			}
+
+			if (mbdyn_stop_at_end_of_iteration()) {
+				return (bOK = false);
+			}
+
+			mbsleep(&SleepTime);
+		}
+
+	} else if (!RecvCmd(u, 0, "command")) {
+		mbdyn_set_stop_at_end_of_iteration();
+		return (bOK = false);
+	}
+
+	return ActOnCmd(u);
+}
+
+// socket flags are meaningless here
+int
+ExtShmHandler::GetSendFlags(void) const
+{
+	return 0;
+}
+
+int
+ExtShmHandler::GetRecvFlags(void) const
+{
+	return 0;
+}
+
+ssize_t
+ExtShmHandler::SendN(const char *buf, size_t len, int flags)
+{
+	return mbc_shm_sendn(pShm, buf, len);
+}
+
+ssize_t
+ExtShmHandler::RecvN(char *buf, size_t len, int flags)
+{
+	return mbc_shm_recvn(pShm, buf, len, 0);
+}
+
+ExtFileHandlerBase *
+ReadExtShmHandler(DataManager* pDM,
+	MBDynParser& HP,
+	unsigned int uLabel)
+{
+#ifdef USE_SHM
+	if (!HP.IsKeyWord("name")) {
+		silent_cerr("ExtShmHandler"
+			"(" << uLabel << "): "
+			"keyword \"name\" expected "
+			"at line " << HP.GetLineData()
+			<< std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	const char *s = HP.GetStringWithDelims();
+	if (s == 0 || s[0] == '\0') {
+		silent_cerr("ExtShmHandler"
+			"(" << uLabel << "): "
+			"unable to read shared memory name "
+			"at line " << HP.GetLineData()
+			<< std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	std::string name(s);
+	if (name[0] != '/') {
+		// shm_open(3) wants a leading slash
+		name.insert(0, 1, '/');
+	}
+
+	size_t size = 0;
+	if (HP.IsKeyWord("size")) {
+		integer i = HP.GetInt();
+		if (i <= 0) {
+			silent_cerr("ExtShmHandler"
+				"(" << uLabel << "): "
+				"invalid size " << i << " "
+				"at line " << HP.GetLineData()
+				<< std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		size = i;
+	}
+
+	mbsleep_t SleepTime = mbsleep_init(0);
+	std::streamsize Precision = 0;
+	ReadExtFileParams(pDM, HP, uLabel, SleepTime, Precision);
+	// NOTE: precision is ignored
+
+	ExtFileHandlerBase *pEFH = 0;
+	SAFENEWWITHCONSTRUCTOR(pEFH, ExtShmHandler,
+		ExtShmHandler(name, size, SleepTime));
+
+	return pEFH;
+#else // ! USE_SHM
+	silent_cerr("ExtShmHandler(" << uLabel << "): "
+		"shared memory not supported" << std::endl);
+	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+#endif // ! USE_SHM
+}
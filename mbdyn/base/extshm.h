@@ -0,0 +1,92 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EXTSHM_H
+#define EXTSHM_H
+
+#include <mbconfig.h>
+
+#include <string>
+
+#include "extforce.h"
+#include "shm.h"
+
+/* ExtShmHandler - begin */
+
+/** Shared memory communicator.
+ *
+ * Same protocol as ExtSocketHandler, but exchanged through
+ * the lock-free ring buffers of a POSIX shared memory segment
+ * (see libmbc's shm.h), which avoids a system call and a copy
+ * per message when both peers run on the same host.
+ */
+class ExtShmHandler : public ExtRemoteHandler {
+protected:
+	std::string name;
+	mbc_shm_t *pShm;
+
+	bool SendCmd(uint8_t u, const char *what);
+	bool RecvCmd(uint8_t& u, int flags, const char *what);
+
+public:
+	ExtShmHandler(const std::string& name, size_t size, mbsleep_t SleepTime);
+	virtual ~ExtShmHandler(void);
+
+	virtual bool Prepare_pre(void);
+	virtual Negotiate NegotiateRequest(void) const;
+	virtual void Prepare_post(bool ok);
+
+	virtual void AfterPredict(void);
+
+	virtual bool Send_pre(SendWhen when);
+	virtual void Send_post(SendWhen when);
+
+	virtual bool Recv_pre(void);
+
+	virtual ExtFileHandlerBase::Type GetType(void) { return ExtFileHandlerBase::TYPE_SHM; };
+
+	virtual int GetSendFlags(void) const;
+	virtual int GetRecvFlags(void) const;
+	virtual ssize_t SendN(const char *buf, size_t len, int flags);
+	virtual ssize_t RecvN(char *buf, size_t len, int flags);
+};
+
+/* ExtShmHandler - end */
+
+class DataManager;
+class MBDynParser;
+
+extern ExtFileHandlerBase *
+ReadExtShmHandler(DataManager* pDM,
+	MBDynParser& HP,
+	unsigned int uLabel);
+
+#endif // EXTSHM_H
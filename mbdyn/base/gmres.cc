@@ -56,12 +56,14 @@
 
 Gmres::Gmres(const Preconditioner::PrecondType PType, 
 		const integer iPStep,
+		const Preconditioner::Param& PParam,
 		doublereal ITol,
 		integer MaxIt,
 		doublereal etaMx,
 		doublereal T,
+		bool bFDProd,
 		const NonlinearSolverTestOptions& options)
-: MatrixFreeSolver(PType, iPStep, ITol, MaxIt, etaMx, T, options),
+: MatrixFreeSolver(PType, iPStep, PParam, ITol, MaxIt, etaMx, T, bFDProd, options),
 v(NULL),
 s(MaxLinIt + 1), cs(MaxLinIt + 1), sn(MaxLinIt + 1)
 {
@@ -182,6 +184,8 @@ Gmres::Solve(const NonlinearProblem* pNLP,
 
 	doublereal dOldErr = 0.;
 	doublereal dErrFactor = 1.;
+	bool bResConverged = pGetResTest()->GetType() == NonlinearSolverTest::NONE;
+	bool bSolConverged = pGetSolTest()->GetType() == NonlinearSolverTest::NONE;
 	while (true) {
 
 #ifdef 	USE_EXTERNAL 	
@@ -204,7 +208,7 @@ Gmres::Solve(const NonlinearProblem* pNLP,
 			pS->PrintResidual(*pRes, iIterCnt);
       		}
 
-		bool bTest = MakeResTest(pS, pNLP, *pRes, Tol, dErr, dErrDiff);
+		bResConverged = MakeResTest(pS, pNLP, *pRes, Tol, dErr, dErrDiff);
 		if (iIterCnt > 0) {
 			dErrFactor *= dErr/dOldErr;
 		}
@@ -220,7 +224,7 @@ Gmres::Solve(const NonlinearProblem* pNLP,
 #endif /* USE_MPI */
 			{
 				silent_cout("\tIteration(" << iIterCnt << ") " << dErr);
-				if (bBuildMat && !bTest) {
+				if (bBuildMat && !bResConverged) {
 					silent_cout(" J");
 				}
 				silent_cout(std::endl);
@@ -229,7 +233,7 @@ Gmres::Solve(const NonlinearProblem* pNLP,
 		
 		pS->CheckTimeStepLimit(dErr, dErrDiff);
 
-		if (bTest) {
+		if (bResConverged && bSolConverged) {
 	 		return;
       		}
       		if (!std::isfinite(dErr)) {
@@ -273,28 +277,8 @@ Gmres::Solve(const NonlinearProblem* pNLP,
 		dx.Reset();
 		
 		if (bBuildMat) {
-			pSM->MatrReset();
-
-rebuild_matrix:;
-			try {
-      				pNLP->Jacobian(pSM->pMatHdl());
-
-			} catch (MatrixHandler::ErrRebuildMatrix& e) {
-				silent_cout("NewtonRaphsonSolver: "
-						"rebuilding matrix..."
-						<< std::endl);
-
-				/* need to rebuild the matrix... */
-      				pSM->MatrInitialize();
-				goto rebuild_matrix;
-
-			} catch (...) {
-				throw;
-			}
-
-			bBuildMat = false;
+			BuildPrecond(pNLP, pSM);
 			TotalIter = 0;
-			TotJac++;
 			
 #ifdef DEBUG_ITERATIVE
 			std::cerr << "Jacobian " << std::endl;
@@ -329,7 +313,7 @@ rebuild_matrix:;
 			}
 #endif /* DEBUG_ITERATIVE */
 
-			pNLP->EvalProd(Tau, *pr, vHat, w);
+			JacobianProd(pNLP, *pr, vHat, w);
 			
 #if 0
 			(pSM->pMatHdl())->MatVecMul(w, vHat);
@@ -466,7 +450,7 @@ rebuild_matrix:;
 
 		/* se ha impiegato troppi passi riassembla lo jacobiano */
 		
-		if (TotalIter >= PrecondIter) {
+		if (bRebuildPrecond(i, TotalIter)) {
 			bBuildMat = true;
 		}
 		/* calcola il nuovo eta */
@@ -490,7 +474,7 @@ rebuild_matrix:;
 		
       		pNLP->Update(&dx);
 		
-		bTest = MakeSolTest(pS, dx, SolTol, dSolErr);
+		bSolConverged = MakeSolTest(pS, dx, SolTol, dSolErr);
 		if (outputIters()) {
 #ifdef USE_MPI
 			if (!bParallel || MBDynComm.Get_rank() == 0)
@@ -501,7 +485,7 @@ rebuild_matrix:;
 			}
 		}
 
-       		if (bTest) {
+       		if (bResConverged && bSolConverged) {
 			throw ConvergenceOnSolution(MBDYN_EXCEPT_ARGS);
       		}
 
@@ -53,10 +53,12 @@ private:
 public:
 	Gmres(const Preconditioner::PrecondType PType, 
 			const integer iPStep,
+			const Preconditioner::Param& PParam,
 			doublereal ITol,
 			integer MaxIt,
 			doublereal etaMx,
 			doublereal T,
+			bool bFDProd,
 			const NonlinearSolverTestOptions& options);
 	
 	~Gmres(void);
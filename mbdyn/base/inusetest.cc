@@ -48,6 +48,8 @@
 
 unsigned dst = 100;
 unsigned rst = 10;
+bool bChunk = false;
+MT_ChunkSchedule schedule;
 
 class A : public InUse {
 private:
@@ -81,6 +83,7 @@ struct Arg {
 	pthread_t t;
 	sem_t s;
 	MT_VecIter<A *> i;
+	MT_ChunkVecIter<A *> ci;
 	unsigned *c;
 };
 
@@ -114,7 +117,11 @@ f(void *p)
 			break;
 		}
 
-		f2(arg->i, arg->n, arg->cnt);
+		if (bChunk) {
+			f2(arg->ci, arg->n, arg->cnt);
+		} else {
+			f2(arg->i, arg->n, arg->cnt);
+		}
 
 		pthread_mutex_lock(&mutex);
 		--*(arg->c);
@@ -146,7 +153,8 @@ usage:;
 			s = argv[0];
 		}
 
-		std::cout << "usage: " << s << " [lnsSt]" << std::endl
+		std::cout << "usage: " << s << " [clnsSt]" << std::endl
+			<< "\t-c (use cost-aware chunks)" << std::endl
 			//<< "\t-l <loops>" << std::endl
 			<< "\t-n <size>" << std::endl
 			<< "\t-s <sleeptime>" << std::endl
@@ -157,14 +165,18 @@ usage:;
 
 	while (true) {
 		char	*next;
-		//int	opt = getopt(argc, argv, "l:n:s:S:t:");
-		int	opt = getopt(argc, argv, "n:s:S:t:");
+		//int	opt = getopt(argc, argv, "cl:n:s:S:t:");
+		int	opt = getopt(argc, argv, "cn:s:S:t:");
 
 		if (opt == EOF) {
 			break;
 		}
 
 		switch (opt) {
+		case 'c':
+			bChunk = true;
+			break;
+
 // 		case 'l':
 // 			loops = strtoul(optarg, &next, 10);
 // 			break;
@@ -203,9 +215,12 @@ usage:;
 		ppA[i] = new A(i);
 	}
 
+	schedule.Init(size, nt);
+
 	for (unsigned i = 0; i < nt; i++) {
 		arg[i].n = i;
 		arg[i].i.Init(ppA, size);
+		arg[i].ci.Init(ppA, size, &schedule);
 		arg[i].c = &c;
 		arg[i].cnt = 0;
 		arg[i].stop = false;
@@ -217,14 +232,22 @@ usage:;
 	}
 
 	for (unsigned k = 0; k < 10; k++) {
-		arg[0].i.ResetAccessData();
+		if (bChunk) {
+			schedule.Reset();
+		} else {
+			arg[0].i.ResetAccessData();
+		}
 		c = nt - 1;
 
 		for (unsigned i = 1; i < nt; i++) {
 			sem_post(&arg[i].s);
 		}
 
-		f2(arg[0].i, arg[0].n, arg[0].cnt);
+		if (bChunk) {
+			f2(arg[0].ci, arg[0].n, arg[0].cnt);
+		} else {
+			f2(arg[0].i, arg[0].n, arg[0].cnt);
+		}
 
 		if (nt > 1) {
 			pthread_mutex_lock(&mutex);
@@ -236,6 +259,10 @@ usage:;
 			pthread_mutex_unlock(&mutex);
 		}
 
+		if (bChunk) {
+			schedule.Rebalance();
+		}
+
 		c = arg[0].cnt;
 		fprintf(stderr, "cnt = {%u", arg[0].cnt);
 		for (unsigned i = 1; i < nt; i++) {
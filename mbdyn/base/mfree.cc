@@ -39,18 +39,23 @@
   
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
+#include <algorithm>
+
 #include "precond_.h"
 #include "mfree.h"
 
 const doublereal defaultGamma = 0.9;
+const doublereal defaultRebuildRatio = 2.;
 
 MatrixFreeSolver::MatrixFreeSolver(
 		const Preconditioner::PrecondType PType, 
 		const integer iPStep,
+		const Preconditioner::Param& PParam,
 		doublereal ITol,
 		integer MaxIt,
 		doublereal etaMx,
 		doublereal T,
+		bool bFDProd,
 		const NonlinearSolverTestOptions& options)
 : NonlinearSolver(options),
 pPM(NULL),
@@ -61,6 +66,9 @@ Tau(T),
 gamma(defaultGamma),
 etaMax(etaMx),
 PrecondIter(iPStep),
+dRebuildRatio(PParam.dRebuildRatio),
+iRefLinIter(-1),
+bFDJacProd(bFDProd),
 bBuildMat(true),
 pPrevNLP(NULL)
 {
@@ -68,6 +76,21 @@ pPrevNLP(NULL)
 	switch(PType) {
 	case Preconditioner::FULLJACOBIANMATRIX:
 		SAFENEW(pPM, FullJacobianPr);
+		/* the preconditioner is the exact inverse */
+		if (dRebuildRatio < 0.) {
+			dRebuildRatio = 0.;
+		}
+		break;
+
+	case Preconditioner::ILU:
+	case Preconditioner::ILUT:
+		SAFENEWWITHCONSTRUCTOR(pPM, IncompleteLUPr,
+			IncompleteLUPr(PType, PParam));
+		break;
+
+	case Preconditioner::BLOCKJACOBI:
+		SAFENEWWITHCONSTRUCTOR(pPM, BlockJacobiPr,
+			BlockJacobiPr(PParam));
 		break;
 	
 	default:
@@ -75,6 +98,10 @@ pPrevNLP(NULL)
 			<< std::endl);
 		throw ErrGeneric(MBDYN_EXCEPT_ARGS); 
 	}
+
+	if (dRebuildRatio < 0.) {
+		dRebuildRatio = defaultRebuildRatio;
+	}
 }
 
 MatrixFreeSolver::~MatrixFreeSolver(void)
@@ -85,3 +112,70 @@ MatrixFreeSolver::~MatrixFreeSolver(void)
 	}
 }
 
+void
+MatrixFreeSolver::BuildPrecond(const NonlinearProblem* pNLP,
+	SolutionManager* pSM)
+{
+	pSM->MatrReset();
+
+rebuild_matrix:;
+	try {
+		pNLP->Jacobian(pSM->pMatHdl());
+
+	} catch (MatrixHandler::ErrRebuildMatrix& e) {
+		silent_cout("MatrixFreeSolver: "
+				"rebuilding matrix..."
+				<< std::endl);
+
+		/* need to rebuild the matrix... */
+		pSM->MatrInitialize();
+		goto rebuild_matrix;
+	}
+
+	pPM->Build(pSM);
+
+	bBuildMat = false;
+	iRefLinIter = -1;
+	TotJac++;
+}
+
+static const integer iMinRefLinIter = 4;
+
+bool
+MatrixFreeSolver::bRebuildPrecond(integer iLinIter, integer iTotalIter)
+{
+	if (dRebuildRatio <= 0.) {
+		return iTotalIter >= PrecondIter;
+	}
+
+	/* with the ratio rule, zero steps means no cap */
+	if (PrecondIter > 0 && iTotalIter >= PrecondIter) {
+		return true;
+	}
+
+	/* the first solve after a rebuild sets the reference;
+	 * a few inner iterations are always cheaper than a rebuild,
+	 * so an almost exact preconditioner is not refreshed
+	 * on negligible fluctuations */
+	if (iRefLinIter < 0) {
+		iRefLinIter = std::max(iLinIter, iMinRefLinIter);
+		return false;
+	}
+
+	return iLinIter > dRebuildRatio*iRefLinIter;
+}
+
+void
+MatrixFreeSolver::JacobianProd(const NonlinearProblem* pNLP,
+	const VectorHandler& f0,
+	const VectorHandler& w,
+	VectorHandler& z) const
+{
+	if (bFDJacProd) {
+		pNLP->EvalProd(Tau, f0, w, z);
+
+	} else {
+		/* z is reset by the data manager */
+		pNLP->Jacobian(&z, &w);
+	}
+}
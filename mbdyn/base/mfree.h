@@ -67,16 +67,36 @@ protected:
 	doublereal gamma;
 	doublereal etaMax; 
 	integer PrecondIter; 
+	doublereal dRebuildRatio;
+	integer iRefLinIter;
+	bool bFDJacProd;
 	bool bBuildMat;
 	const NonlinearProblem* pPrevNLP;
+
+	/* assembles the Jacobian matrix and builds the preconditioner */
+	void BuildPrecond(const NonlinearProblem* pNLP, SolutionManager* pSM);
+
+	/* true when the preconditioner needs be rebuilt after a linear
+	 * solve that took iLinIter inner iterations, iTotalIter since
+	 * the last rebuild */
+	bool bRebuildPrecond(integer iLinIter, integer iTotalIter);
+
+	/* z = J * w, either with the Jacobian vector product
+	 * of the elements or by finite differences about f0 */
+	void JacobianProd(const NonlinearProblem* pNLP,
+			const VectorHandler& f0,
+			const VectorHandler& w,
+			VectorHandler& z) const;
 	
 public:
 	MatrixFreeSolver(const Preconditioner::PrecondType PType, 
 			const integer iPStep,
+			const Preconditioner::Param& PParam,
 			doublereal ITol,
 			integer MaxIt,
 			doublereal etaMx,
 			doublereal T,
+			bool bFDProd,
 			const NonlinearSolverTestOptions& options);
 
 	~MatrixFreeSolver(void);
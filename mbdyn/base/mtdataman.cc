@@ -55,10 +55,12 @@ extern "C" {
 }
 
 #include <cerrno>
+#include <algorithm>
 
 #include "mtdataman.h"
 #include "spmapmh.h"
-#include "task2cpu.h"
+#include "spcoomh.h"
+#include "threadpool.h"
 
 #ifdef USE_NAIVE_MULTITHREAD
 static inline void
@@ -74,40 +76,43 @@ do_unlock(AO_TS_t *p)
 }
 
 static void
-naivepsad(doublereal **ga, integer **gri,
-                integer *gnzr, integer **gci, integer *gnzc, char **gnz,
-                doublereal **a, integer **ci, integer *nzc,
+naivepsad(naive_mat *g, const naive_mat *m,
                 integer from, integer to, AO_TS_t *lock)
 {
 
         for (integer r = from; r < to; r++) {
-                integer nc = nzc[r];
+                integer nc = m->nzc[r];
 
                 if (nc) {
-                        doublereal *pgar = ga[r];
-                        doublereal *par  = a[r];
+                        const doublereal *par  = m->a[r];
+                        const integer *pci = m->ci[r];
 
                         for (integer i = 0; i < nc; i++) {
-                                integer c = ci[r][i];
+                                integer c = pci[i];
+                                integer k = naive_find(g, r, c);
 
-                                if (gnz[r][c]) {
-                                        pgar[c] += par[c];
+                                if (k >= 0) {
+                                        g->a[r][k] += par[i];
 
                                 } else {
-                                        pgar[c] = par[c];
-                                        gci[r][gnzc[r]] = c;
-                                        /* This can only be set to 1 from 0,
-                                         * so concurrency is harmless
-                                         */
-                                        gnz[r][c] = 1;
+                                        /* rows are partitioned among
+                                         * threads, so only the column
+                                         * index needs to be locked */
+                                        k = naive_row_insert(g, r, c);
+                                        if (k < 0) {
+                                                throw std::bad_alloc();
+                                        }
+                                        g->a[r][k] = par[i];
 
                                         do_lock(&lock[c]);
 
-                                        gri[c][gnzr[c]] = r;
-                                        gnzr[c]++;
+                                        int rc = naive_col_insert(g, c, r, k);
 
                                         do_unlock(&lock[c]);
-                                        gnzc[r]++;
+
+                                        if (rc != 0) {
+                                                throw std::bad_alloc();
+                                        }
                                 }
                         }
                 }
@@ -117,6 +122,202 @@ naivepsad(doublereal **ga, integer **gri,
 
 /* MultiThreadDataManager - begin */
 
+/* visits the rows a submatrix is assembled into */
+class RowVisitorMatrixHandler : public MatrixHandler {
+protected:
+        integer iSize;
+        doublereal dDummy;
+
+        virtual void Visit(integer iRow) = 0;
+
+public:
+        RowVisitorMatrixHandler(integer iSize)
+        : iSize(iSize), dDummy(0.)
+        {
+                NO_OP;
+        };
+
+        virtual ~RowVisitorMatrixHandler(void)
+        {
+                NO_OP;
+        };
+
+#ifdef DEBUG
+        virtual void IsValid(void) const override
+        {
+                NO_OP;
+        };
+#endif /* DEBUG */
+
+        virtual void Resize(integer, integer) override
+        {
+                throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+        };
+
+        virtual void Reset(void) override
+        {
+                NO_OP;
+        };
+
+        virtual void
+        PutCoef(integer iRow, integer iCol, const doublereal& dCoef) override
+        {
+                Visit(iRow);
+        };
+
+        virtual void
+        IncCoef(integer iRow, integer iCol, const doublereal& dCoef) override
+        {
+                Visit(iRow);
+        };
+
+        virtual void
+        DecCoef(integer iRow, integer iCol, const doublereal& dCoef) override
+        {
+                Visit(iRow);
+        };
+
+        virtual const doublereal&
+        dGetCoef(integer iRow, integer iCol) const override
+        {
+                return ::Zero1;
+        };
+
+        virtual const doublereal&
+        operator () (integer iRow, integer iCol) const override
+        {
+                return ::Zero1;
+        };
+
+        virtual doublereal&
+        operator () (integer iRow, integer iCol) override
+        {
+                Visit(iRow);
+                dDummy = 0.;
+                return dDummy;
+        };
+
+        virtual integer iGetNumRows(void) const override
+        {
+                return iSize;
+        };
+
+        virtual integer iGetNumCols(void) const override
+        {
+                return iSize;
+        };
+
+        virtual MatrixHandler* Copy() const override
+        {
+                throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+        };
+
+        virtual bool AddItem(integer iRow, const sp_grad::SpGradient& oItem) override
+        {
+                Visit(iRow);
+                return true;
+        };
+
+        virtual bool SubItem(integer iRow, const sp_grad::SpGradient& oItem) override
+        {
+                Visit(iRow);
+                return true;
+        };
+};
+
+/* records the rows a submatrix is assembled into */
+class RowRecorderMatrixHandler : public RowVisitorMatrixHandler {
+protected:
+        std::vector<integer>& Rows;
+
+        virtual void Visit(integer iRow) override
+        {
+                Rows.push_back(iRow);
+        };
+
+public:
+        RowRecorderMatrixHandler(integer iSize, std::vector<integer>& Rows)
+        : RowVisitorMatrixHandler(iSize), Rows(Rows)
+        {
+                NO_OP;
+        };
+};
+
+/* checks that a submatrix is assembled only into the rows
+ * marked with a given stamp */
+class RowCheckerMatrixHandler : public RowVisitorMatrixHandler {
+protected:
+        const std::vector<unsigned>& RowMark;
+        unsigned uStamp;
+        bool bOutside;
+
+        virtual void Visit(integer iRow) override
+        {
+                if (RowMark[iRow] != uStamp) {
+                        bOutside = true;
+                }
+        };
+
+public:
+        RowCheckerMatrixHandler(integer iSize,
+                const std::vector<unsigned>& RowMark, unsigned uStamp)
+        : RowVisitorMatrixHandler(iSize), RowMark(RowMark), uStamp(uStamp),
+        bOutside(false)
+        {
+                NO_OP;
+        };
+
+        bool bIsOutside(void) const
+        {
+                return bOutside;
+        };
+};
+
+/* initial estimate of the assembly cost of an element */
+static doublereal
+dElemCostEstimate(const Elem *pEl)
+{
+        integer iNumRows = 0;
+        integer iNumCols = 0;
+
+        pEl->WorkSpaceDim(&iNumRows, &iNumCols);
+
+        return std::abs(iNumRows)*iNumCols + 1.;
+}
+
+/* elements whose residual cannot be assembled concurrently
+ * with that of other elements */
+static bool
+bResSerialElem(const Elem *pEl)
+{
+        switch (pEl->GetElemType()) {
+        case Elem::INDUCEDVELOCITY:	/* collect the loads of the aerodynamic elements */
+        case Elem::AERODYNAMIC:		/* add their loads to the rotors */
+        case Elem::AEROMODAL:
+        case Elem::FORCE:		/* external forces exchange data with the peer */
+        case Elem::EXTERNAL:
+                return true;
+
+        default:
+                return false;
+        }
+}
+
+/* elements whose residual updates data used by the other elements;
+ * they come first in the element list (see Elem::Type) */
+static bool
+bResLeadElem(const Elem *pEl)
+{
+        switch (pEl->GetElemType()) {
+        case Elem::AIRPROPERTIES:	/* air velocity */
+        case Elem::GRAVITY:		/* gravity acceleration */
+                return true;
+
+        default:
+                return false;
+        }
+}
+
 
 /*
  * costruttore: inizializza l'oggetto, legge i dati e crea le strutture di
@@ -130,14 +331,16 @@ MultiThreadDataManager::MultiThreadDataManager(MBDynParser& HP,
                 const char* sOutputFileName,
                 const char* sInputFileName,
                 bool bAbortAfterInput,
-                unsigned nThreads)
+                unsigned nThreads,
+                unsigned uFlags)
 :
 DataManager(HP, OF, pS, dInitialTime, sOutputFileName, sInputFileName, bAbortAfterInput),
+uMTFlags(uFlags),
 AssMode(ASS_UNKNOWN),
 CCReady(CC_NO),
+pColoredJacHdl(0),
 thread_data(0),
 op(MultiThreadDataManager::OP_UNKNOWN),
-thread_count(0),
 propagate_ErrMatrixRebuild(AO_TS_INITIALIZER)
 {
         DataManager::nThreads = nThreads;
@@ -173,26 +376,21 @@ propagate_ErrMatrixRebuild(AO_TS_INITIALIZER)
         }
 #endif
 
-        if (pthread_mutex_init(&thread_mutex, NULL)) {
-                silent_cerr("MultiThreadDataManager::MultiThreadDataManager(): "
-                                "mutex init failed" << std::endl);
-                throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-        }
-
-        if (pthread_cond_init(&thread_cond, NULL)) {
-                silent_cerr("MultiThreadDataManager::MultiThreadDataManager(): "
-                                "cond init failed" << std::endl);
-                throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+        /* the helper threads are those of the shared pool */
+        unsigned nAvail = ThreadPool::Get().iGetAvailThreads();
+        if (DataManager::nThreads > nAvail) {
+                silent_cerr("MultiThreadDataManager: " << DataManager::nThreads
+                                << " threads requested, " << nAvail
+                                << " available; using " << nAvail << std::endl);
+                DataManager::nThreads = nAvail;
         }
 
-        ThreadSpawn();
+        ThreadInit();
 }
 
 MultiThreadDataManager::~MultiThreadDataManager(void)
 {
         ThreadDestroy();
-        pthread_mutex_destroy(&thread_mutex);
-        pthread_cond_destroy(&thread_cond);
 }
 
 void MultiThreadDataManager::ThreadDestroy(void)
@@ -201,18 +399,8 @@ void MultiThreadDataManager::ThreadDestroy(void)
                 return;
         }
 
-        op = MultiThreadDataManager::OP_EXIT;
-        thread_count = nThreads - 1;
-
         for (unsigned i = 1; i < nThreads; i++) {
-                void *retval = NULL;
-
-                sem_post(&thread_data[i].sem);
-                if (pthread_join(thread_data[i].thread, &retval)) {
-                        silent_cerr("pthread_join() failed on thread " << i
-                                        << std::endl);
-                        /* already shutting down ... */
-                }
+                thread_cleanup(&thread_data[i]);
         }
 
         if (thread_data[0].lock) {
@@ -225,155 +413,119 @@ void MultiThreadDataManager::ThreadDestroy(void)
 }
 
 
-void *
-MultiThreadDataManager::thread(void *p)
+void
+MultiThreadDataManager::ThreadOp(ThreadData *arg)
 {
-        MultiThreadDataManager::ThreadData *arg
-                = (MultiThreadDataManager::ThreadData *)p;
-
-        silent_cout("MultiThreadDataManager: thread " << arg->threadNumber
-                        << " [self=" << pthread_self()
-                        << ",pid=" << getpid() << "]"
-                        << " starting..." << std::endl);
-
-        bool bKeepGoing = true;
-
-#ifdef HAVE_PTHREAD_SIGMASK
-        /* deal with signals ... */
-        sigset_t newset /* , oldset */ ;
-        sigemptyset(&newset);
-        sigaddset(&newset, SIGTERM);
-        sigaddset(&newset, SIGINT);
-        sigaddset(&newset, SIGHUP);
-        pthread_sigmask(SIG_BLOCK, &newset, /* &oldset */ NULL);
-#endif
+        try {
+             DEBUGCOUT("thread " << arg->threadNumber << ": "
+                       "op " << arg->pDM->op << std::endl);
+
+             /* select requested operation */
+             switch (arg->pDM->op) {
+             case MultiThreadDataManager::OP_ASSJAC_CC:
+                  //arg->pJacHdl->Reset();
+                  try {
+                       arg->pDM->DataManager::AssJac(*arg->pJacHdl,
+                                                     arg->dCoef,
+                                                     arg->ElemIter[ES_CC],
+                                                     *arg->pWorkMat);
 
-        SetAffinity(*arg);
-
-        while (bKeepGoing) {
-             /* stop here until told to start */
-             /*
-              * NOTE: here
-              * - the requested operation must be set;
-              * - the appropriate operation args must be set
-              * - the thread_count must be set to nThreads - 1
-              */
-             sem_wait(&arg->sem);
-
-             try {
-                  DEBUGCOUT("thread " << arg->threadNumber << ": "
-                            "op " << arg->pDM->op << std::endl);
-
-                  /* select requested operation */
-                  switch (arg->pDM->op) {
-                  case MultiThreadDataManager::OP_ASSJAC_CC:
-                       //arg->pJacHdl->Reset();
-                       try {
-                            arg->pDM->DataManager::AssJac(*arg->pJacHdl,
-                                                          arg->dCoef,
-                                                          arg->ElemIter,
-                                                          *arg->pWorkMat);
-
-                       } catch (MatrixHandler::ErrRebuildMatrix& e) {
-                            silent_cerr("thread " << arg->threadNumber
-                                        << " caught ErrRebuildMatrix"
-                                        << std::endl);
+                  } catch (MatrixHandler::ErrRebuildMatrix& e) {
+                       silent_cerr("thread " << arg->threadNumber
+                                   << " caught ErrRebuildMatrix"
+                                   << std::endl);
 
-                            mbdyn_test_and_set(&arg->pDM->propagate_ErrMatrixRebuild);
+                       mbdyn_test_and_set(&arg->pDM->propagate_ErrMatrixRebuild);
+
+                  } catch (...) {
+                       throw;
+                  }
+                  break;
 
-                       } catch (...) {
-                            throw;
-                       }
-                       break;
+             case MultiThreadDataManager::OP_ASSJAC_CC_COLORED:
+                  /* NOTE: exceptions are handled internally,
+                   * since all threads must reach the barriers */
+                  arg->pDM->CCAssJacColoredThread(*arg);
+                  break;
 #ifdef USE_NAIVE_MULTITHREAD
-                  case MultiThreadDataManager::OP_ASSJAC_NAIVE:
+             case MultiThreadDataManager::OP_ASSJAC_NAIVE:
 #if 0
-                       arg->ppNaiveJacHdl[arg->threadNumber]->Reset();
+                  arg->ppNaiveJacHdl[arg->threadNumber]->Reset();
 #endif
-                       /* NOTE: Naive should never throw
-                        * ErrRebuildMatrix ... */
-                       arg->pDM->DataManager::AssJac(*arg->ppNaiveJacHdl[arg->threadNumber],
-                                                     arg->dCoef,
-                                                     arg->ElemIter,
-                                                     *arg->pWorkMat);
-                       break;
-
-                  case MultiThreadDataManager::OP_SUM_NAIVE:
-                  {
-                       /* FIXME: if the naive matrix is permuted (colamd),
-                        * this should not impact the parallel assembly,
-                        * because all the matrices refer to the same
-                        * permutation vector */
-                       NaiveMatrixHandler* to = arg->ppNaiveJacHdl[0];
-                       integer nn = to->iGetNumRows();
-                       integer iFrom = (nn*(arg->threadNumber))/arg->pDM->nThreads;
-                       integer iTo = (nn*(arg->threadNumber + 1))/arg->pDM->nThreads;
-                       for (unsigned int matrix = 1; matrix < arg->pDM->nThreads; matrix++) {
-                            NaiveMatrixHandler* from = arg->ppNaiveJacHdl[matrix];
-                            naivepsad(to->ppdRows,
-                                      to->ppiRows, to->piNzr,
-                                      to->ppiCols, to->piNzc, to->ppnonzero,
-                                      from->ppdRows, from->ppiCols, from->piNzc,
-                                      iFrom, iTo, arg->lock);
-                       }
-                       break;
+                  /* NOTE: Naive should never throw
+                   * ErrRebuildMatrix ... */
+                  arg->pDM->DataManager::AssJac(*arg->ppNaiveJacHdl[arg->threadNumber],
+                                                arg->dCoef,
+                                                arg->ElemIter[ES_NAIVE],
+                                                *arg->pWorkMat);
+                  break;
+
+             case MultiThreadDataManager::OP_SUM_NAIVE:
+             {
+                  /* FIXME: if the naive matrix is permuted (colamd),
+                   * this should not impact the parallel assembly,
+                   * because all the matrices refer to the same
+                   * permutation vector */
+                  NaiveMatrixHandler* to = arg->ppNaiveJacHdl[0];
+                  integer nn = to->iGetNumRows();
+                  integer iFrom = (nn*(arg->threadNumber))/arg->pDM->nThreads;
+                  integer iTo = (nn*(arg->threadNumber + 1))/arg->pDM->nThreads;
+                  for (unsigned int matrix = 1; matrix < arg->pDM->nThreads; matrix++) {
+                       NaiveMatrixHandler* from = arg->ppNaiveJacHdl[matrix];
+                       naivepsad(to->pMat, from->pMat,
+                                 iFrom, iTo, arg->lock);
                   }
+                  break;
+             }
 #endif
-                  case MultiThreadDataManager::OP_ASSJAC_GRAD:
-                  {
-                       arg->pDM->DataManager::AssJac(arg->oGradJacHdl,
-                                                     arg->dCoef,
-                                                     arg->ElemIter,
-                                                     *arg->pWorkMat);
-                       break;
-                  }
-                  case MultiThreadDataManager::OP_ASSJAC_PROD:
-                  {
-                       ASSERT(arg->pJacProd != nullptr);
-                       ASSERT(arg->pY != nullptr);
-                       
-                       arg->pDM->DataManager::AssJac(*arg->pJacProd,
-                                                     *arg->pY,
-                                                     arg->dCoef,                                                     
-                                                     arg->ElemIter,
-                                                     *arg->pWorkMat);
-                       break;
-                  }
-#ifdef MBDYN_X_MT_ASSRES
-                  case MultiThreadDataManager::OP_ASSRES:
-                       arg->pResHdl->Reset();
-                       if (arg->pAbsResHdl) arg->pAbsResHdl->Reset();
-                       arg->pDM->DataManager::AssRes(*arg->pResHdl,
-                                                     arg->dCoef,
-                                                     arg->ElemIter,
-                                                     *arg->pWorkVec,
-                                                     arg->pAbsResHdl);
-                       break;
-#endif /* MBDYN_X_MT_ASSRES */
-
-                  case MultiThreadDataManager::OP_EXIT:
-                       /* cleanup */
-                       thread_cleanup(arg);
-                       bKeepGoing = false;
-                       break;
-
-                  default:
-                       silent_cerr("MultiThreadDataManager: unhandled op"
-                                   << std::endl);
-                       throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-                  }
-
-             } catch (...) {
-                  arg->except = std::current_exception();
+             case MultiThreadDataManager::OP_ASSJAC_GRAD:
+             {
+                  arg->pDM->DataManager::AssJac(arg->oGradJacHdl,
+                                                arg->dCoef,
+                                                arg->ElemIter[ES_GRAD],
+                                                *arg->pWorkMat);
+                  break;
+             }
+             case MultiThreadDataManager::OP_ASSJAC_PROD:
+             {
+                  ASSERT(arg->pJacProd != nullptr);
+                  ASSERT(arg->pY != nullptr);
+                  
+                  arg->pDM->DataManager::AssJac(*arg->pJacProd,
+                                                *arg->pY,
+                                                arg->dCoef,                                                     
+                                                arg->ElemIter[ES_GRAD_PROD],
+                                                *arg->pWorkMat);
+                  break;
+             }
+             case MultiThreadDataManager::OP_ASSRES:
+                  arg->pDM->AssResThread(*arg);
+                  break;
+
+             default:
+                  silent_cerr("MultiThreadDataManager: unhandled op"
+                              << std::endl);
+                  throw ErrGeneric(MBDYN_EXCEPT_ARGS);
              }
 
-             /* decrease counter and signal if last
-              * (mutex + cond) */
-             arg->pDM->EndOfOp();                
+        } catch (...) {
+             arg->except = std::current_exception();
         }
+}
+
+void
+MultiThreadDataManager::RunOp(DataManagerOp o, const std::function<void (void)>& f)
+{
+        op = o;
 
-        /* all threads are joined */
-        pthread_exit(NULL);
+        ThreadPool::Get().Run(nThreads, [this, &f](unsigned iTask, unsigned) {
+                if (iTask == 0) {
+                        f();
+
+                } else {
+                        ThreadOp(&thread_data[iTask]);
+                }
+        });
 }
 
 void
@@ -388,18 +540,12 @@ MultiThreadDataManager::thread_cleanup(ThreadData *arg)
                 if (arg->pJacHdl) {
                         SAFEDELETE(arg->pJacHdl);
                 }
-#ifdef MBDYN_X_MT_ASSRES
-                SAFEDELETE(arg->pResHdl);
-#endif
 #ifdef USE_NAIVE_MULTITHREAD
                 if (arg->ppNaiveJacHdl && arg->ppNaiveJacHdl[arg->threadNumber]) {
                         SAFEDELETE(arg->ppNaiveJacHdl[arg->threadNumber]);
                         arg->ppNaiveJacHdl[arg->threadNumber] = nullptr;
                 }
 #endif
-                if (arg->pAbsResHdl) {
-                     SAFEDELETE(arg->pAbsResHdl);
-                }
         } else {
 #ifdef USE_NAIVE_MULTITHREAD
                 if (arg->ppNaiveJacHdl) {
@@ -416,8 +562,6 @@ MultiThreadDataManager::thread_cleanup(ThreadData *arg)
 
         ASSERT(!arg->pY);
 
-        sem_destroy(&arg->sem);
-
 #ifdef HAVE_SYS_TIMES_H
         /* Tempo di CPU impiegato */
         struct tms tmsbuf;
@@ -431,51 +575,55 @@ MultiThreadDataManager::thread_cleanup(ThreadData *arg)
 #endif /* HAVE_SYS_TIMES_H */
 }
 
+/* sets up the per-thread data */
 void
-MultiThreadDataManager::EndOfOp(void)
+MultiThreadDataManager::ThreadInit(void)
 {
-        bool last;
+        ASSERT(nThreads > 1);
 
-        /* decrement the thread counter */
-        pthread_mutex_lock(&thread_mutex);
-        thread_count--;
-        last = (thread_count == 0);
+        SAFENEWARRNOFILL(thread_data, MultiThreadDataManager::ThreadData, nThreads);
 
-        /* if last thread, signal to restart */
-        if (last) {
-                pthread_cond_signal(&thread_cond);
-                // pthread_cond_broadcast(&thread_cond);
+        /* initial cost estimate from the size of the contributions;
+         * replaced by the measured cost after the first assembly */
+        for (unsigned s = 0; s < ES_LAST; s++) {
+                ElemSchedule[s].Init(Elems.size(), nThreads);
+        }
+        for (unsigned i = 0; i < Elems.size(); i++) {
+                doublereal dCost = dElemCostEstimate(Elems[i]);
+                for (unsigned s = 0; s < ES_LAST; s++) {
+                        ElemSchedule[s].SetCost(i, dCost);
+                }
         }
 
-        pthread_mutex_unlock(&thread_mutex);
-}
-
-/* starts the helper threads */
-void
-MultiThreadDataManager::ThreadSpawn(void)
-{
-        ASSERT(nThreads > 1);
+        if (uMTFlags & MT_ASSRES) {
+                ResSchedule.Init(Elems.size(), nThreads);
+                ResContribs.resize(Elems.size());
+                bResSerial.resize(Elems.size());
+                for (unsigned i = 0; i < Elems.size(); i++) {
+                        bResSerial[i] = bResLeadElem(Elems[i]) || bResSerialElem(Elems[i]);
+                        if (bResSerial[i]) {
+                                if (bResLeadElem(Elems[i])) {
+                                        ResLeadElems.push_back(i);
 
-        SAFENEWARRNOFILL(thread_data, MultiThreadDataManager::ThreadData, nThreads);
+                                } else {
+                                        ResSerialElems.push_back(i);
+                                }
+                                ResSchedule.SetCost(i, 0.);
 
-        const Task2CPU& oCPUSet = Task2CPU::GetGlobalState();
-        int iCPUIndex = oCPUSet.iGetFirstCPU();
-        const unsigned uNumCPUs = oCPUSet.iGetCount();
+                        } else {
+                                ResSchedule.SetCost(i, dElemCostEstimate(Elems[i]));
+                        }
+                }
+        }
 
         for (unsigned i = 0; i < nThreads; i++) {
                 /* callback data */
                 thread_data[i].pDM = this;
-                sem_init(&thread_data[i].sem, 0, 0);
                 thread_data[i].threadNumber = i;
 
-                if (uNumCPUs >= nThreads) {
-                     thread_data[i].iCPUIndex = iCPUIndex;
-                     iCPUIndex = oCPUSet.iGetNextCPU(iCPUIndex);
-                } else {
-                     thread_data[i].iCPUIndex = -1;
+                for (unsigned s = 0; s < ES_LAST; s++) {
+                        thread_data[i].ElemIter[s].Init(&Elems[0], Elems.size(), &ElemSchedule[s]);
                 }
-
-                thread_data[i].ElemIter.Init(&Elems[0], Elems.size());
                 thread_data[i].lock = 0;
 
                 /* SubMatrixHandlers */
@@ -528,38 +676,34 @@ MultiThreadDataManager::ThreadSpawn(void)
                                                MyVectorHandler,
                                                MyVectorHandler(iTotDofs));
                 }
-#ifdef MBDYN_X_MT_ASSRES
-                /* set below */
-                thread_data[i].pResHdl = 0;
-#endif
-                thread_data[i].pAbsResHdl = 0;
+                if (uMTFlags & MT_ASSRES) {
+                        thread_data[i].ResIter.Init(&Elems[0], Elems.size(), &ResSchedule);
+                }
+                thread_data[i].bChangedEqStructure = false;
 
                 /* to be sure... */
                 thread_data[i].pMatA = 0;
                 thread_data[i].pMatB = 0;
+        }
+}
 
-                if (i == 0) {
-                        continue;
-                }
-#ifdef MBDYN_X_MT_ASSRES
-                SAFENEWWITHCONSTRUCTOR(thread_data[i].pResHdl,
-                                MyVectorHandler, MyVectorHandler(iTotDofs));
+void
+MultiThreadDataManager::AssResJac(VectorHandler& ResHdl, MatrixHandler& JacHdl,
+                                  doublereal dCoef, VectorHandler*const pAbsResHdl)
+{
+        bool bChangedEqStructure = false;
 
-                SAFENEWWITHCONSTRUCTOR(thread_data[i].pAbsResHdl,
-                                MyVectorHandler, MyVectorHandler(iTotDofs));
-#endif
-                /* create thread */
-                if (pthread_create(&thread_data[i].thread, NULL, thread,
-                                        &thread_data[i]) != 0) {
-                        silent_cerr("pthread_create() failed "
-                                        "for thread " << i
-                                        << " of " << nThreads << std::endl);
-                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-                }
+        try {
+                AssRes(ResHdl, dCoef, pAbsResHdl);
+        } catch (const ChangedEquationStructure&) {
+                bChangedEqStructure = true;
         }
 
+        AssJac(JacHdl, dCoef);
 
-        SetAffinity(thread_data[0]);
+        if (bChangedEqStructure) {
+                throw ChangedEquationStructure(MBDYN_EXCEPT_ARGS);
+        }
 }
 
 void
@@ -571,8 +715,11 @@ MultiThreadDataManager::AssJac(MatrixHandler& JacHdl, doublereal dCoef)
 #endif
         NodesUpdateJac(dCoef, NodeIter);
 
-        if (dynamic_cast<CompactSparseMatrixHandler*>(&JacHdl) || dynamic_cast<SpMapMatrixHandler*>(&JacHdl)) {
-                AssMode = ASS_CC;
+        if (dynamic_cast<CompactSparseMatrixHandler*>(&JacHdl)
+                || dynamic_cast<SpMapMatrixHandler*>(&JacHdl)
+                || dynamic_cast<SpCooMatrixHandler*>(&JacHdl))
+        {
+                AssMode = (uMTFlags & MT_COLORED) ? ASS_CC_COLORED : ASS_CC;
                 CCAssJac(JacHdl, dCoef);
         } else if ((pGradJacHdl = dynamic_cast<SpGradientSparseMatrixHandler*>(&JacHdl))) {
                 AssMode = ASS_GRAD;
@@ -607,9 +754,7 @@ void MultiThreadDataManager::GradAssJacProd(VectorHandler& JacY, const VectorHan
 {
         ASSERT(thread_data != NULL);
 
-        thread_data[0].ElemIter.ResetAccessData();
-        op = MultiThreadDataManager::OP_ASSJAC_PROD;
-        thread_count = nThreads - 1;
+        ElemSchedule[ES_GRAD_PROD].Reset();
 
         for (unsigned i = 0; i < nThreads; ++i) {
              thread_data[i].except = std::exception_ptr{};
@@ -618,22 +763,15 @@ void MultiThreadDataManager::GradAssJacProd(VectorHandler& JacY, const VectorHan
         for (unsigned i = 1; i < nThreads; i++) {
                 thread_data[i].dCoef = dCoef;
                 thread_data[i].pY = &Y;
-                sem_post(&thread_data[i].sem);
-        }
-
-        try {
-                DataManager::AssJac(JacY, Y, dCoef, thread_data[0].ElemIter, *thread_data[0].pWorkMat);
-        } catch (...) {
-             thread_data[0].except = std::current_exception();
         }
-        
-        pthread_mutex_lock(&thread_mutex);
 
-        if (thread_count > 0) {
-                pthread_cond_wait(&thread_cond, &thread_mutex);
-        }
-
-        pthread_mutex_unlock(&thread_mutex);
+        RunOp(MultiThreadDataManager::OP_ASSJAC_PROD, [&]() {
+                try {
+                        DataManager::AssJac(JacY, Y, dCoef, thread_data[0].ElemIter[ES_GRAD_PROD], *thread_data[0].pWorkMat);
+                } catch (...) {
+                     thread_data[0].except = std::current_exception();
+                }
+        });
 
         for (unsigned i = 1; i < nThreads; ++i) {
                 thread_data[i].pY = nullptr;
@@ -645,6 +783,8 @@ void MultiThreadDataManager::GradAssJacProd(VectorHandler& JacY, const VectorHan
              }
         }
 
+        ElemSchedule[ES_GRAD_PROD].Rebalance();
+
         for (unsigned i = 1; i < nThreads; i++) {
                 JacY += *thread_data[i].pJacProd;
         }
@@ -674,9 +814,14 @@ retry:;
         case CC_NO:
                 DEBUGCERR("CC_NO => CC_FIRST" << std::endl);
 
-                ASSERT(dynamic_cast<SpMapMatrixHandler *>(&JacHdl) != 0);
+                ASSERT(dynamic_cast<SpMapMatrixHandler *>(&JacHdl) != 0
+                        || dynamic_cast<SpCooMatrixHandler *>(&JacHdl) != 0);
 
-                DataManager::AssJac(JacHdl, dCoef, ElemIter, *pWorkMat);
+                if (AssMode == ASS_CC_COLORED) {
+                        CCAssJacColorInit(JacHdl, dCoef);
+                } else {
+                        DataManager::AssJac(JacHdl, dCoef, ElemIter, *pWorkMat);
+                }
                 CCReady = CC_FIRST;
 
                 return;
@@ -688,8 +833,10 @@ retry:;
 
                 DEBUGCERR("CC_FIRST => CC_YES" << std::endl);
 
-                for (unsigned i = 1; i < nThreads; i++) {
-                        thread_data[i].pJacHdl = pMH->Copy();
+                if (AssMode == ASS_CC) {
+                        for (unsigned i = 1; i < nThreads; i++) {
+                                thread_data[i].pJacHdl = pMH->Copy();
+                        }
                 }
 
                 CCReady = CC_YES;
@@ -710,9 +857,12 @@ retry:;
 
         }
 
-        thread_data[0].ElemIter.ResetAccessData();
-        op = MultiThreadDataManager::OP_ASSJAC_CC;
-        thread_count = nThreads - 1;
+        if (AssMode == ASS_CC_COLORED) {
+                CCAssJacColored(JacHdl, dCoef);
+                return;
+        }
+
+        ElemSchedule[ES_CC].Reset();
 
         for (unsigned i = 0; i < nThreads; ++i) {
              thread_data[i].except = std::exception_ptr{};
@@ -720,31 +870,23 @@ retry:;
         
         for (unsigned i = 1; i < nThreads; i++) {
                 thread_data[i].dCoef = dCoef;
-
-                sem_post(&thread_data[i].sem);
-        }
-
-        try {
-                DataManager::AssJac(JacHdl, dCoef, thread_data[0].ElemIter,
-                                    *thread_data[0].pWorkMat);
-
-        } catch (MatrixHandler::ErrRebuildMatrix& e) {
-                silent_cerr("thread " << thread_data[0].threadNumber
-                                << " caught ErrRebuildMatrix"
-                                << std::endl);
-
-                mbdyn_test_and_set(&propagate_ErrMatrixRebuild);
-        } catch (...) {
-             thread_data[0].except = std::current_exception();
         }
 
-        pthread_mutex_lock(&thread_mutex);
+        RunOp(MultiThreadDataManager::OP_ASSJAC_CC, [&]() {
+                try {
+                        DataManager::AssJac(JacHdl, dCoef, thread_data[0].ElemIter[ES_CC],
+                                            *thread_data[0].pWorkMat);
 
-        if (thread_count > 0) {
-                pthread_cond_wait(&thread_cond, &thread_mutex);
-        }
+                } catch (MatrixHandler::ErrRebuildMatrix& e) {
+                        silent_cerr("thread " << thread_data[0].threadNumber
+                                        << " caught ErrRebuildMatrix"
+                                        << std::endl);
 
-        pthread_mutex_unlock(&thread_mutex);
+                        mbdyn_test_and_set(&propagate_ErrMatrixRebuild);
+                } catch (...) {
+                     thread_data[0].except = std::current_exception();
+                }
+        });
 
         if (propagate_ErrMatrixRebuild == AO_TS_SET) {
                 for (unsigned i = 1; i < nThreads; i++) {
@@ -763,11 +905,337 @@ retry:;
              }
         }
         
+        ElemSchedule[ES_CC].Rebalance();
+
         for (unsigned i = 1; i < nThreads; i++) {
                 pMH->AddUnchecked(*thread_data[i].pJacHdl);
         }
 }
 
+/*
+ * Assembles the first Jacobian serially, recording the rows each element
+ * contributes to; the rows of the DOFs of the connected nodes and of the
+ * element itself are added as well, so that contributions that happen
+ * to be absent from the first Jacobian are accounted for.
+ * The elements are then colored (see CCAssJacColor()); an element that
+ * later contributes to a row not recorded here is detected by the
+ * colored assembly, and handled serially.
+ */
+void
+MultiThreadDataManager::CCAssJacColorInit(MatrixHandler& JacHdl, doublereal dCoef)
+{
+        const integer iNumRows = JacHdl.iGetNumRows();
+        const unsigned iNumElems = Elems.size();
+
+        std::vector<integer> Rows;
+        RowRecorderMatrixHandler oRecorder(iNumRows, Rows);
+        std::vector<const Node *> ConnectedNodes;
+
+        std::vector<std::vector<integer> >(iNumElems).swap(ElemRows);
+
+        JacHdl.Reset();
+
+        for (unsigned e = 0; e < iNumElems; e++) {
+                Elem *pEl = Elems[e];
+
+                Rows.clear();
+
+                const VariableSubMatrixHandler& WM
+                        = CCAssJacColoredElem(pEl, *pWorkMat, dCoef);
+                JacHdl += WM;
+                oRecorder += WM;
+
+                pEl->GetConnectedNodes(ConnectedNodes);
+                for (std::vector<const Node *>::const_iterator i = ConnectedNodes.begin();
+                        i != ConnectedNodes.end(); ++i)
+                {
+                        integer iFirstIndex = (*i)->iGetFirstIndex();
+
+                        // Ignore DummyStructNode
+                        if (iFirstIndex < 0) {
+                                continue;
+                        }
+
+                        for (unsigned iCnt = 1; iCnt <= (*i)->iGetNumDof(); iCnt++) {
+                                Rows.push_back(iFirstIndex + iCnt);
+                        }
+                }
+
+                const ElemWithDofs *pEWD = dynamic_cast<const ElemWithDofs *>(pEl);
+                if (pEWD != 0) {
+                        integer iFirstIndex = pEWD->iGetFirstIndex();
+
+                        for (unsigned iCnt = 1; iCnt <= pEWD->iGetNumDof(); iCnt++) {
+                                Rows.push_back(iFirstIndex + iCnt);
+                        }
+                }
+
+                std::sort(Rows.begin(), Rows.end());
+                ElemRows[e].assign(Rows.begin(),
+                        std::unique(Rows.begin(), Rows.end()));
+        }
+
+        for (unsigned i = 0; i < nThreads; i++) {
+                thread_data[i].RowMark.assign(iNumRows + 1, 0);
+                thread_data[i].Unrecorded.clear();
+        }
+
+        CCAssJacColor();
+}
+
+/*
+ * Colors the elements greedily, so that no two elements
+ * of the same color share a row.
+ */
+void
+MultiThreadDataManager::CCAssJacColor(void)
+{
+        const unsigned iNumElems = Elems.size();
+        const integer iNumRows = thread_data[0].RowMark.size() - 1;
+
+        /* greedy (first fit) coloring */
+        std::vector<unsigned> ElemColor(iNumElems);
+        std::vector<std::vector<unsigned> > RowColors(iNumRows + 1);
+        std::vector<unsigned> Forbidden;
+        unsigned nColors = 0;
+
+        for (unsigned e = 0; e < iNumElems; e++) {
+                const std::vector<integer>& Rows = ElemRows[e];
+
+                for (unsigned r = 0; r < Rows.size(); r++) {
+                        const std::vector<unsigned>& RC = RowColors[Rows[r]];
+                        for (unsigned c = 0; c < RC.size(); c++) {
+                                Forbidden[RC[c]] = e + 1;
+                        }
+                }
+
+                unsigned iColor = 0;
+                while (iColor < nColors && Forbidden[iColor] == e + 1) {
+                        iColor++;
+                }
+
+                if (iColor == nColors) {
+                        Forbidden.push_back(0);
+                        nColors++;
+                }
+
+                ElemColor[e] = iColor;
+
+                for (unsigned r = 0; r < Rows.size(); r++) {
+                        std::vector<unsigned>& RC = RowColors[Rows[r]];
+                        if (RC.empty() || RC.back() != iColor) {
+                                RC.push_back(iColor);
+                        }
+                }
+        }
+
+        /* sort the elements by color */
+        ColorOffsets.assign(nColors + 1, 0);
+        for (unsigned e = 0; e < iNumElems; e++) {
+                ColorOffsets[ElemColor[e] + 1]++;
+        }
+
+        for (unsigned c = 0; c < nColors; c++) {
+                ColorOffsets[c + 1] += ColorOffsets[c];
+        }
+
+        ColoredElems.resize(iNumElems);
+        ColoredElemIdx.resize(iNumElems);
+        std::vector<unsigned> ColorFill(ColorOffsets.begin(), ColorOffsets.end() - 1);
+        for (unsigned e = 0; e < iNumElems; e++) {
+                unsigned iPos = ColorFill[ElemColor[e]]++;
+                ColoredElems[iPos] = Elems[e];
+                ColoredElemIdx[iPos] = e;
+        }
+
+        std::vector<MT_ChunkSchedule>(nColors).swap(ColorSchedule);
+        for (unsigned c = 0; c < nColors; c++) {
+                ColorSchedule[c].Init(ColorOffsets[c + 1] - ColorOffsets[c], nThreads);
+                for (unsigned e = ColorOffsets[c]; e < ColorOffsets[c + 1]; e++) {
+                        ColorSchedule[c].SetCost(e - ColorOffsets[c],
+                                dElemCostEstimate(ColoredElems[e]));
+                }
+        }
+
+        silent_cout("MultiThreadDataManager: " << iNumElems << " elements "
+                "in " << nColors << " colors" << std::endl);
+}
+
+/* computes the Jacobian contribution of an element */
+const VariableSubMatrixHandler&
+MultiThreadDataManager::CCAssJacColoredElem(Elem *pEl,
+        VariableSubMatrixHandler& WorkMat, doublereal dCoef)
+{
+        try {
+                ElemProfiler::Sample ps(pElemProf, pEl, ElemProfiler::ASSJAC);
+                return pEl->AssJac(WorkMat, dCoef, *pXCurr, *pXPrimeCurr);
+        }
+        catch (ErrDivideByZero& err) {
+                silent_cerr("AssJac: divide by zero "
+                        "in " << psElemNames[pEl->GetElemType()]
+                        << "(" << pEl->GetLabel() << ")"
+                        << std::endl);
+                throw ErrDivideByZero(MBDYN_EXCEPT_ARGS);
+        }
+}
+
+void
+MultiThreadDataManager::CCAssJacColored(MatrixHandler& JacHdl, doublereal dCoef)
+{
+        ASSERT(thread_data != NULL);
+        ASSERT(!ColorSchedule.empty());
+
+        /* the matrix is shared: reset it only once */
+        JacHdl.Reset();
+        pColoredJacHdl = &JacHdl;
+
+        for (unsigned c = 0; c < ColorSchedule.size(); c++) {
+                ColorSchedule[c].Reset();
+        }
+
+        for (unsigned i = 0; i < nThreads; ++i) {
+             thread_data[i].except = std::exception_ptr{};
+             thread_data[i].dCoef = dCoef;
+             thread_data[i].Unrecorded.clear();
+        }
+
+        RunOp(MultiThreadDataManager::OP_ASSJAC_CC_COLORED, [&]() {
+                CCAssJacColoredThread(thread_data[0]);
+        });
+
+        pColoredJacHdl = 0;
+
+        if (propagate_ErrMatrixRebuild == AO_TS_SET) {
+                CCReady = CC_NO;
+
+                throw MatrixHandler::ErrRebuildMatrix(MBDYN_EXCEPT_ARGS);
+        }
+
+        for (unsigned i = 0; i < nThreads; ++i) {
+             if (thread_data[i].except) {
+                  std::rethrow_exception(thread_data[i].except);
+             }
+        }
+
+        for (unsigned c = 0; c < ColorSchedule.size(); c++) {
+                ColorSchedule[c].Rebalance();
+        }
+
+        /* elements that contributed to rows not accounted for
+         * by the coloring have been skipped: assemble them serially,
+         * add the new rows and color the elements again */
+        std::vector<unsigned> Unrecorded;
+        for (unsigned i = 0; i < nThreads; ++i) {
+                Unrecorded.insert(Unrecorded.end(),
+                        thread_data[i].Unrecorded.begin(),
+                        thread_data[i].Unrecorded.end());
+        }
+
+        if (Unrecorded.empty()) {
+                return;
+        }
+
+        std::sort(Unrecorded.begin(), Unrecorded.end());
+
+        CompactSparseMatrixHandler *pCSC
+                = dynamic_cast<CompactSparseMatrixHandler *>(&JacHdl);
+        std::vector<integer> Rows;
+        RowRecorderMatrixHandler oRecorder(JacHdl.iGetNumRows(), Rows);
+
+        for (unsigned i = 0; i < Unrecorded.size(); i++) {
+                unsigned e = Unrecorded[i];
+                Elem *pEl = Elems[e];
+
+                pedantic_cerr("MultiThreadDataManager: "
+                        << psElemNames[pEl->GetElemType()]
+                        << "(" << pEl->GetLabel() << ") contributes "
+                        "to rows not used for coloring" << std::endl);
+
+                const VariableSubMatrixHandler& WM
+                        = CCAssJacColoredElem(pEl, *pWorkMat, dCoef);
+                if (pCSC) {
+                        WM.AddTo(*pCSC, pEl->GetJacScatterPlan());
+
+                } else {
+                        JacHdl += WM;
+                }
+
+                Rows.assign(ElemRows[e].begin(), ElemRows[e].end());
+                oRecorder += WM;
+                std::sort(Rows.begin(), Rows.end());
+                ElemRows[e].assign(Rows.begin(),
+                        std::unique(Rows.begin(), Rows.end()));
+        }
+
+        CCAssJacColor();
+}
+
+void
+MultiThreadDataManager::CCAssJacColoredThread(ThreadData& oThread)
+{
+        CompactSparseMatrixHandler *pCSC
+                = dynamic_cast<CompactSparseMatrixHandler *>(pColoredJacHdl);
+        const integer iNumRows = pColoredJacHdl->iGetNumRows();
+        bool bFailed = false;
+
+        for (unsigned c = 0; c < ColorSchedule.size(); c++) {
+                if (!bFailed) {
+                        try {
+                                oThread.ColorIter.Init(&ColoredElems[ColorOffsets[c]],
+                                        ColorOffsets[c + 1] - ColorOffsets[c],
+                                        &ColorSchedule[c]);
+
+                                Elem *pEl = 0;
+                                if (oThread.ColorIter.bGetFirst(pEl)) {
+                                        do {
+                                                unsigned e = ColoredElemIdx[ColorOffsets[c]
+                                                        + oThread.ColorIter.iGetIndex()];
+                                                const VariableSubMatrixHandler& WM
+                                                        = CCAssJacColoredElem(pEl,
+                                                                *oThread.pWorkMat,
+                                                                oThread.dCoef);
+
+                                                /* only the rows of the element
+                                                 * are free of conflicts */
+                                                const std::vector<integer>& Rows = ElemRows[e];
+                                                for (unsigned r = 0; r < Rows.size(); r++) {
+                                                        oThread.RowMark[Rows[r]] = e + 1;
+                                                }
+
+                                                RowCheckerMatrixHandler oChecker(iNumRows,
+                                                        oThread.RowMark, e + 1);
+                                                oChecker += WM;
+                                                if (oChecker.bIsOutside()) {
+                                                        oThread.Unrecorded.push_back(e);
+
+                                                } else if (pCSC) {
+                                                        WM.AddTo(*pCSC, pEl->GetJacScatterPlan());
+
+                                                } else {
+                                                        *pColoredJacHdl += WM;
+                                                }
+                                        } while (oThread.ColorIter.bGetNext(pEl));
+                                }
+
+                        } catch (MatrixHandler::ErrRebuildMatrix& e) {
+                                silent_cerr("thread " << oThread.threadNumber
+                                        << " caught ErrRebuildMatrix"
+                                        << std::endl);
+
+                                mbdyn_test_and_set(&propagate_ErrMatrixRebuild);
+                                bFailed = true;
+
+                        } catch (...) {
+                                oThread.except = std::current_exception();
+                                bFailed = true;
+                        }
+                }
+
+                /* a color must be complete before the next one starts */
+                ThreadPool::Get().Barrier();
+        }
+}
+
 #ifdef USE_NAIVE_MULTITHREAD
 void MultiThreadDataManager::NaiveAssJacInit(NaiveMatrixHandler& JacHdl, doublereal dCoef)
 {
@@ -860,9 +1328,7 @@ MultiThreadDataManager::NaiveAssJac(NaiveMatrixHandler& JacHdl, doublereal dCoef
         ASSERT(thread_data != NULL);
 
         /* Assemble per-thread matrix */
-        thread_data[0].ElemIter.ResetAccessData();
-        op = MultiThreadDataManager::OP_ASSJAC_NAIVE;
-        thread_count = nThreads - 1;
+        ElemSchedule[ES_NAIVE].Reset();
 
         for (unsigned i = 0; i < nThreads; ++i) {
              thread_data[i].except = std::exception_ptr{};
@@ -870,8 +1336,6 @@ MultiThreadDataManager::NaiveAssJac(NaiveMatrixHandler& JacHdl, doublereal dCoef
 
         for (unsigned i = 1; i < nThreads; i++) {
                 thread_data[i].dCoef = dCoef;
-
-                sem_post(&thread_data[i].sem);
         }
 
         /* FIXME Right now it's already done before calling AssJac;
@@ -879,53 +1343,37 @@ MultiThreadDataManager::NaiveAssJac(NaiveMatrixHandler& JacHdl, doublereal dCoef
 #if 0
         thread_data[0].ppNaiveJacHdl[0]->Reset();
 #endif
-        try {
-             DataManager::AssJac(*thread_data[0].ppNaiveJacHdl[0],
-                                 dCoef,
-                                 thread_data[0].ElemIter,
-                                 *thread_data[0].pWorkMat);
-        } catch (...) {
-             thread_data[0].except = std::current_exception();
-        }
-        
-        pthread_mutex_lock(&thread_mutex);
-        if (thread_count > 0) {
-                pthread_cond_wait(&thread_cond, &thread_mutex);
-        }
-        pthread_mutex_unlock(&thread_mutex);
+        RunOp(MultiThreadDataManager::OP_ASSJAC_NAIVE, [&]() {
+                try {
+                     DataManager::AssJac(*thread_data[0].ppNaiveJacHdl[0],
+                                         dCoef,
+                                         thread_data[0].ElemIter[ES_NAIVE],
+                                         *thread_data[0].pWorkMat);
+                } catch (...) {
+                     thread_data[0].except = std::current_exception();
+                }
+        });
 
         for (unsigned i = 0; i < nThreads; ++i) {
              if (thread_data[i].except) {
                   std::rethrow_exception(thread_data[i].except);
              }
         }
-        
-        /* Sum per-thread matrices */
-        op = MultiThreadDataManager::OP_SUM_NAIVE;
-        thread_count = nThreads - 1;
-        for (unsigned i = 1; i < nThreads; i++) {
-                sem_post(&thread_data[i].sem);
-        }
-
-        NaiveMatrixHandler* to = thread_data[0].ppNaiveJacHdl[0];
-        integer nn = to->iGetNumRows();
-        integer iFrom = 0;
-        integer iTo = nn/nThreads;
-        for (unsigned matrix = 1; matrix < nThreads; matrix++) {
-                NaiveMatrixHandler* from = thread_data[0].ppNaiveJacHdl[matrix];
-                naivepsad(to->ppdRows,
-                                to->ppiRows, to->piNzr,
-                                to->ppiCols, to->piNzc, to->ppnonzero,
-                                from->ppdRows, from->ppiCols, from->piNzc,
-                                iFrom, iTo, thread_data[0].lock);
-        }
 
-        pthread_mutex_lock(&thread_mutex);
-        if (thread_count > 0) {
-                pthread_cond_wait(&thread_cond, &thread_mutex);
-        }
+        ElemSchedule[ES_NAIVE].Rebalance();
 
-        pthread_mutex_unlock(&thread_mutex);
+        /* Sum per-thread matrices */
+        RunOp(MultiThreadDataManager::OP_SUM_NAIVE, [&]() {
+                NaiveMatrixHandler* to = thread_data[0].ppNaiveJacHdl[0];
+                integer nn = to->iGetNumRows();
+                integer iFrom = 0;
+                integer iTo = nn/nThreads;
+                for (unsigned matrix = 1; matrix < nThreads; matrix++) {
+                        NaiveMatrixHandler* from = thread_data[0].ppNaiveJacHdl[matrix];
+                        naivepsad(to->pMat, from->pMat,
+                                        iFrom, iTo, thread_data[0].lock);
+                }
+        });
 }
 #endif
 
@@ -936,10 +1384,8 @@ MultiThreadDataManager::GradAssJac(SpGradientSparseMatrixHandler& JacHdl, double
 
         JacHdl.Reset(); // FIXME: Matrix cannot be reset in parallel by DataManager::AssJac
 
-        thread_data[0].ElemIter.ResetAccessData();
+        ElemSchedule[ES_GRAD].Reset();
         thread_data[0].oGradJacHdl.SetMatrixHandler(&JacHdl);
-        op = MultiThreadDataManager::OP_ASSJAC_GRAD;
-        thread_count = nThreads - 1;
 
         for (unsigned i = 0; i < nThreads; ++i) {
              thread_data[i].except = std::exception_ptr{};
@@ -948,23 +1394,16 @@ MultiThreadDataManager::GradAssJac(SpGradientSparseMatrixHandler& JacHdl, double
         for (unsigned i = 1; i < nThreads; i++) {
                 thread_data[i].dCoef = dCoef;
                 thread_data[i].oGradJacHdl.SetMatrixHandler(&JacHdl);
-                sem_post(&thread_data[i].sem);
         }
 
-        try {
-             DataManager::AssJac(thread_data[0].oGradJacHdl, dCoef, thread_data[0].ElemIter,
-                                 *thread_data[0].pWorkMat);
-        } catch (...) {
-             thread_data[0].except = std::current_exception();
-        }
-        
-        pthread_mutex_lock(&thread_mutex);
-
-        if (thread_count > 0) {
-                pthread_cond_wait(&thread_cond, &thread_mutex);
-        }
-
-        pthread_mutex_unlock(&thread_mutex);
+        RunOp(MultiThreadDataManager::OP_ASSJAC_GRAD, [&]() {
+                try {
+                     DataManager::AssJac(thread_data[0].oGradJacHdl, dCoef, thread_data[0].ElemIter[ES_GRAD],
+                                         *thread_data[0].pWorkMat);
+                } catch (...) {
+                     thread_data[0].except = std::current_exception();
+                }
+        });
 
         for (unsigned i = 0; i < nThreads; i++) {
                 thread_data[i].oGradJacHdl.SetMatrixHandler(nullptr);
@@ -975,59 +1414,137 @@ MultiThreadDataManager::GradAssJac(SpGradientSparseMatrixHandler& JacHdl, double
                   std::rethrow_exception(thread_data[i].except);
              }
         }
+
+        ElemSchedule[ES_GRAD].Rebalance();
 }
 
-void MultiThreadDataManager::SetAffinity(const ThreadData& oThread)
+void
+MultiThreadDataManager::AssResElem(ThreadData& oThread, Elem *pEl, unsigned iElem)
 {
-     if (oThread.iCPUIndex >= 0) {
-          Task2CPU oCPUSet;
+        const SubVectorHandler *pWorkVec = oThread.pWorkVec;
 
-          pedantic_cerr("Setting affinity of thread " << oThread.threadNumber << " to CPU " << oThread.iCPUIndex << " ...\n");
+        try {
+                ElemProfiler::Sample ps(pElemProf, pEl, ElemProfiler::ASSRES);
+                pWorkVec = &pEl->AssRes(*oThread.pWorkVec, oThread.dCoef,
+                        *pXCurr, *pXPrimeCurr);
+
+        } catch (Elem::ChangedEquationStructure& e) {
+                oThread.bChangedEqStructure = true;
+
+        } catch (ErrDivideByZero& e) {
+                silent_cerr("AssRes: divide by zero "
+                        "in " << psElemNames[pEl->GetElemType()]
+                        << "(" << pEl->GetLabel() << ")"
+                        << std::endl);
+                throw ErrDivideByZero(MBDYN_EXCEPT_ARGS);
+        }
 
-          oCPUSet.SetCPU(oThread.iCPUIndex);
+        /* same order as SubVectorHandler::AddTo() */
+        ResContrib& rc = ResContribs[iElem];
+        rc.uThread = oThread.threadNumber;
+        rc.uOffset = oThread.ResRows.size();
+        for (integer i = pWorkVec->iGetSize(); i > 0; i--) {
+                oThread.ResRows.push_back(pWorkVec->iGetRowIndex(i));
+                oThread.ResCoefs.push_back(pWorkVec->dGetCoef(i));
+        }
+        rc.uSize = oThread.ResRows.size() - rc.uOffset;
+}
 
-          if (!oCPUSet.bSetAffinity()) {
-               silent_cerr("Failed to set affinity of thread " << oThread.threadNumber
-                           << " to CPU " << oThread.iCPUIndex << "\n");
-          }
-     }
+void
+MultiThreadDataManager::AssResThread(ThreadData& oThread)
+{
+        Elem *pEl = 0;
+        if (oThread.ResIter.bGetFirst(pEl)) {
+                do {
+                        unsigned iElem = oThread.ResIter.iGetIndex();
+                        if (!bResSerial[iElem]) {
+                                AssResElem(oThread, pEl, iElem);
+                        }
+                } while (oThread.ResIter.bGetNext(pEl));
+        }
 }
 
-#ifdef MBDYN_X_MT_ASSRES
 void
-MultiThreadDataManager::AssRes(VectorHandler& ResHdl, doublereal dCoef, const VectorHandler* pAbsResHdl)
+MultiThreadDataManager::AssRes(VectorHandler& ResHdl, doublereal dCoef, VectorHandler*const pAbsResHdl)
         /*throw(ChangedEquationStructure)*/
 {
+        if (!(uMTFlags & MT_ASSRES)) {
+                DataManager::AssRes(ResHdl, dCoef, pAbsResHdl);
+                return;
+        }
+
         ASSERT(thread_data != NULL);
 
-        thread_data[0].ElemIter.ResetAccessData();
-        op = MultiThreadDataManager::OP_ASSRES;
-        thread_count = nThreads - 1;
+        ResSchedule.Reset();
 
-        for (unsigned i = 1; i < nThreads; i++) {
+        for (unsigned i = 0; i < nThreads; i++) {
+                thread_data[i].except = std::exception_ptr{};
                 thread_data[i].dCoef = dCoef;
+                thread_data[i].ResRows.clear();
+                thread_data[i].ResCoefs.clear();
+                thread_data[i].bChangedEqStructure = false;
+        }
 
-                sem_post(&thread_data[i].sem);
+        for (std::vector<unsigned>::const_iterator i = ResLeadElems.begin();
+                i != ResLeadElems.end(); ++i)
+        {
+                AssResElem(thread_data[0], Elems[*i], *i);
         }
 
-        DataManager::AssRes(ResHdl, dCoef, thread_data[0].ElemIter,
-                        *thread_data[0].pWorkVec, *thread_data[0].pAbsResHdl);
+        RunOp(MultiThreadDataManager::OP_ASSRES, [&]() {
+                try {
+                        for (std::vector<unsigned>::const_iterator i = ResSerialElems.begin();
+                                i != ResSerialElems.end(); ++i)
+                        {
+                                AssResElem(thread_data[0], Elems[*i], *i);
+                        }
+
+                        AssResThread(thread_data[0]);
+
+                } catch (...) {
+                        thread_data[0].except = std::current_exception();
+                }
+        });
 
-        pthread_mutex_lock(&thread_mutex);
-        if (thread_count > 0) {
-                pthread_cond_wait(&thread_cond, &thread_mutex);
+        for (unsigned i = 0; i < nThreads; ++i) {
+             if (thread_data[i].except) {
+                  std::rethrow_exception(thread_data[i].except);
+             }
         }
-        pthread_mutex_unlock(&thread_mutex);
 
-        for (unsigned i = 1; i < nThreads; i++) {
-                ResHdl += *thread_data[i].pResHdl;
+        ResSchedule.Rebalance();
+
+        /* sum the contributions in the order of the elements,
+         * as DataManager::AssRes() would */
+        bool bChangedEqStructure = false;
+        for (unsigned i = 0; i < nThreads; i++) {
+                bChangedEqStructure |= thread_data[i].bChangedEqStructure;
         }
-        if (pAbsResHdl) {
-                for (unsigned i = 1; i < nThreads; i++) {
-                        *thread_data[i].pAbsResHdl.AddAbsValuesTo(ResHdl);
+
+        for (std::vector<ResContrib>::const_iterator rc = ResContribs.begin();
+                rc != ResContribs.end(); ++rc)
+        {
+                if (rc->uSize == 0) {
+                        continue;
                 }
+
+                const integer *piRow = &thread_data[rc->uThread].ResRows[rc->uOffset];
+                const doublereal *pdCoef = &thread_data[rc->uThread].ResCoefs[rc->uOffset];
+
+                for (unsigned i = 0; i < rc->uSize; i++) {
+                        ResHdl.IncCoef(piRow[i], pdCoef[i]);
+                }
+
+                if (pAbsResHdl) {
+                        for (unsigned i = 0; i < rc->uSize; i++) {
+                                pAbsResHdl->IncCoef(piRow[i], std::abs(pdCoef[i]));
+                        }
+                }
+        }
+
+        if (bChangedEqStructure) {
+                throw ChangedEquationStructure(MBDYN_EXCEPT_ARGS);
         }
 }
-#endif /* MBDYN_X_MT_ASSRES */
 
 #endif /* USE_MULTITHREAD */
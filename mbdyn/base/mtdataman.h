@@ -36,6 +36,8 @@
 
 #ifdef USE_MULTITHREAD
 
+#include <functional>
+
 #include "ac/pthread.h"		/* includes POSIX semaphores */
 
 #include "dataman.h"
@@ -52,12 +54,23 @@ class Solver;
 /* MultiThreadDataManager - begin */
 
 class MultiThreadDataManager : public DataManager {
+public:
+        /* assembly options */
+        enum {
+                MT_DEFAULT = 0x0U,
+                MT_COLORED = 0x1U,	/* colored assembly into a shared CC matrix */
+                MT_ASSRES = 0x2U	/* concurrent assembly of the residual */
+        };
+
 protected:
         // nThreads is now in DataManager
+        unsigned uMTFlags;
+
         enum {
                 ASS_UNKNOWN = -1,
 
                 ASS_CC,			/* use native column-compressed form */
+                ASS_CC_COLORED,		/* conflict-free colors, shared CC matrix */
 #ifdef USE_NAIVE_MULTITHREAD
                 ASS_NAIVE,		/* use native H-P sparse solver */
 #endif
@@ -75,15 +88,66 @@ protected:
                 CC_YES
         } CCReady;
 
-        /* per-thread specific data */
+        /* cost-aware chunked distribution of the elements to the threads;
+         * one per kind of Jacobian assembly, since the cost of each
+         * element (and thus the balance) depends on it */
+        enum ElemScheduleType {
+                ES_CC,
+#ifdef USE_NAIVE_MULTITHREAD
+                ES_NAIVE,
+#endif
+                ES_GRAD,
+                ES_GRAD_PROD,
+
+                ES_LAST
+        };
+        MT_ChunkSchedule ElemSchedule[ES_LAST];
+
+        /* elements sorted by color: the elements of a color never
+         * contribute to the same rows, so they can be assembled
+         * concurrently into the same matrix */
+        std::vector<Elem *> ColoredElems;
+        std::vector<unsigned> ColorOffsets;
+        std::vector<MT_ChunkSchedule> ColorSchedule;
+        std::vector<unsigned> ColoredElemIdx;	/* index in Elems */
+
+        /* rows of each element (sorted) the coloring is based on;
+         * an element that contributes to other rows is assembled
+         * serially, and the elements are colored again */
+        std::vector<std::vector<integer> > ElemRows;
+        MatrixHandler *pColoredJacHdl;
+
+        /* residual assembly: each thread records the contributions
+         * of the elements it assembles; they are summed afterwards
+         * in the order of the elements, so the residual does not
+         * depend on the number of threads nor on the schedule */
+        MT_ChunkSchedule ResSchedule;
+        struct ResContrib {
+                unsigned uThread;
+                unsigned uOffset;
+                unsigned uSize;
+        };
+        std::vector<ResContrib> ResContribs;
+
+        /* elements whose residual has side effects on other elements
+         * (e.g. aerodynamic elements and rotors); they are assembled
+         * by the main thread in their original order */
+        std::vector<unsigned> ResSerialElems;
+        std::vector<bool> bResSerial;
+
+        /* elements whose residual updates data read by all the others
+         * (e.g. gravity and air properties); they are assembled by the
+         * main thread before the helper threads are started */
+        std::vector<unsigned> ResLeadElems;
+
+        /* per-thread specific data; the threads are those of the pool */
         struct ThreadData {
                 MultiThreadDataManager *pDM;
                 integer threadNumber;
-                integer iCPUIndex;
-                pthread_t thread;
-                sem_t sem;
                 std::exception_ptr except;
-                mutable MT_VecIter<Elem *> ElemIter;
+                mutable MT_ChunkVecIter<Elem *> ElemIter[ES_LAST];
+                mutable MT_ChunkVecIter<Elem *> ColorIter;
+                mutable MT_ChunkVecIter<Elem *> ResIter;
 
                 VariableSubMatrixHandler *pWorkMatA;	/* Working SubMatrix */
                 VariableSubMatrixHandler *pWorkMatB;
@@ -92,6 +156,11 @@ protected:
 
                 /* for CC assembly */
                 CompactSparseMatrixHandler* pJacHdl;
+
+                /* for colored assembly: rows of the current element,
+                 * and elements that contributed to other rows */
+                std::vector<unsigned> RowMark;
+                std::vector<unsigned> Unrecorded;
 #ifdef USE_NAIVE_MULTITHREAD
                 /* for Naive assembly */
                 NaiveMatrixHandler** ppNaiveJacHdl;
@@ -101,10 +170,13 @@ protected:
                 VectorHandler* pJacProd;
 
                 AO_TS_t* lock;
-#ifdef MBDYN_X_MT_ASSRES
-                VectorHandler* pResHdl;
-#endif
-                VectorHandler* pAbsResHdl;
+
+                /* for residual assembly: rows and values
+                 * of the recorded contributions */
+                std::vector<integer> ResRows;
+                std::vector<doublereal> ResCoefs;
+                bool bChangedEqStructure;
+
                 MatrixHandler* pMatA;
                 MatrixHandler* pMatB;
                 doublereal dCoef;
@@ -114,6 +186,7 @@ protected:
                 OP_UNKNOWN = -1,
 
                 OP_ASSJAC_CC,
+                OP_ASSJAC_CC_COLORED,
 #ifdef USE_NAIVE_MULTITHREAD
                 OP_ASSJAC_NAIVE,
                 OP_SUM_NAIVE,
@@ -121,7 +194,6 @@ protected:
                 OP_ASSJAC_GRAD,
                 OP_ASSJAC_PROD,
 
-                /* used only #ifdef MBDYN_X_MT_ASSRES */
                 OP_ASSRES,
 
                 /* not used yet */
@@ -131,42 +203,41 @@ protected:
                 OP_AFTERCONVERGENCE,
                 /* end of not used yet */
 
-                OP_EXIT,
-
                 LAST_OP
         } op;
 
-        /* will be replaced by barriers ... */
-        unsigned thread_count;
-
-        /* this can be replaced by a barrier ... */
-        pthread_mutex_t	thread_mutex;
-        pthread_cond_t	thread_cond;
-
         /* this is used to propagate ErrMatrixRebuild ... */
         AO_TS_t	propagate_ErrMatrixRebuild;
 
-        void EndOfOp(void);
-
-        /* thread function */
-        static void *thread(void *arg);
+        /* executes op in the helper threads */
+        void ThreadOp(ThreadData *arg);
         static void thread_cleanup(ThreadData *arg);
 
-        /* starts the helper threads */
-        void ThreadSpawn(void);
+        /* runs op on the thread pool; the calling thread executes f */
+        void RunOp(DataManagerOp o, const std::function<void (void)>& f);
+
+        /* sets up the per-thread data */
+        void ThreadInit(void);
         void ThreadDestroy(void);
 
         /* specialized assembly */
         virtual void CCAssJac(MatrixHandler& JacHdl, doublereal dCoef);
+        void CCAssJacColorInit(MatrixHandler& JacHdl, doublereal dCoef);
+        void CCAssJacColor(void);
+        const VariableSubMatrixHandler&
+        CCAssJacColoredElem(Elem *pEl, VariableSubMatrixHandler& WorkMat,
+                doublereal dCoef);
+        void CCAssJacColored(MatrixHandler& JacHdl, doublereal dCoef);
+        void CCAssJacColoredThread(ThreadData& oThread);
 #ifdef USE_NAIVE_MULTITHREAD
         virtual void NaiveAssJac(NaiveMatrixHandler& JacHdl, doublereal dCoef);
         virtual void NaiveAssJacInit(NaiveMatrixHandler& JacHdl, doublereal dCoef);
 #endif
         void GradAssJac(SpGradientSparseMatrixHandler& JacHdl, doublereal dCoef);
+        void AssResElem(ThreadData& oThread, Elem *pEl, unsigned iElem);
+        void AssResThread(ThreadData& oThread);
         void GradAssJacProd(VectorHandler& JacY, const VectorHandler& Y, doublereal dCoef);
         virtual void AssJac(VectorHandler& JacY, const VectorHandler& Y, doublereal dCoef) override;
-
-        static void SetAffinity(const ThreadData& oThread);
 public:
         /* costruttore - legge i dati e costruisce le relative strutture */
         MultiThreadDataManager(MBDynParser& HP,
@@ -176,7 +247,8 @@ public:
                         const char* sOutputFileName,
                         const char* sInputFileName,
                         bool bAbortAfterInput,
-                        unsigned nt);
+                        unsigned nt,
+                        unsigned uFlags = MT_DEFAULT);
 
         /* distruttore */
         virtual ~MultiThreadDataManager(void);
@@ -184,11 +256,14 @@ public:
         /* Assembla lo jacobiano */
         virtual void AssJac(MatrixHandler& JacHdl, doublereal dCoef) override;
 
-#ifdef MBDYN_X_MT_ASSRES
+        /* Residuo e jacobiano vengono assemblati separatamente,
+         * per usare l'assemblaggio parallelo dello jacobiano */
+        virtual void AssResJac(VectorHandler& ResHdl, MatrixHandler& JacHdl,
+                               doublereal dCoef, VectorHandler*const pAbsResHdl = 0) override;
+
         /* Assembla il residuo */
-        virtual void AssRes(VectorHandler &ResHdl, doublereal dCoef, VectorHandler*const pAbsResHdl = 0)
+        virtual void AssRes(VectorHandler &ResHdl, doublereal dCoef, VectorHandler*const pAbsResHdl = 0) override
                 /*throw(ChangedEquationStructure)*/;
-#endif /* MBDYN_X_MT_ASSRES */
 };
 
 /* MultiThreadDataManager - end */
@@ -423,6 +423,11 @@ tplStageNIntegrator<N>::Advance(Solver* pS,
 
 		SetCoefForStageS(S, TStep, dAph, StType);
 		PredictForStageS(S);
+		if (m_bLocalError && S == N) {
+			// the estimate uses the prediction of the last stage,
+			// extrapolated from the stages of this step
+			SavePrediction();
+		}
 		pDM->LinkToSolution(*pXCurr, *pXPrimeCurr);
      	 	pDM->AfterPredict();
 
@@ -458,11 +463,24 @@ tplStageNIntegrator<N>::Advance(Solver* pS,
 
 		tmpErr = 0.;
 		tmpEffIter = 0;
-		pS->pGetNonlinearSolver()->Solve(this, pS, MaxIters, dTol,
-    			tmpEffIter, tmpErr, dSolTol, SolErr);
+		try {
+			pS->pGetNonlinearSolver()->Solve(this, pS, MaxIters, dTol,
+    				tmpEffIter, tmpErr, dSolTol, SolErr);
+		}
+		catch (NonlinearSolver::ConvergenceOnSolution& e) {
+			if (m_bLocalError && S == N) {
+				pS->CheckLocalError(dLocalError());
+			}
+			throw;
+		}
 		EffIter += tmpEffIter;
 		Err += tmpErr;
 
+		// the step may still be rejected because of the local error
+		if (m_bLocalError && S == N) {
+			pS->CheckLocalError(dLocalError());
+		}
+
 		// if it gets here, it surely converged
 		pDM->AfterConvergence();
 	}
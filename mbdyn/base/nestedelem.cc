@@ -205,6 +205,20 @@ NestedElem::AfterConvergence(const VectorHandler& X, const VectorHandler& XP)
 	pElem->AfterConvergence(X, XP);
 }
 
+void
+NestedElem::SaveState(CheckpointOut& out) const
+{
+	ASSERT(pElem != NULL);
+	pElem->SaveState(out);
+}
+
+void
+NestedElem::RestoreState(CheckpointIn& in)
+{
+	ASSERT(pElem != NULL);
+	pElem->RestoreState(in);
+}
+
 /* assemblaggio jacobiano */
 VariableSubMatrixHandler& 
 NestedElem::AssJac(VariableSubMatrixHandler& WorkMat,
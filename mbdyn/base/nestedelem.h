@@ -130,6 +130,9 @@ public:
 	virtual void AfterConvergence(const VectorHandler& X,
      			const VectorHandler& XP);
 
+	virtual void SaveState(CheckpointOut& out) const;
+	virtual void RestoreState(CheckpointIn& in);
+
 	/* assemblaggio jacobiano */
 	virtual VariableSubMatrixHandler&
 	AssJac(VariableSubMatrixHandler& WorkMat,
@@ -216,12 +216,12 @@ DataManager::fGetDefaultOutputFlag(const Node::Type& t) const
 Node*
 DataManager::pFindNode(Node::Type Typ, unsigned int uL) const
 {
-	NodeMapToListType::const_iterator p = NodeData[Typ].NodeMapToList.find(uL);
-	if (p == NodeData[Typ].NodeMapToList.end()) {
+	KeyNodePair *p = NodeData[Typ].NodeMapToList.find(uL);
+	if (p == 0) {
 		return 0;
 	}
 
-	return p->second->second;
+	return p->second;
 }
 
 /* DataManager - end */
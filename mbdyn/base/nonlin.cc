@@ -746,6 +746,9 @@ std::ostream& NonlinearSolver::PrintSolverTime(std::ostream& os) const
      os << "\toverall CPU time spent in AssRes:\t" << FloatSec(dTimeCPU[CPU_RESIDUAL]).count() << "s\n";
      os << "\toverall CPU time spent in AssJac:\t" << FloatSec(dTimeCPU[CPU_JACOBIAN]).count() << "s\n";
      os << "\toverall CPU time spent in Solve:\t" << FloatSec(dTimeCPU[CPU_LINEAR_SOLVER]).count() << "s\n";
+     if (dTimeCPU[CPU_RESIDUAL_JACOBIAN].count() > 0) {
+	  os << "\toverall CPU time spent in AssResJac:\t" << FloatSec(dTimeCPU[CPU_RESIDUAL_JACOBIAN]).count() << "s\n";
+     }
 
      std::chrono::nanoseconds total(0);
 
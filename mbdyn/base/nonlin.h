@@ -331,6 +331,10 @@ public:
  	public:
  		MaxResidualExceeded(MBDYN_EXCEPT_ARGS_DECL): NoConvergence(MBDYN_EXCEPT_ARGS_PASSTHRU) {};
  	};
+ 	class LocalErrorExceeded: public NoConvergence {
+ 	public:
+ 		LocalErrorExceeded(MBDYN_EXCEPT_ARGS_DECL): NoConvergence(MBDYN_EXCEPT_ARGS_PASSTHRU) {};
+ 	};
 	class ConvergenceOnSolution : public MBDynErrBase {
 	public:
 		ConvergenceOnSolution(MBDYN_EXCEPT_ARGS_DECL) : MBDynErrBase(MBDYN_EXCEPT_ARGS_PASSTHRU) {};
@@ -379,6 +383,7 @@ protected:
 		CPU_RESIDUAL,
 		CPU_JACOBIAN,
 		CPU_LINEAR_SOLVER,
+		CPU_RESIDUAL_JACOBIAN,	/* fused assembly */
 		CPU_LAST_TYPE
 	};
 
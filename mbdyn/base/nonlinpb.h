@@ -56,8 +56,31 @@ public:
 
         virtual void Jacobian(VectorHandler* pJac, const VectorHandler* pY) const = 0;
 
+	/* residuo e jacobiano nello stesso punto; chi puo' li assembla
+	 * con un solo passaggio sugli elementi.  Come Residual(),
+	 * puo' sollevare ChangedEquationStructure, ma solo dopo
+	 * aver assemblato anche lo jacobiano */
+	virtual void ResidualJacobian(VectorHandler* pRes, VectorHandler* pAbsRes,
+		MatrixHandler* pJac) const {
+		try {
+			Residual(pRes, pAbsRes);
+		}
+		catch (SolutionDataManager::ChangedEquationStructure& e) {
+			Jacobian(pJac);
+			throw;
+		}
+		Jacobian(pJac);
+	};
+
 	virtual void Update(const VectorHandler* pSol) const = 0;
 
+	/* coefficiente delle derivate nello jacobiano; serve per
+	 * capire se uno jacobiano gia' fattorizzato e' ancora
+	 * rappresentativo (0 se non significativo) */
+	virtual doublereal dGetJacobianCoef(void) const {
+		return 0.;
+	};
+
 	/* scale factor for tests */
 	virtual doublereal TestScale(const NonlinearSolverTest *pTest,
 								 doublereal& dAlgebraicEquations) const = 0;
@@ -53,25 +53,90 @@
 #include <cfloat>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 
 NewtonRaphsonSolver::NewtonRaphsonSolver(const bool bTNR,
                                          const bool bKJ, 
                                          const integer IterBfAss,
-                                         const NonlinearSolverTestOptions& options)
+                                         const NonlinearSolverTestOptions& options,
+                                         const bool bFRJ,
+                                         const doublereal dAR,
+                                         const doublereal dACR)
 : NonlinearSolver(options), pRes(NULL),pAbsRes(NULL),
 pSol(NULL),
 bTrueNewtonRaphson(bTNR),
 IterationBeforeAssembly(IterBfAss),
 bKeepJac(bKJ),
+bFusedAssembly(bFRJ),
 iPerformedIterations(0),
-pPrevNLP(0)
+pPrevNLP(0),
+dAdaptiveRate(dAR),
+dAdaptiveCoefRatio(dACR),
+bJacValid(false),
+dJacCoef(0.)
 {
-	NO_OP;
+	std::memset(&AdaptiveStats, 0, sizeof(AdaptiveStats));
 }
 
 NewtonRaphsonSolver::~NewtonRaphsonSolver(void)
 {
-	NO_OP;
+	if (dAdaptiveRate > 0. && AdaptiveStats.iIterations > 0) {
+		unsigned long iReused = AdaptiveStats.iIterations - AdaptiveStats.iJacobians;
+
+		silent_cout("NewtonRaphsonSolver: adaptive Jacobian: "
+			<< AdaptiveStats.iIterations << " iterations, "
+			<< AdaptiveStats.iJacobians << " Jacobian matrices, "
+			<< iReused << " reused ("
+			<< (100.*iReused)/AdaptiveStats.iIterations << "%); "
+			"Jacobian refreshed because of "
+			<< AdaptiveStats.iFirst << " new problems, "
+			<< AdaptiveStats.iCoef << " coefficient changes, "
+			<< AdaptiveStats.iRate << " slow convergence, "
+			<< AdaptiveStats.iRequest << " element requests"
+			<< std::endl);
+	}
+}
+
+bool
+NewtonRaphsonSolver::bCoefChanged(const doublereal& dCoef) const
+{
+	if (dCoef == dJacCoef) {
+		return false;
+	}
+
+	if (dCoef <= 0. || dJacCoef <= 0.) {
+		return true;
+	}
+
+	doublereal dRatio = dCoef/dJacCoef;
+	if (dRatio < 1.) {
+		dRatio = 1./dRatio;
+	}
+
+	return dRatio > dAdaptiveCoefRatio;
+}
+
+bool
+NewtonRaphsonSolver::bRateTooSlow(const doublereal& dRate,
+	const doublereal& dErr,
+	const doublereal& Tol,
+	integer iIterCnt,
+	integer iMaxIter) const
+{
+	if (dRate > dAdaptiveRate) {
+		return true;
+	}
+
+	/* con questa velocita' di convergenza non si arriverebbe
+	 * alla tolleranza entro il numero massimo di iterazioni */
+	if (dRate > 0. && Tol > 0. && dErr > Tol) {
+		doublereal dIters = std::log(Tol/dErr)/std::log(dRate);
+		if (iIterCnt + dIters > std::abs(iMaxIter)) {
+			return true;
+		}
+	}
+
+	return false;
 }
 
 void
@@ -94,18 +159,28 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
 
         if (pNLP != pPrevNLP) {
             ResetCond();
+            bJacValid = false;
         }
         
 	pPrevNLP = pNLP;
 	dSolErr = 0.;
 
+	/* riuso adattativo: lo jacobiano resta valido solo se
+	 * si esce normalmente; dopo un'eccezione va ricalcolato */
+	const bool bAdaptive = (dAdaptiveRate > 0.);
+	bool bHaveJac = bJacValid;
+	bJacValid = false;
+	const doublereal dCoef = pNLP->dGetJacobianCoef();
+
 	bool bResConverged = pGetResTest()->GetType() == NonlinearSolverTest::NONE;
 	bool bSolConverged = pGetSolTest()->GetType() == NonlinearSolverTest::NONE;
 	doublereal dOldErr = 0.;
 	doublereal dErrFactor = 1.;
 	doublereal dErrDiff = 0.;
+	doublereal dErrRate = 1.;
 	bool bJacBuilt = false;
         CPUStopWatch oCPUResidual(*this, CPU_RESIDUAL), oCPUJacobian(*this, CPU_JACOBIAN), oCPULinearSolver(*this, CPU_LINEAR_SOLVER);
+        CPUStopWatch oCPUResidualJacobian(*this, CPU_RESIDUAL_JACOBIAN);
 
         oCPUResidual.Tic();
                 
@@ -125,15 +200,82 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
 		}
 
 		bool forceJacobian(false);
-		try {
-	      		pNLP->Residual(pRes, pAbsRes);
+
+		/* gli jacobiani richiesti dal riuso adattativo per motivi
+		 * noti prima del residuo */
+		bool bAdaptiveJac(false);
+		if (bAdaptive) {
+			if (!bHaveJac) {
+				bAdaptiveJac = true;
+				AdaptiveStats.iFirst++;
+
+			} else if (bCoefChanged(dCoef)) {
+				bAdaptiveJac = true;
+				AdaptiveStats.iCoef++;
+			}
 		}
-		catch (SolutionDataManager::ChangedEquationStructure& e) {
-			if (bHonorJacRequest) {
-				forceJacobian = true;
+
+		/* se lo jacobiano va comunque ricalcolato in questa
+		 * iterazione, residuo e jacobiano possono essere assemblati
+		 * con un solo passaggio sugli elementi; solo pero' se
+		 * l'iterazione non puo' terminare sul test del residuo,
+		 * altrimenti lo jacobiano dell'iterazione che converge
+		 * andrebbe sprecato: o perche' il test sulla soluzione
+		 * non e' ancora soddisfatto, o perche' l'errore stimato
+		 * dagli ultimi due, supponendo convergenza quadratica
+		 * (e_k+1 = e_k^3/e_k-1^2), e' ancora sopra la tolleranza;
+		 * senza storia si suppone che non converga: alla prima
+		 * iterazione sempre, alla seconda se e_0 > Tol */
+		const bool bFused = bFusedAssembly
+			&& (!bSolConverged
+				|| iIterCnt == 0
+				|| dOldErr*dErrRate*dErrRate > Tol)
+			&& iIterCnt < std::abs(iMaxIter)
+			&& (bAdaptive ? bAdaptiveJac
+				: (bTrueNewtonRaphson
+					|| (iPerformedIterations%IterationBeforeAssembly == 0)));
+
+		if (bFused) {
+			oCPUResidualJacobian.Tic(oCPUResidual);
+      			pSM->MatrReset();
+		}
+
+		for (bool bRebuild = true; bRebuild; ) {
+			bRebuild = false;
+			try {
+				if (bFused) {
+					pNLP->ResidualJacobian(pRes, pAbsRes, pSM->pMatHdl());
+
+				} else {
+	      				pNLP->Residual(pRes, pAbsRes);
+				}
+			}
+			catch (SolutionDataManager::ChangedEquationStructure& e) {
+				if (bHonorJacRequest) {
+					forceJacobian = true;
+				}
+			}
+			catch (MatrixHandler::ErrRebuildMatrix& e) {
+				silent_cout("NewtonRaphsonSolver: "
+						"rebuilding matrix..."
+						<< std::endl);
+
+				/* need to rebuild the matrix... */
+      				pSM->MatrInitialize();
+				bHaveJac = false;
+				pRes->Reset();
+				if (pAbsRes) {
+					pAbsRes->Reset();
+				}
+				/* FIXME: could loop forever! */
+				bRebuild = true;
 			}
 		}
 
+		if (bFused) {
+			oCPUResidual.Tic(oCPUResidualJacobian);
+		}
+
 		/* FIXME: if Tol == 0., no convergence on residual
 		 * is required, so we could simply don't compute
 		 * the test; I'm leaving it in place so it appears
@@ -146,9 +288,28 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
 			pS->PrintResidual(*pRes, iIterCnt);
 		}
 
+		if (bFused) {
+			/* lo jacobiano e' gia' nella matrice */
+			bHaveJac = true;
+			dJacCoef = dCoef;
+
+		} else if (bAdaptive && !bAdaptiveJac) {
+			if (forceJacobian || !bHaveJac) {
+				bAdaptiveJac = true;
+				AdaptiveStats.iRequest++;
+
+			} else if (iIterCnt > 0 && dOldErr > 0.
+				&& bRateTooSlow(dErr/dOldErr, dErr, Tol, iIterCnt, iMaxIter))
+			{
+				bAdaptiveJac = true;
+				AdaptiveStats.iRate++;
+			}
+		}
+
 		if (iIterCnt > 0) {
 			dErrFactor *= dErr/dOldErr;
 		}
+		dErrRate = (iIterCnt > 0 && dOldErr > 0.) ? dErr/dOldErr : 1.;
 		dOldErr = dErr;
 
 #ifdef USE_MPI
@@ -182,6 +343,9 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
                                     silent_cout(" CPU:" << oCPUResidual
                                                 << "+" << oCPUJacobian
                                                 << "+" << oCPULinearSolver);
+                                    if (bFusedAssembly) {
+                                        silent_cout("+" << oCPUResidualJacobian);
+                                    }
 				}
 
 				silent_cout('\n');
@@ -191,11 +355,13 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
 		pS->CheckTimeStepLimit(dErr, dErrDiff);
 
 		if (bResConverged && bSolConverged) {
+			bJacValid = bHaveJac;
 			return;
 		}
       		
 		if (iIterCnt >= std::abs(iMaxIter)) {
 			if (iMaxIter < 0 && dErrFactor < 1.) {
+				bJacValid = bHaveJac;
 				return;
 			}
 			if (outputBailout()) {
@@ -210,9 +376,15 @@ NewtonRaphsonSolver::Solve(const NonlinearProblem *pNLP,
         
       	bJacBuilt = false;
 
-		if (bTrueNewtonRaphson
-			|| (iPerformedIterations%IterationBeforeAssembly == 0)
-			|| forceJacobian)
+		if (bFused) {
+			/* gia' assemblato insieme al residuo */
+			TotJac++;
+			bJacBuilt = true;
+
+		} else if (bAdaptive ? bAdaptiveJac
+			: (bTrueNewtonRaphson
+				|| (iPerformedIterations%IterationBeforeAssembly == 0)
+				|| forceJacobian))
 		{
       			pSM->MatrReset();
 rebuild_matrix:;
@@ -234,10 +406,19 @@ rebuild_matrix:;
 
 			TotJac++;
 			bJacBuilt = true;
+			bHaveJac = true;
+			dJacCoef = dCoef;
 		}
 
 		iPerformedIterations++;
 
+		if (bAdaptive) {
+			AdaptiveStats.iIterations++;
+			if (bJacBuilt) {
+				AdaptiveStats.iJacobians++;
+			}
+		}
+
 #ifdef USE_MPI
 		if (!bParallel || MBDynComm.Get_rank() == 0)
 #endif /* USE_MPI */
@@ -286,6 +467,7 @@ rebuild_matrix:;
 		}
 
 		if (bResConverged && bSolConverged) {
+		     bJacValid = bHaveJac;
 		     return;
 		}
 
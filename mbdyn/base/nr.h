@@ -52,14 +52,42 @@ class NewtonRaphsonSolver : public NonlinearSolver
 	bool bTrueNewtonRaphson;
 	integer IterationBeforeAssembly;
 	bool bKeepJac;
+	bool bFusedAssembly;
 	integer iPerformedIterations;
 	const NonlinearProblem* pPrevNLP;	
 
+	/* riuso adattativo dello jacobiano: la matrice fattorizzata
+	 * viene mantenuta fra le iterazioni e fra i passi finche'
+	 * il rapporto fra residui successivi resta sotto dAdaptiveRate
+	 * e il coefficiente dello jacobiano non cambia piu' di
+	 * dAdaptiveCoefRatio volte (disabilitato se dAdaptiveRate <= 0) */
+	doublereal dAdaptiveRate;
+	doublereal dAdaptiveCoefRatio;
+	bool bJacValid;
+	doublereal dJacCoef;
+
+	/* statistiche del riuso adattativo */
+	struct {
+		unsigned long iIterations;
+		unsigned long iJacobians;
+		unsigned long iFirst;
+		unsigned long iRate;
+		unsigned long iCoef;
+		unsigned long iRequest;
+	} AdaptiveStats;
+
+	bool bCoefChanged(const doublereal& dCoef) const;
+	bool bRateTooSlow(const doublereal& dRate, const doublereal& dErr,
+		const doublereal& Tol, integer iIterCnt, integer iMaxIter) const;
+
 public:
 	NewtonRaphsonSolver(const bool bTNR,
 			const bool bKJ, 
 			const integer IterBfAss,
-			const NonlinearSolverTestOptions& options);
+			const NonlinearSolverTestOptions& options,
+			const bool bFRJ = false,
+			const doublereal dAR = 0.,
+			const doublereal dACR = 0.);
 	
 	~NewtonRaphsonSolver(void);
 	
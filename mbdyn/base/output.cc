@@ -35,6 +35,7 @@
 
 #include <sstream>
 #include <list>
+#include <algorithm>
 
 #include "output.h"
 #include "mbpar.h"
@@ -84,8 +85,9 @@ const char* psExt[] = {
 	".trc",
         ".sol",
         ".prl",
-	".m",		// NOTE: ALWAYS LAST!
-	NULL		// 35
+	".prof",
+	".m",		// 35 NOTE: ALWAYS LAST!
+	NULL
 };
 
 const std::unordered_map<const OutputHandler::Dimensions, const std::string> DimensionNames ({
@@ -535,6 +537,9 @@ OutputHandler::OutputHandler_int(void)
              | OUTPUT_MAY_USE_TEXT | OUTPUT_USE_TEXT;
 
         OutData[SURFACE_LOADS].pof = &ofSurfaceLoads;
+
+	OutData[PROFILE].flags = OUTPUT_MAY_USE_TEXT | OUTPUT_USE_TEXT;
+	OutData[PROFILE].pof = &ofProfile;
         
 	OutData[EIGENANALYSIS].flags = OUTPUT_USE_DEFAULT_PRECISION | OUTPUT_USE_SCIENTIFIC
 			| OUTPUT_MAY_USE_TEXT | OUTPUT_USE_TEXT;
@@ -548,6 +553,20 @@ OutputHandler::OutputHandler_int(void)
 #if defined(USE_NETCDF)
 	ncCount1x3[1] = ncCount1x3x3[1] = 3;
 	ncCount1x3x3[2] = 3;
+
+	m_NcFormat = netCDF::NcFile::classic;
+	m_iNcDeflateLevel = 0;
+	m_uNcChunkSteps = 0;
+	m_uNcBufSteps = 0;
+	m_uNcStagedSteps = 0;
+	m_bNcSync = false;
+#ifdef USE_MULTITHREAD
+	m_bNcWriterThread = false;
+	m_bNcThreadRunning = false;
+	m_bNcBusy = false;
+	m_bNcStop = false;
+	m_bNcFailed = false;
+#endif /* USE_MULTITHREAD */
 #endif  /* USE_NETCDF */
 }
 
@@ -568,6 +587,14 @@ OutputHandler::~OutputHandler(void)
 		if (IsOpen(iCnt)) {
 #ifdef USE_NETCDF
 			if (iCnt == NETCDF) {
+				try {
+					NcFinish();
+				}
+				catch (...) {
+					silent_cerr("OutputHandler: unable to write "
+						"buffered NetCDF data" << std::endl);
+				}
+
 				if (m_pBinFile != 0) {
 					delete m_pBinFile;
 				}
@@ -626,6 +653,7 @@ void
 OutputHandler::NetCDFOpen(const OutputHandler::OutFiles out, const netCDF::NcFile::FileFormat NetCDF_Format)
 {
 	if (!IsOpen(out)) {
+		m_NcFormat = NetCDF_Format;
 		m_pBinFile = new netCDF::NcFile(_sPutExt((char*)(psExt[NETCDF])), netCDF::NcFile::replace, NetCDF_Format); // using the default (nc4) mode was seen to drasticly reduce the writing speed, thus using classic format
 		//~ NC_FILL only applies top variables, not files or groups in netcdf-cxx4
 		// also: error messages (throw) are part of the netcdf-cxx4 interface by default...
@@ -634,10 +662,290 @@ OutputHandler::NetCDFOpen(const OutputHandler::OutFiles out, const netCDF::NcFil
 		m_DimTime = CreateDim("time");
 		m_DimV1 = CreateDim("Vec1", 1);
 		m_DimV3 = CreateDim("Vec3", 3);
+
+#ifdef USE_MULTITHREAD
+		if (m_uNcBufSteps > 0 && m_bNcWriterThread) {
+			pthread_mutex_init(&m_NcMutex, NULL);
+			pthread_cond_init(&m_NcCond, NULL);
+			m_bNcBusy = false;
+			m_bNcStop = false;
+			if (pthread_create(&m_NcThread, NULL, NcWriter, this) != 0) {
+				silent_cerr("OutputHandler: pthread_create() failed; "
+					"NetCDF buffers will be written "
+					"by the main thread" << std::endl);
+				pthread_cond_destroy(&m_NcCond);
+				pthread_mutex_destroy(&m_NcMutex);
+
+			} else {
+				m_bNcThreadRunning = true;
+			}
+		}
+#endif /* USE_MULTITHREAD */
 	}
 
 	return;
 }
+
+void
+OutputHandler::NetCDFSetBuffer(unsigned uSteps, bool bWriterThread)
+{
+	ASSERT(m_pBinFile == 0);
+
+	m_uNcBufSteps = uSteps;
+#ifdef USE_MULTITHREAD
+	m_bNcWriterThread = bWriterThread;
+#else /* ! USE_MULTITHREAD */
+	if (bWriterThread) {
+		silent_cerr("OutputHandler: NetCDF writer thread "
+			"not available; please rebuild with multithread "
+			"support enabled" << std::endl);
+	}
+#endif /* ! USE_MULTITHREAD */
+}
+
+void
+OutputHandler::NetCDFSetCompression(int iDeflateLevel, unsigned uChunkSteps)
+{
+	ASSERT(m_pBinFile == 0);
+	ASSERT(iDeflateLevel >= 0 && iDeflateLevel <= 9);
+
+	m_iNcDeflateLevel = iDeflateLevel;
+	m_uNcChunkSteps = uChunkSteps;
+}
+
+void
+OutputHandler::NetCDFSync(void)
+{
+	if (m_uNcBufSteps > 0) {
+		// the file is synced after each flush
+		m_bNcSync = true;
+		return;
+	}
+
+	m_pBinFile->sync(); // only works with netcdf-cxx4 >= 4.3.0
+}
+
+void
+OutputHandler::NetCDFWait(void)
+{
+#ifdef USE_MULTITHREAD
+	if (!m_bNcThreadRunning) {
+		return;
+	}
+
+	pthread_mutex_lock(&m_NcMutex);
+	while (m_bNcBusy) {
+		pthread_cond_wait(&m_NcCond, &m_NcMutex);
+	}
+	bool bFailed = m_bNcFailed;
+	pthread_mutex_unlock(&m_NcMutex);
+
+	if (bFailed) {
+		silent_cerr("OutputHandler: NetCDF writer thread failed" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+#endif /* USE_MULTITHREAD */
+}
+
+#ifdef USE_MULTITHREAD
+void *
+OutputHandler::NcWriter(void *p)
+{
+	OutputHandler *pOH = static_cast<OutputHandler *>(p);
+
+	pthread_mutex_lock(&pOH->m_NcMutex);
+	while (true) {
+		while (!pOH->m_bNcBusy && !pOH->m_bNcStop) {
+			pthread_cond_wait(&pOH->m_NcCond, &pOH->m_NcMutex);
+		}
+
+		if (!pOH->m_bNcBusy) {
+			// stop requested and nothing left to write
+			break;
+		}
+
+		pthread_mutex_unlock(&pOH->m_NcMutex);
+
+		bool bFailed = false;
+		try {
+			pOH->NcWriteBlocks(pOH->m_NcBack);
+		}
+		catch (...) {
+			bFailed = true;
+		}
+
+		pthread_mutex_lock(&pOH->m_NcMutex);
+		pOH->m_bNcFailed = pOH->m_bNcFailed || bFailed;
+		pOH->m_bNcBusy = false;
+		pthread_cond_broadcast(&pOH->m_NcCond);
+	}
+	pthread_mutex_unlock(&pOH->m_NcMutex);
+
+	return NULL;
+}
+
+void
+OutputHandler::NcStopWriter(void)
+{
+	if (!m_bNcThreadRunning) {
+		return;
+	}
+
+	pthread_mutex_lock(&m_NcMutex);
+	m_bNcStop = true;
+	pthread_cond_broadcast(&m_NcCond);
+	pthread_mutex_unlock(&m_NcMutex);
+
+	pthread_join(m_NcThread, NULL);
+	pthread_cond_destroy(&m_NcCond);
+	pthread_mutex_destroy(&m_NcMutex);
+	m_bNcThreadRunning = false;
+}
+#endif /* USE_MULTITHREAD */
+
+OutputHandler::NcBlock&
+OutputHandler::NcNewBlock(void)
+{
+	if (m_NcFront.nUsed == m_NcFront.Blocks.size()) {
+		m_NcFront.Blocks.resize(m_NcFront.nUsed + 1);
+	}
+
+	NcBlock& b = m_NcFront.Blocks[m_NcFront.nUsed++];
+	b.Data.clear();
+
+	return b;
+}
+
+void
+OutputHandler::NcStage(const MBDynNcVar& Var, size_t iStart,
+	const doublereal *pd, const std::vector<size_t>& RecCount)
+{
+	size_t iSize = 1;
+	for (size_t i = 1; i < RecCount.size(); i++) {
+		iSize *= RecCount[i];
+	}
+
+	std::unordered_map<int, size_t>::const_iterator i = m_NcOpenBlocks.find(Var.getId());
+	if (i != m_NcOpenBlocks.end()) {
+		NcBlock& b = m_NcFront.Blocks[i->second];
+		size_t iEnd = b.Start[0] + b.Count[0];
+
+		if (iStart == iEnd) {
+			// next record of a contiguous block
+			b.Data.insert(b.Data.end(), pd, pd + iSize);
+			b.Count[0]++;
+			return;
+		}
+
+		if (iStart >= b.Start[0] && iStart < iEnd) {
+			// record already staged: overwrite it
+			std::copy(pd, pd + iSize, b.Data.begin() + (iStart - b.Start[0])*iSize);
+			return;
+		}
+
+		// not contiguous: a new block is started
+	}
+
+	NcBlock& b = NcNewBlock();
+	b.Var = Var;
+	b.Start.assign(RecCount.size(), 0);
+	b.Start[0] = iStart;
+	b.Count = RecCount;
+	b.Data.insert(b.Data.end(), pd, pd + iSize);
+
+	m_NcOpenBlocks[Var.getId()] = m_NcFront.nUsed - 1;
+}
+
+void
+OutputHandler::NcStage(const MBDynNcVar& Var,
+	const std::vector<size_t>& Start,
+	const std::vector<size_t>& Count,
+	const doublereal *pd)
+{
+	size_t iSize = 1;
+	for (size_t i = 0; i < Count.size(); i++) {
+		iSize *= Count[i];
+	}
+
+	// arbitrary hyperslab: the block cannot be extended;
+	// later records of the same variable go into a new block,
+	// so that the order of the writes is preserved
+	m_NcOpenBlocks.erase(Var.getId());
+
+	NcBlock& b = NcNewBlock();
+	b.Var = Var;
+	b.Start = Start;
+	b.Count = Count;
+	b.Data.insert(b.Data.end(), pd, pd + iSize);
+}
+
+void
+OutputHandler::NcEndStep(void)
+{
+	if (++m_uNcStagedSteps >= m_uNcBufSteps) {
+		NcFlush();
+	}
+}
+
+void
+OutputHandler::NcWriteBlocks(const NcBuffer& Buf) const
+{
+	for (size_t i = 0; i < Buf.nUsed; i++) {
+		const NcBlock& b = Buf.Blocks[i];
+		b.Var.putVar(b.Start, b.Count, &b.Data[0]);
+	}
+
+	if (Buf.bSync) {
+		m_pBinFile->sync();
+	}
+}
+
+void
+OutputHandler::NcFlush(void)
+{
+	m_uNcStagedSteps = 0;
+	m_NcOpenBlocks.clear();
+
+	if (m_NcFront.nUsed == 0) {
+		return;
+	}
+
+	m_NcFront.bSync = m_bNcSync;
+
+#ifdef USE_MULTITHREAD
+	if (m_bNcThreadRunning) {
+		// double buffering: wait for the previous flush
+		// to complete, then hand the staged blocks over
+		NetCDFWait();
+
+		pthread_mutex_lock(&m_NcMutex);
+		std::swap(m_NcFront, m_NcBack);
+		m_bNcBusy = true;
+		pthread_cond_broadcast(&m_NcCond);
+		pthread_mutex_unlock(&m_NcMutex);
+
+		m_NcFront.nUsed = 0;
+		return;
+	}
+#endif /* USE_MULTITHREAD */
+
+	NcWriteBlocks(m_NcFront);
+	m_NcFront.nUsed = 0;
+}
+
+void
+OutputHandler::NcFinish(void)
+{
+	if (m_uNcBufSteps == 0) {
+		return;
+	}
+
+	NcFlush();
+	NetCDFWait();
+#ifdef USE_MULTITHREAD
+	NcStopWriter();
+#endif /* USE_MULTITHREAD */
+}
 #endif /* USE_NETCDF */
 
 void
@@ -835,6 +1143,7 @@ OutputHandler::Close(const OutputHandler::OutFiles out)
 
 #ifdef USE_NETCDF
 	if (out == NETCDF) {
+		NcFinish();
 		m_pBinFile->close();
 
 	} else
@@ -984,6 +1293,8 @@ OutputHandler::CreateDim(const std::string& name, integer size)
 {
 	ASSERT(m_pBinFile != 0);
 
+	NetCDFWait();
+
 	MBDynNcDim dim;
 	if (size == -1) {
 		dim = m_pBinFile->addDim(name);  // .c_str is useless here
@@ -1008,33 +1319,58 @@ OutputHandler::GetDim(const std::string& name) const
 /// and regardless of its type, and this without requiring a if condition
 /// or further testing of the NcVar, which if done at every timestep
 /// would slow down the execution
+/// when buffering is enabled, the values are only staged (see NcStage())
 void
 OutputHandler::WriteNcVar(const MBDynNcVar& Var_Var, const Mat3x3& pGetVar) {
+	if (m_uNcBufSteps > 0) {
+		NcStage(Var_Var, ncStart1x3x3[0], pGetVar.pGetMat(), ncCount1x3x3);
+		return;
+	}
 	Var_Var.putVar(ncStart1x3x3, ncCount1x3x3, pGetVar.pGetMat());
 }
 void
 OutputHandler::WriteNcVar(const MBDynNcVar& Var_Var, const Mat3x3& pGetVar,
 		const size_t& ncStart) 
 {
-	std::vector<size_t> ncStart1x3x3Tmp = ncStart1x3x3;
-	ncStart1x3x3Tmp[0] = ncStart;
-	Var_Var.putVar(ncStart1x3x3Tmp, ncCount1x3x3, pGetVar.pGetMat());
+	if (m_uNcBufSteps > 0) {
+		NcStage(Var_Var, ncStart, pGetVar.pGetMat(), ncCount1x3x3);
+		return;
+	}
+	// temporarily use the current step start vector, to avoid a copy
+	const size_t ncCurr = ncStart1x3x3[0];
+	ncStart1x3x3[0] = ncStart;
+	Var_Var.putVar(ncStart1x3x3, ncCount1x3x3, pGetVar.pGetMat());
+	ncStart1x3x3[0] = ncCurr;
 }
 void
 OutputHandler::WriteNcVar(const MBDynNcVar& Var_Var, const Vec3& pGetVar) {
+	if (m_uNcBufSteps > 0) {
+		NcStage(Var_Var, ncStart1x3[0], pGetVar.pGetVec(), ncCount1x3);
+		return;
+	}
 	Var_Var.putVar(ncStart1x3, ncCount1x3, pGetVar.pGetVec());
 }
 void
 OutputHandler::WriteNcVar(const MBDynNcVar& Var_Var, const Vec3& pGetVar,
 		const size_t& ncStart) 
 {
-	std::vector<size_t> ncStart1x3Tmp = ncStart1x3;
-	ncStart1x3Tmp[0] = ncStart;
-	Var_Var.putVar(ncStart1x3Tmp, ncCount1x3, pGetVar.pGetVec());
+	if (m_uNcBufSteps > 0) {
+		NcStage(Var_Var, ncStart, pGetVar.pGetVec(), ncCount1x3);
+		return;
+	}
+	const size_t ncCurr = ncStart1x3[0];
+	ncStart1x3[0] = ncStart;
+	Var_Var.putVar(ncStart1x3, ncCount1x3, pGetVar.pGetVec());
+	ncStart1x3[0] = ncCurr;
 }
 template <class Tvar>
 void
 OutputHandler::WriteNcVar(const MBDynNcVar& Var_Var, const Tvar& pGetVar) {
+	if (m_uNcBufSteps > 0) {
+		const doublereal d = pGetVar;
+		NcStage(Var_Var, ncStart1[0], &d, ncCount1);
+		return;
+	}
 	Var_Var.putVar(ncStart1, ncCount1, &pGetVar);
 }
 template <class Tvar, class Tstart>
@@ -1042,7 +1378,15 @@ void
 OutputHandler::WriteNcVar(const MBDynNcVar& Var_Var, const Tvar& pGetVar, 
 		const Tstart& ncStart) 
 {
-	Var_Var.putVar(std::vector<size_t>(1,ncStart), ncCount1, &pGetVar);
+	if (m_uNcBufSteps > 0) {
+		const doublereal d = pGetVar;
+		NcStage(Var_Var, ncStart, &d, ncCount1);
+		return;
+	}
+	const size_t ncCurr = ncStart1[0];
+	ncStart1[0] = ncStart;
+	Var_Var.putVar(ncStart1, ncCount1, &pGetVar);
+	ncStart1[0] = ncCurr;
 }
 template <class Tvar, class Tstart>
 void
@@ -1050,6 +1394,15 @@ OutputHandler::WriteNcVar(const MBDynNcVar& Var_Var, const Tvar& pGetVar,
 		const std::vector<Tstart>& ncStart,
 		const std::vector<size_t>& count) 
 {
+	if (m_uNcBufSteps > 0) {
+		size_t iSize = 1;
+		for (size_t i = 0; i < count.size(); i++) {
+			iSize *= count[i];
+		}
+		std::vector<doublereal> d(&pGetVar, &pGetVar + iSize);
+		NcStage(Var_Var, std::vector<size_t>(ncStart.begin(), ncStart.end()), count, &d[0]);
+		return;
+	}
 	Var_Var.putVar(ncStart, count, &pGetVar);
 }
 
@@ -1074,11 +1427,32 @@ OutputHandler::CreateVar(const std::string& name, const MBDynNcType& type,
 {
 	MBDynNcVar var;
 
+	NetCDFWait();
+
 	var = m_pBinFile->addVar(name, type, dims);
 	for (AttrValVec::const_iterator i = attrs.begin(); i != attrs.end(); ++i) {
 		var.putAtt(i->attr, i->val);
 	}
 
+	// chunking and compression only apply to NetCDF-4 files,
+	// and only to the variables that depend on time
+	if ((m_NcFormat == netCDF::NcFile::nc4 || m_NcFormat == netCDF::NcFile::nc4classic)
+		&& !dims.empty() && dims[0].isUnlimited())
+	{
+		if (m_uNcChunkSteps > 0) {
+			std::vector<size_t> chunks(dims.size());
+			chunks[0] = m_uNcChunkSteps;
+			for (size_t i = 1; i < dims.size(); i++) {
+				chunks[i] = dims[i].getSize();
+			}
+			var.setChunking(netCDF::NcVar::nc_CHUNKED, chunks);
+		}
+
+		if (m_iNcDeflateLevel > 0) {
+			var.setCompression(true, true, m_iNcDeflateLevel);
+		}
+	}
+
 	return var;
 }
 
@@ -60,6 +60,9 @@ typedef netCDF::NcType MBDynNcType;
 #define MbNcInt MBDynNcType(MBDynNcInt) /**< creates a NcType object for a int, makes the notation simpler */
 #define MbNcDouble MBDynNcType(MBDynNcDouble) /**< creates a NcType object for a double, makes the notation simpler */
 #define MbNcChar MBDynNcType(MBDynNcChar) /**< makes the notation simpler */
+#ifdef USE_MULTITHREAD
+#include <pthread.h>
+#endif /* USE_MULTITHREAD */
 #endif
 
 #include "myassert.h"
@@ -110,8 +113,9 @@ public:
 		TRACES,
                 SOLIDS,
                 SURFACE_LOADS,
-		EIGENANALYSIS,			// NOTE: ALWAYS LAST!
-		LASTFILE			// 35
+		PROFILE,
+		EIGENANALYSIS,			// 35 NOTE: ALWAYS LAST!
+		LASTFILE
 	};
 	enum struct Dimensions {
 		Dimensionless,
@@ -176,6 +180,9 @@ public:
 		currentStep++;
 #if defined(USE_NETCDF)
 		ncStart1[0] = ncStart1x3[0] = ncStart1x3x3[0] = this->GetCurrentStep();
+		if (m_uNcBufSteps > 0) {
+			NcEndStep();
+		}
 #endif  /* USE_NETCDF */
 	};
        	inline long GetCurrentStep(void) const {
@@ -213,6 +220,67 @@ private:
 	MBDynNcDim m_DimV1;
 	MBDynNcDim m_DimV3;
 	MBDynNcFile *m_pBinFile;   /* ! one ! binary NetCDF data file */
+
+	/*
+	 * Scrittura bufferizzata: i valori scritti da WriteNcVar()
+	 * vengono accumulati per m_uNcBufSteps passi in blocchi contigui,
+	 * uno per variabile, e scritti con un solo putVar() per blocco.
+	 * Con USE_MULTITHREAD la scrittura puo' essere affidata
+	 * a un thread dedicato, con doppio buffer.
+	 */
+	struct NcBlock {
+		MBDynNcVar Var;
+		std::vector<size_t> Start;
+		std::vector<size_t> Count;
+		std::vector<doublereal> Data;
+	};
+	typedef std::vector<NcBlock> NcBlockVec;
+
+	netCDF::NcFile::FileFormat m_NcFormat;
+	int m_iNcDeflateLevel;		/* 0: no compression */
+	unsigned m_uNcChunkSteps;	/* 0: library default */
+	unsigned m_uNcBufSteps;		/* 0: no buffering */
+	unsigned m_uNcStagedSteps;
+	bool m_bNcSync;
+
+	/* i blocchi vengono riusati da un flush all'altro,
+	 * per non riallocare i dati */
+	struct NcBuffer {
+		NcBlockVec Blocks;
+		size_t nUsed;
+		bool bSync;
+		NcBuffer(void) : nUsed(0), bSync(false) { NO_OP; };
+	};
+	NcBuffer m_NcFront;
+	/* blocco aperto di ciascuna variabile (per id) in m_NcFront */
+	std::unordered_map<int, size_t> m_NcOpenBlocks;
+
+#ifdef USE_MULTITHREAD
+	bool m_bNcWriterThread;
+	bool m_bNcThreadRunning;
+	bool m_bNcBusy;
+	bool m_bNcStop;
+	bool m_bNcFailed;
+	NcBuffer m_NcBack;
+	pthread_t m_NcThread;
+	pthread_mutex_t m_NcMutex;
+	pthread_cond_t m_NcCond;
+
+	static void *NcWriter(void *p);
+	void NcStopWriter(void);
+#endif /* USE_MULTITHREAD */
+
+	NcBlock& NcNewBlock(void);
+	void NcStage(const MBDynNcVar& Var, size_t iStart,
+		const doublereal *pd, const std::vector<size_t>& RecCount);
+	void NcStage(const MBDynNcVar& Var,
+		const std::vector<size_t>& Start,
+		const std::vector<size_t>& Count,
+		const doublereal *pd);
+	void NcEndStep(void);
+	void NcWriteBlocks(const NcBuffer& Buf) const;
+	void NcFlush(void);
+	void NcFinish(void);
 #endif /* USE_NETCDF */
 
 	/* handlers to streams */
@@ -249,6 +317,7 @@ private:
 	std::ofstream ofTraces;
         std::ofstream ofSolids;
         std::ofstream ofSurfaceLoads;
+	std::ofstream ofProfile;		/* 35 */
 	std::ofstream ofEigenanalysis;
 
 	int iCurrWidth;
@@ -283,6 +352,17 @@ public:
 	void Open(const OutputHandler::OutFiles out);
 #ifdef USE_NETCDF
 	void NetCDFOpen(const OutputHandler::OutFiles out, const netCDF::NcFile::FileFormat NetCDF_Format);
+
+	/* to be called before NetCDFOpen() */
+	void NetCDFSetBuffer(unsigned uSteps, bool bWriterThread);
+	void NetCDFSetCompression(int iDeflateLevel, unsigned uChunkSteps);
+
+	/* syncs the file (after each flush, when buffered) */
+	void NetCDFSync(void);
+
+	/* waits for the writer thread to be idle;
+	 * must be called before accessing the file directly */
+	void NetCDFWait(void);
 #endif
 
 	/* Overload for eigenanalysis text output */
@@ -345,6 +425,7 @@ public:
 	inline std::ostream& Traces(void) const;
         inline std::ostream& Solids(void) const;
         inline std::ostream& SurfaceLoads(void) const;
+	inline std::ostream& Profile(void) const;
 	inline std::ostream& Eigenanalysis(void) const;
 
 	inline int iW(void) const;
@@ -745,6 +826,13 @@ OutputHandler::Traces(void) const
 	return const_cast<std::ostream &>(dynamic_cast<const std::ostream &>(ofTraces));
 }
 
+inline std::ostream&
+OutputHandler::Profile(void) const
+{
+	ASSERT(IsOpen(PROFILE));
+	return const_cast<std::ostream &>(dynamic_cast<const std::ostream &>(ofProfile));
+}
+
 inline std::ostream&
 OutputHandler::Eigenanalysis(void) const
 {
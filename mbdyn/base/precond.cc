@@ -39,12 +39,33 @@
   
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
   
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
 #include "precond_.h"  
 
+Preconditioner::Param::Param(void)
+: iFillLevel(0),
+dDropTol(1.e-3),
+iFill(10),
+dRebuildRatio(-1.)
+{
+	NO_OP;
+}
+
 Preconditioner::~Preconditioner(void)
 {
 	NO_OP;
 }
+
+void
+Preconditioner::Build(SolutionManager* pSM)
+{
+	NO_OP;
+}
 	
 FullJacobianPr::~FullJacobianPr(void)
 {
@@ -77,15 +98,415 @@ FullJacobianPr::Precond(VectorHandler& b, VectorHandler& x,
 		pds = pSM->pdSetSolVec(x.pdGetVec());
 
 	} else {
+		/* the linear solver may still hold distinct pointers
+		 * (e.g. while computing a permutation), so move both */
 		x = b;
 		pdr = pSM->pdSetResVec(x.pdGetVec());
+		pds = pSM->pdSetSolVec(x.pdGetVec());
 	}
 
 	pSM->Solve();
 
 	(void)pSM->pdSetResVec(pdr);
-	if (pds != 0 && pds != pdr) {
-		(void)pSM->pdSetSolVec(pds);
+	(void)pSM->pdSetSolVec(pds);
+}
+
+/* copies the Jacobian matrix in compressed row form, 0-based,
+ * with sorted column indices and duplicates summed */
+static void
+GetCompressedRows(const MatrixHandler& MH,
+	std::vector<integer>& Ap,
+	std::vector<integer>& Ai,
+	std::vector<doublereal>& Ax)
+{
+	const integer n = MH.iGetNumRows();
+
+	std::vector<std::vector<std::pair<integer, doublereal> > > Rows(n);
+	MH.EnumerateNz([&Rows](integer iRow, integer iCol, doublereal dCoef) {
+		Rows[iRow - 1].push_back(std::make_pair(iCol - 1, dCoef));
+	});
+
+	Ap.resize(n + 1);
+	Ai.clear();
+	Ax.clear();
+	Ap[0] = 0;
+	for (integer i = 0; i < n; i++) {
+		std::vector<std::pair<integer, doublereal> >& r = Rows[i];
+		std::sort(r.begin(), r.end());
+		for (std::vector<std::pair<integer, doublereal> >::const_iterator
+			j = r.begin(); j != r.end(); ++j)
+		{
+			if (integer(Ai.size()) > Ap[i] && Ai.back() == j->first) {
+				Ax.back() += j->second;
+			} else {
+				Ai.push_back(j->first);
+				Ax.push_back(j->second);
+			}
+		}
+		Ap[i + 1] = Ai.size();
+
+		/* release memory as soon as possible */
+		std::vector<std::pair<integer, doublereal> >().swap(r);
+	}
+}
+
+IncompleteLUPr::IncompleteLUPr(PrecondType t, const Param& p)
+: Type(t),
+iFillLevel(p.iFillLevel),
+dDropTol(p.dDropTol),
+iFill(p.iFill),
+iSize(0)
+{
+	ASSERT(Type == ILU || Type == ILUT);
+}
+
+IncompleteLUPr::~IncompleteLUPr(void)
+{
+	NO_OP;
+}
+
+void
+IncompleteLUPr::Build(SolutionManager* pSM)
+{
+	std::vector<integer> Ap, Ai;
+	std::vector<doublereal> Ax;
+	GetCompressedRows(*pSM->pMatHdl(), Ap, Ai, Ax);
+
+	iSize = Ap.size() - 1;
+	const integer n = iSize;
+	const bool bILUT = (Type == ILUT);
+	const doublereal dEps = std::numeric_limits<doublereal>::epsilon();
+
+	Lp.assign(1, 0);
+	Li.clear();
+	Lx.clear();
+	Up.assign(1, 0);
+	Ui.clear();
+	Ulev.clear();
+	Ux.clear();
+	Dinv.resize(n);
+	Work.resize(n);
+
+	/* dense work row; Pos < 0 marks an empty entry */
+	std::vector<doublereal> w(n, 0.);
+	std::vector<integer> Lev(n, 0);
+	std::vector<integer> Pos(n, -1);
+	std::vector<integer> Nz;
+	std::priority_queue<integer, std::vector<integer>, std::greater<integer> > Lower;
+	std::vector<std::pair<doublereal, integer> > Keep;
+
+	integer iPivots = 0;
+
+	for (integer i = 0; i < n; i++) {
+		doublereal dRowNorm = 0.;
+
+		Nz.clear();
+		for (integer k = Ap[i]; k < Ap[i + 1]; k++) {
+			integer j = Ai[k];
+			w[j] = Ax[k];
+			Lev[j] = 0;
+			Pos[j] = Nz.size();
+			Nz.push_back(j);
+			if (j < i) {
+				Lower.push(j);
+			}
+			dRowNorm += Ax[k]*Ax[k];
+		}
+		dRowNorm = std::sqrt(dRowNorm);
+		const doublereal dTol = dDropTol*dRowNorm;
+
+		/* eliminate the lower part in increasing column order;
+		 * fill-in columns are always larger than the current one */
+		while (!Lower.empty()) {
+			integer k = Lower.top();
+			Lower.pop();
+
+			doublereal dL = w[k]*Dinv[k];
+			w[k] = dL;
+			if (bILUT && std::abs(dL) < dTol) {
+				w[k] = 0.;
+				continue;
+			}
+
+			for (integer kk = Up[k]; kk < Up[k + 1]; kk++) {
+				integer j = Ui[kk];
+				integer l = Lev[k] + Ulev[kk] + 1;
+				if (!bILUT && l > iFillLevel) {
+					continue;
+				}
+
+				if (Pos[j] < 0) {
+					w[j] = -dL*Ux[kk];
+					Lev[j] = l;
+					Pos[j] = Nz.size();
+					Nz.push_back(j);
+					if (j < i) {
+						Lower.push(j);
+					}
+
+				} else {
+					w[j] -= dL*Ux[kk];
+					if (l < Lev[j]) {
+						Lev[j] = l;
+					}
+				}
+			}
+		}
+
+		doublereal d = (Pos[i] < 0) ? 0. : w[i];
+
+		/* store the factors */
+		for (int iPart = 0; iPart < 2; iPart++) {
+			Keep.clear();
+			for (std::vector<integer>::const_iterator j = Nz.begin();
+				j != Nz.end(); ++j)
+			{
+				if ((iPart == 0) ? (*j < i) : (*j > i)) {
+					if (w[*j] == 0. || (bILUT && std::abs(w[*j]) < dTol)) {
+						continue;
+					}
+					Keep.push_back(std::make_pair(-std::abs(w[*j]), *j));
+				}
+			}
+
+			if (bILUT && integer(Keep.size()) > iFill) {
+				std::nth_element(Keep.begin(), Keep.begin() + iFill, Keep.end());
+				Keep.resize(iFill);
+			}
+
+			std::vector<integer>& Mi = (iPart == 0) ? Li : Ui;
+			std::vector<doublereal>& Mx = (iPart == 0) ? Lx : Ux;
+			std::vector<integer> Mj(Keep.size());
+			for (unsigned k = 0; k < Keep.size(); k++) {
+				Mj[k] = Keep[k].second;
+			}
+			std::sort(Mj.begin(), Mj.end());
+			for (unsigned k = 0; k < Mj.size(); k++) {
+				Mi.push_back(Mj[k]);
+				Mx.push_back(w[Mj[k]]);
+				if (iPart == 1) {
+					Ulev.push_back(Lev[Mj[k]]);
+				}
+			}
+		}
+		Lp.push_back(Li.size());
+		Up.push_back(Ui.size());
+
+		/* replace zero (or tiny) pivots */
+		if (std::abs(d) <= dEps*dRowNorm || d == 0.) {
+			doublereal dPiv = std::sqrt(dEps)*(dRowNorm > 0. ? dRowNorm : 1.);
+			d = (d < 0.) ? -dPiv : dPiv;
+			iPivots++;
+		}
+		Dinv[i] = 1./d;
+
+		/* reset the work row */
+		for (std::vector<integer>::const_iterator j = Nz.begin();
+			j != Nz.end(); ++j)
+		{
+			w[*j] = 0.;
+			Pos[*j] = -1;
+		}
+	}
+
+	if (iPivots) {
+		pedantic_cerr("IncompleteLUPr::Build: " << iPivots
+			<< " small pivots replaced" << std::endl);
+	}
+}
+
+void
+IncompleteLUPr::Precond(VectorHandler& b, VectorHandler& x, 
+		SolutionManager* pSM) const
+{
+	ASSERT(b.iGetSize() == iSize);
+	ASSERT(x.iGetSize() == iSize);
+
+	/* b and x may be the same vector */
+	const doublereal *pb = b.pdGetVec();
+	std::copy(pb, pb + iSize, Work.begin());
+
+	for (integer i = 0; i < iSize; i++) {
+		doublereal d = Work[i];
+		for (integer k = Lp[i]; k < Lp[i + 1]; k++) {
+			d -= Lx[k]*Work[Li[k]];
+		}
+		Work[i] = d;
 	}
+
+	for (integer i = iSize - 1; i >= 0; i--) {
+		doublereal d = Work[i];
+		for (integer k = Up[i]; k < Up[i + 1]; k++) {
+			d -= Ux[k]*Work[Ui[k]];
+		}
+		Work[i] = d*Dinv[i];
+	}
+
+	std::copy(Work.begin(), Work.end(), x.pdGetVec());
+}
+
+BlockJacobiPr::BlockJacobiPr(const Param& p)
+: BlockPtr(p.BlockPtr)
+{
+	NO_OP;
+}
+
+BlockJacobiPr::~BlockJacobiPr(void)
+{
+	NO_OP;
 }
 
+void
+BlockJacobiPr::SetBlocks(integer iSize)
+{
+	if (BlockPtr.empty() || BlockPtr.back() != iSize) {
+		/* no (consistent) partition: point Jacobi */
+		if (!BlockPtr.empty()) {
+			silent_cerr("BlockJacobiPr: block partition does not match "
+				"the size of the problem (" << iSize << "); "
+				"using point Jacobi" << std::endl);
+		}
+
+		BlockPtr.resize(iSize + 1);
+		for (integer i = 0; i <= iSize; i++) {
+			BlockPtr[i] = i;
+		}
+	}
+
+	BlockOf.resize(iSize);
+	ValPtr.resize(BlockPtr.size());
+	ValPtr[0] = 0;
+	for (unsigned b = 0; b < BlockPtr.size() - 1; b++) {
+		integer nb = BlockPtr[b + 1] - BlockPtr[b];
+		for (integer i = BlockPtr[b]; i < BlockPtr[b + 1]; i++) {
+			BlockOf[i] = b;
+		}
+		ValPtr[b + 1] = ValPtr[b] + nb*nb;
+	}
+
+	Val.resize(ValPtr.back());
+	Piv.resize(iSize);
+	bSingular.resize(BlockPtr.size() - 1);
+	Work.resize(iSize);
+}
+
+void
+BlockJacobiPr::Build(SolutionManager* pSM)
+{
+	const MatrixHandler& MH = *pSM->pMatHdl();
+	const integer n = MH.iGetNumRows();
+
+	if (integer(BlockOf.size()) != n) {
+		SetBlocks(n);
+	}
+
+	std::fill(Val.begin(), Val.end(), 0.);
+	MH.EnumerateNz([this](integer iRow, integer iCol, doublereal dCoef) {
+		integer b = BlockOf[iRow - 1];
+		if (b == BlockOf[iCol - 1]) {
+			integer i0 = BlockPtr[b];
+			integer nb = BlockPtr[b + 1] - i0;
+			Val[ValPtr[b] + (iRow - 1 - i0)*nb + iCol - 1 - i0] += dCoef;
+		}
+	});
+
+	/* dense LU with partial pivoting of each block */
+	integer iSingular = 0;
+	for (unsigned b = 0; b < bSingular.size(); b++) {
+		integer i0 = BlockPtr[b];
+		integer nb = BlockPtr[b + 1] - i0;
+		doublereal *A = &Val[ValPtr[b]];
+		integer *p = &Piv[i0];
+
+		doublereal dNorm = 0.;
+		for (integer k = 0; k < nb*nb; k++) {
+			dNorm = std::max(dNorm, std::abs(A[k]));
+		}
+		const doublereal dTol = std::numeric_limits<doublereal>::epsilon()*nb*dNorm;
+
+		bSingular[b] = false;
+		for (integer k = 0; k < nb; k++) {
+			integer m = k;
+			for (integer i = k + 1; i < nb; i++) {
+				if (std::abs(A[i*nb + k]) > std::abs(A[m*nb + k])) {
+					m = i;
+				}
+			}
+			p[k] = m;
+
+			if (std::abs(A[m*nb + k]) <= dTol || A[m*nb + k] == 0.) {
+				bSingular[b] = true;
+				break;
+			}
+
+			if (m != k) {
+				std::swap_ranges(&A[k*nb], &A[k*nb] + nb, &A[m*nb]);
+			}
+
+			doublereal dInv = 1./A[k*nb + k];
+			for (integer i = k + 1; i < nb; i++) {
+				doublereal l = (A[i*nb + k] *= dInv);
+				if (l != 0.) {
+					for (integer j = k + 1; j < nb; j++) {
+						A[i*nb + j] -= l*A[k*nb + j];
+					}
+				}
+			}
+		}
+
+		if (bSingular[b]) {
+			iSingular++;
+		}
+	}
+
+	if (iSingular) {
+		pedantic_cerr("BlockJacobiPr::Build: " << iSingular
+			<< " singular blocks left unpreconditioned" << std::endl);
+	}
+}
+
+void
+BlockJacobiPr::Precond(VectorHandler& b, VectorHandler& x, 
+		SolutionManager* pSM) const
+{
+	const integer n = BlockOf.size();
+
+	ASSERT(b.iGetSize() == n);
+	ASSERT(x.iGetSize() == n);
+
+	const doublereal *pb = b.pdGetVec();
+	std::copy(pb, pb + n, Work.begin());
+
+	for (unsigned ib = 0; ib < bSingular.size(); ib++) {
+		if (bSingular[ib]) {
+			continue;
+		}
+
+		integer i0 = BlockPtr[ib];
+		integer nb = BlockPtr[ib + 1] - i0;
+		const doublereal *A = &Val[ValPtr[ib]];
+		const integer *p = &Piv[i0];
+		doublereal *y = &Work[i0];
+
+		for (integer k = 0; k < nb; k++) {
+			if (p[k] != k) {
+				std::swap(y[k], y[p[k]]);
+			}
+		}
+
+		for (integer i = 1; i < nb; i++) {
+			for (integer j = 0; j < i; j++) {
+				y[i] -= A[i*nb + j]*y[j];
+			}
+		}
+
+		for (integer i = nb - 1; i >= 0; i--) {
+			for (integer j = i + 1; j < nb; j++) {
+				y[i] -= A[i*nb + j]*y[j];
+			}
+			y[i] /= A[i*nb + i];
+		}
+	}
+
+	std::copy(Work.begin(), Work.end(), x.pdGetVec());
+}
@@ -40,6 +40,8 @@
 #ifndef PRECOND_H
 #define PRECOND_H
 
+#include <vector>
+
 #include <solman.h>
 
 class Preconditioner
@@ -48,10 +50,36 @@ public:
 
 	enum PrecondType {
 		UNKNOWN = -1,
-		FULLJACOBIANMATRIX
+		FULLJACOBIANMATRIX,
+		ILU,
+		ILUT,
+		BLOCKJACOBI
+	};
+
+	/* parameters of the preconditioners
+	 * built from the sparse Jacobian matrix */
+	struct Param {
+		/* ILU(k): level of fill */
+		integer iFillLevel;
+		/* ILUT: relative drop tolerance and max fill per row */
+		doublereal dDropTol;
+		integer iFill;
+		/* block Jacobi: first (0-based) index of each block;
+		 * the last element is the size of the problem */
+		std::vector<integer> BlockPtr;
+		/* rebuild when a linear solve needs more than dRebuildRatio
+		 * times the inner iterations of the first one after the
+		 * last rebuild; <= 0 disables, < 0 uses the default
+		 * of each preconditioner */
+		doublereal dRebuildRatio;
+
+		Param(void);
 	};
 	
 	virtual ~Preconditioner(void);
+
+	/* called each time the Jacobian matrix is assembled */
+	virtual void Build(SolutionManager* pSM);
 	
 	virtual void Precond(VectorHandler& b,
 			VectorHandler& x, 
@@ -52,5 +52,73 @@ public:
 			SolutionManager* pSM) const;
 };
 
+/*
+ * Incomplete LU factorization of the Jacobian matrix;
+ * the matrix is only read from the solution manager, which is never
+ * asked to factor it.  The fill is limited either by level (ILU(k))
+ * or by magnitude and number of entries per row (ILUT).
+ */
+class IncompleteLUPr : public Preconditioner
+{
+protected:
+	const PrecondType Type;
+	const integer iFillLevel;
+	const doublereal dDropTol;
+	const integer iFill;
+
+	integer iSize;
+
+	/* strictly lower factor, unit diagonal (CSR, 0-based) */
+	std::vector<integer> Lp, Li;
+	std::vector<doublereal> Lx;
+
+	/* strictly upper factor (CSR, 0-based), levels of fill
+	 * and inverse of the diagonal */
+	std::vector<integer> Up, Ui, Ulev;
+	std::vector<doublereal> Ux, Dinv;
+
+	mutable std::vector<doublereal> Work;
+
+public:
+	IncompleteLUPr(PrecondType t, const Param& p);
+	~IncompleteLUPr(void);
+
+	void Build(SolutionManager* pSM);
+	void Precond(VectorHandler& b, VectorHandler& x, 
+			SolutionManager* pSM) const;
+};
+
+/*
+ * Block Jacobi: dense LU factorization of the diagonal blocks
+ * of the Jacobian matrix that belong to the same DofOwner
+ * (the degrees of freedom of a node, the reactions of a joint, ...);
+ * singular blocks, e.g. those of algebraic constraints,
+ * are left unpreconditioned.
+ */
+class BlockJacobiPr : public Preconditioner
+{
+protected:
+	std::vector<integer> BlockPtr;
+	std::vector<integer> BlockOf;
+
+	/* row-major LU factors of each block, and row pivots */
+	std::vector<integer> ValPtr;
+	std::vector<doublereal> Val;
+	std::vector<integer> Piv;
+	std::vector<bool> bSingular;
+
+	mutable std::vector<doublereal> Work;
+
+	void SetBlocks(integer iSize);
+
+public:
+	BlockJacobiPr(const Param& p);
+	~BlockJacobiPr(void);
+
+	void Build(SolutionManager* pSM);
+	void Precond(VectorHandler& b, VectorHandler& x, 
+			SolutionManager* pSM) const;
+};
+
 #endif /* PRECOND__H */
 
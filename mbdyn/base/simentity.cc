@@ -195,5 +195,17 @@ void SimulationEntity::ReadInitialState(MBDynParser& HP)
 	NO_OP;
 }
 
+void
+SimulationEntity::SaveState(CheckpointOut& out) const
+{
+	NO_OP;
+}
+
+void
+SimulationEntity::RestoreState(CheckpointIn& in)
+{
+	NO_OP;
+}
+
 /* SimulationEntity - end */
 
@@ -68,10 +68,16 @@
  *	Update()		: use converged solution
  *	AfterConvergence()	: account for conveged state
  *	dGetPrivData()		: get an internal state
+ *
+ * checkpoint:
+ *	SaveState()		: write private state
+ *	RestoreState()		: read it back, in the same order
  */
 
 class MBDynParser;
 class DataManager;
+class CheckpointOut;
+class CheckpointIn;
 
 class SimulationEntity {
 protected:
@@ -224,6 +230,16 @@ public:
 
 	virtual void ReadInitialState(MBDynParser& HP);
 
+	/*
+	 * Binary checkpoint of the private state that cannot be
+	 * recomputed from the solution vectors, e.g. reference
+	 * orientations or the status of friction models.
+	 * Called after convergence; RestoreState() must read exactly
+	 * what SaveState() wrote.  By default there is no such state
+	 */
+	virtual void SaveState(CheckpointOut& out) const;
+	virtual void RestoreState(CheckpointIn& in);
+
 };
 
 /* SimulationEntity - end */
@@ -124,6 +124,13 @@ public:
 
 	virtual ~tplSingleStepIntegrator(void);
 
+	// the intermediate variables are updated in place at each Advance(),
+	// so a rejected step could not be repeated from the same state
+	virtual bool
+	SetLocalErrorTolerance(doublereal dRelTol, doublereal dAbsTol) override {
+		return false;
+	};
+
 	virtual doublereal
 	Advance(Solver* pS, 
 		const doublereal TStep, 
@@ -61,11 +61,13 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
-#include "ac/sys_sysinfo.h"
+#include <functional>
+#include <exception>
 
 #include "solver.h"
 #include "dataman.h"
 #include "mtdataman.h"
+#include "threadpool.h"
 #include "stepsol_impl.h"
 #include "ms34stepsol.h"
 #include "multistagestepsol_impl.h"
@@ -321,6 +323,7 @@ Solver::Solver(MBDynParser& HPar,
 :
 #ifdef USE_MULTITHREAD
 nThreads(nThreads),
+uMTFlags(MultiThreadDataManager::MT_DEFAULT),
 #endif /* USE_MULTITHREAD */
 pTSC(0),
 dCurrTimeStep(0.),
@@ -385,15 +388,20 @@ ResTest(NonlinearSolverTest::NORM),
 SolTest(NonlinearSolverTest::NONE),
 bScale(false),
 bTrueNewtonRaphson(true),
+bFusedAssembly(false),
+dAdaptiveJacRate(0.),
+dAdaptiveJacCoefRatio(0.),
 NonlinearSolverType(NonlinearSolver::UNKNOWN),
 /* for matrix-free solvers */
 MFSolverType(MatrixFreeSolver::UNKNOWN),
 dIterTol(::dDefaultTol),
 PcType(Preconditioner::FULLJACOBIANMATRIX),
+PcParam(),
 iPrecondSteps(::iDefaultPreconditionerSteps),
 iIterativeMaxSteps(::iDefaultPreconditionerSteps),
 dIterertiveEtaMax(defaultIterativeEtaMax),
 dIterertiveTau(defaultIterativeTau),
+bIterativeFDProd(false),
 /* end of matrix-free solvers */
 /* for line search solver */
 oLineSearchParam(),
@@ -425,7 +433,8 @@ dTest(std::numeric_limits<double>::max()),
 dSolTest(std::numeric_limits<double>::max()),
 bSolConv(false),
 bOut(false),
-lStep(0)
+lStep(0),
+bRestored(false)
 {
 	DEBUGCOUTFNAME("Solver::Solver");
 	::InitTimeStepData();
@@ -436,19 +445,24 @@ lStep(0)
 void
 Solver::ThreadPrepare(void)
 {
+	/* all the threads come from the shared pool,
+	 * whose size is set by the -N command line option */
+	const unsigned nMaxThreads = ThreadPool::iGetMaxThreads();
+
 	/* check for thread potential */
 	if (nThreads == 0) {
-		int n = get_nprocs();
-
-		if (n > 1) {
+		if (nMaxThreads > 1) {
 			silent_cout("no multithread requested "
-					"with a potential of " << n
+					"with a potential of " << nMaxThreads
 					<< " CPUs" << std::endl);
-			nThreads = n;
-
-		} else {
-			nThreads = 1;
 		}
+		nThreads = nMaxThreads;
+
+	} else if (nThreads > nMaxThreads) {
+		silent_cerr("warning: " << nThreads << " assembly threads requested, "
+				"only " << nMaxThreads << " available "
+				"(see the -N command line option)" << std::endl);
+		nThreads = nMaxThreads;
 	}
 }
 #endif /* USE_MULTITHREAD */
@@ -538,7 +552,8 @@ Solver::Prepare(void)
 						sOutputFileName.c_str(),
 						sInputFileName.c_str(),
 						eAbortAfter == AFTER_INPUT,
-						nThreads));
+						nThreads,
+						uMTFlags));
 
 		} else
 #endif /* USE_MULTITHREAD */
@@ -856,7 +871,7 @@ Solver::Prepare(void)
 	 *     o         # if t < t_i, analysis at t = t_i *before derivatives*
 	 *         o     # if t == t_i, analysis at t = t_i *after derivatives*
 	 */
-	if (EigAn.bAnalysis) {
+	if (EigAn.bAnalysis && !pDM->bRestoreCheckpoint()) {
 		EigAn.currAnalysis = EigAn.Analyses.begin();
 		while (*EigAn.currAnalysis < dTime) {
 			Eig();
@@ -932,6 +947,28 @@ Solver::Prepare(void)
 #ifdef USE_EXTERNAL
 	pNLS->SetExternal(External::EMPTY);
 #endif /* USE_EXTERNAL */
+
+	if (pDM->bRestoreCheckpoint()) {
+		/* the checkpoint replaces derivatives and dummy steps */
+		pDM->RestoreCheckpoint();
+		bRestored = true;
+
+		pDM->SetTime(dTime, dCurrTimeStep, lStep);
+		pDM->Update();
+
+		if (EigAn.bAnalysis) {
+			EigAn.currAnalysis = std::find_if(EigAn.Analyses.begin(),
+				EigAn.Analyses.end(), std::bind(std::greater<doublereal>(), std::placeholders::_1, dTime));
+		}
+
+		silent_cout("Restarting after step " << lStep
+			<< " at time " << dTime << std::endl);
+
+		eStatus = SOLVER_STATUS_PREPARED;
+
+		return true;
+	}
+
 	/* Setup SolutionManager(s) */
 	SetupSolmans(pDerivativeSteps->GetIntegratorNumUnknownStates());
 
@@ -1550,10 +1587,29 @@ Solver::Start(void)
 	pNLS->SetExternal(External::REGULAR);
 #endif /* USE_EXTERNAL */
 
+	if (bRestored) {
+		/* the integration history comes from the checkpoint,
+		 * so the start-up steps are not needed */
+		pTSC->Init(iMaxIterations, dMinTimeStep, MaxTimeStep, dCurrTimeStep);
+		pTSC->SetStepIntegrator(pRegularSteps);
+
+		if (pRTSolver) {
+			pRTSolver->Init();
+		}
+
+		SetupSolmans(pRegularSteps->GetIntegratorNumUnknownStates(), true);
+		pCurrStepIntegrator = pRegularSteps;
+
+		eStatus = SOLVER_STATUS_STARTED;
+
+		return true;
+	}
+
 	lStep = 0; /* Resetto di nuovo lStep */
 	dRefTimeStep = dInitialTimeStep;
 	dCurrTimeStep = dRefTimeStep;
 	pTSC->Init(iMaxIterations, dMinTimeStep, MaxTimeStep, dInitialTimeStep);
+	pTSC->SetStepIntegrator(pRegularSteps);
 
 	//DEBUGCOUT("Step " << lStep << " has been successfully completed "
 	//		"in " << iStIter << " iterations" << std::endl);
@@ -2221,6 +2277,10 @@ IfFirstStepIsToBeRepeated:
 
 	eStatus = SOLVER_STATUS_STARTED;
 
+	/* checkpoints requested during the start-up steps;
+	 * SaveState() requires the solver to be started */
+	pDM->CheckpointIfPending();
+
 	return true;
 }
 
@@ -2242,6 +2302,8 @@ Solver::Advance(void)
 	CurrStep = StepIntegrator::NEWSTEP;
 
 	if (pDM->EndOfSimulation() || dTime >= dFinalTime) {
+		pDM->CheckpointIfPending(true);
+
 		if (pRTSolver) {
 			pRTSolver->StopCommanded();
 		}
@@ -2278,6 +2340,9 @@ Solver::Advance(void)
 #endif /* USE_MPI */
 			)
 	{
+		/* e.g. SIGTERM from a batch scheduler */
+		pDM->CheckpointIfPending(true);
+
 		if (pRTSolver) {
 			pRTSolver->StopCommanded();
 		}
@@ -2482,6 +2547,8 @@ IfStepIsToBeRepeated:
 	dCurrTimeStep = pTSC->dGetNewStepTime(CurrStep, iStIter);
 	DEBUGCOUT("Current time step: " << dCurrTimeStep << std::endl);
 
+	pDM->CheckpointIfPending();
+
 	return true;
 }
 
@@ -2589,6 +2656,12 @@ Solver::~Solver(void)
 		SAFEDELETE(pNLS);
 	}
 
+	for (std::vector<SolutionManager *>::iterator i = EigSolMan.begin();
+		i != EigSolMan.end(); ++i)
+	{
+		SAFEDELETE(*i);
+	}
+
 	if (pTSC) {
 		delete pTSC;
 	}
@@ -2596,6 +2669,61 @@ Solver::~Solver(void)
 	DestroyTimeStepData();
 }
 
+void
+Solver::SaveState(CheckpointOut& out) const
+{
+	ASSERT(eStatus == SOLVER_STATUS_STARTED);
+
+	/* dTime is the time of the last converged step,
+	 * dCurrTimeStep the size of the next one */
+	integer iStep = lStep;
+	out.Put(dTime);
+	out.Put(dRefTimeStep);
+	out.Put(dCurrTimeStep);
+	out.Put(iStep);
+	out.Put(iTotIter);
+	out.Put(dTotErr);
+
+	out.Put(*pX);
+	out.Put(*pXPrime);
+
+	unsigned uPrev = qX.size();
+	out.Put(uPrev);
+	for (unsigned i = 0; i < uPrev; i++) {
+		out.Put(*qX[i]);
+		out.Put(*qXPrime[i]);
+	}
+}
+
+void
+Solver::RestoreState(CheckpointIn& in)
+{
+	integer iStep;
+	in.Get(dTime);
+	in.Get(dRefTimeStep);
+	in.Get(dCurrTimeStep);
+	in.Get(iStep);
+	in.Get(iTotIter);
+	in.Get(dTotErr);
+	lStep = iStep;
+
+	in.Get(*pX);
+	in.Get(*pXPrime);
+
+	/* the same integrator must be used */
+	unsigned uPrev;
+	in.Get(uPrev);
+	if (uPrev != qX.size()) {
+		silent_cerr("checkpoint has " << uPrev << " previous states, "
+			"integrator needs " << qX.size() << std::endl);
+		throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+	}
+	for (unsigned i = 0; i < uPrev; i++) {
+		in.Get(*qX[i]);
+		in.Get(*qXPrime[i]);
+	}
+}
+
 /*scrive il contributo al file di restart*/
 std::ostream &
 Solver::Restart(std::ostream& out,DataManager::eRestart type) const
@@ -2776,7 +2904,15 @@ Solver::Restart(std::ostream& out,DataManager::eRestart type) const
 	case NonlinearSolver::NEWTONRAPHSON:
 	default :
 		out << "  nonlinear solver: newton raphson";
-		if (!bTrueNewtonRaphson) {
+		if (dAdaptiveJacRate > 0.) {
+			out << ", adaptive"
+				<< ", contraction rate, " << dAdaptiveJacRate
+				<< ", coefficient ratio, " << dAdaptiveJacCoefRatio;
+			if (bHonorJacRequest) {
+				out << ", honor element requests";
+			}
+
+		} else if (!bTrueNewtonRaphson) {
                         out << ", modified, " << oLineSearchParam.iIterationsBeforeAssembly;
                         if (oLineSearchParam.bKeepJacAcrossSteps) {
 				out << ", keep jacobian matrix";
@@ -2785,6 +2921,9 @@ Solver::Restart(std::ostream& out,DataManager::eRestart type) const
 				out << ", honor element requests";
 			}
 		}
+		if (bFusedAssembly) {
+			out << ", fused assembly";
+		}
 		out << ";" << std::endl;
 	}
 	out << "  solver: ";
@@ -2923,6 +3062,9 @@ Solver::ReadData(MBDynParser& HP)
 				"gmres",
 					/* DEPRECATED */ "full" "jacobian" /* END OF DEPRECATED */ ,
 					"full" "jacobian" "matrix",
+					"ilu",
+					"ilut",
+					"block" "jacobi",
 
 		/* RTAI stuff */
 		"real" "time",
@@ -3054,6 +3196,9 @@ Solver::ReadData(MBDynParser& HP)
 				GMRES,
 					FULLJACOBIAN,
 					FULLJACOBIANMATRIX,
+					ILU,
+					ILUT,
+					BLOCKJACOBI,
 
 		/* RTAI stuff */
 		REALTIME,
@@ -4317,6 +4462,30 @@ Solver::ReadData(MBDynParser& HP)
                                                   throw ErrGeneric(MBDYN_EXCEPT_ARGS);
                                              }
                                         }
+
+					if (HP.IsKeyWord("shift")) {
+						integer iNumShifts = 1;
+						if (HP.IsKeyWord("list")) {
+							iNumShifts = HP.GetInt();
+							if (iNumShifts <= 0) {
+								silent_cerr("invalid number of shifts "
+									"at line " << HP.GetLineData()
+									<< std::endl);
+								throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+							}
+						}
+
+						for (integer i = 0; i < iNumShifts; i++) {
+							doublereal dShift = HP.GetReal();
+							if (dShift == 0.) {
+								silent_cerr("null shift "
+									"at line " << HP.GetLineData()
+									<< std::endl);
+								throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+							}
+							EigAn.arpack.Shifts.push_back(dShift);
+						}
+					}
 #else // !USE_ARPACK
 					silent_cerr("\"use arpack\" "
 						"needs to configure --with-arpack "
@@ -4651,12 +4820,58 @@ Solver::ReadData(MBDynParser& HP)
 				bTrueNewtonRaphson = true;
                                 oLineSearchParam.bKeepJacAcrossSteps = false;
                                 oLineSearchParam.iIterationsBeforeAssembly = 0;
+				dAdaptiveJacRate = 0.;
 
 				if (NonlinearSolverType == NonlinearSolver::NEWTONRAPHSON && HP.IsKeyWord("true")) {
+					if (HP.IsKeyWord("fused" "assembly")) {
+						bFusedAssembly = true;
+					}
 					break;
 				}
 
-				if (HP.IsKeyWord("modified")) {
+				if (NonlinearSolverType == NonlinearSolver::NEWTONRAPHSON && HP.IsKeyWord("adaptive")) {
+					/* lo jacobiano viene riusato, anche fra
+					 * un passo e l'altro, finche' la velocita'
+					 * di convergenza e' sufficiente */
+					bTrueNewtonRaphson = false;
+					dAdaptiveJacRate = ::dDefaultAdaptiveJacRate;
+					dAdaptiveJacCoefRatio = ::dDefaultAdaptiveJacCoefRatio;
+
+					if (HP.IsKeyWord("contraction" "rate")) {
+						dAdaptiveJacRate = HP.GetReal();
+						if (dAdaptiveJacRate <= 0. || dAdaptiveJacRate >= 1.) {
+							silent_cerr("contraction rate must be between 0 and 1 "
+								"at line " << HP.GetLineData() << std::endl);
+							throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+					}
+
+					if (HP.IsKeyWord("coefficient" "ratio")) {
+						dAdaptiveJacCoefRatio = HP.GetReal();
+						if (dAdaptiveJacCoefRatio < 1.) {
+							silent_cerr("coefficient ratio must be greater than or equal to one "
+								"at line " << HP.GetLineData() << std::endl);
+							throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+						}
+					}
+
+					DEBUGLCOUT(MYDEBUG_INPUT, "adaptive "
+							"Newton-Raphson "
+							"will be used; "
+							"matrix will be "
+							"assembled when the "
+							"contraction rate exceeds "
+							<< dAdaptiveJacRate
+							<< " or the coefficient changes "
+							"by more than a factor "
+							<< dAdaptiveJacCoefRatio
+							<< std::endl);
+
+					if (HP.IsKeyWord("honor" "element" "requests")) {
+						bHonorJacRequest = true;
+					}
+
+				} else if (HP.IsKeyWord("modified")) {
 					bTrueNewtonRaphson = false;
                                         oLineSearchParam.iIterationsBeforeAssembly = HP.GetInt();
 
@@ -4693,7 +4908,14 @@ Solver::ReadData(MBDynParser& HP)
                                 }
 
 					while (HP.IsArg()) {
-                                                if (HP.IsKeyWord("default" "solver" "options")) {
+						if (NonlinearSolverType == NonlinearSolver::NEWTONRAPHSON
+							&& HP.IsKeyWord("fused" "assembly"))
+						{
+							/* residuo e jacobiano assemblati
+							 * con un solo passaggio */
+							bFusedAssembly = true;
+
+						} else if (HP.IsKeyWord("default" "solver" "options")) {
                                                 oLineSearchParam.uFlags &= ~LineSearchParameters::ABORT_AT_LAMBDA_MIN;
                                                 oLineSearchParam.uFlags |= LineSearchParameters::NON_NEGATIVE_SLOPE_CONTINUE;
                                                 oLineSearchParam.uFlags |= LineSearchParameters::ZERO_GRADIENT_CONTINUE;
@@ -5259,6 +5481,10 @@ Solver::ReadData(MBDynParser& HP)
 							<< std::endl);
 				}
 
+				if (HP.IsKeyWord("finite" "difference")) {
+					bIterativeFDProd = true;
+				}
+
 				if (HP.IsKeyWord("tau")) {
 					dIterertiveTau = HP.GetReal();
 					DEBUGLCOUT(MYDEBUG_INPUT,
@@ -5286,25 +5512,29 @@ Solver::ReadData(MBDynParser& HP)
 					case FULLJACOBIAN:
 					case FULLJACOBIANMATRIX:
 						PcType = Preconditioner::FULLJACOBIANMATRIX;
-						if (HP.IsKeyWord("steps")) {
-							iPrecondSteps = HP.GetInt();
-							DEBUGLCOUT(MYDEBUG_INPUT,
-									"number of steps "
-									"before recomputing "
-									"the preconditioner: "
-									<< iPrecondSteps
-									<< std::endl);
+						break;
+
+					case ILU:
+						PcType = Preconditioner::ILU;
+						if (HP.IsKeyWord("fill" "level")) {
+							PcParam.iFillLevel = HP.GetInt(0, HighParser::range_ge<integer>(0));
 						}
-						if (HP.IsKeyWord("honor" "element" "requests")) {
-							bHonorJacRequest = true;
-							DEBUGLCOUT(MYDEBUG_INPUT,
-									"honor elements' "
-									"request to update "
-									"the preconditioner"
-									<< std::endl);
+						break;
+
+					case ILUT:
+						PcType = Preconditioner::ILUT;
+						if (HP.IsKeyWord("drop" "tolerance")) {
+							PcParam.dDropTol = HP.GetReal(0., HighParser::range_ge<doublereal>(0.));
+						}
+						if (HP.IsKeyWord("fill")) {
+							PcParam.iFill = HP.GetInt(0, HighParser::range_ge<integer>(0));
 						}
 						break;
 
+					case BLOCKJACOBI:
+						PcType = Preconditioner::BLOCKJACOBI;
+						break;
+
 						/* add other preconditioners
 						 * here */
 
@@ -5316,6 +5546,33 @@ Solver::ReadData(MBDynParser& HP)
 							<< std::endl);
 						throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 					}
+
+					/* sparse preconditioners are rebuilt
+					 * when the inner iterations degrade */
+					if (PcType != Preconditioner::FULLJACOBIANMATRIX) {
+						iPrecondSteps = 0;
+					}
+
+					if (HP.IsKeyWord("steps")) {
+						iPrecondSteps = HP.GetInt();
+						DEBUGLCOUT(MYDEBUG_INPUT,
+								"number of steps "
+								"before recomputing "
+								"the preconditioner: "
+								<< iPrecondSteps
+								<< std::endl);
+					}
+					if (HP.IsKeyWord("rebuild" "ratio")) {
+						PcParam.dRebuildRatio = HP.GetReal(0., HighParser::range_ge<doublereal>(0.));
+					}
+					if (HP.IsKeyWord("honor" "element" "requests")) {
+						bHonorJacRequest = true;
+						DEBUGLCOUT(MYDEBUG_INPUT,
+								"honor elements' "
+								"request to update "
+								"the preconditioner"
+								<< std::endl);
+					}
 					break;
 				}
 				break;
@@ -5333,17 +5590,8 @@ Solver::ReadData(MBDynParser& HP)
 		case THREADS:
 			if (HP.IsKeyWord("auto")) {
 #ifdef USE_MULTITHREAD
-				int n = get_nprocs();
-				/* sanity checks ... */
-				if (n <= 0) {
-					silent_cerr("got " << n << " CPUs "
-							"at line "
-							<< HP.GetLineData()
-							<< std::endl);
-					nThreads = 1;
-				} else {
-					nThreads = n;
-				}
+				/* all the threads of the pool */
+				nThreads = ThreadPool::iGetMaxThreads();
 #else /* ! USE_MULTITHREAD */
 				silent_cerr("configure with "
 						"--enable-multithread "
@@ -5391,7 +5639,28 @@ Solver::ReadData(MBDynParser& HP)
 					bSolverThreads = true;
 					nSolverThreads = nt;
 				}
-#else /* ! USE_MULTITHREAD */
+#endif // USE_MULTITHREAD
+
+				while (HP.IsArg()) {
+					if (HP.IsKeyWord("colored")) {
+#ifdef USE_MULTITHREAD
+						uMTFlags |= MultiThreadDataManager::MT_COLORED;
+#endif // USE_MULTITHREAD
+
+					} else if (HP.IsKeyWord("residual")) {
+#ifdef USE_MULTITHREAD
+						uMTFlags |= MultiThreadDataManager::MT_ASSRES;
+#endif // USE_MULTITHREAD
+
+					} else {
+						silent_cerr("threads: unknown option "
+							"at line " << HP.GetLineData()
+							<< std::endl);
+						throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+					}
+				}
+
+#ifndef USE_MULTITHREAD
 				silent_cerr("configure with "
 						"--enable-multithread "
 						"for multithreaded assembly"
@@ -6018,6 +6287,14 @@ EndOfCycle: /* esce dal ciclo di lettura */
 
 #ifdef USE_MULTITHREAD
 	if (bSolverThreads) {
+		/* solver and assembly threads share the pool */
+		if (nSolverThreads > ThreadPool::iGetMaxThreads()) {
+			silent_cerr("warning: " << nSolverThreads << " solver threads requested, "
+					"only " << ThreadPool::iGetMaxThreads() << " available "
+					"(see the -N command line option)" << std::endl);
+			nSolverThreads = ThreadPool::iGetMaxThreads();
+		}
+
 		if (!CurrLinearSolver.SetNumThreads(nSolverThreads)) {
 			silent_cerr("linear solver "
 					<< CurrLinearSolver.GetSolverName()
@@ -6497,12 +6774,16 @@ eig_lapack(const MatrixHandler* pMatA, const MatrixHandler* pMatB,
 #endif // USE_LAPACK
 
 #ifdef USE_ARPACK
-// Computes eigenvalues and eigenvectors using ARPACK's
-// canonical non-symmetric eigenanalysis
-static void
-eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
-	DataManager *pDM, Solver::EigenAnalysis *pEA,
-	bool bNewLine, const unsigned uCurr)
+// Runs ARPACK's canonical non-symmetric eigenanalysis of the operator
+// Y = OP * X computed by Op; on success, D contains the real and
+// the imaginary parts of the nconv converged Ritz values, and Z
+// the corresponding Ritz vectors
+typedef std::function<void (const VectorHandler& X, VectorHandler& Y)> ArpackOp;
+
+static bool
+eig_arpack_run(integer N, const char *WHICH, const ArpackOp& Op,
+	DataManager *pDM, Solver::EigenAnalysis *pEA, bool& bNewLine,
+	std::vector<doublereal>& D, std::vector<doublereal>& Z, integer& nconv)
 {
 	// shift
 	doublereal SIGMAR = 0.;
@@ -6511,8 +6792,6 @@ eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
 	// arpack-related vars
 	integer IDO;		// 0 at first iteration; then set by dnaupd
 	const char *BMAT;	// 'I' for standard problem
-	integer N;		// size of problem
-	const char *WHICH;	// "SM" to request smallest eigenvalues
 	integer NEV;		// number of eigenvalues
 	doublereal TOL;		// -1 to use machine precision
 	std::vector<doublereal> RESID;	// residual vector (ignored if IDO==0)
@@ -6526,11 +6805,8 @@ eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
 	integer LWORKL;
 	integer INFO;
 
-        static constexpr char szWhich[][3] = {"LM", "SM", "LR", "SR", "LI", "SI"};
         IDO = 0;
         BMAT = "I";
-        N = pMatA->iGetNumRows();
-        WHICH = szWhich[pEA->eWhichEigVal];
         NEV = pEA->arpack.iNEV;
         if (NEV > N) {
                 silent_cerr("eig_arpack: invalid NEV=" << NEV << " > size of problem (=" << N << ")" << std::endl);
@@ -6577,50 +6853,7 @@ eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
 		MyVectorHandler X(N, &WORKD[IPNTR[0] - 1]);
 		MyVectorHandler Y(N, &WORKD[IPNTR[1] - 1]);
 
-		/*
-		 * NOTE: we are solving the problem
-
-			MatB * X * Lambda = MatA * X
-
-		 * and we want to focus on Ritz parameters Lambda
-		 * as close as possible to (1., 0.), which maps
-		 * to (0., 0.) in continuous time.
-		 *
-		 * We are casting the problem in the form
-
-			X * Alpha = A * X
-
-		 * by putting the problem in canonical form
-
-			X * Lambda = MatB \ MatA * X
-
-		 * and then subtracting a shift Sigma = (1., 0) after :
-
-			X * Lambda - X = MatB \ MatA * X - X
-
-			X * (Lambda - 1.) = (MatB \ MatA - I) * X
-
-		 * so
-
-			Alpha = Lambda - 1.
-
-			A = MatB \ MatA - I
-
-		 * and the sequence of operations for Y = A * X is
-
-			X' = MatA * X
-			X'' = MatB \ X'
-			Y = X'' - X
-
-		 * the eigenvalues need to be modified by adding 1.
-		 */
-
-
-		pMatA->MatVecMul(*pSM->pResHdl(), X);
-		pSM->Solve();
-		*pSM->pSolHdl() -= X;
-
-		Y = *pSM->pSolHdl();
+		Op(X, Y);
 
 		static const int CNT = 100;
 		cnt++;
@@ -6639,7 +6872,7 @@ eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
 			}
 			silent_cerr((cnt >= CNT ? "\n" : "")
 				<< "ARPACK: interrupted" << std::endl);
-			return;
+			return false;
 		}
 	} while (IDO == 1 || IDO == -1);
 
@@ -6659,7 +6892,7 @@ eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
 		}
 		silent_cerr("ARPACK error after " << cnt << " iterations; "
 			"IDO=" << IDO << ", INFO=" << INFO << std::endl);
-		return;
+		return false;
 	}
 
 	switch (INFO) {
@@ -6722,9 +6955,9 @@ eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
 	logical RVEC = true;
 	const char *HOWMNY = "A";
 	std::vector<logical> SELECT(NCV);
-	std::vector<doublereal> D(2*NCV);
+	D.resize(2*NCV);
 	doublereal *DR = &D[0], *DI = &D[NCV];
-	std::vector<doublereal> Z(N*(NCV + 1));
+	Z.resize(N*(NCV + 1));
 	integer LDZ = N;
 	std::vector<doublereal> WORKEV(3*NCV);
 
@@ -6763,7 +6996,81 @@ eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
 		&TOL, &RESID[0], &NCV, &V[0], &LDV, &IPARAM[0], &IPNTR[0],
 		&WORKD[0], &WORKL[0], &LWORKL, &INFO);
 
-	int nconv = IPARAM[4];
+	nconv = IPARAM[4];
+
+	return true;
+}
+
+// Computes eigenvalues and eigenvectors using ARPACK's
+// canonical non-symmetric eigenanalysis
+static void
+eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
+	DataManager *pDM, Solver::EigenAnalysis *pEA,
+	bool bNewLine, const unsigned uCurr)
+{
+	static constexpr char szWhich[][3] = {"LM", "SM", "LR", "SR", "LI", "SI"};
+
+	const integer N = pMatA->iGetNumRows();
+
+	auto Op = [pMatA, pSM](const VectorHandler& X, VectorHandler& Y) {
+		/*
+		 * NOTE: we are solving the problem
+
+			MatB * X * Lambda = MatA * X
+
+		 * and we want to focus on Ritz parameters Lambda
+		 * as close as possible to (1., 0.), which maps
+		 * to (0., 0.) in continuous time.
+		 *
+		 * We are casting the problem in the form
+
+			X * Alpha = A * X
+
+		 * by putting the problem in canonical form
+
+			X * Lambda = MatB \ MatA * X
+
+		 * and then subtracting a shift Sigma = (1., 0) after :
+
+			X * Lambda - X = MatB \ MatA * X - X
+
+			X * (Lambda - 1.) = (MatB \ MatA - I) * X
+
+		 * so
+
+			Alpha = Lambda - 1.
+
+			A = MatB \ MatA - I
+
+		 * and the sequence of operations for Y = A * X is
+
+			X' = MatA * X
+			X'' = MatB \ X'
+			Y = X'' - X
+
+		 * the eigenvalues need to be modified by adding 1.
+		 */
+
+
+		pMatA->MatVecMul(*pSM->pResHdl(), X);
+		pSM->Solve();
+		*pSM->pSolHdl() -= X;
+
+		Y = *pSM->pSolHdl();
+	};
+
+	std::vector<doublereal> D;
+	std::vector<doublereal> Z;
+	integer nconv = 0;
+	if (!eig_arpack_run(N, szWhich[pEA->eWhichEigVal], Op,
+		pDM, pEA, bNewLine, D, Z, nconv))
+	{
+		return;
+	}
+
+	const integer NCV = pEA->arpack.iNCV;
+	doublereal *DR = &D[0], *DI = &D[NCV];
+
 	if (nconv > 0) {
 		ASSERT(nconv <= NCV);
 		MyVectorHandler AlphaR(nconv, DR);
@@ -6790,6 +7097,146 @@ eig_arpack(const MatrixHandler* pMatA, SolutionManager* pSM,
 		silent_cerr("no converged Ritz coefficients" << std::endl);
 	}
 }
+
+// Computes eigenvalues and eigenvectors using ARPACK
+// in shift-invert mode about each of the requested shifts
+static void
+eig_arpack_shift_invert(const MatrixHandler* pMatB,
+	const std::vector<SolutionManager *>& SM,
+	DataManager *pDM, Solver::EigenAnalysis *pEA,
+	bool bNewLine, const unsigned uCurr)
+{
+	/*
+	 * NOTE: the problem
+
+		MatB * X * Lambda = MatA * X
+
+	 * is shifted about the discrete-time image Sigma
+	 * of each continuous-time real shift s
+
+		Sigma = (1 + s h/2)/(1 - s h/2)
+
+	 * and the Ritz values Nu of
+
+		(MatA - Sigma MatB) \ MatB * X = X * Nu
+
+	 * are the largest in magnitude when Lambda is closest to Sigma,
+	 * with Lambda = Sigma + 1/Nu.  Since the Jacobian matrix is linear
+	 * in the coefficient, MatA - Sigma MatB = (1 - Sigma) J(1/s),
+	 * where J(c) is the matrix assembled by AssJac with coefficient c;
+	 * its factorization is computed once in SM[k] before getting here.
+	 */
+
+	const doublereal h = pEA->dParam;
+	const integer N = pMatB->iGetNumRows();
+	const integer NCV = pEA->arpack.iNCV;
+	const doublereal dTol = std::max(pEA->arpack.dTOL,
+		std::sqrt(std::numeric_limits<doublereal>::epsilon()));
+
+	std::vector<doublereal> LR, LI;
+	std::vector<doublereal> VR;
+
+	for (std::vector<doublereal>::size_type k = 0; k < pEA->arpack.Shifts.size(); k++) {
+		const doublereal s = pEA->arpack.Shifts[k];
+		const doublereal dSigma = (1. + s*h/2.)/(1. - s*h/2.);
+		const doublereal dScale = 1./(1. - dSigma);
+		SolutionManager *pSM = SM[k];
+
+		auto Op = [pMatB, pSM, dScale](const VectorHandler& X, VectorHandler& Y) {
+			pMatB->MatVecMul(*pSM->pResHdl(), X);
+			pSM->Solve();
+			Y.ScalarMul(*pSM->pSolHdl(), dScale);
+		};
+
+		std::vector<doublereal> D;
+		std::vector<doublereal> Z;
+		integer nconv = 0;
+		if (!eig_arpack_run(N, "LM", Op, pDM, pEA, bNewLine, D, Z, nconv)) {
+			continue;
+		}
+
+		const doublereal *DR = &D[0], *DI = &D[NCV];
+		for (integer j = 0; j < nconv; j++) {
+			const doublereal d = DR[j]*DR[j] + DI[j]*DI[j];
+			if (d == 0.) {
+				continue;
+			}
+
+			// the conjugate is stored right after
+			if (DI[j] != 0. && j + 1 >= nconv) {
+				break;
+			}
+
+			const doublereal dLR = dSigma + DR[j]/d;
+			const doublereal dLI = DI[j]/d;
+
+			// the same eigenvalue may be found about more than one shift
+			bool bDup = false;
+			for (std::vector<doublereal>::size_type i = 0; i < LR.size(); i++) {
+				const doublereal dRef = std::max(1., std::sqrt(LR[i]*LR[i] + LI[i]*LI[i]));
+				if (std::abs(LR[i] - dLR) + std::abs(LI[i] - dLI) < dTol*dRef) {
+					bDup = true;
+					break;
+				}
+			}
+
+			const doublereal *pz = &Z[N*j];
+			if (DI[j] == 0.) {
+				if (!bDup) {
+					LR.push_back(dLR);
+					LI.push_back(0.);
+					VR.insert(VR.end(), pz, pz + N);
+				}
+
+			} else {
+				// Lambda = Sigma + conj(Nu)/|Nu|^2 is associated
+				// with Z(j) + i Z(j + 1); store the eigenvalue
+				// with positive imaginary part first
+				if (!bDup) {
+					LR.push_back(dLR);
+					LI.push_back(dLI);
+					VR.insert(VR.end(), pz, pz + N);
+					for (integer i = 0; i < N; i++) {
+						VR.push_back(-pz[N + i]);
+					}
+
+					LR.push_back(dLR);
+					LI.push_back(-dLI);
+				}
+				j++;
+			}
+		}
+	}
+
+	const integer n = LR.size();
+	if (n > 0) {
+		MyVectorHandler LambdaR(n, &LR[0]);
+		MyVectorHandler LambdaI(n, &LI[0]);
+		std::vector<bool> vOut(n);
+		output_eigenvalues(0, LambdaR, LambdaI, 0., pDM, pEA, 1, n, vOut);
+
+		if (pEA->uFlags & Solver::EigenAnalysis::EIG_OUTPUT_GEOMETRY) {
+			pDM->OutputEigGeometry(uCurr, pEA->iResultsPrecision);
+		}
+
+		if (pEA->uFlags & Solver::EigenAnalysis::EIG_OUTPUT_EIGENVECTORS) {
+			// complex pairs share two columns, as in eig_arpack
+			ASSERT(VR.size() <= std::vector<doublereal>::size_type(N*n));
+			VR.resize(N*n, 0.);
+			std::vector<doublereal *> VRC(n);
+			FullMatrixHandler MatVR(&VR[0], &VRC[0], N*n, N, n);
+			pDM->OutputEigenvectors(0, LambdaR, LambdaI, 0.,
+				0, MatVR, vOut, uCurr, pEA->iResultsPrecision);
+		}
+
+	} else {
+		if (bNewLine && silent_err) {
+			silent_cerr(std::endl);
+			bNewLine = false;
+		}
+		silent_cerr("no converged Ritz coefficients" << std::endl);
+	}
+}
 #endif // USE_ARPACK
 
 #ifdef USE_JDQZ
@@ -6975,6 +7422,75 @@ lwork       Size of workspace, >= 4+m+5jmax+3kmax if GMRESm
 }
 #endif // USE_JDQZ
 
+// Assembles the Jacobian matrix with coefficient dCoef into the matrix
+// of a solution manager, rebuilding its sparsity pattern if needed;
+// returns the (possibly reallocated) matrix
+static MatrixHandler *
+eig_assjac(DataManager *pDM, SolutionManager *pSM, const doublereal& dCoef)
+{
+	pSM->MatrReset();
+
+rebuild_matrix:;
+	try {
+		pSM->pMatHdl()->Reset();
+		pDM->AssJac(*pSM->pMatHdl(), dCoef);
+
+	} catch (MatrixHandler::ErrRebuildMatrix& e) {
+		silent_cout("Eig: rebuilding matrix..." << std::endl);
+
+		/* need to rebuild the matrix... */
+		pSM->MatrInitialize();
+		goto rebuild_matrix;
+	}
+
+	pSM->pMatHdl()->PacMat(); // Needed for Trilinos sparse matrix handler
+
+	return pSM->pMatHdl();
+}
+
+#ifdef USE_ARPACK
+// Factors the matrix of a solution manager by solving with a null rhs
+struct EigFactorData {
+	SolutionManager *pSM;
+	std::exception_ptr except;
+};
+
+static void
+eig_factor(EigFactorData *pData)
+{
+	try {
+		pData->pSM->pResHdl()->Reset();
+		pData->pSM->Solve();
+
+	} catch (...) {
+		pData->except = std::current_exception();
+	}
+}
+
+// Factors the matrices of independent solution managers,
+// up to nThreads at a time on the thread pool
+static void
+eig_factor(const std::vector<SolutionManager *>& SM, unsigned nThreads)
+{
+	typedef std::vector<SolutionManager *>::size_type size_type;
+
+	std::vector<EigFactorData> Data(SM.size());
+	for (size_type k = 0; k < SM.size(); k++) {
+		Data[k].pSM = SM[k];
+	}
+
+	ThreadPool::Get().ParallelFor(SM.size(), [&Data](unsigned k) {
+		eig_factor(&Data[k]);
+	}, nThreads);
+
+	for (size_type k = 0; k < SM.size(); k++) {
+		if (Data[k].except) {
+			std::rethrow_exception(Data[k].except);
+		}
+	}
+}
+#endif // USE_ARPACK
+
 // Driver for eigenanalysis
 void
 Solver::Eig(bool bNewLine)
@@ -7014,9 +7530,37 @@ Solver::Eig(bool bNewLine)
                         iNLD = iNumLocDofs*iStates;
                 }
 
-                pSM = AllocateSolman(iNLD, iLWS);                
-		pMatB = pSM->pMatHdl();
-                pMatA = pMatB->Copy();
+                if (!EigAn.arpack.Shifts.empty() && bParallel) {
+                        silent_cerr("ARPACK shift-invert eigenanalysis "
+                                "is not supported by the parallel solver" << std::endl);
+                        throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+                }
+
+                // the solution managers are kept across analyses,
+                // so the symbolic factorization is computed only once
+                const std::vector<SolutionManager *>::size_type nSM
+                        = std::max<std::vector<SolutionManager *>::size_type>(1, EigAn.arpack.Shifts.size());
+                while (EigSolMan.size() < nSM) {
+                        EigSolMan.push_back(AllocateSolman(iNLD, iLWS));
+                }
+
+                if (EigAn.arpack.Shifts.empty()) {
+                        pSM = EigSolMan[0];
+                        pMatB = pSM->pMatHdl();
+
+                } else {
+                        SAFENEWWITHCONSTRUCTOR(pMatB, SpMapMatrixHandler,
+                                SpMapMatrixHandler(iNLD));
+                }
+
+                if (bParallel) {
+                        pMatA = pMatB->Copy();
+
+                } else {
+                        // the sparsity pattern of a reused matrix may change
+                        SAFENEWWITHCONSTRUCTOR(pMatA, SpMapMatrixHandler,
+                                SpMapMatrixHandler(iNLD));
+                }
 
 	} else if (EigAn.uFlags & EigenAnalysis::EIG_USE_JDQZ) {
 		SAFENEWWITHCONSTRUCTOR(pMatA, NaiveMatrixHandler,
@@ -7064,9 +7608,45 @@ Solver::Eig(bool bNewLine)
              Res.Reset();
              oFakeStepIntegrator.SetCoef(h/2.);
              pDM->AssRes(Res, h/2.);
-             pMatB->Reset();
-             pDM->AssJac(*pMatB, h/2.);
-             pMatB->PacMat(); // Needed for Trilinos sparse matrix handler
+             if (pSM) {
+                  pMatB = eig_assjac(pDM, pSM, h/2.);
+
+             } else {
+                  pMatB->Reset();
+                  pDM->AssJac(*pMatB, h/2.);
+                  pMatB->PacMat(); // Needed for Trilinos sparse matrix handler
+             }
+
+#ifdef USE_ARPACK
+             if (EigAn.uFlags & EigenAnalysis::EIG_USE_ARPACK) {
+                  /*
+                   * MatA - Sigma MatB = (1 - Sigma) J(1/s),
+                   * see eig_arpack_shift_invert()
+                   */
+                  for (std::vector<doublereal>::size_type k = 0; k < EigAn.arpack.Shifts.size(); k++) {
+                       const doublereal s = EigAn.arpack.Shifts[k];
+                       if (std::abs(1. - s*h/2.) < std::numeric_limits<doublereal>::epsilon()) {
+                            silent_cerr("ARPACK: shift " << s << " maps to infinity "
+                                 "with the current time step" << std::endl);
+                            throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+                       }
+
+                       pDM->Update();
+                       Res.Reset();
+                       oFakeStepIntegrator.SetCoef(1./s);
+                       pDM->AssRes(Res, 1./s);
+                       eig_assjac(pDM, EigSolMan[k], 1./s);
+                  }
+
+                  if (!EigAn.arpack.Shifts.empty()) {
+#ifdef USE_MULTITHREAD
+                       eig_factor(EigSolMan, nThreads);
+#else // ! USE_MULTITHREAD
+                       eig_factor(EigSolMan, 1);
+#endif // ! USE_MULTITHREAD
+                  }
+             }
+#endif // USE_ARPACK
         }
 
 #ifdef DEBUG
@@ -7116,7 +7696,12 @@ Solver::Eig(bool bNewLine)
 
 #ifdef USE_ARPACK
 	case EigenAnalysis::EIG_USE_ARPACK:
-		eig_arpack(pMatA, pSM, pDM, &EigAn, bNewLine, uCurr);
+		if (EigAn.arpack.Shifts.empty()) {
+			eig_arpack(pMatA, pSM, pDM, &EigAn, bNewLine, uCurr);
+
+		} else {
+			eig_arpack_shift_invert(pMatB, EigSolMan, pDM, &EigAn, bNewLine, uCurr);
+		}
 		break;
 #endif // USE_ARPACK
 
@@ -7138,8 +7723,7 @@ Solver::Eig(bool bNewLine)
 	pDM->OutputEigClose();
 
 	if (pSM) {
-                pMatB = nullptr; // pMatB will be deleted when deleting pSM
-		SAFEDELETE(pSM);
+                pMatB = nullptr; // pMatB is owned by pSM, which is kept in EigSolMan
 	}
 
 	if (pMatA) {
@@ -7249,16 +7833,22 @@ Solver::AllocateNonlinearSolver()
 
 	switch (NonlinearSolverType) {
 	case NonlinearSolver::MATRIXFREE:
+		if (PcType == Preconditioner::BLOCKJACOBI) {
+			pDM->GetDofBlocks(PcParam.BlockPtr);
+		}
+
 		switch (MFSolverType) {
 		case MatrixFreeSolver::BICGSTAB:
 			SAFENEWWITHCONSTRUCTOR(pNLS,
 					BiCGStab,
 					BiCGStab(PcType,
 						iPrecondSteps,
+						PcParam,
 						dIterTol,
 						iIterativeMaxSteps,
 						dIterertiveEtaMax,
 						dIterertiveTau,
+						bIterativeFDProd,
 						*this));
 			break;
 
@@ -7272,10 +7862,12 @@ Solver::AllocateNonlinearSolver()
 					Gmres,
 					Gmres(PcType,
 						iPrecondSteps,
+						PcParam,
 						dIterTol,
 						iIterativeMaxSteps,
 						dIterertiveEtaMax,
 						dIterertiveTau,
+						bIterativeFDProd,
 						*this));
 			break;
 		}
@@ -7291,7 +7883,10 @@ Solver::AllocateNonlinearSolver()
 				NewtonRaphsonSolver(bTrueNewtonRaphson,
                                         oLineSearchParam.bKeepJacAcrossSteps,
                                         oLineSearchParam.iIterationsBeforeAssembly,
-					*this));
+					*this,
+					bFusedAssembly,
+					dAdaptiveJacRate,
+					dAdaptiveJacCoefRatio));
 		break;
 	case NonlinearSolver::LINESEARCH:
             switch (CurrLinearSolver.GetSolver()) {
@@ -7489,6 +8084,26 @@ Solver::PrintSolution(const VectorHandler& Sol, integer iIterCnt) const
 	pDM->PrintSolution(Sol, iIterCnt);
 }
 
+void Solver::CheckLocalError(doublereal dLocalErr) const /*throw(NonlinearSolver::LocalErrorExceeded)*/
+{
+	if (!pTSC->bRejectStep(dLocalErr)) {
+		return;
+	}
+
+	if (outputIters()) {
+#ifdef USE_MPI
+		if (!bParallel || MBDynComm.Get_rank() == 0)
+#endif /* USE_MPI */
+		{
+			silent_cerr("warning: local error estimate = " << dLocalErr
+					<< " > 1; time step = " << dCurrTimeStep
+					<< " rejected" << std::endl);
+		}
+	}
+
+	throw NonlinearSolver::LocalErrorExceeded(MBDYN_EXCEPT_ARGS);
+}
+
 void Solver::CheckTimeStepLimit(doublereal dErr, doublereal dErrDiff) const /*throw(NonlinearSolver::MaxResidualExceeded, NonlinearSolver::TimeStepLimitExceeded)*/
 {
 	if (pDerivativeSteps) {
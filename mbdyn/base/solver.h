@@ -105,6 +105,7 @@ public:
 protected:
 #ifdef USE_MULTITHREAD
 	unsigned nThreads;
+	unsigned uMTFlags;
 
 	void ThreadPrepare(void);
 #endif /* USE_MULTITHREAD */
@@ -189,6 +190,9 @@ public:
                         integer iNCV;
                         doublereal dTOL;
                         integer iMaxIterations;
+                        // real shifts (continuous time) for shift-invert mode;
+                        // empty for the default canonical mode
+                        std::vector<doublereal> Shifts;
                      ARPACK(void) : iNEV(0), iNCV(0), dTOL(0.), iMaxIterations(300) { NO_OP; };
                 } arpack;
 
@@ -367,14 +371,20 @@ protected:
 
    	/* Parametri per solutore nonlineare */
    	bool bTrueNewtonRaphson;
+	bool bFusedAssembly;
+	/* riuso adattativo dello jacobiano (disabilitato se <= 0) */
+	doublereal dAdaptiveJacRate;
+	doublereal dAdaptiveJacCoefRatio;
 	NonlinearSolver::Type NonlinearSolverType;
 	MatrixFreeSolver::SolverType MFSolverType;
 	doublereal dIterTol;
 	Preconditioner::PrecondType PcType;
+	Preconditioner::Param PcParam;
 	integer iPrecondSteps;
 	integer iIterativeMaxSteps;
 	doublereal dIterertiveEtaMax;
 	doublereal dIterertiveTau;
+	bool bIterativeFDProd;
 	LineSearchParameters oLineSearchParam;
 #ifdef USE_TRILINOS
         NoxSolverParameters oNoxSolverParam;
@@ -398,6 +408,9 @@ protected:
 
 	/* il solution manager v*/
 	SolutionManager *pSM;
+	/* solution managers of the eigenanalysis, one for each shift;
+	 * kept across analyses to reuse the symbolic factorization */
+	std::vector<SolutionManager *> EigSolMan;
 	NonlinearSolver* pNLS;
 
 	/* corregge i puntatori per un nuovo passo */
@@ -437,6 +450,8 @@ protected:
 	bool bSolConv;
 	bool bOut;
 	long lStep;
+	/* state restored from a binary checkpoint */
+	bool bRestored;
 
 public:
    	/* costruttore */
@@ -458,6 +473,11 @@ public:
 
 	std::ostream & Restart(std::ostream& out, DataManager::eRestart type) const;
 
+	/* binary checkpoint of the solution and of the integration history;
+	 * only valid between time steps */
+	void SaveState(CheckpointOut& out) const;
+	void RestoreState(CheckpointIn& in);
+
 	/* EXPERIMENTAL */
 	/* FIXME: better const'ify? */
 	virtual DataManager *pGetDataManager(void) const {
@@ -491,6 +511,7 @@ public:
 	virtual void PrintResidual(const VectorHandler& Res, integer iIterCnt) const;
 	virtual void PrintSolution(const VectorHandler& Sol, integer iIterCnt) const;
 	virtual void CheckTimeStepLimit(doublereal dErr, doublereal dErrDiff) const /*throw(NonlinearSolver::TimeStepLimitExceeded, NonlinearSolver::MaxResidualExceeded)*/;
+	virtual void CheckLocalError(doublereal dLocalErr) const /*throw(NonlinearSolver::LocalErrorExceeded)*/;
         std::ostream& PrintSolverTime(std::ostream& os) const {
 	     return pNLS->PrintSolverTime(os);
         }
@@ -90,6 +90,8 @@ static const doublereal dDefaultDerivativesCoefficient = 1.e-6;
 static const integer iDefaultDummyStepsNumber = 0;
 static const doublereal dDefaultDummyStepsRatio = 1.e-3;
 static const integer iDefaultIterationsBeforeAssembly = 2;
+static const doublereal dDefaultAdaptiveJacRate = 0.5;
+static const doublereal dDefaultAdaptiveJacCoefRatio = 2.;
 static const integer iDefaultIterativeSolversMaxSteps = 100;
 static const integer iDefaultPreconditionerSteps = 20;
 static const doublereal dDefaultTol = 1.e-6;
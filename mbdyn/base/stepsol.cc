@@ -120,6 +120,12 @@ StepIntegrator::SetDriveHandler(const DriveHandler* /* pDH */ )
 	NO_OP;
 }
 
+bool
+StepIntegrator::SetLocalErrorTolerance(doublereal /* dRelTol */ , doublereal /* dAbsTol */ )
+{
+	return false;
+}
+
 #include "stepsol.hc"
 
 ImplicitStepIntegrator::ImplicitStepIntegrator(const integer MaxIt,
@@ -436,6 +442,14 @@ void DerivativeSolver::Jacobian(VectorHandler* pJac, const VectorHandler* pY) co
      pDM->AssJac(*pJac, *pY, dCoef);
 }
 
+void
+DerivativeSolver::ResidualJacobian(VectorHandler* pRes, VectorHandler* pAbsRes,
+	MatrixHandler* pJac) const
+{
+	ASSERT(pDM != NULL);
+	pDM->AssResJac(*pRes, *pJac, dCoef, pAbsRes);
+}
+
 void
 DerivativeSolver::UpdateDof(const int DCount,
 		const DofOrder::Order Order,
@@ -472,6 +486,11 @@ doublereal DerivativeSolver::dGetCoef(unsigned int iDof) const
      return dCoef;
 }
 
+doublereal DerivativeSolver::dGetJacobianCoef(void) const
+{
+     return dCoef;
+}
+
 /* scale factor for tests */
 doublereal
 DerivativeSolver::TestScale(const NonlinearSolverTest *pTest, doublereal& dAlgebraicEqu) const
@@ -491,7 +510,10 @@ StepNIntegrator::StepNIntegrator(const integer MaxIt,
 		const bool bmod_res_test)
 : ImplicitStepIntegrator(MaxIt, dT, dSolutionTol, stp, 1, bmod_res_test),
 db0Differential(0.),
-db0Algebraic(0.)
+db0Algebraic(0.),
+m_bLocalError(false),
+m_dLERelTol(0.),
+m_dLEAbsTol(0.)
 {
 	NO_OP;
 }
@@ -501,6 +523,69 @@ StepNIntegrator::~StepNIntegrator(void)
 	NO_OP;
 }
 
+bool
+StepNIntegrator::SetLocalErrorTolerance(doublereal dRelTol, doublereal dAbsTol)
+{
+	ASSERT(dRelTol >= 0.);
+	ASSERT(dAbsTol >= 0.);
+	ASSERT(dRelTol > 0. || dAbsTol > 0.);
+
+	m_bLocalError = true;
+	m_dLERelTol = dRelTol;
+	m_dLEAbsTol = dAbsTol;
+
+	return true;
+}
+
+void
+StepNIntegrator::SavePrediction(void)
+{
+	const integer iNumDofs = pXCurr->iGetSize();
+
+	if (m_XPred.iGetSize() != iNumDofs) {
+		m_XPred.Resize(iNumDofs);
+	}
+
+	for (integer i = 1; i <= iNumDofs; i++) {
+		m_XPred(i) = (*pXCurr)(i);
+	}
+}
+
+/* norma RMS pesata della differenza tra soluzione predetta e corretta
+ * degli stati differenziali; il passo e' accettabile se <= 1 */
+doublereal
+StepNIntegrator::dLocalError(void) const
+{
+	doublereal dErr2 = 0.;
+	integer iCnt = 0;
+
+	DataManager::DofIterator_const CurrDof = pDofs->begin();
+	const integer iNumDofs = pDofs->size();
+
+	for (integer i = 1; i <= iNumDofs; i++, ++CurrDof) {
+		if (CurrDof->Order != DofOrder::DIFFERENTIAL) {
+			continue;
+		}
+
+		const doublereal dX = (*pXCurr)(i);
+		const doublereal dXPred = m_XPred(i);
+		const doublereal dW = m_dLEAbsTol
+			+ m_dLERelTol*std::max(std::abs(dX), std::abs(dXPred));
+		iCnt++;
+
+		if (dW > 0.) {
+			const doublereal d = (dX - dXPred)/dW;
+			dErr2 += d*d;
+		}
+	}
+
+	if (iCnt == 0) {
+		return 0.;
+	}
+
+	return std::sqrt(dErr2/iCnt);
+}
+
 void
 StepNIntegrator::Residual(VectorHandler* pRes, VectorHandler* pAbsRes) const
 {
@@ -527,6 +612,16 @@ void StepNIntegrator::Jacobian(VectorHandler* pJac, const VectorHandler* pY) con
         pDM->AssJac(*pJac, *pY, db0Differential);
 }
 
+void
+StepNIntegrator::ResidualJacobian(VectorHandler* pRes, VectorHandler* pAbsRes,
+	MatrixHandler* pJac) const
+{
+	ASSERT(pDM != NULL);
+	pDM->AssResJac(*pRes, *pJac, db0Differential, pAbsRes);
+
+	pDM->FDJacCheck(this, pJac);
+}
+
 void
 StepNIntegrator::UpdateDof(const int DCount,
 	const DofOrder::Order Order,
@@ -559,6 +654,11 @@ StepNIntegrator::Update(const VectorHandler* pSol) const
 	pDM->Update();
 }
 
+doublereal StepNIntegrator::dGetJacobianCoef(void) const
+{
+     return db0Differential;
+}
+
 doublereal StepNIntegrator::dGetCoef(unsigned int iDof) const
 {
      ASSERT(iDof > 0);
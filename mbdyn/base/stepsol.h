@@ -136,6 +136,12 @@ public:
 	
 	virtual void SetDriveHandler(const DriveHandler* pDH);
 
+	/* enables the estimate of the local truncation error,
+	 * normalized by the tolerances, which is passed
+	 * to Solver::CheckLocalError() after convergence;
+	 * returns false if the integrator cannot estimate it */
+	virtual bool SetLocalErrorTolerance(doublereal dRelTol, doublereal dAbsTol);
+
 	virtual doublereal
 	Advance(Solver* pS, 
 			const doublereal TStep, 
@@ -224,9 +230,14 @@ public:
 	void Jacobian(MatrixHandler* pJac) const override;
 
 	void Jacobian(VectorHandler* pJac, const VectorHandler* pY) const override;
+
+	void ResidualJacobian(VectorHandler* pRes, VectorHandler* pAbsRes,
+		MatrixHandler* pJac) const override;
 	
 	void Update(const VectorHandler* pSol) const override;
 
+	virtual doublereal dGetJacobianCoef(void) const override;
+
 	virtual doublereal dGetCoef(unsigned int iDof) const override;
      
 	/* scale factor for tests */
@@ -262,6 +273,17 @@ public:
 		// add as needed
 	};
 
+protected:
+	/* stima dell'errore locale: differenza tra predizione
+	 * e soluzione corretta degli stati differenziali */
+	bool m_bLocalError;
+	doublereal m_dLERelTol;
+	doublereal m_dLEAbsTol;
+	MyVectorHandler m_XPred;
+
+	void SavePrediction(void);
+	doublereal dLocalError(void) const;
+
 public:
 	void UpdateDof(const int DCount,
 		const DofOrder::Order Order,
@@ -275,14 +297,21 @@ public:
 
 	virtual ~StepNIntegrator(void);
 
+	virtual bool SetLocalErrorTolerance(doublereal dRelTol, doublereal dAbsTol) override;
+
 	virtual void Residual(VectorHandler* pRes, VectorHandler* pAbsRes=0) const override;
 
 	virtual void Jacobian(MatrixHandler* pJac) const override;
 	
         virtual void Jacobian(VectorHandler* pJac, const VectorHandler* pY) const override;
+
+	virtual void ResidualJacobian(VectorHandler* pRes, VectorHandler* pAbsRes,
+		MatrixHandler* pJac) const override;
      
 	virtual void Update(const VectorHandler* pSol) const override;
 
+	virtual doublereal dGetJacobianCoef(void) const override;
+
 	virtual doublereal dGetCoef(unsigned int iDof) const override;
      
 	virtual doublereal TestScale(const NonlinearSolverTest *pTest, doublereal& dAlgebraicEqu) const override;
@@ -695,6 +695,13 @@ void HybridStepIntegrator::Jacobian(VectorHandler* pJac, const VectorHandler* pY
      pDefaultInteg->Jacobian(pJac, pY);
 }
 
+void HybridStepIntegrator::ResidualJacobian(VectorHandler* pRes, VectorHandler* pAbsRes,
+                                            MatrixHandler* pJac) const
+{
+     ASSERT(pDefaultInteg != nullptr);
+     pDefaultInteg->ResidualJacobian(pRes, pAbsRes, pJac);
+}
+
 void HybridStepIntegrator::Predict()
 {
      DEBUGCOUTFNAME("HybridStepIntegrator::Predict");
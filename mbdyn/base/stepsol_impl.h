@@ -288,6 +288,10 @@ public:
      virtual void
      Jacobian(VectorHandler* pJac, const VectorHandler* pY) const override;
 
+     virtual void
+     ResidualJacobian(VectorHandler* pRes, VectorHandler* pAbsRes,
+                      MatrixHandler* pJac) const override;
+
 private:
      void
      SetSolution(std::deque<VectorHandler*>& qX,
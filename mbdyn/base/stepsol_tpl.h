@@ -280,6 +280,9 @@ tplStepNIntegrator<N>::Advance(Solver* pS,
 	/* predizione */
 	SetCoef(TStep, dAph, StType);
 	Predict();
+	if (m_bLocalError) {
+		SavePrediction();
+	}
 	pDM->LinkToSolution(*pXCurr, *pXPrimeCurr);
       	pDM->AfterPredict();
 
@@ -314,8 +317,21 @@ tplStepNIntegrator<N>::Advance(Solver* pS,
 #endif /* DEBUG */
 
 	Err = 0.;
-	pS->pGetNonlinearSolver()->Solve(this, pS, MaxIters, dTol,
-    			EffIter, Err, dSolTol, SolErr);
+	try {
+		pS->pGetNonlinearSolver()->Solve(this, pS, MaxIters, dTol,
+    				EffIter, Err, dSolTol, SolErr);
+	}
+	catch (NonlinearSolver::ConvergenceOnSolution& e) {
+		if (m_bLocalError) {
+			pS->CheckLocalError(dLocalError());
+		}
+		throw;
+	}
+
+	/* the step may still be rejected because of the local error */
+	if (m_bLocalError) {
+		pS->CheckLocalError(dLocalError());
+	}
 
 	/* if it gets here, it surely converged */
 	pDM->AfterConvergence();
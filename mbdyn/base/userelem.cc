@@ -92,7 +92,12 @@ ParseUserDefinedElem(unsigned uLabel, DofOwner* pDO,
 		throw DataManager::ErrGeneric(MBDYN_EXCEPT_ARGS);
 	}
 
-	return i->second->Read(uLabel, pDO, pDM, HP);
+	UserDefinedElem *pEl = i->second->Read(uLabel, pDO, pDM, HP);
+	if (pEl != 0) {
+		pEl->SetModuleName(i->first);
+	}
+
+	return pEl;
 }
 
 // legacy
@@ -103,7 +108,12 @@ ReadLoadable(DataManager* pDM, MBDynParser& HP,
 	UDEMapType::iterator i = UDEMap.find("loadable");
 	ASSERT(i != UDEMap.end());
 
-	return i->second->Read(uLabel, pDO, pDM, HP);
+	UserDefinedElem *pEl = i->second->Read(uLabel, pDO, pDM, HP);
+	if (pEl != 0) {
+		pEl->SetModuleName(i->first);
+	}
+
+	return pEl;
 }
 
 bool
@@ -208,6 +218,18 @@ UserDefinedElem::NeedsAirProperties(bool yesno)
 	needsAirProperties = yesno;
 }
 
+const std::string&
+UserDefinedElem::GetModuleName(void) const
+{
+	return sModuleName;
+}
+
+void
+UserDefinedElem::SetModuleName(const std::string& s)
+{
+	sModuleName = s;
+}
+
 Elem::Type 
 UserDefinedElem::GetElemType(void) const
 {
@@ -46,6 +46,7 @@ class UserDefinedElem :
 {
 protected:
 	bool needsAirProperties;
+	std::string sModuleName;
 
 public:
    	UserDefinedElem(unsigned uLabel, const DofOwner* pDO);
@@ -54,6 +55,10 @@ public:
 	bool NeedsAirProperties(void) const;
 	void NeedsAirProperties(bool yesno);
 
+	/* name the element was registered with (see SetUDE()) */
+	const std::string& GetModuleName(void) const;
+	void SetModuleName(const std::string& s);
+
    	virtual Elem::Type GetElemType(void) const;
    	virtual AerodynamicElem::Type GetAerodynamicElemType(void) const;
 
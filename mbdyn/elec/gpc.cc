@@ -491,6 +491,38 @@ gpc_build_matrices(integer ndimA, doublereal* A,
    	return 0;
 }
 
+/*
+ * data Z = M^-1*E, dove E sono le ultime nrhs colonne dell'identita'
+ * ed M e' simmetrica, mette in dest le ultime nrhs righe di M^-1*P^T,
+ * organizzate per righe: la riga i e' Z_i^T*P^T
+ */
+
+static inline int
+gpc_zt_pt(integer ndimz, integer nrowz, integer nrhs, const doublereal* Z,
+	  integer ndimp, integer nrowp, const doublereal* P,
+	  doublereal* dest)
+{
+   	for (integer i = nrhs; i-- > 0; ) {
+      		const doublereal* zi = Z+ndimz*i;
+      		doublereal* di = dest+nrowp*i;
+
+      		for (integer k = nrowp; k-- > 0; ) {
+	 		di[k] = 0.;
+      		}
+
+      		for (integer c = nrowz; c-- > 0; ) {
+	 		const doublereal* pc = P+ndimp*c;
+	 		doublereal z = zi[c];
+	 		for (integer k = nrowp; k-- > 0; ) {
+	    			/* dest[k+nrowp*i] += Z[c+ndimz*i]*P[k+ndimp*c]; */
+	    			di[k] += z*pc[k];
+	 		}
+      		}
+   	}
+
+   	return 0;
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -505,6 +537,26 @@ __FC_DECL__(dgesvd)(char* jobu, char* jobvt,
 		    doublereal* work, integer* lwork, 
 		    integer* info);
 
+extern int
+__FC_DECL__(dgeqrf)(integer* m, integer* n,
+		    doublereal* a, integer* lda,
+		    doublereal* tau,
+		    doublereal* work, integer* lwork,
+		    integer* info);
+
+extern int
+__FC_DECL__(dtrcon)(char* norm, char* uplo, char* diag, integer* n,
+		    const doublereal* a, integer* lda,
+		    doublereal* rcond,
+		    doublereal* work, integer* iwork,
+		    integer* info);
+
+extern int
+__FC_DECL__(dpotrs)(char* uplo, integer* n, integer* nrhs,
+		    const doublereal* a, integer* lda,
+		    doublereal* b, integer* ldb,
+		    integer* info);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -614,7 +666,7 @@ pdWork(NULL)
    	iMin = std::min(m, n);	/* usati per vari parametri */
    	iMax = std::max(m, n);       /* serve solo qui, non serve tenerlo */
    
-   	iWork = std::max(3*iMin+iMax, 5*iMin-4); /* aumentare per maggiore eff. */
+   	iWork = std::max(3*iMin+iMax, 5*iMin); /* aumentare per maggiore eff. */
    
    	/* aree di lavoro per SVD:
     	 * s:    (min(m,n))
@@ -623,7 +675,8 @@ pdWork(NULL)
 	 * vt:   (ldvt*n)
 	 *       ldvt >= min(m,n)
 	 * work: lwork
-	 *       lwork >= max(3*min(m,n)+max(m,n),5*min(m,n)-4)
+	 *       lwork >= max(3*min(m,n)+max(m,n),5*min(m,n))
+	 *       (5*min(m,n)-4 per le versioni di LAPACK precedenti la 3.0)
 	 */
      
    	integer i = iMin	/* s */
@@ -686,6 +739,346 @@ GPC_LAPACK_pinv::Inv(integer ndima, integer nrowa,
 /* GPC_LAPACK_pinv - end */
 
 
+/* GPC_LAPACK_chol - begin */
+
+GPC_LAPACK_chol::GPC_LAPACK_chol(integer n, integer nrhs,
+				 integer nrowp, integer nout,
+				 doublereal dRCondMin)
+: n(n),
+nrhs(nrhs),
+nrowp(nrowp),
+nout(nout),
+nrowa(nrowp+n),
+iMaxIter(0),
+dTol(1.e-13),
+dRCondMin(dRCondMin),
+bFactored(false),
+iSkip(0),
+iSkipNext(1),
+ndimp(0),
+pdCurrP(NULL),
+pdCurrW(NULL),
+pdCurrR(NULL),
+dCurrLambda(0.),
+iLWork(0),
+pdBase(NULL),
+pdA(NULL),
+pdTau(NULL),
+pdZ(NULL),
+pdR(NULL),
+pdS(NULL),
+pdP(NULL),
+pdQ(NULL),
+pdT(NULL),
+pdWork(NULL),
+piWork(NULL)
+{
+   	ASSERT(n > 0);
+   	ASSERT(nrhs > 0);
+   	ASSERT(nrhs <= n);
+   	ASSERT(nrowp > 0);
+   	ASSERT(nout > 0);
+   	ASSERT(nrowp%nout == 0);
+   	ASSERT(n%nrhs == 0);
+
+   	/*
+	 * un'iterazione costa circa 4*nrowp*n+2*n^2 per ogni colonna di E
+	 * (prodotto per M e due sostituzioni), la fattorizzazione
+	 * circa 2*nrowa*n^2: oltre nrowa*n/(nrhs*(2*nrowp+n)) iterazioni
+	 * conviene rifattorizzare
+	 */
+   	iMaxIter = std::min(integer(20),
+			    std::max(integer(1), (nrowa*n)/(nrhs*(2*nrowp+n))));
+
+   	iLWork = 3*n;
+#ifdef USE_LAPACK
+   	/* dimensione ottimale del lavoro di dgeqrf() */
+   	integer info = 0;
+   	integer lwork = -1;
+   	doublereal dLWork = 0.;
+   	doublereal dDummy = 0.;
+   	__FC_DECL__(dgeqrf)(&nrowa, &n, &dDummy, &nrowa, &dDummy,
+			    &dLWork, &lwork, &info);
+   	if (info == 0) {
+      		iLWork = std::max(iLWork, integer(dLWork));
+   	}
+#endif /* USE_LAPACK */
+
+   	SAFENEWARR(pdBase, doublereal,
+		   nrowa*n+n+n*nrhs+4*n+nrowp+iLWork);
+   	SAFENEWARR(piWork, integer, n);
+
+   	pdA = pdBase;
+   	pdTau = pdA+nrowa*n;
+   	pdZ = pdTau+n;
+   	pdR = pdZ+n*nrhs;
+   	pdS = pdR+n;
+   	pdP = pdS+n;
+   	pdQ = pdP+n;
+   	pdT = pdQ+n;
+   	pdWork = pdT+nrowp;
+}
+
+GPC_LAPACK_chol::~GPC_LAPACK_chol(void)
+{
+   	SAFEDELETEARR(piWork);
+   	SAFEDELETEARR(pdBase);
+}
+
+/* y = M*x = P^T*W*(P*x)+lambda*R*x, senza costruire M */
+void
+GPC_LAPACK_chol::MatVec(const doublereal* x, doublereal* y)
+{
+   	for (integer k = nrowp; k-- > 0; ) {
+      		pdT[k] = 0.;
+   	}
+   	for (integer c = n; c-- > 0; ) {
+      		const doublereal* pc = pdCurrP+ndimp*c;
+      		doublereal xc = x[c];
+      		for (integer k = nrowp; k-- > 0; ) {
+	 		pdT[k] += pc[k]*xc;
+      		}
+   	}
+
+   	if (pdCurrW != NULL) {
+      		for (integer k = nrowp; k-- > 0; ) {
+	 		pdT[k] *= pdCurrW[k/nout];
+      		}
+   	}
+
+   	for (integer c = n; c-- > 0; ) {
+      		const doublereal* pc = pdCurrP+ndimp*c;
+      		doublereal d = 0.;
+      		for (integer k = nrowp; k-- > 0; ) {
+	 		d += pc[k]*pdT[k];
+      		}
+      		if (pdCurrR != NULL) {
+	 		d += dCurrLambda*pdCurrR[c/nrhs]*x[c];
+      		}
+      		y[c] = d;
+   	}
+}
+
+/*
+ * fattorizza A = Q*R, lasciando R in pdA; > 0 se i pesi sono negativi
+ * o se A e' mal condizionata
+ */
+integer
+GPC_LAPACK_chol::Factor(void)
+{
+   	bFactored = false;
+
+#ifdef USE_LAPACK
+   	for (integer c = n; c-- > 0; ) {
+      		const doublereal* pc = pdCurrP+ndimp*c;
+      		doublereal* ac = pdA+nrowa*c;
+
+      		for (integer k = nrowp; k-- > 0; ) {
+	 		doublereal w = 1.;
+	 		if (pdCurrW != NULL) {
+	    			w = pdCurrW[k/nout];
+	    			if (w < 0.) {
+	       				return n+1;
+	    			}
+	 		}
+	 		ac[k] = sqrt(w)*pc[k];
+      		}
+
+      		for (integer k = n; k-- > 0; ) {
+	 		ac[nrowp+k] = 0.;
+      		}
+      		if (pdCurrR != NULL) {
+	 		doublereal r = dCurrLambda*pdCurrR[c/nrhs];
+	 		if (r < 0.) {
+	    			return n+1;
+	 		}
+	 		ac[nrowp+c] = sqrt(r);
+      		}
+   	}
+
+   	integer info = 0;
+   	__FC_DECL__(dgeqrf)(&nrowa, &n, pdA, &nrowa, pdTau,
+			    pdWork, &iLWork, &info);
+   	if (info != 0) {
+      		return info;
+   	}
+
+   	/* rcond(R) = rcond(A), stimato in norma 1 */
+   	static char norm = '1';
+   	static char uplo = 'U';
+   	static char diag = 'N';
+   	doublereal dRCond = 0.;
+   	__FC_DECL__(dtrcon)(&norm, &uplo, &diag, &n, pdA, &nrowa, &dRCond,
+			    pdWork, piWork, &info);
+   	if (info != 0) {
+      		return info;
+   	}
+
+   	if (!(dRCond >= dRCondMin)) {
+      		return n+1;
+   	}
+
+   	bFactored = true;
+
+   	return 0;
+#else /* !USE_LAPACK */
+   	return 1;
+#endif /* !USE_LAPACK */
+}
+
+/*
+ * gradiente coniugato precondizionato con il fattore R
+ * di un passo precedente, per la colonna irhs di Z;
+ * false se non converge in iMaxIter iterazioni
+ */
+bool
+GPC_LAPACK_chol::PCG(integer irhs)
+{
+#ifdef USE_LAPACK
+   	static char uplo = 'U';
+   	integer one = 1;
+   	integer info = 0;
+
+   	doublereal* z = pdZ+n*irhs;
+
+   	/* r = e - M*z */
+   	MatVec(z, pdR);
+   	for (integer i = n; i-- > 0; ) {
+      		pdR[i] = -pdR[i];
+   	}
+   	pdR[n-nrhs+irhs] += 1.;
+
+   	doublereal dZNorm2 = 0.;
+   	for (integer i = n; i-- > 0; ) {
+      		dZNorm2 += z[i]*z[i];
+   	}
+
+   	doublereal dRS = 0.;
+   	for (integer iIter = 0; ; iIter++) {
+      		/* s = (R_old^T*R_old)^-1*r, stima della correzione di z */
+      		for (integer i = n; i-- > 0; ) {
+	 		pdS[i] = pdR[i];
+      		}
+      		__FC_DECL__(dpotrs)(&uplo, &n, &one, pdA, &nrowa, pdS, &n, &info);
+      		if (info != 0) {
+	 		return false;
+      		}
+
+      		doublereal dSNorm2 = 0.;
+      		doublereal dRSNew = 0.;
+      		for (integer i = n; i-- > 0; ) {
+	 		dSNorm2 += pdS[i]*pdS[i];
+	 		dRSNew += pdR[i]*pdS[i];
+      		}
+
+      		if (dSNorm2 <= dTol*dTol*dZNorm2) {
+	 		return true;
+      		}
+
+      		if (iIter == iMaxIter) {
+	 		return false;
+      		}
+
+      		if (iIter == 0) {
+	 		for (integer i = n; i-- > 0; ) {
+	    			pdP[i] = pdS[i];
+	 		}
+
+      		} else {
+	 		doublereal dBeta = dRSNew/dRS;
+	 		for (integer i = n; i-- > 0; ) {
+	    			pdP[i] = pdS[i]+dBeta*pdP[i];
+	 		}
+      		}
+      		dRS = dRSNew;
+
+      		/* q = M*p */
+      		MatVec(pdP, pdQ);
+
+      		doublereal dPQ = 0.;
+      		for (integer i = n; i-- > 0; ) {
+	 		dPQ += pdP[i]*pdQ[i];
+      		}
+      		if (!(dPQ > 0.)) {
+	 		/* M non e' (piu') definita positiva */
+	 		return false;
+      		}
+
+      		doublereal dAlpha = dRS/dPQ;
+      		dZNorm2 = 0.;
+      		for (integer i = n; i-- > 0; ) {
+	 		z[i] += dAlpha*pdP[i];
+	 		pdR[i] -= dAlpha*pdQ[i];
+	 		dZNorm2 += z[i]*z[i];
+      		}
+   	}
+#else /* !USE_LAPACK */
+   	return false;
+#endif /* !USE_LAPACK */
+}
+
+integer
+GPC_LAPACK_chol::Solve(integer ndim, const doublereal* P,
+		       const doublereal* W, const doublereal* R,
+		       doublereal dLambda)
+{
+   	ASSERT(ndim >= nrowp);
+   	ASSERT(P != NULL);
+
+   	ndimp = ndim;
+   	pdCurrP = P;
+   	pdCurrW = W;
+   	pdCurrR = R;
+   	dCurrLambda = dLambda;
+
+   	if (bFactored) {
+      		integer irhs;
+      		for (irhs = 0; irhs < nrhs; irhs++) {
+	 		if (!PCG(irhs)) {
+	    			break;
+	 		}
+      		}
+
+      		if (irhs == nrhs) {
+	 		return 0;
+      		}
+   	}
+
+   	if (iSkip > 0) {
+      		iSkip--;
+      		return n+1;
+   	}
+
+   	integer info = Factor();
+   	if (info != 0) {
+      		iSkip = iSkipNext;
+      		iSkipNext = std::min(2*iSkipNext, integer(64));
+      		return info;
+   	}
+   	iSkipNext = 1;
+
+#ifdef USE_LAPACK
+   	/* Z = M^-1*E = R^-1*R^-T*E con la nuova fattorizzazione */
+   	for (integer i = n*nrhs; i-- > 0; ) {
+      		pdZ[i] = 0.;
+   	}
+   	for (integer irhs = nrhs; irhs-- > 0; ) {
+      		pdZ[n*irhs+n-nrhs+irhs] = 1.;
+   	}
+
+   	static char uplo = 'U';
+   	__FC_DECL__(dpotrs)(&uplo, &n, &nrhs, pdA, &nrowa, pdZ, &n, &info);
+   	if (info != 0) {
+      		bFactored = false;
+   	}
+#endif /* USE_LAPACK */
+
+   	return info;
+}
+
+/* GPC_LAPACK_chol - end */
+
+
 /* GPCDesigner - begin */
 
 GPCDesigner::GPCDesigner(integer iNumOut, integer iNumIn, 
@@ -762,7 +1155,8 @@ iDim(iNumOutputs*iPredStep),
 iTmpRows(iNumOutputs*(iPredStep-iPredHor)),
 iTmpCols(iNumInputs*(iContrStep-0)),
 f_armax(f),
-pInv(NULL)
+pInv(NULL),
+pChol(NULL)
 {
 #if !defined(USE_LAPACK)
 #error "need LAPACK for pseudo-inversion"
@@ -776,6 +1170,19 @@ pInv(NULL)
 		break;
 #endif /* USE_LAPACK */
    	}
+
+   	/*
+	 * se P ha almeno tante righe quante colonne, pinv(P) = (P^T*P)^-1*P^T
+	 * e si puo' usare il progetto incrementale; altrimenti, sempre SVD.
+	 * La soglia di condizionamento e' su P, come quella sui valori
+	 * singolari di P in gpc_pinv()
+	 */
+   	if (iTmpRows >= iTmpCols) {
+      		SAFENEWWITHCONSTRUCTOR(pChol,
+				       GPC_LAPACK_chol,
+				       GPC_LAPACK_chol(iTmpCols, iNumInputs,
+					       iTmpRows, iNumOutputs, 1.e-12));
+   	}
    
    	/* note that iPredHor == iContrStep */
      
@@ -810,11 +1217,14 @@ pInv(NULL)
       		pdC = pdmd+iNumInputs*iTmpRows;
       		pdcc = pdC+iDim*(iNumOutputs*iOrderA);
    	}
+
 }
 
 DeadBeat::~DeadBeat(void)
 {
-   	NO_OP;
+   	if (pChol != NULL) {
+      		SAFEDELETE(pChol);
+   	}
 }
 
 void 
@@ -841,24 +1251,40 @@ DeadBeat::DesignControl(const doublereal* pdTheta,
 			   iPredStep, iOrderA, iOrderB,
 			   (doublereal*)pdTheta);
 
-   	/* l'inversore sa come invertire, e mette l'inversa in pdPTmp */
-   	integer info = pInv->Inv(iDim, iTmpRows, iTmpCols, pdPTmp);
+   	/* progetto incrementale: le ultime righe di pinv(P) vanno in md */
+   	integer info = 1;
+   	if (pChol != NULL) {
+      		info = pChol->Solve(iDim, pdPTmp, NULL, NULL, 0.);
+      		if (info == 0) {
+	 		gpc_zt_pt(iTmpCols, iTmpCols, iNumInputs, pChol->pdGetZ(),
+		   		  iDim, iTmpRows, pdPTmp, pdmd);
+
+      		} else {
+	 		pedantic_cerr("DeadBeat::DesignControl(): "
+				"conditioning alarm, using SVD" << std::endl);
+      		}
+   	}
+
+   	if (info != 0) {
+      		/* l'inversore sa come invertire, e mette l'inversa in pdPTmp */
+      		info = pInv->Inv(iDim, iTmpRows, iTmpCols, pdPTmp);
    
-   	if (info < 0) {
-      		silent_cerr("DeadBeat::DesignControl(): illegal value in " 
-			<< -info << "-th argument of dgesvd()" << std::endl);
-      		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-   	} else if (info > 0) {
-      		silent_cerr("DeadBeat::DesignControl(): error in dgesvd()" << std::endl);
-      		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-   	} /* else: OK */
+      		if (info < 0) {
+	 		silent_cerr("DeadBeat::DesignControl(): illegal value in " 
+				<< -info << "-th argument of dgesvd()" << std::endl);
+	 		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+      		} else if (info > 0) {
+	 		silent_cerr("DeadBeat::DesignControl(): error in dgesvd()" << std::endl);
+	 		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+      		} /* else: OK */
      
-   	/* recupero delle matrici (pinv(P) e' organizzata per righe) */
+      		/* recupero delle matrici (pinv(P) e' organizzata per righe) */
 
-   	/* copia le ultime righe dell'inversa di p, che sta in pdPTmp, in md */
-   	doublereal* p = pdPTmp+iTmpRows*(iNumInputs*(iContrStep-1));
-   	for (integer i = iTmpRows*iNumInputs; i-- > 0; ) {
-      		pdmd[i] = p[i];
+      		/* copia le ultime righe dell'inversa di p, che sta in pdPTmp, in md */
+      		doublereal* p = pdPTmp+iTmpRows*(iNumInputs*(iContrStep-1));
+      		for (integer i = iTmpRows*iNumInputs; i-- > 0; ) {
+	 		pdmd[i] = p[i];
+      		}
    	}
 
    	/* anche ac, bc (e cc) vengono organizzate per righe */
@@ -931,7 +1357,8 @@ Weight(pDC),
 pdM(NULL),
 pdInvP(NULL),
 f_armax(f),
-pInv(NULL)
+pInv(NULL),
+pChol(NULL)
 {
    	ASSERT(pW != NULL);
    	ASSERT(pW != NULL);
@@ -954,6 +1381,16 @@ pInv(NULL)
       		silent_cerr("unable to create GPCInv" << std::endl);
       		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
    	}
+
+   	/*
+	 * progetto incrementale; pInv solo in caso di allarme.
+	 * pInv pseudo-inverte M = A^T*A, la cui soglia sui valori singolari
+	 * corrisponde a rcond(A) >= 1e-6
+	 */
+   	SAFENEWWITHCONSTRUCTOR(pChol,
+			       GPC_LAPACK_chol,
+			       GPC_LAPACK_chol(iTmpCols, iNumInputs,
+				       iTmpRows, iNumOutputs, 1.e-6));
    
    	/* note that iPredHor == iContrStep */
      
@@ -996,6 +1433,9 @@ pInv(NULL)
 
 GPC::~GPC(void)
 {
+   	if (pChol != NULL) {
+      		SAFEDELETE(pChol);
+   	}
    	SAFEDELETEARR(pdW);
    	SAFEDELETEARR(pdR);
 }
@@ -1051,7 +1491,8 @@ gpc_mult_t(integer ndiml, integer nrowl, integer ncoll, doublereal* L,
       		doublereal* di = dest+ndimd*i;
       		doublereal* Li = L+ndiml*i;
 		
-      		for (integer j = ncolr; j-- > 0; ) {
+      		/* R e' nrowr x ncolr, quindi dest ha nrowr colonne */
+      		for (integer j = nrowr; j-- > 0; ) {
 	 		doublereal* dij = di+j;
 	 		doublereal* Rj = R+j;
 			
@@ -1096,32 +1537,50 @@ GPC::DesignControl(const doublereal* pdTheta,
 			   iPredStep, iOrderA, iOrderB,
 			   (doublereal*)pdTheta);
    
-   	/* M = P^T*W*P+R */
-   	make_m(iDim, iTmpRows, iTmpCols, pdPTmp,
-	       iNumOutputs, iNumInputs, iPredStep-iPredHor,
-	       pdW, pdR, Weight.dGet(), pdM);
-	       
-   	/* l'inversore sa come invertire, e mette l'inversa in pdM */
-   	integer info = pInv->Inv(iTmpCols, iTmpCols, iTmpCols, pdM);
+   	doublereal dLambda = Weight.dGet();
+
+   	/* le ultime righe di M^-1*P^T (organizzata per righe) */
+   	doublereal* p = pdInvP+iTmpRows*(iNumInputs*(iContrStep-1));
+
+   	/* progetto incrementale: calcola solo le ultime righe, senza M */
+   	integer info = 1;
+   	if (pChol != NULL) {
+      		info = pChol->Solve(iDim, pdPTmp, pdW, pdR, dLambda);
+      		if (info == 0) {
+	 		gpc_zt_pt(iTmpCols, iTmpCols, iNumInputs, pChol->pdGetZ(),
+		   		  iDim, iTmpRows, pdPTmp, p);
+
+      		} else {
+	 		pedantic_cerr("GPC::DesignControl(): "
+				"conditioning alarm, using SVD" << std::endl);
+      		}
+   	}
+
+   	if (info != 0) {
+      		/* M = P^T*W*P+R */
+      		make_m(iDim, iTmpRows, iTmpCols, pdPTmp,
+	     	       iNumOutputs, iNumInputs, iPredStep-iPredHor,
+	     	       pdW, pdR, dLambda, pdM);
+
+      		/* l'inversore sa come invertire, e mette l'inversa in pdM */
+      		info = pInv->Inv(iTmpCols, iTmpCols, iTmpCols, pdM);
    
-   	/* M^-1*P^T */
-   	gpc_mult_t(iTmpCols, iTmpCols, iTmpCols, pdM,
-	      	   iDim, iTmpRows, iTmpCols, pdPTmp, 
-		   iTmpRows, pdInvP);
+      		/* M^-1*P^T */
+      		gpc_mult_t(iTmpCols, iTmpCols, iTmpCols, pdM,
+	      	   	   iDim, iTmpRows, iTmpCols, pdPTmp, 
+		   	   iTmpRows, pdInvP);
    
-   	if (info < 0) {
-      		silent_cerr("GPC::DesignControl(): illegal value in " 
-			<< -info << "-th argument of dgesvd()" << std::endl);
-      		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-   	} else if (info > 0) {
-      		silent_cerr("GPC::DesignControl(): error in dgesvd()" << std::endl);
-      		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
-   	} /* else: OK */
+      		if (info < 0) {
+	 		silent_cerr("GPC::DesignControl(): illegal value in " 
+				<< -info << "-th argument of dgesvd()" << std::endl);
+	 		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+      		} else if (info > 0) {
+	 		silent_cerr("GPC::DesignControl(): error in dgesvd()" << std::endl);
+	 		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+      		} /* else: OK */
+   	}
      
    	/* recupero delle matrici (pinv(P) e' organizzata per righe) */
-
-   	/* copia le ultime righe dell'inversa di p, che sta in pdPTmp, in md */
-   	doublereal* p = pdInvP+iTmpRows*(iNumInputs*(iContrStep-1));
    
 #if 0 /* FIXME: here weight matrices are applied to the pseudo-inverse */
    	for (integer i = iTmpRows*iNumInputs; i-- > 0; ) {
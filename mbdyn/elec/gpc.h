@@ -89,6 +89,101 @@ public:
 /* GPC_LAPACK_pinv - end */
 
 
+/*
+ * risolve M*Z = E, con M = A^T*A, n x n, ed E le ultime nrhs colonne
+ * della matrice identita'; Z contiene quindi le ultime nrhs colonne
+ * (ovvero, per simmetria, righe) di M^-1, le sole che servono per
+ * progettare il controllore.  A e' la matrice dei minimi quadrati:
+ *
+ *	A = [ W^1/2*P        ]
+ *	    [ (lambda*R)^1/2 ]
+ *
+ * con P nrowp x n, W diagonale a blocchi di nout righe ed R diagonale
+ * a blocchi di nrhs colonne; W = NULL vale W = I, R = NULL vale R = 0
+ * (deadbeat: M = P^T*P).
+ *
+ * Nel controllo adattativo P cambia poco da un passo all'altro, perche'
+ * il modello identificato si aggiorna gradualmente: il fattore R di A = Q*R,
+ * che e' anche il fattore di Cholesky di M, viene ricalcolato solo quando
+ * serve, e negli altri passi e' usato come precondizionatore di un
+ * gradiente coniugato che parte dalla soluzione del passo precedente.
+ * M non viene mai costruita: il prodotto M*p = P^T*W*(P*p)+lambda*R*p
+ * costa O(nrowp*n), e la sostituzione con il vecchio fattore O(n^2);
+ * l'O(nrowp*n^2) della fattorizzazione (e della SVD) si paga solo
+ * quando il gradiente coniugato non converge.
+ *
+ * Se la fattorizzazione fallisce o se A e' mal condizionata (allarme
+ * di condizionamento, rcond(A) < dRCondMin, stimato sul fattore R),
+ * Solve() restituisce un valore > 0 ed il chiamante ricorre alla
+ * pseudoinversa calcolata con la SVD; dopo un allarme, la fattorizzazione
+ * non viene ritentata per un numero di passi che raddoppia ad ogni
+ * allarme consecutivo.
+ */
+
+/* GPC_LAPACK_chol - begin */
+
+class GPC_LAPACK_chol {
+protected:
+   	integer n;
+   	integer nrhs;
+   	integer nrowp;		/* righe di P */
+   	integer nout;		/* righe di P con lo stesso peso W */
+   	integer nrowa;		/* righe di A: nrowp+n */
+
+   	integer iMaxIter;	/* iterazioni prima di rifattorizzare */
+   	doublereal dTol;	/* errore relativo stimato su Z */
+   	doublereal dRCondMin;	/* soglia dell'allarme di condizionamento */
+
+   	bool bFactored;
+
+   	integer iSkip;		/* passi da saltare dopo un allarme */
+   	integer iSkipNext;
+
+   	/* il problema del passo corrente, passato a Solve() */
+   	integer ndimp;
+   	const doublereal* pdCurrP;
+   	const doublereal* pdCurrW;
+   	const doublereal* pdCurrR;
+   	doublereal dCurrLambda;
+
+   	integer iLWork;
+
+   	doublereal* pdBase;
+   	doublereal* pdA;	/* A, poi il fattore R nel triangolo superiore */
+   	doublereal* pdTau;	/* riflettori di dgeqrf() */
+   	doublereal* pdZ;	/* soluzione, stima iniziale al passo dopo */
+   	doublereal* pdR;	/* residuo */
+   	doublereal* pdS;	/* residuo precondizionato */
+   	doublereal* pdP;	/* direzione di ricerca */
+   	doublereal* pdQ;	/* M*p */
+   	doublereal* pdT;	/* P*p */
+   	doublereal* pdWork;	/* lavoro per dgeqrf() e dtrcon() */
+   	integer* piWork;
+
+   	void MatVec(const doublereal* x, doublereal* y);
+   	integer Factor(void);
+   	bool PCG(integer irhs);
+
+public:
+   	GPC_LAPACK_chol(integer n, integer nrhs, integer nrowp, integer nout,
+			doublereal dRCondMin);
+   	~GPC_LAPACK_chol(void);
+
+   	integer Solve(integer ndimp, const doublereal* P,
+		      const doublereal* W, const doublereal* R,
+		      doublereal dLambda);
+   	inline const doublereal* pdGetZ(void) const;
+};
+
+inline const doublereal*
+GPC_LAPACK_chol::pdGetZ(void) const
+{
+   	return pdZ;
+}
+
+/* GPC_LAPACK_chol - end */
+
+
 
 /*
  * Progetta le matrici di controllo per un controllore discreto MIMO
@@ -218,6 +313,7 @@ protected:
    	flag f_armax;
 
    	GPCInv* pInv;
+   	GPC_LAPACK_chol* pChol;	/* NULL se P ha piu' colonne che righe */
    
 public:
    	DeadBeat(integer iNumOut, integer iNumIn, integer iOrdA, integer iOrdB,
@@ -257,6 +353,7 @@ protected:
    	flag f_armax;
 
    	GPCInv* pInv;
+   	GPC_LAPACK_chol* pChol;
    
 public:
    	GPC(integer iNumOut, integer iNumIn, integer iOrdA, integer iOrdB,
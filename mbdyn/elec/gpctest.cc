@@ -0,0 +1,251 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Test of the incremental control design of DeadBeat and GPC
+ * (GPC_LAPACK_chol) against the SVD pseudo-inverse, on a slowly
+ * drifting ARX model, as in adaptive control.  With s >= 16 the
+ * deadbeat P of this model is rank deficient, so the conditioning
+ * alarm and the fallback to the SVD are exercised as well.
+ * Prints the maximum relative difference of the designed matrices
+ * and the time spent by each path; exits with 1 if the two paths
+ * disagree.
+ *
+ * usage: gpctest [<s> [<steps>]]
+ *	s:	predictive horizon (default 16; the control horizon is s/2)
+ *	steps:	number of design steps (default 200)
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "myassert.h"
+#include "mynewmem.h"
+#include "clock_time.h"
+#include "gpc.h"
+
+#ifdef USE_DBC
+
+/*
+ * the designers only need the value of the GPC weight drive;
+ * these stubs let the test link against gpc.o alone,
+ * and pDC is never dereferenced
+ */
+static doublereal dLambda = 1.;
+static DriveCaller* const pDC = reinterpret_cast<DriveCaller*>(&dLambda);
+
+DriveOwner::DriveOwner(const DriveCaller* /* pDC */ )
+: pDriveCaller(0)
+{
+	NO_OP;
+}
+
+DriveOwner::~DriveOwner(void)
+{
+	NO_OP;
+}
+
+doublereal
+DriveOwner::dGet(void) const
+{
+	return dLambda;
+}
+
+/* the reference designers always use the SVD */
+class DeadBeatSVD : public DeadBeat {
+public:
+	DeadBeatSVD(integer iNumOut, integer iNumIn,
+		integer iOrdA, integer iOrdB, integer iPredS, integer iContrS)
+	: DeadBeat(iNumOut, iNumIn, iOrdA, iOrdB, iPredS, iContrS, 0., 0)
+	{
+		if (pChol != NULL) {
+			SAFEDELETE(pChol);
+			pChol = NULL;
+		}
+	};
+};
+
+class GPCSVD : public GPC {
+public:
+	GPCSVD(integer iNumOut, integer iNumIn,
+		integer iOrdA, integer iOrdB, integer iPredS, integer iContrS,
+		doublereal* pW, doublereal* pR)
+	: GPC(iNumOut, iNumIn, iOrdA, iOrdB, iPredS, iContrS, iContrS, 0,
+		pW, pR, pDC, 0., 0)
+	{
+		SAFEDELETE(pChol);
+		pChol = NULL;
+	};
+};
+
+/* pesi, distrutti da GPC */
+static doublereal*
+weights(integer n)
+{
+	doublereal* p = NULL;
+	SAFENEWARR(p, doublereal, n);
+	for (integer i = 0; i < n; i++) {
+		p[i] = 1. + .1*i;
+	}
+	return p;
+}
+
+static void
+accum(integer n, const doublereal* d, const doublereal* dref,
+	doublereal& num, doublereal& den)
+{
+	for (integer i = 0; i < n; i++) {
+		num += (d[i] - dref[i])*(d[i] - dref[i]);
+		den += dref[i]*dref[i];
+	}
+}
+
+static const integer nout = 3;
+static const integer nin = 2;
+static const integer pa = 4;
+static const integer pb = 4;
+
+/* runs iSteps designs */
+static bool
+run(integer s, integer iSteps)
+{
+	const integer q = s/2;
+	const integer iRow = nout*(nout*pa + nin*(pb + 1));
+	std::vector<doublereal> theta(nout*iRow);
+
+	srand(3);
+	for (integer i = 0; i < nout*iRow; i++) {
+		theta[i] = (rand()/doublereal(RAND_MAX) - .5)*.2;
+	}
+	for (integer r = 0; r < nout; r++) {
+		/* b_0 dominante */
+		theta[r*iRow + nout*pa + r % nin] += 1.;
+	}
+
+	DeadBeat db(nout, nin, pa, pb, s, q, 0., 0);
+	DeadBeatSVD dbsvd(nout, nin, pa, pb, s, q);
+	GPC gpc(nout, nin, pa, pb, s, q, q, 0,
+		weights(s - q), weights(q), pDC, 0., 0);
+	GPCSVD gpcsvd(nout, nin, pa, pb, s, q, weights(s - q), weights(q));
+
+	doublereal dDBErr = 0., dGPCErr = 0.;
+	doublereal dDBTime = 0., dDBSVDTime = 0.;
+	doublereal dGPCTime = 0., dGPCSVDTime = 0.;
+
+	for (integer iStep = 0; iStep < iSteps; iStep++) {
+		/* il modello identificato cambia poco ad ogni passo */
+		for (integer i = 0; i < nout*iRow; i++) {
+			theta[i] *= 1. + 1.e-4*(rand()/doublereal(RAND_MAX) - .5);
+		}
+
+		doublereal *pac, *pbc, *pmd;
+		doublereal *pacref, *pbcref, *pmdref;
+
+		doublereal t0 = mbdyn_clock_time();
+		db.DesignControl(&theta[0], &pac, &pbc, &pmd);
+		doublereal t1 = mbdyn_clock_time();
+		dbsvd.DesignControl(&theta[0], &pacref, &pbcref, &pmdref);
+		doublereal t2 = mbdyn_clock_time();
+		dDBTime += t1 - t0;
+		dDBSVDTime += t2 - t1;
+
+		doublereal num = 0., den = 0.;
+		accum(nin*nout*(s - q), pmd, pmdref, num, den);
+		accum(nin*nout*pa, pac, pacref, num, den);
+		accum(nin*nin*pb, pbc, pbcref, num, den);
+		dDBErr = std::max(dDBErr, std::sqrt(num/den));
+
+		t0 = mbdyn_clock_time();
+		gpc.DesignControl(&theta[0], &pac, &pbc, &pmd);
+		t1 = mbdyn_clock_time();
+		gpcsvd.DesignControl(&theta[0], &pacref, &pbcref, &pmdref);
+		t2 = mbdyn_clock_time();
+		dGPCTime += t1 - t0;
+		dGPCSVDTime += t2 - t1;
+
+		num = 0.;
+		den = 0.;
+		accum(nin*nout*(s - q), pmd, pmdref, num, den);
+		accum(nin*nout*pa, pac, pacref, num, den);
+		accum(nin*nin*pb, pbc, pbcref, num, den);
+		dGPCErr = std::max(dGPCErr, std::sqrt(num/den));
+	}
+
+	std::cout << "s=" << s << std::endl
+		<< "    DeadBeat: max rel err " << dDBErr
+		<< "; incremental " << dDBTime << "s, SVD " << dDBSVDTime << "s"
+		<< std::endl
+		<< "    GPC:      max rel err " << dGPCErr
+		<< "; incremental " << dGPCTime << "s, SVD " << dGPCSVDTime << "s"
+		<< std::endl;
+
+	return dDBErr < 1.e-6 && dGPCErr < 1.e-6;
+}
+
+int
+main(int argc, char* argv[])
+{
+	integer s = 16;
+	integer iSteps = 200;
+
+	if (argc > 1) {
+		s = atoi(argv[1]);
+		if (s < 2) {
+			std::cerr << "invalid s=" << argv[1] << std::endl;
+			return 1;
+		}
+	}
+
+	if (argc > 2) {
+		iSteps = atoi(argv[2]);
+		if (iSteps < 1) {
+			std::cerr << "invalid steps=" << argv[2] << std::endl;
+			return 1;
+		}
+	}
+
+	return run(s, iSteps) ? 0 : 1;
+}
+
+#else /* !USE_DBC */
+
+int
+main(void)
+{
+	std::cerr << "need USE_DBC for DeadBeat and GPC" << std::endl;
+	return 0;
+}
+
+#endif /* !USE_DBC */
@@ -36,9 +36,11 @@
 
 #include <cerrno>
 #include <fstream>
+#include <memory>
 
 #include "ac/getopt.h"
 #include "task2cpu.h"
+#include "threadpool.h"
 
 extern "C" {
 #include <time.h>
@@ -237,9 +239,10 @@ mbdyn_usage(const char *sShortOpts)
 		<< "  -h, --help                prints this message" << std::endl
 		<< "  -H, --show-table          print symbol table and exit" << std::endl
 		<< "  -l, --license             prints the licensing terms" << std::endl
-		/*
-		<< "  -N, --threads             number of threads (need multithread support)" << std::endl
-		 */
+		<< "  -m, --mmap" << std::endl
+		<< "  -M, --no-mmap             map/don't map input files in memory (default: map)" << std::endl
+		<< "  -N, --threads {auto|<n>}  number of threads shared by assembly" << std::endl
+		<< "                            and linear solvers (need multithread support)" << std::endl
 		);
 #ifdef USE_MPI
 	silent_cout(
@@ -291,7 +294,7 @@ mbdyn_welcome(void)
 }
 
 /* Dati di getopt */
-static char sShortOpts[] = "C:d:eE::f:hHlN:o:pPrRsS:tTvwW:a:";
+static char sShortOpts[] = "C:d:eE::f:hHlmMN:o:pPrRsS:tTvwW:a:";
 
 #ifdef HAVE_GETOPT_LONG
 static struct option LongOpts[] = {
@@ -303,6 +306,8 @@ static struct option LongOpts[] = {
 	{ "help",           no_argument,       NULL,           int('h') },
 	{ "show-table",     no_argument,       NULL,           int('H') },
 	{ "license",        no_argument,       NULL,           int('l') },
+	{ "mmap",           no_argument,       NULL,           int('m') },
+	{ "no-mmap",        no_argument,       NULL,           int('M') },
 	{ "threads",	    required_argument, NULL,	       int('N') },
 	{ "output-file",    required_argument, NULL,           int('o') },
 	{ "parallel",	    no_argument,       NULL,           int('p') },
@@ -484,6 +489,14 @@ mbdyn_parse_arguments(mbdyn_proc_t& mbp, int argc, char *argv[], int& currarg)
 			mbdyn_license();
 			throw NoErr(MBDYN_EXCEPT_ARGS);
 
+		case int('m'):
+			MappedInputStream::Enable(true);
+			break;
+
+		case int('M'):
+			MappedInputStream::Enable(false);
+			break;
+
 		case int('N'):
 			if (strcmp(optarg, "auto") == 0) {
 				mbp.nThreads = 0;
@@ -503,6 +516,9 @@ mbdyn_parse_arguments(mbdyn_proc_t& mbp, int argc, char *argv[], int& currarg)
 
 				mbp.nThreads = unsigned(n);
 			}
+
+			/* size of the thread pool */
+			ThreadPool::SetMaxThreads(mbp.nThreads);
 			break;
 
 		case int('o'):
@@ -931,11 +947,22 @@ mbdyn_program(mbdyn_proc_t& mbp, int argc, char *argv[], int& currarg)
 			std::string sOrigCWD(buf);
 #endif // HAVE_GETCWD && HAVE_CHDIR
 
+			/* il file di ingresso viene mappato in memoria,
+			 * se possibile, prima di cambiare directory */
+			std::unique_ptr<MappedInputStream> pMappedIn;
+			if (mbp.FileStreamIn.is_open() && MappedInputStream::bIsEnabled()) {
+				pMappedIn.reset(new MappedInputStream(mbp.sInputFileName.c_str()));
+				if (!pMappedIn->IsOpen()) {
+					pMappedIn.reset();
+				}
+			}
+
 			std::string sOutputFileName = mbp.sOutputFileName;
 			mbdyn_prepare_files(mbp.sInputFileName, sOutputFileName);
 
 			/* stream in ingresso */
-			InputStream In(*mbp.pIn);
+			InputStream StreamIn(*mbp.pIn);
+			InputStream& In = pMappedIn ? *pMappedIn : StreamIn;
 			MBDynParser HP(*mbp.pMP, In,
 				mbp.sInputFileName == sDefaultInputFileName ? "initial file" : mbp.sInputFileName.c_str());
 
@@ -43,6 +43,35 @@
 #include "beamad.h"
 #include "shapefnc.h"
 
+namespace {
+     // values of the section data computed with sp_grad::SpGradient
+     template <sp_grad::index_type NumRows, sp_grad::index_type NumCols, std::size_t N>
+     std::array<sp_grad::SpMatrixA<doublereal, NumRows, NumCols>, N>
+     GetValues(const std::array<sp_grad::SpMatrixA<sp_grad::SpGradient, NumRows, NumCols>, N>& ATmp)
+     {
+          std::array<sp_grad::SpMatrixA<doublereal, NumRows, NumCols>, N> A;
+
+          for (std::size_t i = 0; i < N; ++i) {
+               A[i] = ATmp[i].GetValue();
+          }
+
+          return A;
+     }
+
+     template <sp_grad::index_type NumRows, std::size_t N>
+     std::array<sp_grad::SpColVectorA<doublereal, NumRows>, N>
+     GetValues(const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, NumRows>, N>& vTmp)
+     {
+          std::array<sp_grad::SpColVectorA<doublereal, NumRows>, N> v;
+
+          for (std::size_t i = 0; i < N; ++i) {
+               v[i] = vTmp[i].GetValue();
+          }
+
+          return v;
+     }
+}
+
 BeamAd::BeamAd(unsigned int uL,
                const StructNodeAd* pN1,
                const StructNodeAd* pN2,
@@ -144,6 +173,24 @@ void BeamAd::UpdateState(const std::array<sp_grad::SpMatrixA<doublereal, 3, 3>,
      }
 }
 
+void BeamAd::UpdateState(const std::array<sp_grad::SpMatrixA<sp_grad::SpGradient, 3, 3>, NUMSEZ>& RTmp,
+                         const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& pTmp,
+                         const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& gTmp,
+                         const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& LTmp,
+                         const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& DefLocTmp,
+                         const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& AzTmp,
+                         const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& AzLocTmp)
+{
+     // AssResJac() takes the residual from this pass
+     UpdateState(GetValues(RTmp),
+                 GetValues(pTmp),
+                 GetValues(gTmp),
+                 GetValues(LTmp),
+                 GetValues(DefLocTmp),
+                 GetValues(AzTmp),
+                 GetValues(AzLocTmp));
+}
+
 template <typename T>
 void
 BeamAd::AssReactionForce(sp_grad::SpGradientAssVec<T>& WorkVec,
@@ -399,6 +446,29 @@ BeamAd::AssRes(SubVectorHandler& WorkVec,
      return WorkVec;
 }
 
+SubVectorHandler&
+BeamAd::AssResJac(SubVectorHandler& WorkVec,
+                  VariableSubMatrixHandler& WorkMat,
+                  VariableSubMatrixHandler*& pJac,
+                  doublereal dCoef,
+                  const VectorHandler& XCurr,
+                  const VectorHandler& XPrimeCurr)
+{
+     DEBUGCOUTFNAME("BeamAd::AssResJac");
+
+     // a single pass with sp_grad::SpGradient; the residual is given by the values
+     sp_grad::SpGradientAssVec<sp_grad::SpGradient>::AssResJac(this,
+                                                               WorkVec,
+                                                               WorkMat.SetSparseGradient(),
+                                                               dCoef,
+                                                               XCurr,
+                                                               XPrimeCurr,
+                                                               sp_grad::SpFunctionCall::REGULAR_JAC);
+     pJac = &WorkMat;
+
+     return WorkVec;
+}
+
 ViscoElasticBeamAd::ViscoElasticBeamAd(unsigned int uL,
                                        const StructNodeAd* pN1,
                                        const StructNodeAd* pN2,
@@ -455,6 +525,33 @@ ViscoElasticBeamAd::UpdateState(const std::array<sp_grad::SpMatrixA<doublereal,
      }
 }
 
+inline void
+ViscoElasticBeamAd::UpdateState(const std::array<sp_grad::SpMatrixA<sp_grad::SpGradient, 3, 3>, NUMSEZ>& RTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& pTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& gTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& gPrimeTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& OmegaTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& LTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& LPrimeTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& DefLocTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& DefPrimeLocTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& AzTmp,
+                                const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& AzLocTmp)
+{
+     // AssResJac() takes the residual from this pass
+     UpdateState(GetValues(RTmp),
+                 GetValues(pTmp),
+                 GetValues(gTmp),
+                 GetValues(gPrimeTmp),
+                 GetValues(OmegaTmp),
+                 GetValues(LTmp),
+                 GetValues(LPrimeTmp),
+                 GetValues(DefLocTmp),
+                 GetValues(DefPrimeLocTmp),
+                 GetValues(AzTmp),
+                 GetValues(AzLocTmp));
+}
+
 template <typename T>
 inline void
 ViscoElasticBeamAd::AssRes(sp_grad::SpGradientAssVec<T>& WorkVec,
@@ -695,6 +792,28 @@ ViscoElasticBeamAd::AssRes(SubVectorHandler& WorkVec,
      return WorkVec;
 }
 
+SubVectorHandler&
+ViscoElasticBeamAd::AssResJac(SubVectorHandler& WorkVec,
+                              VariableSubMatrixHandler& WorkMat,
+                              VariableSubMatrixHandler*& pJac,
+                              doublereal dCoef,
+                              const VectorHandler& XCurr,
+                              const VectorHandler& XPrimeCurr)
+{
+     DEBUGCOUTFNAME("ViscoElasticBeamAd::AssResJac");
+
+     sp_grad::SpGradientAssVec<sp_grad::SpGradient>::AssResJac(this,
+                                                               WorkVec,
+                                                               WorkMat.SetSparseGradient(),
+                                                               dCoef,
+                                                               XCurr,
+                                                               XPrimeCurr,
+                                                               sp_grad::SpFunctionCall::REGULAR_JAC);
+     pJac = &WorkMat;
+
+     return WorkVec;
+}
+
 VariableSubMatrixHandler&
 ViscoElasticBeamAd::AssJac(VariableSubMatrixHandler& WorkMat,
                            doublereal dCoef,
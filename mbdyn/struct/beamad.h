@@ -76,6 +76,14 @@ public:
             const VectorHandler& XCurr,
             const VectorHandler& XPrimeCurr) override;
 
+     virtual SubVectorHandler&
+     AssResJac(SubVectorHandler& WorkVec,
+               VariableSubMatrixHandler& WorkMat,
+               VariableSubMatrixHandler*& pJac,
+               doublereal dCoef,
+               const VectorHandler& XCurr,
+               const VectorHandler& XPrimeCurr) override;
+
      virtual void
      AssJac(VectorHandler& JacY,
             const VectorHandler& Y,
@@ -163,7 +171,7 @@ protected:
                  const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 3>, NUMSEZ>& L,
                  const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& DefLoc,
                  const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& Az,
-                 const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& AzLoc) {}
+                 const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& AzLoc);
 
      inline void
      UpdateState(const std::array<sp_grad::SpMatrixA<sp_grad::GpGradProd, 3, 3>, NUMSEZ>& R,
@@ -211,6 +219,14 @@ public:
             const VectorHandler& XCurr,
             const VectorHandler& XPrimeCurr) override;
 
+     virtual SubVectorHandler&
+     AssResJac(SubVectorHandler& WorkVec,
+               VariableSubMatrixHandler& WorkMat,
+               VariableSubMatrixHandler*& pJac,
+               doublereal dCoef,
+               const VectorHandler& XCurr,
+               const VectorHandler& XPrimeCurr) override;
+
      virtual void
      AssJac(VectorHandler& JacY,
             const VectorHandler& Y,
@@ -271,7 +287,7 @@ protected:
                  const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& DefLoc,
                  const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& DefPrimeLoc,
                  const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& Az,
-                 const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& AzLoc) {}
+                 const std::array<sp_grad::SpColVectorA<sp_grad::SpGradient, 6>, NUMSEZ>& AzLoc);
 
      inline void
      UpdateState(const std::array<sp_grad::SpMatrixA<sp_grad::GpGradProd, 3, 3>, NUMSEZ>& R,
@@ -40,6 +40,7 @@
 #include "constltp.h"
 #include "shapefnc.h"
 #include "beamslider.h"
+#include "checkpoint.h"
 
 
 /* BeamConn - begin */
@@ -946,6 +947,44 @@ BeamSliderJoint::AfterConvergence(const VectorHandler& X,
 	}
 }
 
+void
+BeamSliderJoint::SaveState(CheckpointOut& out) const
+{
+	integer iActiveNode = activeNode;
+	out.Put(iCurrBeam);
+	out.Put(iActiveNode);
+	out.Put(sRef);
+	out.Put(dW[0]);
+	out.Put(dW[1]);
+
+	if (fc) {
+		fc->SaveState(out);
+	}
+}
+
+void
+BeamSliderJoint::RestoreState(CheckpointIn& in)
+{
+	integer iActiveNode;
+	in.Get(iCurrBeam);
+	in.Get(iActiveNode);
+	if (iCurrBeam >= nBeams
+		|| iActiveNode < 0 || iActiveNode > Beam::NUMNODES)
+	{
+		silent_cerr("BeamSliderJoint(" << GetLabel() << "): "
+			"invalid checkpoint state" << std::endl);
+		throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+	}
+	activeNode = iActiveNode;
+	in.Get(sRef);
+	in.Get(dW[0]);
+	in.Get(dW[1]);
+
+	if (fc) {
+		fc->RestoreState(in);
+	}
+}
+
 /* Contributo allo jacobiano durante l'assemblaggio iniziale */
 VariableSubMatrixHandler &
 BeamSliderJoint::InitialAssJac(
@@ -276,6 +276,10 @@ public:
 	virtual void AfterConvergence(const VectorHandler& X,
 		const VectorHandler& XP);
 
+	/* Checkpoint: current beam and friction status */
+	virtual void SaveState(CheckpointOut& out) const;
+	virtual void RestoreState(CheckpointIn& in);
+
 	/* describes the dimension of components of equation */
    virtual std::ostream& DescribeEq(std::ostream& out,
 		  const char *prefix = "",
@@ -35,6 +35,7 @@
 
 #include "Rot.hh"
 #include "brake.h"
+#include "checkpoint.h"
 
 /* Brake - begin */
 
@@ -113,6 +114,20 @@ Brake::AfterConvergence(const VectorHandler& X,
 	fc->AfterConvergence(modF, v, X, XP, iGetFirstIndex() + NumSelfDof);
 }
 
+void
+Brake::SaveState(CheckpointOut& out) const
+{
+	out.Put(dTheta);
+	fc->SaveState(out);
+}
+
+void
+Brake::RestoreState(CheckpointIn& in)
+{
+	in.Get(dTheta);
+	fc->RestoreState(in);
+}
+
 
 /* Contributo al file di restart */
 std::ostream& Brake::Restart(std::ostream& out) const
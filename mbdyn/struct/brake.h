@@ -128,6 +128,10 @@ class Brake : virtual public Elem, public Joint {
    virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+   /* Checkpoint: accumulated angle and friction status */
+   virtual void SaveState(CheckpointOut& out) const;
+   virtual void RestoreState(CheckpointIn& in);
+
    void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = NumDof;
       *piNumCols = NumDof;
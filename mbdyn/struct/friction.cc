@@ -37,6 +37,7 @@
 #include "mbpar.h"
 #include "datamanforward.h"
 #include "friction.h"
+#include "checkpoint.h"
 #include "submat.h"
 
 int sign(const doublereal x) {
@@ -385,6 +386,39 @@ void DiscreteCoulombFriction::AfterConvergence(
 //* 	std::cerr << "CONVERGENZA; v = " << v << "; f = " << f << std::endl;
 };
 
+void DiscreteCoulombFriction::SaveState(CheckpointOut& out) const {
+	unsigned uStatus = status;
+	out.Put(uStatus);
+	out.Put(converged_v);
+	out.Put(saved_sliding_velocity);
+	out.Put(saved_sliding_friction);
+	out.Put(current_friction_force);
+	out.Put(f);
+};
+
+void DiscreteCoulombFriction::RestoreState(CheckpointIn& in) {
+	unsigned uStatus;
+	in.Get(uStatus);
+	if (uStatus > sliding) {
+		silent_cerr("DiscreteCoulombFriction::RestoreState: "
+			"invalid status " << uStatus << std::endl);
+		throw CheckpointIn::ErrCorrupted(MBDYN_EXCEPT_ARGS);
+	}
+	status = status_type(uStatus);
+	in.Get(converged_v);
+	in.Get(saved_sliding_velocity);
+	in.Get(saved_sliding_friction);
+	in.Get(current_friction_force);
+	in.Get(f);
+
+	/* as set by AfterConvergence() */
+	current_velocity = converged_v;
+	previous_switch_v = converged_v;
+	transition_type = null;
+	first_iter = true;
+	first_switch = true;
+};
+
 
 void DiscreteCoulombFriction::AssRes(
 	SubVectorHandler& WorkVec,
@@ -271,6 +271,9 @@ public:
 		const VectorHandler&X, 
 		const VectorHandler&XP,
 		const unsigned int solution_startdof);
+	/* stick/slip status */
+	virtual void SaveState(CheckpointOut& out) const;
+	virtual void RestoreState(CheckpointIn& in);
 	void AssRes(
 		SubVectorHandler& WorkVec,
 		const unsigned int startdof,
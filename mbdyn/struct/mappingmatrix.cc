@@ -0,0 +1,345 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include "myassert.h"
+#include "except.h"
+#include "threadpool.h"
+#include "mappingmatrix.h"
+
+/* minimum work (nonzeros plus rows) per thread */
+static const integer iMinChunkWork = 16384;
+
+static const char sMagic[8] = { 'M', 'B', 'D', 'M', 'A', 'P', '\0', '\0' };
+/* NOTE: increment this each time the binary format changes! */
+static const uint32_t uBinVersion = 1;
+
+static bool
+CoefLess(const MappingMatrix::Coef& a, const MappingMatrix::Coef& b)
+{
+	if (a.iRow != b.iRow) {
+		return a.iRow < b.iRow;
+	}
+
+	return a.iCol < b.iCol;
+}
+
+MappingMatrix::MappingMatrix(integer nRows, integer nCols,
+	std::vector<Coef>& Coefs, unsigned nThreads)
+: m_nRows(nRows),
+m_nCols(nCols),
+m_nThreads(nThreads)
+{
+	/* stable, so that the last of duplicate coefficients can be kept */
+	std::stable_sort(Coefs.begin(), Coefs.end(), CoefLess);
+
+	m_Rp.resize(m_nRows + 1);
+	m_Ri.reserve(Coefs.size());
+	m_Rx.reserve(Coefs.size());
+
+	integer iRow = 0;
+	m_Rp[0] = 0;
+	for (std::vector<Coef>::const_iterator i = Coefs.begin(); i != Coefs.end(); ++i) {
+		ASSERT(i->iRow >= 0 && i->iRow < m_nRows);
+		ASSERT(i->iCol >= 0 && i->iCol < m_nCols);
+
+		std::vector<Coef>::const_iterator next = i + 1;
+		if (next != Coefs.end() && next->iRow == i->iRow && next->iCol == i->iCol) {
+			continue;
+		}
+
+		while (iRow < i->iRow) {
+			m_Rp[++iRow] = m_Ri.size();
+		}
+
+		m_Ri.push_back(i->iCol);
+		m_Rx.push_back(i->dCoef);
+	}
+
+	while (iRow < m_nRows) {
+		m_Rp[++iRow] = m_Ri.size();
+	}
+
+	MakeCSC();
+	MakeChunks();
+}
+
+MappingMatrix::MappingMatrix(const char *sFileName, unsigned nThreads)
+: m_nRows(0),
+m_nCols(0),
+m_nThreads(nThreads)
+{
+	std::ifstream in(sFileName, std::ios::binary);
+	if (!in) {
+		silent_cerr("MappingMatrix: unable to open binary mapping file "
+			"\"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	char magic[sizeof(sMagic)];
+	uint32_t uVersion, uIntSize, uRealSize;
+	in.read(magic, sizeof(magic));
+	in.read((char *)&uVersion, sizeof(uVersion));
+	in.read((char *)&uIntSize, sizeof(uIntSize));
+	in.read((char *)&uRealSize, sizeof(uRealSize));
+	if (!in || std::memcmp(magic, sMagic, sizeof(sMagic)) != 0) {
+		silent_cerr("MappingMatrix: \"" << sFileName << "\" "
+			"is not a binary mapping file" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	if (uVersion != uBinVersion
+		|| uIntSize != sizeof(integer)
+		|| uRealSize != sizeof(doublereal))
+	{
+		silent_cerr("MappingMatrix: binary mapping file "
+			"\"" << sFileName << "\" has version " << uVersion
+			<< ", integer size " << uIntSize
+			<< " and real size " << uRealSize
+			<< "; expected " << uBinVersion
+			<< ", " << sizeof(integer)
+			<< " and " << sizeof(doublereal)
+			<< " (re-create it from the text mapping file)" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	integer nz;
+	in.read((char *)&m_nRows, sizeof(m_nRows));
+	in.read((char *)&m_nCols, sizeof(m_nCols));
+	in.read((char *)&nz, sizeof(nz));
+	if (!in || m_nRows <= 0 || m_nCols <= 0 || nz < 0) {
+		silent_cerr("MappingMatrix: invalid header in binary mapping file "
+			"\"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	m_Rp.resize(m_nRows + 1);
+	m_Ri.resize(nz);
+	m_Rx.resize(nz);
+	in.read((char *)&m_Rp[0], sizeof(integer)*m_Rp.size());
+	if (nz > 0) {
+		in.read((char *)&m_Ri[0], sizeof(integer)*m_Ri.size());
+		in.read((char *)&m_Rx[0], sizeof(doublereal)*m_Rx.size());
+	}
+	if (!in) {
+		silent_cerr("MappingMatrix: premature end of binary mapping file "
+			"\"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	/* a corrupted file must not crash the products */
+	bool bOK = (m_Rp[0] == 0 && m_Rp[m_nRows] == nz);
+	for (integer r = 0; bOK && r < m_nRows; r++) {
+		bOK = (m_Rp[r] <= m_Rp[r + 1]);
+	}
+	for (integer k = 0; bOK && k < nz; k++) {
+		bOK = (m_Ri[k] >= 0 && m_Ri[k] < m_nCols);
+	}
+	if (!bOK) {
+		silent_cerr("MappingMatrix: inconsistent indices in binary mapping file "
+			"\"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	MakeCSC();
+	MakeChunks();
+}
+
+MappingMatrix::~MappingMatrix(void)
+{
+	NO_OP;
+}
+
+void
+MappingMatrix::Save(const char *sFileName) const
+{
+	std::ofstream out(sFileName, std::ios::binary | std::ios::trunc);
+	if (!out) {
+		silent_cerr("MappingMatrix: unable to create binary mapping file "
+			"\"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	uint32_t uIntSize = sizeof(integer), uRealSize = sizeof(doublereal);
+	integer nz = Nz();
+	out.write(sMagic, sizeof(sMagic));
+	out.write((const char *)&uBinVersion, sizeof(uBinVersion));
+	out.write((const char *)&uIntSize, sizeof(uIntSize));
+	out.write((const char *)&uRealSize, sizeof(uRealSize));
+	out.write((const char *)&m_nRows, sizeof(m_nRows));
+	out.write((const char *)&m_nCols, sizeof(m_nCols));
+	out.write((const char *)&nz, sizeof(nz));
+	out.write((const char *)&m_Rp[0], sizeof(integer)*m_Rp.size());
+	if (nz > 0) {
+		out.write((const char *)&m_Ri[0], sizeof(integer)*m_Ri.size());
+		out.write((const char *)&m_Rx[0], sizeof(doublereal)*m_Rx.size());
+	}
+
+	out.close();
+	if (!out) {
+		silent_cerr("MappingMatrix: unable to write binary mapping file "
+			"\"" << sFileName << "\"" << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+}
+
+void
+MappingMatrix::MakeCSC(void)
+{
+	integer nz = Nz();
+
+	m_Cp.assign(m_nCols + 1, 0);
+	m_Ci.resize(nz);
+	m_Cx.resize(nz);
+
+	for (integer k = 0; k < nz; k++) {
+		m_Cp[m_Ri[k] + 1]++;
+	}
+
+	for (integer c = 0; c < m_nCols; c++) {
+		m_Cp[c + 1] += m_Cp[c];
+	}
+
+	/* rows are visited in increasing order, so row indices
+	 * are sorted within each column */
+	std::vector<integer> next(m_Cp.begin(), m_Cp.end() - 1);
+	for (integer r = 0; r < m_nRows; r++) {
+		for (integer k = m_Rp[r]; k < m_Rp[r + 1]; k++) {
+			integer p = next[m_Ri[k]]++;
+			m_Ci[p] = r;
+			m_Cx[p] = m_Rx[k];
+		}
+	}
+}
+
+void
+MappingMatrix::Partition(const std::vector<integer>& Ap, integer n,
+	unsigned nChunks, std::vector<integer>& Chunks)
+{
+	/* the cost of a row is its number of nonzeros plus one */
+	integer iWork = Ap[n] + n;
+	integer nMax = std::max(integer(1), iWork/iMinChunkWork);
+	if (integer(nChunks) > nMax) {
+		nChunks = unsigned(nMax);
+	}
+
+	Chunks.resize(nChunks + 1);
+	Chunks[0] = 0;
+	integer i = 0;
+	for (unsigned t = 1; t < nChunks; t++) {
+		integer iTarget = (iWork/nChunks)*t;
+		while (i < n && Ap[i] + i < iTarget) {
+			i++;
+		}
+		Chunks[t] = i;
+	}
+	Chunks[nChunks] = n;
+}
+
+void
+MappingMatrix::MakeChunks(void)
+{
+	if (m_nThreads < 1) {
+		m_nThreads = 1;
+	}
+
+	Partition(m_Rp, m_nRows, m_nThreads, m_RowChunks);
+	Partition(m_Cp, m_nCols, m_nThreads, m_ColChunks);
+}
+
+void
+MappingMatrix::SetThreads(unsigned nThreads)
+{
+	m_nThreads = nThreads;
+	MakeChunks();
+}
+
+/* y[first:last] = A[first:last, :] * x, A in compressed form */
+static void
+CompressedMul(const integer *Ap, const integer *Ai, const doublereal *Ax,
+	integer first, integer last, const doublereal *x, doublereal *y)
+{
+	for (integer i = first; i < last; i++) {
+		doublereal d = 0.;
+		for (integer k = Ap[i]; k < Ap[i + 1]; k++) {
+			d += Ax[k]*x[Ai[k]];
+		}
+		y[i] = d;
+	}
+}
+
+static void
+CompressedMulChunks(const std::vector<integer>& Ap, const std::vector<integer>& Ai,
+	const std::vector<doublereal>& Ax, const std::vector<integer>& Chunks,
+	const doublereal *x, doublereal *y)
+{
+	unsigned nChunks = Chunks.size() - 1;
+	const integer *pAp = &Ap[0];
+	const integer *pAi = Ai.empty() ? 0 : &Ai[0];
+	const doublereal *pAx = Ax.empty() ? 0 : &Ax[0];
+
+	/* the chunks write disjoint parts of y */
+	ThreadPool::Get().ParallelFor(nChunks, [&](unsigned t) {
+		CompressedMul(pAp, pAi, pAx, Chunks[t], Chunks[t + 1], x, y);
+	});
+}
+
+VectorHandler&
+MappingMatrix::MatVecMul(VectorHandler& out, const VectorHandler& in) const
+{
+	if (in.iGetSize() != m_nCols || out.iGetSize() != m_nRows) {
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	CompressedMulChunks(m_Rp, m_Ri, m_Rx, m_RowChunks, in.pdGetVec(), out.pdGetVec());
+
+	return out;
+}
+
+VectorHandler&
+MappingMatrix::MatTVecMul(VectorHandler& out, const VectorHandler& in) const
+{
+	if (in.iGetSize() != m_nRows || out.iGetSize() != m_nCols) {
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	CompressedMulChunks(m_Cp, m_Ci, m_Cx, m_ColChunks, in.pdGetVec(), out.pdGetVec());
+
+	return out;
+}
+
+/* MappingMatrix - end */
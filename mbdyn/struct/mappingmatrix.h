@@ -0,0 +1,115 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MAPPINGMATRIX_H
+#define MAPPINGMATRIX_H
+
+#include <vector>
+
+#include "vh.h"
+
+/* MappingMatrix - begin */
+
+/*
+ * Read-only sparse operator used by the mapping external forces.
+ * Coefficients are stored twice, in compressed row (CSR) form for
+ * the product with the matrix and in compressed column (CSC) form
+ * for the product with its transpose, so that both only gather
+ * from the input vector; rows (columns) can then be split among
+ * threads, each one writing a disjoint chunk of the output vector.
+ * Within each row (column) the summation order is the same
+ * of SpMapMatrixHandler, so results do not depend on the number
+ * of threads.
+ */
+
+class MappingMatrix {
+protected:
+	integer m_nRows;
+	integer m_nCols;
+
+	/* CSR, 0-based */
+	std::vector<integer> m_Rp;
+	std::vector<integer> m_Ri;
+	std::vector<doublereal> m_Rx;
+
+	/* CSC, 0-based */
+	std::vector<integer> m_Cp;
+	std::vector<integer> m_Ci;
+	std::vector<doublereal> m_Cx;
+
+	/* thread partitions: first row/col of each chunk (size nThreads + 1) */
+	unsigned m_nThreads;
+	std::vector<integer> m_RowChunks;
+	std::vector<integer> m_ColChunks;
+
+	void MakeCSC(void);
+	void MakeChunks(void);
+
+	static void
+	Partition(const std::vector<integer>& Ap, integer n,
+		unsigned nChunks, std::vector<integer>& Chunks);
+
+public:
+	/* coefficient triplet, 0-based */
+	struct Coef {
+		integer iRow;
+		integer iCol;
+		doublereal dCoef;
+	};
+
+	/* builds the operator from triplets; in case of duplicates,
+	 * the last coefficient wins (as with SpMapMatrixHandler) */
+	MappingMatrix(integer nRows, integer nCols, std::vector<Coef>& Coefs,
+		unsigned nThreads = 1);
+
+	/* loads the operator from a binary file written by Save() */
+	MappingMatrix(const char *sFileName, unsigned nThreads = 1);
+
+	~MappingMatrix(void);
+
+	void Save(const char *sFileName) const;
+
+	void SetThreads(unsigned nThreads);
+
+	integer iGetNumRows(void) const { return m_nRows; };
+	integer iGetNumCols(void) const { return m_nCols; };
+	integer Nz(void) const { return m_Rp[m_nRows]; };
+
+	/* out = M * in */
+	VectorHandler& MatVecMul(VectorHandler& out, const VectorHandler& in) const;
+
+	/* out = M^T * in */
+	VectorHandler& MatTVecMul(VectorHandler& out, const VectorHandler& in) const;
+};
+
+/* MappingMatrix - end */
+
+#endif // MAPPINGMATRIX_H
@@ -198,6 +198,7 @@ Inv5jaj(NModes, 0.),
 Inv5jaPj(NModes, 0.),
 Inv9jkajak(::Zero3x3),
 Inv9jkajaPk(::Eye3),
+InvContr(NModes, this->oInv5, this->oInv9),
 a(aa), a0(aa),
 aPrime(NModes, 0.), aPrime0(bb),
 b(bb),
@@ -985,33 +986,29 @@ Modal::AssRes(SubVectorHandler& WorkVec,
 		Inv8jaj.Reset();
 		Inv8jaPj.Reset();
 	}
+
+	/* the O(NModes^2) contractions of Inv5 and Inv9
+	 * are performed on the packed invariants (see modalinv.h) */
 	if (oInv5.iGetNumCols()) {
-		Inv5jaj.Reset(0.);
-		Inv5jaPj.Reset(0.);
+		InvContr.Inv5(a, b, Inv5jaj, Inv5jaPj);
 	}
 
-	// Mat3x3 MatTmp1(::Zero3x3), MatTmp2(::Zero3x3);
-
-	if (oInv9.iGetNumCols()) {
-		Inv9jkajak.Reset();
-		Inv9jkajaPk.Reset();
+	if (oInv8.iGetNumCols() && oInv9.iGetNumCols()) {
+		/*
+		 * questi termini si possono commentare perche' sono
+		 * (sempre ?) piccoli (termini del tipo a*a o a*b)
+		 * eventualmente dare all'utente la possibilita'
+		 * di scegliere se trascurarli o no
+		 */
+		InvContr.Inv9(a, b, Inv9jkajak, Inv9jkajaPk);
 	}
 	Mat3x3 Inv10jaPj(::Zero3x3);
 
-	if (oInv5.iGetNumCols() || oInv8.iGetNumCols() || oInv9.iGetNumCols() || oInv10.iGetNumCols()) {
+	if (oInv8.iGetNumCols() || oInv10.iGetNumCols()) {
 		for (unsigned int jMode = 1; jMode <= NModes; jMode++)  {
 			doublereal a_jMode = a(jMode);
 			doublereal aP_jMode = b(jMode);
 
-			if (oInv5.iGetNumCols()) {
-				for (unsigned int kMode = 1; kMode <= NModes; kMode++) {
-					Vec3 v = oInv5.GetVec((jMode - 1)*NModes + kMode);
-
-					Inv5jaj.AddVec(kMode, v*a_jMode);
-					Inv5jaPj.AddVec(kMode, v*aP_jMode);
-				}
-			}
-
 			if (oInv8.iGetNumCols()) {
 				Mat3x3 Inv8jajTmp;
 
@@ -1023,22 +1020,6 @@ Modal::AssRes(SubVectorHandler& WorkVec,
 
 				Inv8jaj += Inv8jajTmp * a_jMode;
 				Inv8jaPj += Inv8jajTmp * aP_jMode;
-
-				if (oInv9.iGetNumCols()) {
-					/*
-					 * questi termini si possono commentare perche' sono
-					 * (sempre ?) piccoli (termini del tipo a*a o a*b)
-					 * eventualmente dare all'utente la possibilita'
-					 * di scegliere se trascurarli o no
-					 */
-					for (unsigned int kMode = 1; kMode <= NModes; kMode++) {
-						doublereal a_kMode = a(kMode);
-						doublereal aP_kMode = b(kMode);
-						unsigned int iOffset = (jMode - 1)*3*NModes + (kMode - 1)*3 + 1;
-						Inv9jkajak += oInv9.GetMat3x3ScalarMult(iOffset, a_jMode*a_kMode);
-						Inv9jkajaPk += oInv9.GetMat3x3ScalarMult(iOffset, a_jMode*aP_kMode);
-					}
-				}
 			}
 
 			if (oInv10.iGetNumCols()) {
@@ -1200,12 +1181,7 @@ Modal::AssRes(SubVectorHandler& WorkVec,
 			if (oInv8.iGetNumCols()) {
 				MTmp += oInv8.GetMat3x3(jOffset).Transpose();
 				if (oInv9.iGetNumCols()) {
-					for (unsigned int kModem1 = 0; kModem1 < NModes; kModem1++) {
-						doublereal a_kMode = a(kModem1 + 1);
-						integer kOffset = (jMode - 1)*3*NModes + kModem1*3 + 1;
-
-						MTmp -= oInv9.GetMat3x3ScalarMult(kOffset, a_kMode);
-					}
+					MTmp -= InvContr.GetInv9jkak(jMode);
 				}
 			}
 
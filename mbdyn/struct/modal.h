@@ -49,6 +49,7 @@
 #include <array>
 #include <fstream>
 #include <joint.h>
+#include "modalinv.h"
 
 #if 0
 #define MODAL_USE_INV9
@@ -117,6 +118,9 @@ protected:
      
 	Mat3x3 Inv9jkajak;
 	Mat3x3 Inv9jkajaPk;
+
+	/* Inv5 and Inv9 repacked for the contractions with a and b */
+	ModalInvContraction InvContr;
      
 	VecN a, a0;
 	VecN aPrime, aPrime0;
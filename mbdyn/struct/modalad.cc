@@ -218,6 +218,29 @@ ModalAd::AssRes(SubVectorHandler& WorkVec,
      return WorkVec;
 }
 
+SubVectorHandler&
+ModalAd::AssResJac(SubVectorHandler& WorkVec,
+                   VariableSubMatrixHandler& WorkMat,
+                   VariableSubMatrixHandler*& pJac,
+                   doublereal dCoef,
+                   const VectorHandler& XCurr,
+                   const VectorHandler& XPrimeCurr)
+{
+     DEBUGCOUT("Entering ModalAd::AssResJac()" << std::endl);
+
+     // a single pass with sp_grad::SpGradient; the residual is given by the values
+     sp_grad::SpGradientAssVec<sp_grad::SpGradient>::AssResJac(this,
+                                                               WorkVec,
+                                                               WorkMat.SetSparseGradient(),
+                                                               dCoef,
+                                                               XCurr,
+                                                               XPrimeCurr,
+                                                               sp_grad::SpFunctionCall::REGULAR_JAC);
+     pJac = &WorkMat;
+
+     return WorkVec;
+}
+
 void
 ModalAd::UpdateStrNodeData(ModalAd::StrNodeData& oNode,
                            const sp_grad::SpColVector<doublereal, 3>& d1tot,
@@ -308,6 +331,68 @@ ModalAd::UpdateInvariants(const sp_grad::SpColVector<doublereal, 3>& Inv3jajTmp,
      }
 }
 
+// AssResJac() takes the residual from the sp_grad::SpGradient pass
+void
+ModalAd::UpdateStrNodeData(ModalAd::StrNodeData& oNode,
+                           const sp_grad::SpColVector<sp_grad::SpGradient, 3>& d1tot,
+                           const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& R1tot,
+                           const sp_grad::SpColVector<sp_grad::SpGradient, 3>& F,
+                           const sp_grad::SpColVector<sp_grad::SpGradient, 3>& M,
+                           const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& R2)
+{
+     using namespace sp_grad;
+
+     const SpColVector<doublereal, 3> d1totTmp(d1tot.GetValue());
+     const SpMatrix<doublereal, 3, 3> R1totTmp(R1tot.GetValue());
+     const SpColVector<doublereal, 3> FTmp(F.GetValue());
+     const SpColVector<doublereal, 3> MTmp(M.GetValue());
+     const SpMatrix<doublereal, 3, 3> R2Tmp(R2.GetValue());
+
+     UpdateStrNodeData(oNode, d1totTmp, R1totTmp, FTmp, MTmp, R2Tmp);
+}
+
+void
+ModalAd::UpdateModalNode(const sp_grad::SpColVector<sp_grad::SpGradient, 3>& x,
+                         const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& R)
+{
+     using namespace sp_grad;
+
+     const SpColVector<doublereal, 3> xTmp(x.GetValue());
+     const SpMatrix<doublereal, 3, 3> RTmp(R.GetValue());
+
+     UpdateModalNode(xTmp, RTmp);
+}
+
+void
+ModalAd::UpdateState(const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>& a,
+                     const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>& aPrime,
+                     const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>& b,
+                     const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>& bPrime)
+{
+     using namespace sp_grad;
+
+     const SpColVector<doublereal, SpMatrixSize::DYNAMIC> aTmp(a.GetValue());
+     const SpColVector<doublereal, SpMatrixSize::DYNAMIC> aPrimeTmp(aPrime.GetValue());
+     const SpColVector<doublereal, SpMatrixSize::DYNAMIC> bTmp(b.GetValue());
+     const SpColVector<doublereal, SpMatrixSize::DYNAMIC> bPrimeTmp(bPrime.GetValue());
+
+     UpdateState(aTmp, aPrimeTmp, bTmp, bPrimeTmp);
+}
+
+void
+ModalAd::UpdateInvariants(const sp_grad::SpColVector<sp_grad::SpGradient, 3>& Inv3jaj,
+                          const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& Inv8jaj,
+                          const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& Inv9jkajak)
+{
+     using namespace sp_grad;
+
+     const SpColVector<doublereal, 3> Inv3jajTmp(Inv3jaj.GetValue());
+     const SpMatrix<doublereal, 3, 3> Inv8jajTmp(Inv8jaj.GetValue());
+     const SpMatrix<doublereal, 3, 3> Inv9jkajakTmp(Inv9jkajak.GetValue());
+
+     UpdateInvariants(Inv3jajTmp, Inv8jajTmp, Inv9jkajakTmp);
+}
+
 #ifdef DEBUG
 #define DEBUG_DUMP_GRAD_VEC_SIZE(varname, tplname)                      \
      if (std::is_same<sp_grad::SpGradient, tplname>::value) {           \
@@ -93,6 +93,14 @@ public:
             const VectorHandler& XCurr,
             const VectorHandler& XPrimeCurr) override;
 
+     virtual SubVectorHandler&
+     AssResJac(SubVectorHandler& WorkVec,
+               VariableSubMatrixHandler& WorkMat,
+               VariableSubMatrixHandler*& pJac,
+               doublereal dCoef,
+               const VectorHandler& XCurr,
+               const VectorHandler& XPrimeCurr) override;
+
      virtual void
      AssJac(VectorHandler& JacY,
             const VectorHandler& Y,
@@ -149,7 +157,7 @@ private:
                        const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& R1tot,
                        const sp_grad::SpColVector<sp_grad::SpGradient, 3>& F,
                        const sp_grad::SpColVector<sp_grad::SpGradient, 3>& M,
-                       const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& R2) {}
+                       const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& R2);
 
      inline void
      UpdateStrNodeData(StrNodeData& oNode,
@@ -165,7 +173,7 @@ private:
 
      inline void
      UpdateModalNode(const sp_grad::SpColVector<sp_grad::SpGradient, 3>& x,
-                     const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& R) {}
+                     const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& R);
 
      inline void
      UpdateModalNode(const sp_grad::SpColVector<sp_grad::GpGradProd, 3>& x,
@@ -178,10 +186,10 @@ private:
                  const sp_grad::SpColVector<doublereal, sp_grad::SpMatrixSize::DYNAMIC>& bP);
 
      inline void
-     UpdateState(const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>&,
-                 const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>&,
-                 const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>&,
-                 const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>&) { }
+     UpdateState(const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>& a,
+                 const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>& aP,
+                 const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>& b,
+                 const sp_grad::SpColVector<sp_grad::SpGradient, sp_grad::SpMatrixSize::DYNAMIC>& bP);
 
      inline void
      UpdateState(const sp_grad::SpColVector<sp_grad::GpGradProd, sp_grad::SpMatrixSize::DYNAMIC>&,
@@ -197,7 +205,7 @@ private:
      inline void
      UpdateInvariants(const sp_grad::SpColVector<sp_grad::SpGradient, 3>& Inv3jaj,
                       const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& Inv8jaj,
-                      const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& Inv9jkajak) {}
+                      const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& Inv9jkajak);
 
      inline void
      UpdateInvariants(const sp_grad::SpColVector<sp_grad::GpGradProd, 3>& Inv3jaj,
@@ -92,8 +92,7 @@ ExtModalForce::Prepare(ExtFileHandlerBase *pEFH, unsigned uLabel, bool bRigid, u
 
 			uint32_ptr[1] = uModes;
 
-			ssize_t rc = sendn(pEFH->GetOutFileDes(),
-				(const char *)buf, sizeof(buf),
+			ssize_t rc = pEFH->SendN((const char *)buf, sizeof(buf),
 				pEFH->GetSendFlags());
 			if (rc == -1) {
 				int save_errno = WSAGetLastError();
@@ -132,8 +131,7 @@ ExtModalForce::Prepare(ExtFileHandlerBase *pEFH, unsigned uLabel, bool bRigid, u
 			char buf[sizeof(uint32_t) + sizeof(uint32_t)];
 			uint32_t *uint32_ptr;
 
-			ssize_t rc = recvn(pEFH->GetInFileDes(),
-				buf, sizeof(buf),
+			ssize_t rc = pEFH->RecvN(buf, sizeof(buf),
 				pEFH->GetRecvFlags());
 			if (rc == -1) {
 				int save_errno = WSAGetLastError();
@@ -201,7 +199,7 @@ ExtModalForce::Recv(ExtFileHandlerBase *pEFH, unsigned uFlags, unsigned& uLabel,
 		return RecvFromStream(*infp, uFlags, uLabel, f, m, fv);
 
 	} else {
-		return RecvFromFileDes(pEFH->GetInFileDes(), pEFH->GetRecvFlags(),
+		return RecvFromFileDes(pEFH, pEFH->GetRecvFlags(),
 			uFlags, uLabel, f, m, fv);
 	}
 }
@@ -217,7 +215,7 @@ ExtModalForce::Send(ExtFileHandlerBase *pEFH, unsigned uFlags, unsigned uLabel,
 		return SendToStream(*outfp, uFlags, uLabel, x, R, v, w, q, qP);
 
 	} else {
-		return SendToFileDes(pEFH->GetOutFileDes(), pEFH->GetSendFlags(),
+		return SendToFileDes(pEFH, pEFH->GetSendFlags(),
 			uFlags, uLabel, x, R, v, w, q, qP);
 	}
 }
@@ -247,7 +245,7 @@ ExtModalForce::RecvFromStream(std::istream& inf, unsigned uFlags, unsigned& uLab
 }
 
 unsigned
-ExtModalForce::RecvFromFileDes(int infd, int recv_flags,
+ExtModalForce::RecvFromFileDes(ExtFileHandlerBase *pEFH, int recv_flags,
 	unsigned uFlags, unsigned& uLabel,
 	Vec3& f, Vec3& m, std::vector<doublereal>& fv)
 {
@@ -258,11 +256,11 @@ ExtModalForce::RecvFromFileDes(int infd, int recv_flags,
 	if ((uFlags & ExtModalForceBase::EMF_RIGID)) {
 		size = 3*sizeof(doublereal);
 
-		rc = recvn(infd, (char*)f.pGetVec(), size, recv_flags);
+		rc = pEFH->RecvN((char*)f.pGetVec(), size, recv_flags);
 		if (rc != (ssize_t)size) {
 			// error
 		}
-		rc = recvn(infd, (char*)m.pGetVec(), size, recv_flags);
+		rc = pEFH->RecvN((char*)m.pGetVec(), size, recv_flags);
 		if (rc != (ssize_t)size) {
 			// error
 		}
@@ -270,7 +268,7 @@ ExtModalForce::RecvFromFileDes(int infd, int recv_flags,
 
 	if ((uFlags & ExtModalForceBase::EMF_MODAL)) {
 		size = fv.size()*sizeof(doublereal);
-		rc = recvn(infd, (char*)&fv[0], size, recv_flags);
+		rc = pEFH->RecvN((char*)&fv[0], size, recv_flags);
 		if (rc != (ssize_t)size) {
 			// error
 		}
@@ -304,7 +302,7 @@ ExtModalForce::SendToStream(std::ostream& outf, unsigned uFlags, unsigned uLabel
 }
 
 void
-ExtModalForce::SendToFileDes(int outfd, int send_flags,
+ExtModalForce::SendToFileDes(ExtFileHandlerBase *pEFH, int send_flags,
 	unsigned uFlags, unsigned uLabel,
 	const Vec3& x, const Mat3x3& R, const Vec3& v, const Vec3& w,
 	const std::vector<doublereal>& q,
@@ -312,15 +310,15 @@ ExtModalForce::SendToFileDes(int outfd, int send_flags,
 {
 #ifdef USE_SOCKET
 	if ((uFlags & ExtModalForceBase::EMF_RIGID)) {
-		sendn(outfd, (const char*)x.pGetVec(), 3*sizeof(doublereal), send_flags);
-		sendn(outfd, (const char*)R.pGetMat(), 9*sizeof(doublereal), send_flags);
-		sendn(outfd, (const char*)v.pGetVec(), 3*sizeof(doublereal), send_flags);
-		sendn(outfd, (const char*)w.pGetVec(), 3*sizeof(doublereal), send_flags);
+		pEFH->SendN((const char*)x.pGetVec(), 3*sizeof(doublereal), send_flags);
+		pEFH->SendN((const char*)R.pGetMat(), 9*sizeof(doublereal), send_flags);
+		pEFH->SendN((const char*)v.pGetVec(), 3*sizeof(doublereal), send_flags);
+		pEFH->SendN((const char*)w.pGetVec(), 3*sizeof(doublereal), send_flags);
 	}
 
 	if ((uFlags & ExtModalForceBase::EMF_MODAL)) {
-		sendn(outfd, (const char*)&q[0], q.size()*sizeof(doublereal), send_flags);
-		sendn(outfd, (const char*)&qP[0], qP.size()*sizeof(doublereal), send_flags);
+		pEFH->SendN((const char*)&q[0], q.size()*sizeof(doublereal), send_flags);
+		pEFH->SendN((const char*)&qP[0], qP.size()*sizeof(doublereal), send_flags);
 	}
 #else // ! USE_SOCKET
 	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
@@ -122,7 +122,7 @@ protected:
 	RecvFromStream(std::istream& inf, unsigned uFlags, unsigned& uLabel,
 		Vec3& f, Vec3& m, std::vector<doublereal>& fv);
 	virtual unsigned
-	RecvFromFileDes(int infd, int recv_flags, unsigned uFlags, unsigned& uLabel,
+	RecvFromFileDes(ExtFileHandlerBase *pEFH, int recv_flags, unsigned uFlags, unsigned& uLabel,
 		Vec3& f, Vec3& m, std::vector<doublereal>& fv);
 
 	virtual void
@@ -131,7 +131,7 @@ protected:
 		const std::vector<doublereal>& q,
 		const std::vector<doublereal>& qP);
 	virtual void
-	SendToFileDes(int outfd, int send_flags, unsigned uFlags, unsigned uLabel,
+	SendToFileDes(ExtFileHandlerBase *pEFH, int send_flags, unsigned uFlags, unsigned uLabel,
 		const Vec3& x, const Mat3x3& R, const Vec3& v, const Vec3& w,
 		const std::vector<doublereal>& q,
 		const std::vector<doublereal>& qP);
@@ -0,0 +1,173 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <algorithm>
+
+#include "ac/lapack.h"
+#include "modalinv.h"
+
+/*
+ * C = A*B, with A (m x k), B (k x n) and C (m x n) stored column-major
+ */
+static void
+ModalGemm(integer m, integer n, integer k,
+	const doublereal *pA, const doublereal *pB, doublereal *pC)
+{
+#if defined HAVE_BLAS
+#if defined HAVE_CBLAS
+	cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans,
+		m, n, k, 1., pA, m, pB, k, 0., pC, m);
+#else /* HAVE_BLAS && !HAVE_CBLAS */
+	const doublereal dOne = 1., dZero = 0.;
+	__FC_DECL__(dgemm)("N", "N", &m, &n, &k,
+		&dOne, pA, &m, pB, &k, &dZero, pC, &m);
+#endif /* !HAVE_CBLAS */
+#else /* !HAVE_BLAS */
+	/* column-oriented, so that the inner loop vectorizes */
+	for (integer c = 0; c < n; c++) {
+		doublereal *pc = &pC[m*c];
+		std::fill(pc, pc + m, 0.);
+		for (integer l = 0; l < k; l++) {
+			const doublereal d = pB[k*c + l];
+			const doublereal *pa = &pA[m*l];
+			for (integer r = 0; r < m; r++) {
+				pc[r] += pa[r]*d;
+			}
+		}
+	}
+#endif /* !HAVE_BLAS */
+}
+
+ModalInvContraction::ModalInvContraction(integer NModes,
+	const Mat3xN& oInv5, const Mat3xN& oInv9)
+: m_NModes(NModes),
+m_ab(2*NModes)
+{
+	if (oInv5.iGetNumCols()) {
+		m_Inv5.resize(3*NModes*NModes);
+		m_Inv5ab.resize(2*3*NModes);
+
+		for (integer j = 0; j < NModes; j++) {
+			for (int r = 0; r < 3; r++) {
+				for (integer k = 0; k < NModes; k++) {
+					m_Inv5[k + NModes*r + 3*NModes*j]
+						= oInv5(r + 1, j*NModes + k + 1);
+				}
+			}
+		}
+	}
+
+	if (oInv9.iGetNumCols()) {
+		m_Inv9.resize(9*NModes*NModes);
+		m_Inv9ab.resize(2*9*NModes);
+
+		for (integer k = 0; k < NModes; k++) {
+			for (int r = 0; r < 3; r++) {
+				for (int c = 0; c < 3; c++) {
+					for (integer j = 0; j < NModes; j++) {
+						m_Inv9[j + NModes*(c + 3*r) + 9*NModes*k]
+							= oInv9(r + 1, 3*(j*NModes + k) + c + 1);
+					}
+				}
+			}
+		}
+	}
+}
+
+ModalInvContraction::~ModalInvContraction(void)
+{
+	NO_OP;
+}
+
+void
+ModalInvContraction::SetAB(const VecN& a, const VecN& b)
+{
+	std::copy(a.pGetVec(), a.pGetVec() + m_NModes, m_ab.begin());
+	std::copy(b.pGetVec(), b.pGetVec() + m_NModes, m_ab.begin() + m_NModes);
+}
+
+void
+ModalInvContraction::Inv5(const VecN& a, const VecN& b,
+	Mat3xN& Inv5jaj, Mat3xN& Inv5jaPj)
+{
+	ASSERT(!m_Inv5.empty());
+
+	SetAB(a, b);
+	ModalGemm(3*m_NModes, 2, m_NModes, &m_Inv5[0], &m_ab[0], &m_Inv5ab[0]);
+
+	for (int r = 0; r < 3; r++) {
+		for (integer k = 0; k < m_NModes; k++) {
+			Inv5jaj(r + 1, k + 1) = m_Inv5ab[k + m_NModes*r];
+			Inv5jaPj(r + 1, k + 1) = m_Inv5ab[k + m_NModes*r + 3*m_NModes];
+		}
+	}
+}
+
+void
+ModalInvContraction::Inv9(const VecN& a, const VecN& b,
+	Mat3x3& Inv9jkajak, Mat3x3& Inv9jkajaPk)
+{
+	ASSERT(!m_Inv9.empty());
+
+	SetAB(a, b);
+	ModalGemm(9*m_NModes, 2, m_NModes, &m_Inv9[0], &m_ab[0], &m_Inv9ab[0]);
+
+	const doublereal *pa = a.pGetVec();
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 3; c++) {
+			const doublereal *pu = &m_Inv9ab[m_NModes*(c + 3*r)];
+			const doublereal *pv = pu + 9*m_NModes;
+			doublereal du = 0., dv = 0.;
+			for (integer j = 0; j < m_NModes; j++) {
+				du += pa[j]*pu[j];
+				dv += pa[j]*pv[j];
+			}
+			Inv9jkajak(r + 1, c + 1) = du;
+			Inv9jkajaPk(r + 1, c + 1) = dv;
+		}
+	}
+}
+
+Mat3x3
+ModalInvContraction::GetInv9jkak(integer jMode) const
+{
+	ASSERT(jMode >= 1 && jMode <= m_NModes);
+
+	const doublereal *pu = &m_Inv9ab[jMode - 1];
+	const integer M = m_NModes;
+
+	/* Mat3x3 constructor takes the coefficients column-wise */
+	return Mat3x3(pu[0], pu[3*M], pu[6*M],
+		pu[M], pu[4*M], pu[7*M],
+		pu[2*M], pu[5*M], pu[8*M]);
+}
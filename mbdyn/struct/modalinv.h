@@ -0,0 +1,103 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* Contrazione degli invarianti d'inerzia dell'elemento modale */
+
+#ifndef MODALINV_H
+#define MODALINV_H
+
+#include <vector>
+
+#include "matvec3.h"
+#include "matvec3n.h"
+
+/* ModalInvContraction - begin */
+
+/*
+ * The invariants Inv5 and Inv9 of the modal element are contracted
+ * with the modal coordinates a and their derivatives b at each residual
+ * evaluation, which costs O(NModes^2) operations.  As read from the FEM
+ * file they are stored as 3 x (NModes*NModes) and 3 x (3*NModes*NModes)
+ * matrices, which would require many small 3x3 products; here they are
+ * repacked once, column-major, so that each contraction is a single
+ * (NModes*3 x NModes) or (NModes*9 x NModes) by (NModes x 2)
+ * matrix product, performed by BLAS dgemm() when available.
+ *
+ * Packed layouts (0-based indices):
+ *
+ *   Inv5(r, j*NModes + k)     -> m_Inv5[k + NModes*r + 3*NModes*j]
+ *   Inv9(r, 3*(j*NModes + k) + c)
+ *                             -> m_Inv9[j + NModes*(c + 3*r) + 9*NModes*k]
+ */
+class ModalInvContraction {
+protected:
+	integer m_NModes;
+
+	std::vector<doublereal> m_Inv5;
+	std::vector<doublereal> m_Inv9;
+
+	/* [a, b] */
+	std::vector<doublereal> m_ab;
+
+	/* [sum_j Inv5(r, (j, k))*a_j, sum_j Inv5(r, (j, k))*b_j] */
+	std::vector<doublereal> m_Inv5ab;
+
+	/* [sum_k Inv9_jk*a_k, sum_k Inv9_jk*b_k] */
+	std::vector<doublereal> m_Inv9ab;
+
+	void SetAB(const VecN& a, const VecN& b);
+
+public:
+	ModalInvContraction(integer NModes, const Mat3xN& oInv5, const Mat3xN& oInv9);
+	~ModalInvContraction(void);
+
+	/*
+	 * Inv5jaj(r, k) = sum_j Inv5(r, (j, k))*a_j
+	 * Inv5jaPj(r, k) = sum_j Inv5(r, (j, k))*b_j
+	 */
+	void Inv5(const VecN& a, const VecN& b, Mat3xN& Inv5jaj, Mat3xN& Inv5jaPj);
+
+	/*
+	 * Inv9jkajak = sum_jk Inv9_jk*a_j*a_k
+	 * Inv9jkajaPk = sum_jk Inv9_jk*a_j*b_k
+	 *
+	 * also stores sum_k Inv9_jk*a_k for GetInv9jkak()
+	 */
+	void Inv9(const VecN& a, const VecN& b, Mat3x3& Inv9jkajak, Mat3x3& Inv9jkajaPk);
+
+	/* sum_k Inv9_jk*a_k, as computed by the last call to Inv9();
+	 * jMode is 1-based */
+	Mat3x3 GetInv9jkak(integer jMode) const;
+};
+
+/* ModalInvContraction - end */
+
+#endif /* MODALINV_H */
@@ -0,0 +1,203 @@
+/* $Header$ */
+/* 
+ * MBDyn (C) is a multibody analysis code. 
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati	<pierangelo.masarati@polimi.it>
+ * Paolo Mantegazza	<paolo.mantegazza@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Benchmark of the contractions of the inertia invariants of the modal
+ * element with the modal coordinates, on synthetic invariants:
+ * direct evaluation by 3x3 blocks vs. ModalInvContraction.
+ *
+ * usage: modalinvbench [<NModes> ...]
+ */
+
+#include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "modalinv.h"
+
+static void
+Direct(integer NModes, const Mat3xN& oInv5, const Mat3xN& oInv9,
+	const VecN& a, const VecN& b,
+	Mat3xN& Inv5jaj, Mat3xN& Inv5jaPj,
+	Mat3x3& Inv9jkajak, Mat3x3& Inv9jkajaPk, std::vector<Mat3x3>& Inv9jkak)
+{
+	Inv5jaj.Reset(0.);
+	Inv5jaPj.Reset(0.);
+	Inv9jkajak.Reset();
+	Inv9jkajaPk.Reset();
+
+	for (integer jMode = 1; jMode <= NModes; jMode++) {
+		doublereal a_jMode = a(jMode);
+		doublereal aP_jMode = b(jMode);
+
+		for (integer kMode = 1; kMode <= NModes; kMode++) {
+			Vec3 v = oInv5.GetVec((jMode - 1)*NModes + kMode);
+
+			Inv5jaj.AddVec(kMode, v*a_jMode);
+			Inv5jaPj.AddVec(kMode, v*aP_jMode);
+		}
+
+		for (integer kMode = 1; kMode <= NModes; kMode++) {
+			doublereal a_kMode = a(kMode);
+			doublereal aP_kMode = b(kMode);
+			integer iOffset = (jMode - 1)*3*NModes + (kMode - 1)*3 + 1;
+			Inv9jkajak += oInv9.GetMat3x3ScalarMult(iOffset, a_jMode*a_kMode);
+			Inv9jkajaPk += oInv9.GetMat3x3ScalarMult(iOffset, a_jMode*aP_kMode);
+		}
+	}
+
+	for (integer jMode = 1; jMode <= NModes; jMode++) {
+		Mat3x3 MTmp(::Zero3x3);
+		for (integer kMode = 1; kMode <= NModes; kMode++) {
+			integer kOffset = (jMode - 1)*3*NModes + (kMode - 1)*3 + 1;
+			MTmp += oInv9.GetMat3x3ScalarMult(kOffset, a(kMode));
+		}
+		Inv9jkak[jMode - 1] = MTmp;
+	}
+}
+
+static doublereal
+MaxDiff(const Mat3x3& m1, const Mat3x3& m2)
+{
+	doublereal d = 0.;
+	for (int r = 1; r <= 3; r++) {
+		for (int c = 1; c <= 3; c++) {
+			d = std::max(d, std::abs(m1(r, c) - m2(r, c)));
+		}
+	}
+
+	return d;
+}
+
+int
+main(int argc, char *argv[])
+{
+	std::vector<integer> Sizes;
+	for (int i = 1; i < argc; i++) {
+		Sizes.push_back(std::atoi(argv[i]));
+	}
+
+	if (Sizes.empty()) {
+		const integer DefaultSizes[] = { 10, 20, 50, 100, 200, 500 };
+		Sizes.assign(std::begin(DefaultSizes), std::end(DefaultSizes));
+	}
+
+	std::cout << "# NModes, direct [s], packed [s], speedup, max difference" << std::endl;
+
+	std::srand(1);
+	for (std::vector<integer>::const_iterator i = Sizes.begin(); i != Sizes.end(); ++i) {
+		const integer NModes = *i;
+		if (NModes <= 0) {
+			std::cerr << "invalid number of modes " << NModes << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		Mat3xN oInv5(NModes*NModes), oInv9(3*NModes*NModes);
+		for (int r = 1; r <= 3; r++) {
+			for (integer c = 1; c <= NModes*NModes; c++) {
+				oInv5(r, c) = doublereal(std::rand())/RAND_MAX - .5;
+			}
+			for (integer c = 1; c <= 3*NModes*NModes; c++) {
+				oInv9(r, c) = doublereal(std::rand())/RAND_MAX - .5;
+			}
+		}
+
+		VecN a(NModes), b(NModes);
+		for (integer j = 1; j <= NModes; j++) {
+			a(j) = doublereal(std::rand())/RAND_MAX - .5;
+			b(j) = doublereal(std::rand())/RAND_MAX - .5;
+		}
+
+		ModalInvContraction InvContr(NModes, oInv5, oInv9);
+
+		Mat3xN Inv5jaj(NModes, 0.), Inv5jaPj(NModes, 0.);
+		Mat3x3 Inv9jkajak, Inv9jkajaPk;
+		std::vector<Mat3x3> Inv9jkak(NModes);
+
+		Mat3xN Inv5jajP(NModes, 0.), Inv5jaPjP(NModes, 0.);
+		Mat3x3 Inv9jkajakP, Inv9jkajaPkP;
+
+		/* about 1e9 multiplications per variant */
+		const integer iRepeat = std::max(integer(1), integer(1e9/(36.*NModes*NModes)));
+
+		typedef std::chrono::steady_clock Clock;
+		typedef std::chrono::duration<double> Seconds;
+
+		Clock::time_point t0 = Clock::now();
+		for (integer n = 0; n < iRepeat; n++) {
+			Direct(NModes, oInv5, oInv9, a, b,
+				Inv5jaj, Inv5jaPj, Inv9jkajak, Inv9jkajaPk, Inv9jkak);
+		}
+		Clock::time_point t1 = Clock::now();
+		doublereal dDummy = 0.;
+		for (integer n = 0; n < iRepeat; n++) {
+			InvContr.Inv5(a, b, Inv5jajP, Inv5jaPjP);
+			InvContr.Inv9(a, b, Inv9jkajakP, Inv9jkajaPkP);
+			for (integer jMode = 1; jMode <= NModes; jMode++) {
+				dDummy += InvContr.GetInv9jkak(jMode)(1, 1);
+			}
+		}
+		Clock::time_point t2 = Clock::now();
+
+		doublereal dDiff = std::max(MaxDiff(Inv9jkajak, Inv9jkajakP),
+			MaxDiff(Inv9jkajaPk, Inv9jkajaPkP));
+		for (integer jMode = 1; jMode <= NModes; jMode++) {
+			dDiff = std::max(dDiff, MaxDiff(Inv9jkak[jMode - 1],
+				InvContr.GetInv9jkak(jMode)));
+			for (int r = 1; r <= 3; r++) {
+				dDiff = std::max(dDiff, std::abs(Inv5jaj(r, jMode) - Inv5jajP(r, jMode)));
+				dDiff = std::max(dDiff, std::abs(Inv5jaPj(r, jMode) - Inv5jaPjP(r, jMode)));
+			}
+		}
+
+		doublereal dDirect = Seconds(t1 - t0).count()/iRepeat;
+		doublereal dPacked = Seconds(t2 - t1).count()/iRepeat;
+
+		std::cout << std::setw(4) << NModes
+			<< " " << std::setw(12) << dDirect
+			<< " " << std::setw(12) << dPacked
+			<< " " << std::setw(8) << dDirect/dPacked
+			<< " " << std::setw(12) << dDiff
+			<< (dDummy == 0. ? " " : "") << std::endl;
+
+		if (!(dDiff <= 1e-10*NModes*NModes)) {
+			std::cerr << "packed contraction differs from the direct one" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
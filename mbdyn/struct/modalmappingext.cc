@@ -31,6 +31,8 @@
 
 #include "mbconfig.h"           /* This goes first in every *.c,*.cc file */
 
+#include "ac/sys_sysinfo.h"
+
 #include "dataman.h"
 #include "extedge.h"
 #include "extsocket.h"
@@ -44,7 +46,7 @@ ModalMappingExt::ModalMappingExt(unsigned int uL,
 	DataManager *pDM,
 	const StructNode *pRefNode,
 	std::vector<const StructNode *>& n,
-	SpMapMatrixHandler *pH,
+	MappingMatrix *pH,
 	bool bOutputAccelerations,
 	ExtFileHandlerBase *pEFH,
 	ExtModalForceBase* pEMF,
@@ -399,9 +401,88 @@ ModalMappingExt::GetConnectedNodes(std::vector<const Node *>& connectedNodes) co
 	}
 }
 
-SpMapMatrixHandler *
+static unsigned
+ReadMappingThreads(MBDynParser& HP)
+{
+	unsigned nThreads = 1;
+	if (!HP.IsKeyWord("threads")) {
+		return nThreads;
+	}
+
+	if (HP.IsKeyWord("auto")) {
+#ifdef USE_MULTITHREAD
+		int n = get_nprocs();
+		if (n > 0) {
+			nThreads = n;
+		}
+#endif /* USE_MULTITHREAD */
+
+	} else {
+		int n = HP.GetInt();
+		if (n <= 0) {
+			silent_cerr("invalid mapping threads number " << n
+				<< " at line " << HP.GetLineData() << std::endl);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+		nThreads = n;
+	}
+
+#ifndef USE_MULTITHREAD
+	if (nThreads > 1) {
+		silent_cerr("configure with --enable-multithread "
+			"for multithreaded mapping (line " << HP.GetLineData() << ")"
+			<< std::endl);
+		nThreads = 1;
+	}
+#endif /* ! USE_MULTITHREAD */
+
+	return nThreads;
+}
+
+static MappingMatrix *
+ReadBinaryMappingMatrix(MBDynParser& HP, integer& nRows, integer& nCols)
+{
+	const char *sFileName = HP.GetFileName();
+	if (sFileName == 0) {
+		silent_cerr("unable to read binary mapping file name "
+			"at line " << HP.GetLineData() << std::endl);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	MappingMatrix *pH = 0;
+	SAFENEWWITHCONSTRUCTOR(pH, MappingMatrix, MappingMatrix(sFileName));
+
+	if ((nRows >= 0 && nRows != pH->iGetNumRows())
+		|| (nCols >= 0 && nCols != pH->iGetNumCols()))
+	{
+		silent_cerr("ReadSparseMappingMatrix(\"" << sFileName << "\"): "
+			"rows=" << pH->iGetNumRows()
+			<< " cols=" << pH->iGetNumCols()
+			<< " inconsistent with expected rows=" << nRows
+			<< " cols=" << nCols
+			<< " at line " << HP.GetLineData() << std::endl);
+		SAFEDELETE(pH);
+		throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+	}
+
+	nRows = pH->iGetNumRows();
+	nCols = pH->iGetNumCols();
+
+	pedantic_cout("got " << pH->Nz() << " nonzeros from binary file \"" << sFileName << "\"" << std::endl);
+
+	return pH;
+}
+
+MappingMatrix *
 ReadSparseMappingMatrix(MBDynParser& HP, integer& nRows, integer& nCols)
 {
+	MappingMatrix *pH = 0;
+	if (HP.IsKeyWord("binary" "mapping" "file")) {
+		pH = ReadBinaryMappingMatrix(HP, nRows, nCols);
+		pH->SetThreads(ReadMappingThreads(HP));
+		return pH;
+	}
+
 	bool bSparse;
 	if (HP.IsKeyWord("full" "mapping" "file")) {
 		bSparse = false;
@@ -534,9 +615,7 @@ ReadSparseMappingMatrix(MBDynParser& HP, integer& nRows, integer& nCols)
 			<< std::endl);
 	}
 
-	SpMapMatrixHandler *pH = 0;
-	SAFENEWWITHCONSTRUCTOR(pH, SpMapMatrixHandler,
-		SpMapMatrixHandler(nRows, nCols));
+	std::vector<MappingMatrix::Coef> Coefs;
 
 	if (bSparse) {
 		integer ir, ic, cnt = 0, nzcnt = 0;
@@ -549,7 +628,8 @@ ReadSparseMappingMatrix(MBDynParser& HP, integer& nRows, integer& nCols)
 			}
 
 			if (std::abs(d) > dThreshold) {
-				(*pH)(ir, ic) = d;
+				MappingMatrix::Coef c = { ir - 1, ic - 1, d };
+				Coefs.push_back(c);
 				nzcnt++;
 			}
 
@@ -570,7 +650,8 @@ ReadSparseMappingMatrix(MBDynParser& HP, integer& nRows, integer& nCols)
 					throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 				}
 				if (std::abs(d) > dThreshold) {
-					(*pH)(ir, ic) = d;
+					MappingMatrix::Coef c = { ir - 1, ic - 1, d };
+					Coefs.push_back(c);
 					nzcnt++;
 				}
 			}
@@ -578,6 +659,29 @@ ReadSparseMappingMatrix(MBDynParser& HP, integer& nRows, integer& nCols)
 		pedantic_cout("got " << nzcnt << " nonzeros from file \"" << sFileName << "\"" << std::endl);
 	}
 
+	SAFENEWWITHCONSTRUCTOR(pH, MappingMatrix,
+		MappingMatrix(nRows, nCols, Coefs));
+
+	if (HP.IsKeyWord("save" "binary")) {
+		const char *sBinFileName = HP.GetFileName();
+		if (sBinFileName == 0) {
+			silent_cerr("unable to read binary mapping file name "
+				"at line " << HP.GetLineData() << std::endl);
+			SAFEDELETE(pH);
+			throw ErrGeneric(MBDYN_EXCEPT_ARGS);
+		}
+
+		try {
+			pH->Save(sBinFileName);
+
+		} catch (...) {
+			SAFEDELETE(pH);
+			throw;
+		}
+	}
+
+	pH->SetThreads(ReadMappingThreads(HP));
+
 	return pH;
 }
 
@@ -715,7 +819,7 @@ ReadModalMappingExtForce(DataManager* pDM,
 	}
 
 	integer nCols = 6*nNodes;
-	SpMapMatrixHandler *pH = ReadSparseMappingMatrix(HP, nModes, nCols);
+	MappingMatrix *pH = ReadSparseMappingMatrix(HP, nModes, nCols);
 	ASSERT(nCols == 6*nNodes);
 
 	flag fOut = pDM->fReadOutput(HP, Elem::FORCE);
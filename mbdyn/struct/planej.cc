@@ -37,6 +37,7 @@
 #include <limits>
 
 #include "planej.h"
+#include "checkpoint.h"
 #include "Rot.hh"
 #include "hint_impl.h"
 
@@ -499,6 +500,31 @@ PlaneHingeJoint::AfterConvergence(const VectorHandler& X,
 	}
 }
 
+void
+PlaneHingeJoint::SaveState(CheckpointOut& out) const
+{
+	integer iNTheta = NTheta;
+	out.Put(iNTheta);
+	out.Put(dTheta);
+	out.Put(dThetaWrapped);
+	if (fc) {
+		fc->SaveState(out);
+	}
+}
+
+void
+PlaneHingeJoint::RestoreState(CheckpointIn& in)
+{
+	integer iNTheta;
+	in.Get(iNTheta);
+	NTheta = iNTheta;
+	in.Get(dTheta);
+	in.Get(dThetaWrapped);
+	if (fc) {
+		fc->RestoreState(in);
+	}
+}
+
 /* Funzione che legge lo stato iniziale dal file di input */
 void
 PlaneHingeJoint::ReadInitialState(MBDynParser& HP)
@@ -1813,6 +1839,25 @@ PlaneRotationJoint::AfterConvergence(const VectorHandler& X,
 	dTheta = 2*M_PI*NTheta + dThetaWrapped;
 }
 
+void
+PlaneRotationJoint::SaveState(CheckpointOut& out) const
+{
+	integer iNTheta = NTheta;
+	out.Put(iNTheta);
+	out.Put(dTheta);
+	out.Put(dThetaWrapped);
+}
+
+void
+PlaneRotationJoint::RestoreState(CheckpointIn& in)
+{
+	integer iNTheta;
+	in.Get(iNTheta);
+	NTheta = iNTheta;
+	in.Get(dTheta);
+	in.Get(dThetaWrapped);
+}
+
 
 /* Contributo al file di restart */
 std::ostream& PlaneRotationJoint::Restart(std::ostream& out) const
@@ -3016,6 +3061,31 @@ AxialRotationJoint::AfterConvergence(const VectorHandler& X,
 	}
 }
 
+void
+AxialRotationJoint::SaveState(CheckpointOut& out) const
+{
+	integer iNTheta = NTheta;
+	out.Put(iNTheta);
+	out.Put(dTheta);
+	out.Put(dThetaWrapped);
+	if (fc) {
+		fc->SaveState(out);
+	}
+}
+
+void
+AxialRotationJoint::RestoreState(CheckpointIn& in)
+{
+	integer iNTheta;
+	in.Get(iNTheta);
+	NTheta = iNTheta;
+	in.Get(dTheta);
+	in.Get(dThetaWrapped);
+	if (fc) {
+		fc->RestoreState(in);
+	}
+}
+
 
 /* Contributo al file di restart */
 std::ostream& AxialRotationJoint::Restart(std::ostream& out) const
@@ -4380,6 +4450,25 @@ PlanePinJoint::AfterConvergence(const VectorHandler& X,
 
 }
 
+void
+PlanePinJoint::SaveState(CheckpointOut& out) const
+{
+	integer iNTheta = NTheta;
+	out.Put(iNTheta);
+	out.Put(dTheta);
+	out.Put(dThetaWrapped);
+}
+
+void
+PlanePinJoint::RestoreState(CheckpointIn& in)
+{
+	integer iNTheta;
+	in.Get(iNTheta);
+	NTheta = iNTheta;
+	in.Get(dTheta);
+	in.Get(dThetaWrapped);
+}
+
 void
 PlanePinJoint::ReadInitialState(MBDynParser& HP)
 {
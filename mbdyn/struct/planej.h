@@ -139,6 +139,10 @@ class PlaneHingeJoint : virtual public Elem, public Joint {
    virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+   /* Checkpoint: unwrapped angle and friction status */
+   virtual void SaveState(CheckpointOut& out) const;
+   virtual void RestoreState(CheckpointIn& in);
+
    void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = NumDof;
       *piNumCols = NumDof;
@@ -284,6 +288,10 @@ class PlaneRotationJoint : virtual public Elem, public Joint {
 	virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+	/* Checkpoint: unwrapped angle */
+	virtual void SaveState(CheckpointOut& out) const;
+	virtual void RestoreState(CheckpointIn& in);
+
    void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = 3+3+2;
       *piNumCols = 3+3+2; 
@@ -458,6 +466,10 @@ public Joint, public DriveOwner {
 	virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+	/* Checkpoint: unwrapped angle and friction status */
+	virtual void SaveState(CheckpointOut& out) const;
+	virtual void RestoreState(CheckpointIn& in);
+
    void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = NumDof;
       *piNumCols = NumDof;
@@ -598,6 +610,10 @@ class PlanePinJoint : virtual public Elem, public Joint {
 	virtual void AfterConvergence(const VectorHandler& X, 
 			const VectorHandler& XP);
 
+	/* Checkpoint: unwrapped angle */
+	virtual void SaveState(CheckpointOut& out) const;
+	virtual void RestoreState(CheckpointIn& in);
+
    virtual void WorkSpaceDim(integer* piNumRows, integer* piNumCols) const { 
       *piNumRows = 11; 
       *piNumCols = 11;
@@ -305,6 +305,14 @@ public:
             const VectorHandler& XCurr,
             const VectorHandler& XPrimeCurr) override;
 
+     virtual SubVectorHandler&
+     AssResJac(SubVectorHandler& WorkVec,
+               VariableSubMatrixHandler& WorkMat,
+               VariableSubMatrixHandler*& pJac,
+               doublereal dCoef,
+               const VectorHandler& XCurr,
+               const VectorHandler& XPrimeCurr) override;
+
      virtual void
      AssJac(VectorHandler& JacY,
             const VectorHandler& Y,
@@ -452,6 +460,12 @@ protected:
                              const sp_grad::SpColVector<sp_grad::SpGradient, 6>& sigma,
                              const sp_grad::SpMatrix<sp_grad::SpGradient, 3, 3>& F,
                              const SolidElemStatic* pElem) {
+               // AssResJac() takes the residual from this pass
+               const sp_grad::SpMatrix<doublereal, 3, 3> G_tmp(G.GetValue());
+               const sp_grad::SpColVector<doublereal, 6> sigma_tmp(sigma.GetValue());
+               const sp_grad::SpMatrix<doublereal, 3, 3> F_tmp(F.GetValue());
+
+               UpdateStressStrain(G_tmp, sigma_tmp, F_tmp, pElem);
           }
 
           inline void
@@ -593,6 +607,14 @@ public:
             const VectorHandler& XCurr,
             const VectorHandler& XPrimeCurr) override;
 
+     virtual SubVectorHandler&
+     AssResJac(SubVectorHandler& WorkVec,
+               VariableSubMatrixHandler& WorkMat,
+               VariableSubMatrixHandler*& pJac,
+               doublereal dCoef,
+               const VectorHandler& XCurr,
+               const VectorHandler& XPrimeCurr) override;
+
      virtual void
      AssJac(VectorHandler& JacY,
             const VectorHandler& Y,
@@ -1165,6 +1187,30 @@ SolidElemStatic<ElementType, CollocationType, SolidCSLType, StructNodeType>::Ass
      return WorkMat;
 }
 
+template <typename ElementType, typename CollocationType, typename SolidCSLType, typename StructNodeType>
+SubVectorHandler&
+SolidElemStatic<ElementType, CollocationType, SolidCSLType, StructNodeType>::AssResJac(SubVectorHandler& WorkVec,
+                                                                                       VariableSubMatrixHandler& WorkMat,
+                                                                                       VariableSubMatrixHandler*& pJac,
+                                                                                       doublereal dCoef,
+                                                                                       const VectorHandler& XCurr,
+                                                                                       const VectorHandler& XPrimeCurr)
+{
+     DEBUGCOUTFNAME("SolidElemStatic::AssResJac");
+
+     // a single pass with sp_grad::SpGradient; the residual is given by the values
+     sp_grad::SpGradientAssVec<sp_grad::SpGradient>::AssResJac(this,
+                                                               WorkVec,
+                                                               WorkMat.SetSparseGradient(),
+                                                               dCoef,
+                                                               XCurr,
+                                                               XPrimeCurr,
+                                                               sp_grad::SpFunctionCall::REGULAR_JAC);
+     pJac = &WorkMat;
+
+     return WorkVec;
+}
+
 template <typename ElementType, typename CollocationType, typename SolidCSLType, typename StructNodeType>
 void
 SolidElemStatic<ElementType, CollocationType, SolidCSLType, StructNodeType>::AssJac(VectorHandler& JacY,
@@ -2074,6 +2120,34 @@ SolidElemDynamic<ElementType, CollocationType, SolidCSLType, eMassMatrix>::AssJa
      return WorkMat;
 }
 
+template <typename ElementType, typename CollocationType, typename SolidCSLType, MassMatrixType eMassMatrix>
+SubVectorHandler&
+SolidElemDynamic<ElementType, CollocationType, SolidCSLType, eMassMatrix>::AssResJac(SubVectorHandler& WorkVec,
+                                                                                     VariableSubMatrixHandler& WorkMat,
+                                                                                     VariableSubMatrixHandler*& pJac,
+                                                                                     doublereal dCoef,
+                                                                                     const VectorHandler& XCurr,
+                                                                                     const VectorHandler& XPrimeCurr)
+{
+     DEBUGCOUTFNAME("SolidElemDynamic::AssResJac");
+
+     using namespace sp_grad;
+
+     SpGradientAssVec<SpGradient>::AssResJac(this,
+                                             WorkVec,
+                                             WorkMat.SetSparseGradient(),
+                                             dCoef,
+                                             XCurr,
+                                             XPrimeCurr,
+                                             SpFunctionCall::REGULAR_JAC);
+
+     MassMatrixHelper<eMassMatrix>::AddInertia(*this, M);
+
+     pJac = &WorkMat;
+
+     return WorkVec;
+}
+
 template <typename ElementType, typename CollocationType, typename SolidCSLType, MassMatrixType eMassMatrix>
 void
 SolidElemDynamic<ElementType, CollocationType, SolidCSLType, eMassMatrix>::AssJac(VectorHandler& JacY,
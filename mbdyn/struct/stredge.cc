@@ -224,7 +224,7 @@ velocity, RF, 3, 121, 0
 }
 
 void
-StructExtEDGEForce::SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen when)
+StructExtEDGEForce::SendToFileDes(ExtFileHandlerBase::SendWhen when)
 {
 	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 }
@@ -588,7 +588,7 @@ force, RF, 3, 121, 0
 }
 
 void
-StructExtEDGEForce::RecvFromFileDes(int infd)
+StructExtEDGEForce::RecvFromFileDes(void)
 {
 	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 }
@@ -314,8 +314,7 @@ StructExtForce::Prepare(ExtFileHandlerBase *pEFH)
 
 			uint32_ptr[1] = m_Points.size();
 
-			ssize_t rc = sendn(pEFH->GetOutFileDes(),
-				(const char *)buf, sizeof(buf),
+			ssize_t rc = pEFH->SendN((const char *)buf, sizeof(buf),
 				pEFH->GetSendFlags());
 
 			if (rc == SOCKET_ERROR) {
@@ -355,8 +354,7 @@ StructExtForce::Prepare(ExtFileHandlerBase *pEFH)
 			char buf[sizeof(uint32_t) + sizeof(uint32_t)];
 			uint32_t *uint32_ptr;
 
-			ssize_t rc = recvn(pEFH->GetInFileDes(),
-				(char *)buf, sizeof(buf),
+			ssize_t rc = pEFH->RecvN((char *)buf, sizeof(buf),
 				pEFH->GetRecvFlags());
 			if (rc == SOCKET_ERROR) {
 				int save_errno = WSAGetLastError();
@@ -469,14 +467,15 @@ StructExtForce::Send(ExtFileHandlerBase *pEFH, ExtFileHandlerBase::SendWhen when
 	{
 	case ExtFileHandlerBase::TYPE_FILE:
 	case ExtFileHandlerBase::TYPE_EDGE:
-	case ExtFileHandlerBase::TYPE_SOCKET: {
+	case ExtFileHandlerBase::TYPE_SOCKET:
+	case ExtFileHandlerBase::TYPE_SHM: {
 
 	std::ostream *outfp = pEFH->GetOutStream();
 	if (outfp) {
 		SendToStream(*outfp, when);
 
 	} else {
-		SendToFileDes(pEFH->GetOutFileDes(), when);
+		SendToFileDes(when);
 	}
 
 		break;
@@ -696,7 +695,7 @@ StructExtForce::SendToStream(std::ostream& outf, ExtFileHandlerBase::SendWhen wh
    done. See more at:
    https://stackoverflow.com/questions/1953639/is-it-safe-to-cast-socket-to-int-under-win64 */
 void
-StructExtForce::SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen when)
+StructExtForce::SendToFileDes(ExtFileHandlerBase::SendWhen when)
 {
 #ifdef USE_SOCKET
 	if (pRefNode) {
@@ -711,36 +710,36 @@ StructExtForce::SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen when)
 			uint32_t l[2];
 			l[0] = pRefNode->GetLabel();
 			l[1] = 0;
-			sendn(outfd, (const char *)&l[0], sizeof(l), 0);
+			pEFH->SendN((const char *)&l[0], sizeof(l), 0);
 		}
 
-		sendn(outfd, (const char *)xRef.pGetVec(), 3*sizeof(doublereal), 0);
+		pEFH->SendN((const char *)xRef.pGetVec(), 3*sizeof(doublereal), 0);
 		switch (uRot) {
 		case MBC_ROT_NONE:
 			break;
 
 		case MBC_ROT_MAT:
-			sendn(outfd, (const char *)RRef.pGetMat(), 9*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)RRef.pGetMat(), 9*sizeof(doublereal), 0);
 			break;
 
 		case MBC_ROT_THETA: {
 			Vec3 Theta(RotManip::VecRot(RRef));
-			sendn(outfd, (const char *)Theta.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)Theta.pGetVec(), 3*sizeof(doublereal), 0);
 			} break;
 
 		case MBC_ROT_EULER_123: {
 			Vec3 E(MatR2EulerAngles123(RRef)*dRaDegr);
-			sendn(outfd, (const char *)E.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)E.pGetVec(), 3*sizeof(doublereal), 0);
 			} break;
 		}
-		sendn(outfd, (const char *)xpRef.pGetVec(), 3*sizeof(doublereal), 0);
+		pEFH->SendN((const char *)xpRef.pGetVec(), 3*sizeof(doublereal), 0);
 		if (uRot != MBC_ROT_NONE) {
-			sendn(outfd, (const char *)wRef.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)wRef.pGetVec(), 3*sizeof(doublereal), 0);
 		}
 		if (bOutputAccelerations) {
-			sendn(outfd, (const char *)xppRef.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)xppRef.pGetVec(), 3*sizeof(doublereal), 0);
 			if (uRot != MBC_ROT_NONE) {
-				sendn(outfd, (const char *)wpRef.pGetVec(), 3*sizeof(doublereal), 0);
+				pEFH->SendN((const char *)wpRef.pGetVec(), 3*sizeof(doublereal), 0);
 			}
 		}
 
@@ -866,7 +865,7 @@ StructExtForce::SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen when)
 		}
 	}
 
-	sendn(outfd, &iobuf[0], iobuf.size(), 0);
+	pEFH->SendN(&iobuf[0], iobuf.size(), 0);
 #else // ! USE_SOCKET
 	throw ErrGeneric(MBDYN_EXCEPT_ARGS);
 #endif // ! USE_SOCKET
@@ -880,7 +879,8 @@ StructExtForce::Recv(ExtFileHandlerBase *pEFH)
 	{
 	case ExtFileHandlerBase::TYPE_FILE:
 	case ExtFileHandlerBase::TYPE_EDGE:
-	case ExtFileHandlerBase::TYPE_SOCKET: {
+	case ExtFileHandlerBase::TYPE_SOCKET:
+	case ExtFileHandlerBase::TYPE_SHM: {
 
 		std::istream *infp = pEFH->GetInStream();
 
@@ -888,7 +888,7 @@ StructExtForce::Recv(ExtFileHandlerBase *pEFH)
         	    RecvFromStream(*infp);
 
         	} else {
-        	    RecvFromFileDes(pEFH->GetInFileDes());
+        	    RecvFromFileDes();
         	}
 
         }
@@ -1029,7 +1029,7 @@ StructExtForce::RecvFromStream(std::istream& inf)
 }
 
 void
-StructExtForce::RecvFromFileDes(int infd)
+StructExtForce::RecvFromFileDes(void)
 {
 #ifdef USE_SOCKET
 	if (pRefNode) {
@@ -1050,7 +1050,7 @@ StructExtForce::RecvFromFileDes(int infd)
 			ulen += 3*sizeof(doublereal);
 		}
 
-		len = recvn(infd, (char *)buf, ulen, 0);
+		len = pEFH->RecvN((char *)buf, ulen, 0);
 		if (len == -1) {
 			int save_errno = WSAGetLastError();
 			char *err_msg = strerror(save_errno);
@@ -1088,7 +1088,7 @@ StructExtForce::RecvFromFileDes(int infd)
 		}
 	}
 
-	ssize_t len = recvn(infd, (char *)&iobuf[0], dynamics_nbytes, 0);
+	ssize_t len = pEFH->RecvN((char *)&iobuf[0], dynamics_nbytes, 0);
 	if (len == -1) {
 		int save_errno = WSAGetLastError();
 		char *err_msg = strerror(save_errno);
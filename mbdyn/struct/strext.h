@@ -101,9 +101,9 @@ protected:
 	void Recv(ExtFileHandlerBase *pEFH);
    
 	virtual void SendToStream(std::ostream& outf, ExtFileHandlerBase::SendWhen when);
-	virtual void SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen when);
+	virtual void SendToFileDes(ExtFileHandlerBase::SendWhen when);
 	virtual void RecvFromStream(std::istream& inf);
-	virtual void RecvFromFileDes(int infd);
+	virtual void RecvFromFileDes(void);
    
 public:
 	/* Costruttore */
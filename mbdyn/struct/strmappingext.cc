@@ -52,7 +52,7 @@ StructMappingExtForce::StructMappingExtForce(unsigned int uL,
 	std::vector<const StructDispNode *>& nodes,
 	std::vector<Vec3>& offsets,
 	std::vector<unsigned>& labels,
-	SpMapMatrixHandler *pH,
+	MappingMatrix *pH,
 	std::vector<uint32_t>& mappedlabels,
 	bool bLabels,
 	bool bOutputAccelerations,
@@ -222,7 +222,9 @@ m_p(3*uMappedPoints)
 
 StructMappingExtForce::~StructMappingExtForce(void)
 {
-	NO_OP;
+	if (pH) {
+		SAFEDELETE(pH);
+	}
 }
 
 void
@@ -272,8 +274,7 @@ StructMappingExtForce::Prepare(ExtFileHandlerBase *pEFH)
 
 			uint32_ptr[1] = uPoints;
 
-			ssize_t rc = sendn(pEFH->GetOutFileDes(),
-				(const char *)buf, sizeof(buf),
+			ssize_t rc = pEFH->SendN((const char *)buf, sizeof(buf),
 				pEFH->GetSendFlags());
 			if (rc == -1) {
 				int save_errno = WSAGetLastError();
@@ -313,8 +314,7 @@ StructMappingExtForce::Prepare(ExtFileHandlerBase *pEFH)
 			char buf[sizeof(uint32_t) + sizeof(uint32_t)];
 			uint32_t *uint32_ptr;
 
-			ssize_t rc = recvn(pEFH->GetInFileDes(),
-				(char *)buf, sizeof(buf),
+			ssize_t rc = pEFH->RecvN((char *)buf, sizeof(buf),
 				pEFH->GetRecvFlags());
 			if (rc == -1) {
 				int save_errno = WSAGetLastError();
@@ -421,7 +421,7 @@ StructMappingExtForce::Send(ExtFileHandlerBase *pEFH, ExtFileHandlerBase::SendWh
 		SendToStream(*outfp, when);
 
 	} else {
-		SendToFileDes(pEFH->GetOutFileDes(), when);
+		SendToFileDes(when);
 	}
 }
 
@@ -597,7 +597,7 @@ StructMappingExtForce::SendToStream(std::ostream& outf, ExtFileHandlerBase::Send
 }
 
 void
-StructMappingExtForce::SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen when)
+StructMappingExtForce::SendToFileDes(ExtFileHandlerBase::SendWhen when)
 {
 #ifdef USE_SOCKET
 	if (pRefNode) {
@@ -610,30 +610,30 @@ StructMappingExtForce::SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen whe
 
 		if (bLabels) {
 			uint32_t l = pRefNode->GetLabel();
-			sendn(outfd, (const char *)&l, sizeof(l), 0);
+			pEFH->SendN((const char *)&l, sizeof(l), 0);
 		}
 
-		sendn(outfd, (const char *)xRef.pGetVec(), 3*sizeof(doublereal), 0);
+		pEFH->SendN((const char *)xRef.pGetVec(), 3*sizeof(doublereal), 0);
 		switch (uRRot) {
 		case MBC_ROT_MAT:
-			sendn(outfd, (const char *)RRef.pGetMat(), 9*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)RRef.pGetMat(), 9*sizeof(doublereal), 0);
 			break;
 
 		case MBC_ROT_THETA: {
 			Vec3 Theta(RotManip::VecRot(RRef));
-			sendn(outfd, (const char *)Theta.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)Theta.pGetVec(), 3*sizeof(doublereal), 0);
 			} break;
 
 		case MBC_ROT_EULER_123: {
 			Vec3 E(MatR2EulerAngles123(RRef)*dRaDegr);
-			sendn(outfd, (const char *)E.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)E.pGetVec(), 3*sizeof(doublereal), 0);
 			} break;
 		}
-		sendn(outfd, (const char *)xpRef.pGetVec(), 3*sizeof(doublereal), 0);
-		sendn(outfd, (const char *)wRef.pGetVec(), 3*sizeof(doublereal), 0);
+		pEFH->SendN((const char *)xpRef.pGetVec(), 3*sizeof(doublereal), 0);
+		pEFH->SendN((const char *)wRef.pGetVec(), 3*sizeof(doublereal), 0);
 		if (bOutputAccelerations) {
-			sendn(outfd, (const char *)xppRef.pGetVec(), 3*sizeof(doublereal), 0);
-			sendn(outfd, (const char *)wpRef.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)xppRef.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)wpRef.pGetVec(), 3*sizeof(doublereal), 0);
 		}
 
 		for (unsigned p3 = 0, n = 0; n < Nodes.size(); n++) {
@@ -732,27 +732,27 @@ StructMappingExtForce::SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen whe
 	}
 
 	if (bLabels) {
-		sendn(outfd, (const char *)&m_qlabels[0], sizeof(uint32_t)*m_qlabels.size(), 0);
+		pEFH->SendN((const char *)&m_qlabels[0], sizeof(uint32_t)*m_qlabels.size(), 0);
 	}
 
 	if (pH) {
 		pH->MatVecMul(m_q, m_x);
 		pH->MatVecMul(m_qP, m_xP);
 
-		sendn(outfd, (const char *)&m_q[0], sizeof(double)*m_q.size(), 0);
-		sendn(outfd, (const char *)&m_qP[0], sizeof(double)*m_qP.size(), 0);
+		pEFH->SendN((const char *)&m_q[0], sizeof(double)*m_q.size(), 0);
+		pEFH->SendN((const char *)&m_qP[0], sizeof(double)*m_qP.size(), 0);
 
 		if (bOutputAccelerations) {
 			pH->MatVecMul(m_qPP, m_xPP);
-			sendn(outfd, (const char *)&m_qPP[0], sizeof(double)*m_qPP.size(), 0);
+			pEFH->SendN((const char *)&m_qPP[0], sizeof(double)*m_qPP.size(), 0);
 		}
 
 	} else {
-		sendn(outfd, (const char *)&m_x[0], sizeof(double)*m_x.size(), 0);
-		sendn(outfd, (const char *)&m_xP[0], sizeof(double)*m_xP.size(), 0);
+		pEFH->SendN((const char *)&m_x[0], sizeof(double)*m_x.size(), 0);
+		pEFH->SendN((const char *)&m_xP[0], sizeof(double)*m_xP.size(), 0);
 
 		if (bOutputAccelerations) {
-			sendn(outfd, (const char *)&m_xPP[0], sizeof(double)*m_xPP.size(), 0);
+			pEFH->SendN((const char *)&m_xPP[0], sizeof(double)*m_xPP.size(), 0);
 		}
 	}
 
@@ -769,7 +769,7 @@ StructMappingExtForce::Recv(ExtFileHandlerBase *pEFH)
 		RecvFromStream(*infp);
 
 	} else {
-		RecvFromFileDes(pEFH->GetInFileDes());
+		RecvFromFileDes();
 	}
 }
 
@@ -827,7 +827,7 @@ StructMappingExtForce::RecvFromStream(std::istream& inf)
 }
 
 void
-StructMappingExtForce::RecvFromFileDes(int infd)
+StructMappingExtForce::RecvFromFileDes(void)
 {
 #ifdef USE_SOCKET
 	if (pRefNode) {
@@ -842,7 +842,7 @@ StructMappingExtForce::RecvFromFileDes(int infd)
 
 		ulen += 6*sizeof(doublereal);
 
-		len = recvn(infd, (char *)buf, ulen, pEFH->GetRecvFlags());
+		len = pEFH->RecvN((char *)buf, ulen, pEFH->GetRecvFlags());
 		if (len == -1) {
 			int save_errno = WSAGetLastError();
 			char *err_msg = strerror(save_errno);
@@ -880,7 +880,7 @@ StructMappingExtForce::RecvFromFileDes(int infd)
 
 	if (bLabels) {
 		// Hack!
-		ssize_t len = recvn(infd, (char *)&m_p[0], sizeof(uint32_t)*m_p.size(),
+		ssize_t len = pEFH->RecvN((char *)&m_p[0], sizeof(uint32_t)*m_p.size(),
 			pEFH->GetRecvFlags());
 		if (len == -1) {
 			int save_errno = WSAGetLastError();
@@ -920,7 +920,7 @@ StructMappingExtForce::RecvFromFileDes(int infd)
 		fsize = sizeof(double)*m_f.size();
 	}
 
-	ssize_t len = recvn(infd, (char *)fp, fsize, pEFH->GetRecvFlags());
+	ssize_t len = pEFH->RecvN((char *)fp, fsize, pEFH->GetRecvFlags());
 	if (len == -1) {
 		int save_errno = WSAGetLastError();
 		char *err_msg = strerror(save_errno);
@@ -1155,7 +1155,7 @@ StructMembraneMappingExtForce::StructMembraneMappingExtForce(unsigned int uL,
 	std::vector<Vec3>& offsets,
 	std::vector<unsigned>& labels,
 	std::vector<NodeConnData>& nodesConn,
-	SpMapMatrixHandler *pH,
+	MappingMatrix *pH,
 	std::vector<uint32_t>& mappedlabels,
 	bool bLabels,
 	bool bOutputAccelerations,
@@ -1358,7 +1358,7 @@ StructMembraneMappingExtForce::SendToStream(std::ostream& outf, ExtFileHandlerBa
 }
 
 void
-StructMembraneMappingExtForce::SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen when)
+StructMembraneMappingExtForce::SendToFileDes(ExtFileHandlerBase::SendWhen when)
 {
 #ifdef USE_SOCKET
 	if (pRefNode) {
@@ -1371,30 +1371,30 @@ StructMembraneMappingExtForce::SendToFileDes(int outfd, ExtFileHandlerBase::Send
 
 		if (bLabels) {
 			uint32_t l = pRefNode->GetLabel();
-			sendn(outfd, (const char *)&l, sizeof(l), 0);
+			pEFH->SendN((const char *)&l, sizeof(l), 0);
 		}
 
-		sendn(outfd, (const char *)xRef.pGetVec(), 3*sizeof(doublereal), 0);
+		pEFH->SendN((const char *)xRef.pGetVec(), 3*sizeof(doublereal), 0);
 		switch (uRRot) {
 		case MBC_ROT_MAT:
-			sendn(outfd, (const char *)RRef.pGetMat(), 9*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)RRef.pGetMat(), 9*sizeof(doublereal), 0);
 			break;
 
 		case MBC_ROT_THETA: {
 			Vec3 Theta(RotManip::VecRot(RRef));
-			sendn(outfd, (const char *)Theta.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)Theta.pGetVec(), 3*sizeof(doublereal), 0);
 			} break;
 
 		case MBC_ROT_EULER_123: {
 			Vec3 E(MatR2EulerAngles123(RRef)*dRaDegr);
-			sendn(outfd, (const char *)E.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)E.pGetVec(), 3*sizeof(doublereal), 0);
 			} break;
 		}
-		sendn(outfd, (const char *)xpRef.pGetVec(), 3*sizeof(doublereal), 0);
-		sendn(outfd, (const char *)wRef.pGetVec(), 3*sizeof(doublereal), 0);
+		pEFH->SendN((const char *)xpRef.pGetVec(), 3*sizeof(doublereal), 0);
+		pEFH->SendN((const char *)wRef.pGetVec(), 3*sizeof(doublereal), 0);
 		if (bOutputAccelerations) {
-			sendn(outfd, (const char *)xppRef.pGetVec(), 3*sizeof(doublereal), 0);
-			sendn(outfd, (const char *)wpRef.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)xppRef.pGetVec(), 3*sizeof(doublereal), 0);
+			pEFH->SendN((const char *)wpRef.pGetVec(), 3*sizeof(doublereal), 0);
 		}
 
 		for (unsigned p3 = 0, n = 0; n < Nodes.size(); n++) {
@@ -1542,27 +1542,27 @@ StructMembraneMappingExtForce::SendToFileDes(int outfd, ExtFileHandlerBase::Send
 	}
 
 	if (bLabels) {
-		sendn(outfd, (const char *)&m_qlabels[0], sizeof(uint32_t)*m_qlabels.size(), 0);
+		pEFH->SendN((const char *)&m_qlabels[0], sizeof(uint32_t)*m_qlabels.size(), 0);
 	}
 
 	if (pH) {
 		pH->MatVecMul(m_q, m_x);
 		pH->MatVecMul(m_qP, m_xP);
 
-		sendn(outfd, (const char *)&m_q[0], sizeof(double)*m_q.size(), 0);
-		sendn(outfd, (const char *)&m_qP[0], sizeof(double)*m_qP.size(), 0);
+		pEFH->SendN((const char *)&m_q[0], sizeof(double)*m_q.size(), 0);
+		pEFH->SendN((const char *)&m_qP[0], sizeof(double)*m_qP.size(), 0);
 
 		if (bOutputAccelerations) {
 			pH->MatVecMul(m_qPP, m_xPP);
-			sendn(outfd, (const char *)&m_qPP[0], sizeof(double)*m_qPP.size(), 0);
+			pEFH->SendN((const char *)&m_qPP[0], sizeof(double)*m_qPP.size(), 0);
 		}
 
 	} else {
-		sendn(outfd, (const char *)&m_x[0], sizeof(double)*m_x.size(), 0);
-		sendn(outfd, (const char *)&m_xP[0], sizeof(double)*m_xP.size(), 0);
+		pEFH->SendN((const char *)&m_x[0], sizeof(double)*m_x.size(), 0);
+		pEFH->SendN((const char *)&m_xP[0], sizeof(double)*m_xP.size(), 0);
 
 		if (bOutputAccelerations) {
-			sendn(outfd, (const char *)&m_xPP[0], sizeof(double)*m_xPP.size(), 0);
+			pEFH->SendN((const char *)&m_xPP[0], sizeof(double)*m_xPP.size(), 0);
 		}
 	}
 
@@ -1625,7 +1625,7 @@ StructMembraneMappingExtForce::RecvFromStream(std::istream& inf)
 }
 
 void
-StructMembraneMappingExtForce::RecvFromFileDes(int infd)
+StructMembraneMappingExtForce::RecvFromFileDes(void)
 {
 #ifdef USE_SOCKET
 	if (pRefNode) {
@@ -1640,7 +1640,7 @@ StructMembraneMappingExtForce::RecvFromFileDes(int infd)
 
 		ulen += 6*sizeof(doublereal);
 
-		len = recvn(infd, (char *)buf, ulen, pEFH->GetRecvFlags());
+		len = pEFH->RecvN((char *)buf, ulen, pEFH->GetRecvFlags());
 		if (len == -1) {
 			int save_errno = WSAGetLastError();
 			char *err_msg = strerror(save_errno);
@@ -1678,7 +1678,7 @@ StructMembraneMappingExtForce::RecvFromFileDes(int infd)
 
 	if (bLabels) {
 		// Hack!
-		ssize_t len = recvn(infd, (char *)&m_p[0], sizeof(uint32_t)*m_p.size(),
+		ssize_t len = pEFH->RecvN((char *)&m_p[0], sizeof(uint32_t)*m_p.size(),
 			pEFH->GetRecvFlags());
 		if (len == -1) {
 			int save_errno = WSAGetLastError();
@@ -1718,7 +1718,7 @@ StructMembraneMappingExtForce::RecvFromFileDes(int infd)
 		fsize = sizeof(double)*m_f.size();
 	}
 
-	ssize_t len = recvn(infd, (char *)fp, fsize, pEFH->GetRecvFlags());
+	ssize_t len = pEFH->RecvN((char *)fp, fsize, pEFH->GetRecvFlags());
 	if (len == -1) {
 		int save_errno = WSAGetLastError();
 		char *err_msg = strerror(save_errno);
@@ -2323,7 +2323,7 @@ ReadStructMappingExtForce(DataManager* pDM,
 		}
 	}
 
-	SpMapMatrixHandler *pH = 0;
+	MappingMatrix *pH = 0;
 	std::vector<uint32_t> MappedLabels;
 	if (HP.IsKeyWord("mapped" "points" "number")) {
 		int nMappedPoints = 0;
@@ -38,7 +38,7 @@
 #include <string>
 
 #include "extforce.h"
-#include "spmapmh.h"
+#include "mappingmatrix.h"
 #include "stlvh.h"
 
 /* StructMappingExtForce - begin */
@@ -53,7 +53,7 @@ protected:
 	Vec3 F2, M2;
 
 	// Mapping matrix
-	SpMapMatrixHandler *pH;
+	MappingMatrix *pH;
 
 	struct OffsetData {
 		unsigned uLabel;
@@ -96,9 +96,9 @@ protected:
 	void Recv(ExtFileHandlerBase *pEFH);
    
 	virtual void SendToStream(std::ostream& outf, ExtFileHandlerBase::SendWhen when);
-	virtual void SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen when);
+	virtual void SendToFileDes(ExtFileHandlerBase::SendWhen when);
 	virtual void RecvFromStream(std::istream& inf);
-	virtual void RecvFromFileDes(int infd);
+	virtual void RecvFromFileDes(void);
 
 public:
 	/* Costruttore */
@@ -110,7 +110,7 @@ public:
 		std::vector<const StructDispNode *>& Nodes,
 		std::vector<Vec3>& Offsets,
 		std::vector<unsigned>& Labels,
-		SpMapMatrixHandler *pH,
+		MappingMatrix *pH,
 		std::vector<uint32_t>& MappedLabels,
 		bool bLabels,
 		bool bOutputAccelerations,
@@ -160,9 +160,9 @@ protected:
 	std::vector<NodeConnData> NodesConn;
 
 	virtual void SendToStream(std::ostream& outf, ExtFileHandlerBase::SendWhen when);
-	virtual void SendToFileDes(int outfd, ExtFileHandlerBase::SendWhen when);
+	virtual void SendToFileDes(ExtFileHandlerBase::SendWhen when);
 	virtual void RecvFromStream(std::istream& inf);
-	virtual void RecvFromFileDes(int infd);
+	virtual void RecvFromFileDes(void);
 
 public:
 	/* Costruttore */
@@ -175,7 +175,7 @@ public:
 		std::vector<Vec3>& Offsets,
 		std::vector<unsigned>& Labels,
 		std::vector<NodeConnData>& NodesConn,
-		SpMapMatrixHandler *pH,
+		MappingMatrix *pH,
 		std::vector<uint32_t>& MappedLabels,
 		bool bLabels,
 		bool bOutputAccelerations,
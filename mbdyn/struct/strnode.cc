@@ -41,6 +41,7 @@
 #include "body.h"
 #include "autostr.h"
 #include "dataman.h"
+#include "checkpoint.h"
 
 #include "matvecexp.h"
 #include "Rot.hh"
@@ -795,6 +796,28 @@ StructDispNode::AfterConvergence(const VectorHandler& X,
 	XPPPrev = XPPCurr;
 }
 
+void
+StructDispNode::SaveState(CheckpointOut& out) const
+{
+	out.Put(XPrev);
+	out.Put(XCurr);
+	out.Put(VPrev);
+	out.Put(VCurr);
+	out.Put(XPPPrev);
+	out.Put(XPPCurr);
+}
+
+void
+StructDispNode::RestoreState(CheckpointIn& in)
+{
+	in.Get(XPrev);
+	in.Get(XCurr);
+	in.Get(VPrev);
+	in.Get(VCurr);
+	in.Get(XPPPrev);
+	in.Get(XPPCurr);
+}
+
 /*
  * Metodi per l'estrazione di dati "privati".
  * Si suppone che l'estrattore li sappia interpretare.
@@ -2468,6 +2491,52 @@ StructNode::AfterConvergence(const VectorHandler& X,
 	WPPrev = WPCurr;
 }
 
+void
+StructNode::SaveState(CheckpointOut& out) const
+{
+	StructDispNode::SaveState(out);
+
+	/* the queues are rotated by BeforePredict(), so the order
+	 * of the values matters, not that of the underlying arrays */
+	for (unsigned i = 0; i < NPREV; i++) {
+		out.Put(*qRPrev[i]);
+		out.Put(*qWPrev[i]);
+	}
+
+	out.Put(RRef);
+	out.Put(RCurr);
+	out.Put(gRef);
+	out.Put(gCurr);
+	out.Put(gPRef);
+	out.Put(gPCurr);
+	out.Put(WRef);
+	out.Put(WCurr);
+	out.Put(WPPrev);
+	out.Put(WPCurr);
+}
+
+void
+StructNode::RestoreState(CheckpointIn& in)
+{
+	StructDispNode::RestoreState(in);
+
+	for (unsigned i = 0; i < NPREV; i++) {
+		in.Get(*qRPrev[i]);
+		in.Get(*qWPrev[i]);
+	}
+
+	in.Get(RRef);
+	in.Get(RCurr);
+	in.Get(gRef);
+	in.Get(gCurr);
+	in.Get(gPRef);
+	in.Get(gPCurr);
+	in.Get(WRef);
+	in.Get(WCurr);
+	in.Get(WPPrev);
+	in.Get(WPCurr);
+}
+
 /*
  * Metodi per l'estrazione di dati "privati".
  * Si suppone che l'estrattore li sappia interpretare.
@@ -255,6 +255,10 @@ public:
 			const VectorHandler& XP, 
 			const VectorHandler& XPP) override;
 
+	/* Checkpoint: previous and current kinematics */
+	virtual void SaveState(CheckpointOut& out) const override;
+	virtual void RestoreState(CheckpointIn& in) override;
+
 	/* Metodi per l'estrazione di dati "privati".
 	 * Si suppone che l'estrattore li sappia interpretare.
 	 * Come default non ci sono dati privati estraibili */
@@ -779,6 +783,10 @@ public:
 			const VectorHandler& XP, 
 			const VectorHandler& XPP);
 
+	/* Checkpoint: previous, reference and current orientations */
+	virtual void SaveState(CheckpointOut& out) const;
+	virtual void RestoreState(CheckpointIn& in);
+
 	/*
 	 * Metodi per l'estrazione di dati "privati".
 	 * Si suppone che l'estrattore li sappia interpretare.
@@ -38,6 +38,7 @@
   in the GNU Public License version 2.1
 */
 
+#include <algorithm>
 #include <array>
 #include <functional>
 #include <limits>
@@ -253,6 +254,16 @@ private:
 	  doublereal r1;
      };
 
+     // candidate faces of a contact vertex, found with an enlarged
+     // search radius; valid as long as the vertex does not move
+     // (relative to the target node) more than dSearchMargin
+     struct SearchCache {
+	  Vec3 dXRef = ::Zero3;
+	  doublereal r1Ref = 0.;
+	  bool bValid = false;
+	  std::vector<integer> rgFaces;
+     };
+
      struct ContactNode {
 	  ContactNode(const StructNodeAd* pNode,
 		      std::vector<ContactVertex>&& v,
@@ -263,8 +274,21 @@ private:
 	  const std::vector<ContactVertex> rgVertices;
 	  std::unique_ptr<DriveCaller> dr;
 	  std::unordered_map<TargetFace*, ContactPair> rgContCurr, rgContPrev;
+	  std::vector<SearchCache> rgSearchCache;
+     };
+
+     // bounding volume hierarchy of the target faces,
+     // built once in the reference frame of the target node
+     struct SearchTreeNode {
+	  Vec3 oMin, oMax;
+	  integer iFirst, iCount;	// range in rgSearchFaces (leaf only)
+	  integer iLeft, iRight;	// children (-1 for a leaf)
      };
 
+     static constexpr integer iSearchTreeLeafSize = 4;
+
+     integer BuildSearchTree(integer iFirst, integer iLast);
+     void SearchTree(const Vec3& dX, doublereal dRadius, std::vector<integer>& rgFaces) const;
      void ContactSearch();
 
      doublereal GetContactForce(doublereal dz) const;
@@ -282,8 +306,11 @@ private:
 
      std::vector<TargetFace> rgTargetMesh;
      std::vector<ContactNode> rgContactMesh;
+     std::vector<SearchTreeNode> rgSearchTree;
+     std::vector<integer> rgSearchFaces;
      const StructNodeAd* pTargetNode;
      doublereal dSearchRadius;
+     doublereal dSearchMargin;
      const DifferentiableScalarFunction* pCL;
      const DataManager* const pDM;
      doublereal tCurr, tPrev;
@@ -509,7 +536,8 @@ TriangularContact::ContactNode::ContactNode(const StructNodeAd* pNode,
 					    integer iNumFaces)
      :pContNode(pNode),
       rgVertices(std::move(rgVert)),
-      dr(std::move(dr))
+      dr(std::move(dr)),
+      rgSearchCache(rgVertices.size())
 {
      rgContCurr.reserve(iNumFaces);
      rgContPrev.reserve(iNumFaces);
@@ -521,6 +549,7 @@ TriangularContact::TriangularContact(unsigned uLabel, const DofOwner *pDO,
       UserDefinedElem(uLabel, pDO),
       pTargetNode(nullptr),
       dSearchRadius(std::numeric_limits<doublereal>::max()),
+      dSearchMargin(std::numeric_limits<doublereal>::max()),
       pCL(nullptr),
       pDM(pDM),
       eFrictionModel(FrictionModel::None)
@@ -610,6 +639,10 @@ TriangularContact::TriangularContact(unsigned uLabel, const DofOwner *pDO,
 	  throw ErrGeneric(MBDYN_EXCEPT_ARGS);
      }
 
+     if (dSearchRadius < std::numeric_limits<doublereal>::max()) {
+	  dSearchMargin = dSearchRadius;
+     }
+
      TargetFace oCurrFace(pDM);
 
      if (HP.IsKeyWord("friction" "model")) {
@@ -781,6 +814,16 @@ TriangularContact::TriangularContact(unsigned uLabel, const DofOwner *pDO,
 	  }
      }
 
+     rgSearchFaces.reserve(iNumFaces);
+
+     for (integer i = 0; i < iNumFaces; ++i) {
+	  rgSearchFaces.push_back(i);
+     }
+
+     rgSearchTree.reserve(2 * (iNumFaces / iSearchTreeLeafSize + 1));
+
+     BuildSearchTree(0, iNumFaces);
+
      if (!HP.IsKeyWord("number" "of" "contact" "nodes")) {
 	  silent_cerr("triangular contact(" << uLabel
 		      << "): keyword \"number of contact nodes\" expected at line "
@@ -914,6 +957,106 @@ TriangularContact::InitialWorkSpaceDim(integer* piNumRows, integer* piNumCols) c
      *piNumCols = 0;
 }
 
+integer TriangularContact::BuildSearchTree(integer iFirst, integer iLast)
+{
+     ASSERT(iLast > iFirst);
+
+     const integer iNode = rgSearchTree.size();
+
+     rgSearchTree.emplace_back();
+
+     constexpr doublereal dInf = std::numeric_limits<doublereal>::max();
+
+     Vec3 oMin(dInf, dInf, dInf), oMax(-dInf, -dInf, -dInf);
+     Vec3 ocMin(oMin), ocMax(oMax);
+
+     for (integer i = iFirst; i < iLast; ++i) {
+	  const TargetFace& rFace = rgTargetMesh[rgSearchFaces[i]];
+
+	  for (integer j = 1; j <= 3; ++j) {
+	       oMin(j) = std::min(oMin(j), rFace.oc(j) - rFace.r);
+	       oMax(j) = std::max(oMax(j), rFace.oc(j) + rFace.r);
+	       ocMin(j) = std::min(ocMin(j), rFace.oc(j));
+	       ocMax(j) = std::max(ocMax(j), rFace.oc(j));
+	  }
+     }
+
+     integer iLeft = -1, iRight = -1;
+
+     if (iLast - iFirst > iSearchTreeLeafSize) {
+	  // split at the median of the face centroids along the longest extent
+	  integer iAxis = 1;
+
+	  for (integer j = 2; j <= 3; ++j) {
+	       if (ocMax(j) - ocMin(j) > ocMax(iAxis) - ocMin(iAxis)) {
+		    iAxis = j;
+	       }
+	  }
+
+	  const integer iMid = iFirst + (iLast - iFirst) / 2;
+
+	  std::nth_element(rgSearchFaces.begin() + iFirst,
+			   rgSearchFaces.begin() + iMid,
+			   rgSearchFaces.begin() + iLast,
+			   [this, iAxis] (integer i, integer j) {
+				return rgTargetMesh[i].oc(iAxis) < rgTargetMesh[j].oc(iAxis);
+			   });
+
+	  iLeft = BuildSearchTree(iFirst, iMid);
+	  iRight = BuildSearchTree(iMid, iLast);
+     }
+
+     // rgSearchTree may have been reallocated by the recursive calls
+     SearchTreeNode& rNode = rgSearchTree[iNode];
+
+     rNode.oMin = oMin;
+     rNode.oMax = oMax;
+     rNode.iFirst = iFirst;
+     rNode.iCount = iLast - iFirst;
+     rNode.iLeft = iLeft;
+     rNode.iRight = iRight;
+
+     return iNode;
+}
+
+void TriangularContact::SearchTree(const Vec3& dX, doublereal dRadius, std::vector<integer>& rgFaces) const
+{
+     rgFaces.clear();
+
+     // the depth of the tree is logarithmic in the number of faces
+     std::array<integer, 64> rgStack;
+     integer iTop = 0;
+
+     rgStack[iTop++] = 0;
+
+     const doublereal dRadius2 = dRadius * dRadius;
+
+     while (iTop > 0) {
+	  const SearchTreeNode& rNode = rgSearchTree[rgStack[--iTop]];
+
+	  doublereal dDist2 = 0.;
+
+	  for (integer j = 1; j <= 3; ++j) {
+	       const doublereal dj = std::max({rNode.oMin(j) - dX(j), 0., dX(j) - rNode.oMax(j)});
+	       dDist2 += dj * dj;
+	  }
+
+	  if (dDist2 > dRadius2) {
+	       continue;
+	  }
+
+	  if (rNode.iLeft < 0) {
+	       for (integer i = rNode.iFirst; i < rNode.iFirst + rNode.iCount; ++i) {
+		    rgFaces.push_back(rgSearchFaces[i]);
+	       }
+	  } else {
+	       ASSERT(iTop + 2 <= static_cast<integer>(rgStack.size()));
+	       rgStack[iTop++] = rNode.iRight;
+	       rgStack[iTop++] = rNode.iLeft;
+	  }
+     }
+}
+
 void TriangularContact::ContactSearch()
 {
      const Vec3& X2 = pTargetNode->GetXCurr();
@@ -925,27 +1068,42 @@ void TriangularContact::ContactSearch()
 	  rNode.rgContCurr.clear();
      }
 
-     for (auto& rFace: rgTargetMesh) {
-	  for (auto& rNode: rgContactMesh) {
-	       const doublereal dr = rNode.dr->dGet();
-	       const Vec3& X1 = rNode.pContNode->GetXCurr();
-	       const Mat3x3& R1 = rNode.pContNode->GetRCurr();
-	       const Vec3& X1P = rNode.pContNode->GetVCurr();
-	       const Vec3& omega1 = rNode.pContNode->GetWCurr();
-
-	       for (std::size_t iVertex = 0; iVertex < rNode.rgVertices.size(); ++iVertex) {
-		    const Vec3& o1 = rNode.rgVertices[iVertex].o1;
-		    const doublereal r1 = rNode.rgVertices[iVertex].r1 + dr;
-		    const Vec3 R1_o1 = R1 * o1;
-		    const Vec3 l1 = X1 + R1_o1 - X2;
-		    const doublereal dDist = (l1 - R2 * rFace.oc).Norm() - r1 - rFace.r;
+     for (auto& rNode: rgContactMesh) {
+	  const doublereal dr = rNode.dr->dGet();
+	  const Vec3& X1 = rNode.pContNode->GetXCurr();
+	  const Mat3x3& R1 = rNode.pContNode->GetRCurr();
+	  const Vec3& X1P = rNode.pContNode->GetVCurr();
+	  const Vec3& omega1 = rNode.pContNode->GetWCurr();
+
+	  for (std::size_t iVertex = 0; iVertex < rNode.rgVertices.size(); ++iVertex) {
+	       const Vec3& o1 = rNode.rgVertices[iVertex].o1;
+	       const doublereal r1 = rNode.rgVertices[iVertex].r1 + dr;
+	       const Vec3 R1_o1 = R1 * o1;
+	       const Vec3 l1 = X1 + R1_o1 - X2;
+	       const Vec3 dX = R2.MulTV(l1);
+
+	       SearchCache& rCache = rNode.rgSearchCache[iVertex];
+
+	       // The candidate set has been collected with a search radius
+	       // enlarged by dSearchMargin; it is still a superset of the faces
+	       // within dSearchRadius as long as the vertex did not move by more than that.
+	       if (!rCache.bValid
+		   || (dX - rCache.dXRef).Norm() + std::max(r1 - rCache.r1Ref, 0.) > dSearchMargin) {
+		    SearchTree(dX, r1 + dSearchRadius + dSearchMargin, rCache.rgFaces);
+		    rCache.dXRef = dX;
+		    rCache.r1Ref = r1;
+		    rCache.bValid = true;
+	       }
+
+	       for (const integer iFace: rCache.rgFaces) {
+		    TargetFace& rFace = rgTargetMesh[iFace];
+
+		    const doublereal dDist = (dX - rFace.oc).Norm() - r1 - rFace.r;
 
 		    if (dDist > dSearchRadius) {
 			 continue;
 		    }
 
-		    const Vec3 dX = R2.MulTV(l1);
-
 		    bool bInsert = true;
 
 		    for (integer i = 0; i < TargetFace::iNumVertices; ++i) {
@@ -972,6 +1130,7 @@ void TriangularContact::ContactSearch()
 			      }
 			 }
 
+			 // The first vertex in contact with a face wins, like in the brute force search
 			 rNode.rgContCurr.emplace(&rFace, ContactPair{&rFace.oFrictData, iVertex, vy});
 		    }
 	       }
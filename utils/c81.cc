@@ -88,7 +88,7 @@ main(int argc, char* argv[])
    }
    
    while (argc > 0) {
-      c81_data data;
+      c81_data data = {};
       char buf[1024];      
       
       ifstream in(argv[0]);
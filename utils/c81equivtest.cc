@@ -0,0 +1,224 @@
+/* $Header$ */
+/*
+ * MBDyn (C) is a multibody analysis code.
+ * http://www.mbdyn.org
+ *
+ * Copyright (C) 1996-2023
+ *
+ * Pierangelo Masarati  <pierangelo.masarati@polimi.it>
+ *
+ * Dipartimento di Ingegneria Aerospaziale - Politecnico di Milano
+ * via La Masa, 34 - 20156 Milano, Italy
+ * http://www.aero.polimi.it
+ *
+ * Changing this copyright notice is forbidden.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation (version 2 of the License).
+ * 
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/*
+ * verifica che la ricerca indicizzata nelle tabelle C81 e la valutazione
+ * a blocchi c81_aerod2_u_n() diano esattamente gli stessi risultati
+ * della ricerca per bisezione e della valutazione punto per punto
+ * c81_aerod2_u(), anche per lo jacobiano per differenze in avanti;
+ * esce con EXIT_FAILURE alla prima differenza.
+ *
+ * uso: c81equivtest <file> [<file> ...]
+ */
+
+#include "mbconfig.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+#include "myassert.h"
+#include "mynewmem.h"
+
+#include "aerodata.h"
+#include "aerodc81.h"
+#include "c81data.h"
+
+/*
+ * differenze in avanti punto per punto,
+ * come in AeroData::GetForcesJacForwardDiff_int()
+ */
+static void
+forward_diff(const doublereal *W, const vam_t *VAM, doublereal *TNG0,
+	doublereal *J, outa_t *OUTA, const c81_data *data)
+{
+	const doublereal epsilon = 1.e-3;
+	const doublereal nu = 1.e-9;
+
+	doublereal dv = std::sqrt(W[0]*W[0] + W[1]*W[1] + W[2]*W[2]);
+	doublereal dw = std::sqrt(W[3]*W[3] + W[4]*W[4] + W[5]*W[5]);
+
+	doublereal WW[6], TNG[6];
+	for (int r = 0; r < 6; r++) {
+		WW[r] = W[r];
+	}
+
+	c81_aerod2_u(WW, VAM, TNG0, OUTA, data, 0);
+
+	for (int c = 0; c < 6; c++) {
+		doublereal dorig = WW[c];
+		doublereal delta = (c < 3 ? dv : dw)*epsilon + nu;
+
+		WW[c] = dorig + delta;
+		c81_aerod2_u(WW, VAM, TNG, OUTA, data, 0);
+		for (int r = 0; r < 6; r++) {
+			J[6*c + r] = (TNG[r] - TNG0[r])/delta;
+		}
+		WW[c] = dorig;
+	}
+}
+
+static int
+check_coef(const char *fname, const char *what,
+	int nm, doublereal *m, int na, doublereal *a,
+	const std::vector<doublereal>& va, const std::vector<doublereal>& vm,
+	const std::vector<doublereal>& vc)
+{
+	for (std::vector<doublereal>::size_type i = 0; i < va.size(); i++) {
+		doublereal c = c81_data_get_coef(nm, m, na, a, va[i], vm[i]);
+		if (std::memcmp(&c, &vc[i], sizeof(doublereal)) != 0) {
+			std::cerr << fname << ": " << what
+				<< "(alpha=" << va[i] << ", mach=" << vm[i] << ")"
+				<< " bisec=" << c << " index=" << vc[i]
+				<< std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+check_file(const char *fname)
+{
+	std::ifstream in(fname);
+	if (!in) {
+		std::cerr << "unable to open file '" << fname << "'"
+			<< std::endl;
+		return 1;
+	}
+
+	c81_data databuf = {{'\0'}};
+	c81_data* data = &databuf;
+
+	int rc = c81_data_read(in, data, 1.e-1, 0);
+	in.close();
+	if (rc) {
+		std::cerr << "unable to read c81 data from file "
+			"\"" << fname << "\"" << std::endl;
+		return 1;
+	}
+
+	/* coefficienti: indice contro bisezione, anche sui nodi */
+	std::vector<doublereal> va, vm;
+	const doublereal machs[] = { -.1, 0., .15, .3, .55, .8, .99, 1.5 };
+	for (unsigned j = 0; j < sizeof(machs)/sizeof(machs[0]); j++) {
+		for (doublereal alpha = -400.; alpha <= 400.; alpha += .37) {
+			va.push_back(alpha);
+			vm.push_back(machs[j]);
+		}
+		for (int k = 0; k < data->NAL; k++) {
+			va.push_back(data->al[k]);
+			vm.push_back(machs[j]);
+		}
+	}
+
+	std::vector<doublereal> cl(va.size()), cd(va.size()), cm(va.size());
+	c81_data_get_coefs(data, va.size(), &va[0], &vm[0],
+		&cl[0], &cd[0], &cm[0], NULL, NULL);
+
+	rc = check_coef(fname, "cl", data->NML, data->ml, data->NAL, data->al, va, vm, cl)
+		|| check_coef(fname, "cd", data->NMD, data->md, data->NAD, data->ad, va, vm, cd)
+		|| check_coef(fname, "cm", data->NMM, data->mm, data->NAM, data->am, va, vm, cm);
+
+	/* forze: a blocchi contro punto per punto */
+	vam_t VAM = { 1.225, 340., .5, -.125, .125, 0. };
+	const int n = 1000;
+	std::vector<doublereal> W(6*n), TNG(6*n), TNGn(6*n);
+	std::vector<outa_t> OUTA(n, outa_Zero), OUTAn(n, outa_Zero);
+
+	srand(1);
+	for (int i = 0; i < 6*n; i++) {
+		W[i] = 400.*(doublereal(rand())/RAND_MAX - .5);
+	}
+	/* velocita' trascurabile */
+	for (int r = 0; r < 6; r++) {
+		W[6*7 + r] = 0.;
+	}
+
+	for (int i = 0; i < n; i++) {
+		c81_aerod2_u(&W[6*i], &VAM, &TNG[6*i], &OUTA[i], data, 0);
+	}
+	c81_aerod2_u_n(n, &W[0], &VAM, &TNGn[0], &OUTAn[0], data);
+
+	if (rc == 0 && (std::memcmp(&TNG[0], &TNGn[0], sizeof(doublereal)*6*n) != 0
+		|| std::memcmp(&OUTA[0], &OUTAn[0], sizeof(outa_t)*n) != 0))
+	{
+		std::cerr << fname << ": c81_aerod2_u_n() differs from c81_aerod2_u()"
+			<< std::endl;
+		rc = 1;
+	}
+
+	/* jacobiano: a blocchi contro differenze in avanti */
+	for (int i = 0; rc == 0 && i < n; i++) {
+		doublereal T[6], Tn[6], J[36], Jn[36];
+		outa_t o = outa_Zero, on = outa_Zero;
+
+		forward_diff(&W[6*i], &VAM, T, J, &o, data);
+		c81_aerod2_u_jac(&W[6*i], &VAM, Tn, Jn, &on, data);
+
+		if (std::memcmp(T, Tn, sizeof(T)) != 0
+			|| std::memcmp(J, Jn, sizeof(J)) != 0
+			|| std::memcmp(&o, &on, sizeof(outa_t)) != 0)
+		{
+			std::cerr << fname << ": c81_aerod2_u_jac() differs "
+				"from forward differences at point " << i
+				<< std::endl;
+			rc = 1;
+		}
+	}
+
+	c81_data_destroy(data);
+
+	return rc;
+}
+
+int
+main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		std::cerr << "usage: c81equivtest <file> [<file> ...]" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	for (int i = 1; i < argc; i++) {
+		if (check_file(argv[i])) {
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	exit(EXIT_SUCCESS);
+}
+
@@ -108,6 +108,12 @@ c81_data_merge_from(c81_data *data_from, doublereal wfrom, c81_data *data_to, do
 {
 	*data = *data_from;
 
+	/* the indexes of the tables belong to data_from;
+	 * the merged tables get their own */
+	data->il = c81_index();
+	data->id = c81_index();
+	data->im = c81_index();
+
 	data->ml = new doublereal[data->NML];
 	data->al = new doublereal[data->NAL*(data->NML + 1)];
 
@@ -155,6 +161,7 @@ c81_data_merge_from(c81_data *data_from, doublereal wfrom, c81_data *data_to, do
 	merge_data_from(NA, NM, NM_to, wfrom, wto, workv, m_from, m_to, m_dst, a_from, a_to, a_dst);
 
 	// c81_do_data_stall(data);
+	c81_data_do_index(data);
 
 	return 0;
 }
@@ -215,6 +222,12 @@ c81_data_merge_to(c81_data *data_from, doublereal wfrom, c81_data *data_to, doub
 {
 	*data = *data_to;
 
+	/* the indexes of the tables belong to data_to;
+	 * the merged tables get their own */
+	data->il = c81_index();
+	data->id = c81_index();
+	data->im = c81_index();
+
 	data->ml = new doublereal[data->NML];
 	data->al = new doublereal[data->NAL*(data->NML + 1)];
 
@@ -262,6 +275,7 @@ c81_data_merge_to(c81_data *data_from, doublereal wfrom, c81_data *data_to, doub
 	merge_data_to(NA, NM, NM_from, wfrom, wto, workv, m_from, m_to, m_dst, a_from, a_to, a_dst);
 
 	// c81_do_data_stall(data);
+	c81_data_do_index(data);
 
 	return 0;
 }
@@ -278,9 +292,9 @@ c81_data_merge_both(c81_data *data_from, doublereal wfrom, c81_data *data_to, do
 int
 main(int argc, char *argv[])
 {
-	c81_data	data_from,
-			data_to,
-			data;
+	c81_data	data_from = {},
+			data_to = {},
+			data = {};
 	char		*name_from = 0,
 			*name_to = 0,
 			*name = 0,
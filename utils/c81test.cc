@@ -34,6 +34,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <vector>
 #include "ac/getopt.h"
 
 #include "myassert.h"
@@ -176,17 +177,17 @@ main(int argc, char *argv[])
 		switch (got) {
 		default:
 		case GOT_NONE:
-		case GOT_ALPHA:
-		case GOT_MACH:
 			if (coef == '\0') {
 				std::cerr << "need to select a coefficient "
-					"when alpha and mach "
-					"are not selected altogether"
+					"when neither alpha nor mach "
+					"are selected"
 					<< std::endl;
 				usage(EXIT_FAILURE);
 			}
 			break;
 
+		case GOT_ALPHA:
+		case GOT_MACH:
 		case GOT_ALPHAMACH:
 			break;
 		}
@@ -319,11 +320,42 @@ main(int argc, char *argv[])
 			break;
 
 		case '\0':
-			/* TODO */
+			/* sweep over the CL table, dump all coefficients */
+			NM = data->NML;
+			NA = data->NAL;
+			m = data->ml;
+			a = data->al;
 			break;
 		}
 
-		if (m) {
+		if (m && coef == '\0') {
+			int n = ((got & GOT_ALPHAMACH) == GOT_ALPHA) ? NM : NA;
+			std::vector<doublereal> va(n), vm(n), cl(n), cd(n), cm(n);
+
+			for (int i = 0; i < n; i++) {
+				if ((got & GOT_ALPHAMACH) == GOT_ALPHA) {
+					va[i] = alpha;
+					vm[i] = m[i];
+
+				} else {
+					va[i] = a[i];
+					vm[i] = mach;
+				}
+			}
+
+			c81_data_get_coefs(data, n, &va[0], &vm[0],
+				&cl[0], &cd[0], &cm[0], NULL, NULL);
+
+			for (int i = 0; i < n; i++) {
+				std::cout
+					<< (((got & GOT_ALPHAMACH) == GOT_ALPHA) ? vm[i] : va[i]) << " "
+					<< cl[i] << " "
+					<< cd[i] << " "
+					<< cm[i]
+					<< std::endl;
+			}
+
+		} else if (m) {
 			switch (got & GOT_ALPHAMACH) {
 			case GOT_ALPHA:
 				for (int i = 0; i < NM; i++) {
@@ -61,7 +61,7 @@ usage(void)
 		"\t-a\t\tuse accelerations\n"
 		"\t-c [random:]<c>\tnumber of iterations\n"
 		"\t-f {fx,fy,fz,mx,my,mz} reference node force/moment\n"
-		"\t-H <url>\tURL (local://path | inet://host:port)\n"
+		"\t-H <url>\tURL (local://path | inet://host:port | shm://name)\n"
 		"\t-l\t\tlabels\n"
 		"\t-i <filename>\tinput file\n"
 		"\t-n\t\tonly forces, no moments\n"
@@ -90,6 +90,7 @@ static int accelerations = 0;
 static unsigned rot = MBC_ROT_MAT;
 
 static char *path = NULL;
+static char *shmname = NULL;
 static char *host = NULL;
 static unsigned short int port = -1;
 
@@ -220,6 +221,11 @@ test_init(int argc, char *argv[])
 					usage();
 				}
 #endif /* _WIN32 */
+			} else if (strncasecmp(optarg, "shm://", sizeof("shm://") - 1) == 0) {
+				shmname = optarg + sizeof("shm://") - 1;
+				if (shmname[0] == '\0') {
+					usage();
+				}
 			} else {
 				usage();
 			}
@@ -459,7 +465,15 @@ test_init(int argc, char *argv[])
                     "Finished parsing input\n ");
 	}
 
-	if (path) {
+	if (shmname) {
+		/* attach to shared memory segment created by MBDyn */
+		if (mbc_shm_init((mbc_t *)mbc, shmname)) {
+			fprintf(stderr, "test_strext_socket: "
+				"mbc_shm_init call failed\n ");
+			exit(EXIT_FAILURE);
+		}
+
+	} else if (path) {
 #ifdef _WIN32
 		fprintf(stderr, "test_strext_socket: "
 				"Windows does not support local sockets, use inet sockets instead.\n ");